@@ -0,0 +1,42 @@
+#pragma once
+
+#include "othello/board.hpp"
+#include "othello/endgame.hpp"
+
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+// Every position of one seeded random game, opening to endgame, each with a move to play
+inline std::vector<std::pair<OthelloBoard, Player>> game_positions(uint32_t seed) {
+    std::vector<std::pair<OthelloBoard, Player>> positions;
+    std::mt19937 rng(seed);
+    OthelloBoard board;
+    Player player = Player::BLACK;
+    while (!board.is_game_over()) {
+        auto moves = board.get_valid_moves(player);
+        if (!moves.empty()) {
+            positions.push_back({board, player});
+            board.apply_move(player, moves[rng() % moves.size()]);
+        }
+        player = othello::opponent(player);
+    }
+    return positions;
+}
+
+// Fixed search positions: the start, a middle game and an endgame from game_positions(1)
+inline std::pair<OthelloBoard, Player> search_position(int index) {
+    if (index == 0) return {OthelloBoard(), Player::BLACK};
+    const auto positions = game_positions(1);
+    return positions[index == 1 ? positions.size() / 2 : positions.size() - 12];
+}
+
+// The FFO endgame positions in bench/ffo.obf, each with its published result
+inline const std::vector<othello::ScoredPosition>& ffo_positions() {
+    static const std::vector<othello::ScoredPosition> positions = othello::load_positions(OTHELLO_FFO_FILE);
+    return positions;
+}
+
+} // namespace bench
@@ -0,0 +1,88 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <random>
+#include "bench_positions.hpp"
+#include "othello/endgame.hpp"
+#include "othello/greedy_evaluator.hpp"
+#include "othello/mcts.hpp"
+#include "othello/pattern_evaluator.hpp"
+#include "othello/selfplay.hpp"
+
+// Full searches and games with the CPU evaluators, so they measure the engine rather than
+// the network (see BM_NetworkEvaluate and BM_OpenCLEvaluate for that)
+
+// One 800-simulation search from a fresh tree; the argument picks the position:
+// 0 the start, 1 a middle game, 2 an endgame
+static void BM_Search800(benchmark::State& state) {
+    const auto [board, player] = bench::search_position(static_cast<int>(state.range(0)));
+    othello::GreedyEvaluator evaluator;
+    othello::MCTS mcts(evaluator, 800);
+    mcts.set_log_stats(false);
+    mcts.seed(1);
+    int64_t simulations = 0;
+    for (auto _ : state) {
+        mcts.set_root(board, player);
+        mcts.run();
+        simulations += mcts.last_simulations();
+    }
+    state.SetItemsProcessed(simulations);
+}
+BENCHMARK(BM_Search800)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+
+// The same searches with the pattern evaluator (random weights), whose indices follow the
+// search path incrementally
+static void BM_PatternSearch800(benchmark::State& state) {
+    const auto [board, player] = bench::search_position(static_cast<int>(state.range(0)));
+    othello::PatternEvaluator evaluator;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> weight(-0.05f, 0.05f);
+    for (float& w : evaluator.weights()) w = weight(rng);
+    othello::MCTS mcts(evaluator, 800);
+    mcts.set_log_stats(false);
+    mcts.seed(1);
+    int64_t simulations = 0;
+    for (auto _ : state) {
+        mcts.set_root(board, player);
+        mcts.run();
+        simulations += mcts.last_simulations();
+    }
+    state.SetItemsProcessed(simulations);
+}
+BENCHMARK(BM_PatternSearch800)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+
+// Self-play games at 100 simulations per move on one thread; items are positions
+static void BM_SelfPlayGame(benchmark::State& state) {
+    othello::GreedyEvaluator evaluator;
+    othello::SelfPlayConfig config;
+    config.simulations = 100;
+    uint32_t seed = 1;
+    int64_t positions = 0;
+    for (auto _ : state) positions += othello::SelfPlay::play_game(evaluator, config, seed++).size();
+    state.SetItemsProcessed(positions);
+    state.counters["games_per_second"] = benchmark::Counter(state.iterations(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_SelfPlayGame)->Unit(benchmark::kMillisecond);
+
+// Exact solve of an FFO endgame position from an empty table; the first argument indexes
+// bench/ffo.obf, the second is the thread count. Items are nodes.
+static void BM_SolveFfo(benchmark::State& state) {
+    const othello::ScoredPosition& position = bench::ffo_positions().at(static_cast<size_t>(state.range(0)));
+    othello::EndgameConfig config;
+    config.threads = static_cast<int>(state.range(1));
+    othello::EndgameSolver solver(config);
+    int64_t nodes = 0;
+    for (auto _ : state) {
+        solver.clear();
+        const othello::EndgameResult result = solver.solve(position.board, position.player);
+        if (result.score != position.score) state.SkipWithError("score differs from the published one");
+        nodes += result.nodes;
+    }
+    state.SetItemsProcessed(nodes);
+    state.SetLabel(position.label);
+}
+BENCHMARK(BM_SolveFfo)
+    ->Apply([](benchmark::internal::Benchmark* b) {
+        for (size_t i = 0; i < bench::ffo_positions().size(); ++i) b->Args({int64_t(i), 1})->Args({int64_t(i), 4});
+    })
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
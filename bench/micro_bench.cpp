@@ -0,0 +1,222 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+#include "bench_positions.hpp"
+#include "nn/network.hpp"
+#include "opencl/context.hpp"
+#include "opencl/network_evaluator.hpp"
+#include "othello/greedy_evaluator.hpp"
+#include "othello/mctsnode.hpp"
+#include "othello/network_evaluator.hpp"
+#include "othello/pattern_evaluator.hpp"
+#include "replay/buffer.hpp"
+
+// Micro benchmarks cycle through the positions of one game, so every phase is weighted by
+// how long it lasts in play
+
+namespace {
+    const std::vector<std::pair<OthelloBoard, Player>>& positions() {
+        static const auto all = bench::game_positions(1);
+        return all;
+    }
+
+    std::vector<float> encoded_positions(int n) {
+        std::vector<float> inputs(n * OthelloBoard::kTensorSize);
+        for (int i = 0; i < n; ++i) {
+            const auto& [board, player] = positions()[i % positions().size()];
+            board.encode(player, inputs.data() + i * OthelloBoard::kTensorSize);
+        }
+        return inputs;
+    }
+}
+
+static void BM_LegalMoveMask(benchmark::State& state) {
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto& [board, player] = positions()[i];
+        benchmark::DoNotOptimize(board.legal_move_mask(player));
+        if (++i == positions().size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LegalMoveMask);
+
+static void BM_ValidMoves(benchmark::State& state) {
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto& [board, player] = positions()[i];
+        benchmark::DoNotOptimize(board.get_valid_moves(player));
+        if (++i == positions().size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ValidMoves);
+
+// Placing a disk and flipping the captured lines
+static void BM_ApplyMove(benchmark::State& state) {
+    std::vector<Move> moves;
+    for (const auto& [board, player] : positions()) moves.push_back(board.get_valid_moves(player)[0]);
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto& [board, player] = positions()[i];
+        benchmark::DoNotOptimize(board.apply_move_copy(player, moves[i]));
+        if (++i == positions().size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ApplyMove);
+
+static void BM_EncodeTensor(benchmark::State& state) {
+    float tensor[OthelloBoard::kTensorSize];
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto& [board, player] = positions()[i];
+        board.encode(player, tensor);
+        benchmark::DoNotOptimize(tensor);
+        if (++i == positions().size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EncodeTensor);
+
+// PUCT choice at an expanded node with visits spread over its moves, as MCTS::select_move
+static void BM_UcbSelect(benchmark::State& state) {
+    othello::GreedyEvaluator evaluator;
+    std::vector<othello::MCTSNode> nodes;
+    std::mt19937 rng(1);
+    for (const auto& [board, player] : positions()) {
+        othello::MCTSNode& node = nodes.emplace_back(board, player);
+        node.expand([&](const OthelloBoard& b, Player p, float* policy) {
+            return evaluator.evaluate_into(b, p, policy);
+        });
+        for (uint64_t m = node.legal_move_mask; m; m &= m - 1) {
+            const int idx = __builtin_ctzll(m);
+            node.visit_count[idx] = rng() % 50;
+            node.value_sum[idx] = node.visit_count[idx] * ((rng() % 200) / 100.0f - 1.0f);
+        }
+    }
+    size_t i = 0;
+    for (auto _ : state) {
+        const othello::MCTSNode& node = nodes[i];
+        int total_visits = 0;
+        for (int n : node.visit_count) total_visits += n;
+        float best_score = -1e9f;
+        int best = -1;
+        for (uint64_t m = node.legal_move_mask; m; m &= m - 1) {
+            const int idx = __builtin_ctzll(m);
+            const float score = node.ucb_score(idx, total_visits, 1.5f);
+            if (score > best_score) {
+                best_score = score;
+                best = idx;
+            }
+        }
+        benchmark::DoNotOptimize(best);
+        if (++i == nodes.size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UcbSelect);
+
+static void BM_GreedyEvaluate(benchmark::State& state) {
+    othello::GreedyEvaluator evaluator;
+    float policy[othello::kNumMoves];
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto& [board, player] = positions()[i];
+        benchmark::DoNotOptimize(evaluator.evaluate_into(board, player, policy));
+        if (++i == positions().size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GreedyEvaluate);
+
+// Pattern lookups with random weights, built from scratch for each position as outside a
+// search; the argument is 1 for the one-ply lookahead policy, 0 for the uniform one
+static void BM_PatternEvaluate(benchmark::State& state) {
+    othello::PatternEvaluator evaluator(state.range(0) != 0);
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> weight(-0.05f, 0.05f);
+    for (float& w : evaluator.weights()) w = weight(rng);
+    float policy[othello::kNumMoves];
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto& [board, player] = positions()[i];
+        benchmark::DoNotOptimize(evaluator.evaluate_into(board, player, policy));
+        if (++i == positions().size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PatternEvaluate)->Arg(0)->Arg(1);
+
+// CPU forward passes of the default network; the argument is the batch size
+static void BM_NetworkEvaluate(benchmark::State& state) {
+    const int n = static_cast<int>(state.range(0));
+    nn::Network net;
+    net.init_random(5);
+    othello::NetworkEvaluator evaluator(net);
+    const std::vector<float> inputs = encoded_positions(n);
+    std::vector<float> policies(n * nn::kPolicySize), values(n);
+    for (auto _ : state) {
+        evaluator.evaluate_batch(inputs.data(), n, policies.data(), values.data());
+        benchmark::DoNotOptimize(values.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_NetworkEvaluate)->Arg(1)->Arg(16);
+
+// The same batches through the OpenCL pipeline, on any device (reported as skipped without one)
+static void BM_OpenCLEvaluate(benchmark::State& state) {
+    if (OpenCLContext::enumerate_devices().empty()) {
+        state.SkipWithError("No OpenCL device available");
+        return;
+    }
+    const int n = static_cast<int>(state.range(0));
+    nn::Network net;
+    net.init_random(5);
+    DeviceSelector any;
+    any.type = CL_DEVICE_TYPE_ALL;
+    OpenCLContext context(any);
+    OpenCLEvaluator evaluator(context, net, n);
+    const std::vector<float> inputs = encoded_positions(n);
+    std::vector<float> policies(n * nn::kPolicySize), values(n);
+    for (auto _ : state) {
+        evaluator.evaluate_batch(inputs.data(), n, policies.data(), values.data());
+        benchmark::DoNotOptimize(values.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_OpenCLEvaluate)->Arg(1)->Arg(64)->Arg(256)->UseRealTime();
+
+static void BM_ReplayInsert(benchmark::State& state) {
+    ReplayBuffer buffer(1 << 16);
+    float policy[othello::kNumMoves] = {};
+    policy[19] = 1.0f;
+    size_t i = 0;
+    for (auto _ : state) {
+        const auto& [board, player] = positions()[i];
+        benchmark::DoNotOptimize(buffer.insert(board.bits(player), board.bits(othello::opponent(player)), policy, 0.5f));
+        if (++i == positions().size()) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ReplayInsert);
+
+// Training batches from a full buffer; the argument is the batch size
+static void BM_ReplaySample(benchmark::State& state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    ReplayBuffer buffer(1 << 16);
+    float policy[othello::kNumMoves] = {};
+    policy[19] = 1.0f;
+    for (size_t i = 0; i < buffer.capacity(); ++i) {
+        const auto& [board, player] = positions()[i % positions().size()];
+        buffer.insert(board.bits(player), board.bits(othello::opponent(player)), policy, 0.5f);
+    }
+    std::vector<float> states(n * OthelloBoard::kTensorSize), policies(n * othello::kNumMoves), values(n);
+    std::mt19937 rng(1);
+    for (auto _ : state) {
+        buffer.sample_into(n, states.data(), policies.data(), values.data(), rng);
+        benchmark::DoNotOptimize(values.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_ReplaySample)->Arg(256);
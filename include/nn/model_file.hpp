@@ -0,0 +1,59 @@
+#pragma once
+
+#include "nn/network.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace nn {
+
+// Versioned binary model format, designed to be memory-mapped and used without copying.
+//
+//   ModelHeader                          fixed size, little-endian
+//   TensorEntry[num_tensors]             one per LinearSpec, in parameter order
+//   padding to ModelHeader::alignment
+//   fp32 parameters                      data_bytes, checksummed
+//
+// The tensor table must match the layout Network(config) expects, so a file written for one
+// architecture is rejected by another instead of being silently misread.
+struct ModelHeader {
+    char magic[8];              // "OTHMODEL"
+    uint32_t version;
+    uint32_t header_bytes;      // sizeof(ModelHeader)
+    uint32_t channels;
+    uint32_t trunk_layers;
+    uint32_t value_hidden;
+    uint32_t num_tensors;
+    uint32_t alignment;         // data_offset is a multiple of this
+    uint32_t reserved;
+    uint64_t data_offset;       // bytes from the start of the file
+    uint64_t data_bytes;
+    uint64_t checksum;          // model_checksum() of the parameter bytes
+};
+
+struct TensorEntry {
+    char name[32];
+    uint32_t out;
+    uint32_t in;
+    uint64_t weight_offset;     // in floats, relative to the parameter block
+    uint64_t bias_offset;
+};
+
+constexpr uint32_t kModelVersion = 1;
+constexpr uint32_t kModelAlignment = 64;
+
+uint64_t model_checksum(const void* data, size_t bytes);
+
+// Writes `network` to `path` via a temporary file and rename(), so readers never see a
+// partially written model
+void save_model(const std::string& path, const Network& network);
+
+// Maps `path` read-only and returns a zero-copy view; the mapping lives as long as the network
+Network load_model(const std::string& path);
+
+// Same as load_model for a model image already in memory (e.g. an embedded array).
+// The memory must outlive the network and be aligned to kModelAlignment.
+Network load_model(const void* data, size_t bytes);
+
+} // namespace nn
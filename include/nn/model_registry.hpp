@@ -0,0 +1,55 @@
+#pragma once
+
+#include "nn/network.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace nn {
+
+// Holds the current model for a long-running process and swaps in a new one when the file
+// on disk changes. Publish a new checkpoint with nn::save_model (or any write + rename):
+// poll() notices the new file, validates it and atomically replaces current(). Searches that
+// already hold the previous shared_ptr keep using it until they finish.
+// Replace the file, never rewrite it in place: the current model is a mapping of it.
+class ModelRegistry {
+public:
+    // Loads `path` immediately; throws if it is missing or invalid
+    explicit ModelRegistry(std::string path);
+
+    // Loaded from memory (e.g. the embedded fallback); never reloads
+    explicit ModelRegistry(Network network);
+
+    std::shared_ptr<const Network> current() const { return std::atomic_load(&current_); }
+
+    // Reloads if the file was replaced or modified (or unconditionally with force).
+    // An invalid replacement is logged and the current model kept. Returns true on a swap.
+    bool poll(bool force = false);
+
+    // Incremented on every successful swap
+    uint64_t generation() const { return generation_.load(std::memory_order_acquire); }
+
+    const std::string& path() const { return path_; }
+
+private:
+    struct FileId {
+        uint64_t device = 0, inode = 0, size = 0;
+        int64_t mtime_ns = 0;
+        bool operator==(const FileId& o) const {
+            return device == o.device && inode == o.inode && size == o.size && mtime_ns == o.mtime_ns;
+        }
+    };
+
+    std::string path_;
+    std::shared_ptr<const Network> current_;
+    std::atomic<uint64_t> generation_{0};
+    std::mutex reload_mutex_;
+    FileId loaded_id_;
+
+    static bool stat_file(const std::string& path, FileId& id);
+};
+
+} // namespace nn
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace nn {
+
+constexpr int kBoardSquares = 64;
+constexpr int kInputPlanes = 3;                              // own, opponent, legal moves
+constexpr int kInputSize = kInputPlanes * kBoardSquares;     // matches OthelloBoard::to_tensor
+constexpr int kPolicySize = 65;                              // 64 squares + pass
+
+struct NetworkConfig {
+    int channels = 32;       // trunk width
+    int trunk_layers = 4;    // number of 3x3 conv layers
+    int value_hidden = 64;   // value head hidden units
+};
+
+// Every layer of the network is a linear map y = W x + b.
+// Convolutions are applied per square: 3x3 on a gathered patch, 1x1 on the square itself.
+struct LinearSpec {
+    std::string name;
+    int out;
+    int in;
+    size_t weight_offset;   // [out][in], row-major
+    size_t bias_offset;     // [out]
+};
+
+// Gather the 3x3 neighbourhood of (x, y) from an HWC activation map.
+// Patch layout is [ky][kx][channel]; off-board neighbours are zero.
+template <typename T>
+inline void gather_patch(const T* act, int channels, int stride, int x, int y, T* patch) {
+    for (int ky = 0; ky < 3; ++ky) {
+        for (int kx = 0; kx < 3; ++kx) {
+            T* dst = patch + (ky * 3 + kx) * channels;
+            int nx = x + kx - 1, ny = y + ky - 1;
+            if (nx < 0 || nx >= 8 || ny < 0 || ny >= 8) {
+                for (int c = 0; c < channels; ++c) dst[c] = T(0);
+            } else {
+                const T* src = act + (ny * 8 + nx) * stride;
+                for (int c = 0; c < channels; ++c) dst[c] = src[c];
+            }
+        }
+    }
+}
+
+void softmax(float* x, int n);
+
+// Policy/value network:
+//   trunk:  trunk_layers x (3x3 conv, ReLU)
+//   policy: 1x1 conv -> 2 planes, ReLU, dense -> 65 logits, softmax
+//   value:  1x1 conv -> 1 plane, ReLU, dense -> value_hidden, ReLU, dense -> 1, tanh
+class Network {
+public:
+    // Linear layers following the trunk, in parameter order
+    enum Head { POLICY_CONV = 0, POLICY_FC, VALUE_CONV, VALUE_FC1, VALUE_FC2, NUM_HEADS };
+
+    explicit Network(const NetworkConfig& config = {});
+
+    // Load raw fp32 parameters in layout order; throws if the size does not match
+    static Network from_buffer(const void* data, size_t bytes, const NetworkConfig& config = {});
+
+    // Zero-copy view of count parameters at `data`, e.g. a memory-mapped model file.
+    // `owner` keeps the memory alive for as long as the network (or any copy) exists.
+    static Network view(const float* data, size_t count, const NetworkConfig& config,
+                        std::shared_ptr<const void> owner);
+
+    // Linear layers of `config` in parameter order, without allocating any parameters;
+    // `num_params` receives their total. Throws std::invalid_argument for non-positive sizes.
+    static std::vector<LinearSpec> layout(const NetworkConfig& config, size_t* num_params = nullptr);
+
+    // He-normal weights, zero biases
+    void init_random(uint32_t seed);
+
+    // Single-position inference.
+    // - input: CHW 3x8x8 tensor as produced by OthelloBoard::to_tensor
+    // - policy: receives kPolicySize probabilities
+    // - input_max: optional running max of each linear layer's input (used for calibration)
+    // Returns the value in [-1, 1] from the side to move's perspective.
+    float forward(const float* input, float* policy, std::vector<float>* input_max = nullptr) const;
+
+    const NetworkConfig& config() const { return config_; }
+    const std::vector<LinearSpec>& linears() const { return linears_; }
+    int head_index(Head head) const { return config_.trunk_layers + head; }
+
+    const float* params() const { return view_ ? view_ : params_.data(); }
+    float* mutable_params();   // throws for views, which are read-only
+    size_t num_params() const { return num_params_; }
+    bool is_view() const { return view_ != nullptr; }
+
+private:
+    struct LayoutOnly {};
+    Network(const NetworkConfig& config, LayoutOnly);   // no parameter storage, for views
+
+    NetworkConfig config_;
+    std::vector<LinearSpec> linears_;
+    std::vector<float> params_;              // owned storage; empty for views
+    const float* view_ = nullptr;
+    std::shared_ptr<const void> owner_;
+    size_t num_params_ = 0;
+};
+
+} // namespace nn
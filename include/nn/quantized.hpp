@@ -0,0 +1,52 @@
+#pragma once
+
+#include "nn/network.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace nn {
+
+// Activation ranges collected from fp32 inference, one entry per linear layer input
+struct Calibration {
+    std::vector<float> input_max;
+
+    // Run the fp32 network over sample positions and record activation ranges
+    static Calibration collect(const Network& net, const std::vector<std::vector<float>>& inputs);
+
+    // Plain text, one "<layer name> <max>" per line
+    void save(const std::string& path, const Network& net) const;
+    static Calibration load(const std::string& path, const Network& net);
+};
+
+// Int8 inference path.
+// - weights: symmetric int8, one scale per output channel
+// - activations: 7-bit unsigned (every layer input is post-ReLU or a 0/1 plane),
+//   one scale per layer from the calibration ranges
+// - accumulation in int32, biases and output heads in fp32
+class QuantizedNetwork {
+public:
+    QuantizedNetwork(const Network& net, const Calibration& calibration);
+
+    // Same contract as Network::forward
+    float forward(const float* input, float* policy) const;
+
+private:
+    struct QLinear {
+        int out;
+        int in;
+        int padded_in;                  // multiple of 32 for the SIMD kernels
+        float input_scale;              // real value of one activation step
+        std::vector<int8_t> weights;    // [out][padded_in]
+        std::vector<float> out_scale;   // input_scale * per-channel weight scale
+        std::vector<float> bias;
+    };
+
+    NetworkConfig config_;
+    std::vector<QLinear> layers_;
+
+    const QLinear& head(Network::Head h) const { return layers_[config_.trunk_layers + h]; }
+};
+
+} // namespace nn
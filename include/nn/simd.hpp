@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cstdint>
+
+// Kernels for AVX2, AVX-512 VNNI and AVX-VNNI are compiled with per-function target
+// attributes and picked at runtime, so a portable build (OTHELLO_NATIVE_ARCH off) still runs
+// the fastest path the host supports.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define NN_SIMD_X86 1
+#include <immintrin.h>
+// __builtin_cpu_supports("avxvnni") and the avxvnni target need GCC 11 / Clang 16
+#if (defined(__clang__) && __clang_major__ >= 16) || (!defined(__clang__) && __GNUC__ >= 11)
+#define NN_SIMD_AVXVNNI 1
+#endif
+#endif
+
+namespace nn::simd {
+
+enum class Isa { Scalar, Avx2, Avx512Vnni, AvxVnni };
+
+// Best path this CPU supports, detected once
+inline Isa isa() {
+#if defined(NN_SIMD_X86)
+    static const Isa detected = [] {
+        __builtin_cpu_init();
+        if (!__builtin_cpu_supports("avx2") || !__builtin_cpu_supports("fma")) return Isa::Scalar;
+#if defined(NN_SIMD_AVXVNNI)
+        if (__builtin_cpu_supports("avxvnni")) return Isa::AvxVnni;
+#endif
+        if (__builtin_cpu_supports("avx512vnni") && __builtin_cpu_supports("avx512vl")) return Isa::Avx512Vnni;
+        return Isa::Avx2;
+    }();
+    return detected;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+// Name of the int8 dot-product path in use on this host
+inline const char* int8_backend() {
+    switch (isa()) {
+        case Isa::AvxVnni: return "avx-vnni";
+        case Isa::Avx512Vnni: return "avx512-vnni";
+        case Isa::Avx2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+#if defined(NN_SIMD_X86)
+namespace detail {
+
+__attribute__((target("avx2"))) inline float hsum(__m256 v) {
+    __m128 lo = _mm256_castps256_ps128(v);
+    __m128 hi = _mm256_extractf128_ps(v, 1);
+    lo = _mm_add_ps(lo, hi);
+    lo = _mm_hadd_ps(lo, lo);
+    lo = _mm_hadd_ps(lo, lo);
+    return _mm_cvtss_f32(lo);
+}
+
+__attribute__((target("avx2"))) inline int32_t hsum(__m256i v) {
+    __m128i lo = _mm256_castsi256_si128(v);
+    __m128i hi = _mm256_extracti128_si256(v, 1);
+    lo = _mm_add_epi32(lo, hi);
+    lo = _mm_hadd_epi32(lo, lo);
+    lo = _mm_hadd_epi32(lo, lo);
+    return _mm_cvtsi128_si32(lo);
+}
+
+// Vectorised part of dot(); returns the sum over [0, *done)
+__attribute__((target("avx2,fma"))) inline float dot_avx2(const float* a, const float* b, int n, int* done) {
+    int i = 0;
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    for (; i + 8 <= n; i += 8)
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+    *done = i;
+    return hsum(_mm256_add_ps(acc0, acc1));
+}
+
+__attribute__((target("avx2,fma"))) inline int axpy_avx2(float alpha, const float* x, float* y, int n) {
+    int i = 0;
+    __m256 va = _mm256_set1_ps(alpha);
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(y + i, _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+    return i;
+}
+
+__attribute__((target("avx2"))) inline int32_t dot_u8s8_avx2(const uint8_t* a, const int8_t* b, int n) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i acc = _mm256_setzero_si256();
+    for (int i = 0; i < n; i += 32) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i pairs = _mm256_maddubs_epi16(va, vb);
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(pairs, ones));
+    }
+    return hsum(acc);
+}
+
+__attribute__((target("avx2,avx512vnni,avx512vl"))) inline int32_t dot_u8s8_avx512vnni(const uint8_t* a,
+                                                                                       const int8_t* b, int n) {
+    __m256i acc = _mm256_setzero_si256();
+    for (int i = 0; i < n; i += 32) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        acc = _mm256_dpbusd_epi32(acc, va, vb);
+    }
+    return hsum(acc);
+}
+
+#if defined(NN_SIMD_AVXVNNI)
+__attribute__((target("avx2,avxvnni"))) inline int32_t dot_u8s8_avxvnni(const uint8_t* a, const int8_t* b, int n) {
+    __m256i acc = _mm256_setzero_si256();
+    for (int i = 0; i < n; i += 32) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        acc = _mm256_dpbusd_avx_epi32(acc, va, vb);
+    }
+    return hsum(acc);
+}
+#endif
+
+} // namespace detail
+#endif
+
+// fp32 dot product of two length-n vectors
+inline float dot(const float* a, const float* b, int n) {
+    int i = 0;
+    float sum = 0.0f;
+#if defined(NN_SIMD_X86)
+    if (isa() != Isa::Scalar) sum = detail::dot_avx2(a, b, n, &i);
+#endif
+    for (; i < n; ++i)
+        sum += a[i] * b[i];
+    return sum;
+}
+
+// y += alpha * x
+inline void axpy(float alpha, const float* x, float* y, int n) {
+    int i = 0;
+#if defined(NN_SIMD_X86)
+    if (isa() != Isa::Scalar) i = detail::axpy_avx2(alpha, x, y, n);
+#endif
+    for (; i < n; ++i)
+        y[i] += alpha * x[i];
+}
+
+// Unsigned x signed int8 dot product.
+// - n must be a multiple of 32 (callers zero-pad)
+// - a must hold values in [0, 127] so the AVX2 maddubs pairs cannot saturate
+inline int32_t dot_u8s8(const uint8_t* a, const int8_t* b, int n) {
+#if defined(NN_SIMD_X86)
+    switch (isa()) {
+#if defined(NN_SIMD_AVXVNNI)
+        case Isa::AvxVnni: return detail::dot_u8s8_avxvnni(a, b, n);
+#endif
+        case Isa::Avx512Vnni: return detail::dot_u8s8_avx512vnni(a, b, n);
+        case Isa::Avx2: return detail::dot_u8s8_avx2(a, b, n);
+        default: break;
+    }
+#endif
+    int32_t sum = 0;
+    for (int i = 0; i < n; ++i)
+        sum += static_cast<int32_t>(a[i]) * static_cast<int32_t>(b[i]);
+    return sum;
+}
+
+} // namespace nn::simd
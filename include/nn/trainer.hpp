@@ -0,0 +1,75 @@
+#pragma once
+
+#include "nn/network.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace nn {
+
+struct TrainerConfig {
+    float learning_rate = 1e-3f;
+    float beta1 = 0.9f;            // Adam moment decay rates
+    float beta2 = 0.999f;
+    float epsilon = 1e-8f;
+    float weight_decay = 1e-4f;    // decoupled (AdamW), weights only
+    float value_weight = 1.0f;     // loss = policy cross-entropy + value_weight * value MSE
+    int threads = 1;               // data-parallel shards per minibatch
+};
+
+struct TrainLoss {
+    float policy = 0.0f;   // mean cross-entropy against the target distribution
+    float value = 0.0f;    // mean squared error of the value head
+    float total() const { return policy + value; }
+};
+
+// Minibatch trainer for nn::Network on the CPU.
+//
+// Forward and backward passes mirror Network::forward layer by layer and use the same SIMD
+// kernels (simd::dot / simd::axpy). A minibatch is split into `threads` contiguous shards;
+// each worker accumulates gradients into its own buffer, the buffers are summed, and Adam
+// updates the network's parameters in place.
+//
+// Batches are tensors as produced by the replay buffers: states [n][192] (CHW planes),
+// policies [n][65] and values [n] from the perspective of the side to move.
+class Trainer {
+public:
+    // `network` must own its parameters (not a view) and outlive the trainer
+    Trainer(Network& network, const TrainerConfig& config = {});
+    ~Trainer();
+
+    Trainer(const Trainer&) = delete;
+    Trainer& operator=(const Trainer&) = delete;
+
+    // One Adam step on a minibatch; returns the loss before the update
+    TrainLoss step(const float* states, const float* policies, const float* values, size_t n);
+
+    // Loss of the current parameters, without updating them
+    TrainLoss loss(const float* states, const float* policies, const float* values, size_t n);
+
+    // Mean gradient of the loss over the batch into `grad` (num_params floats)
+    TrainLoss gradient(const float* states, const float* policies, const float* values, size_t n, float* grad);
+
+    uint64_t steps() const { return steps_; }
+    const TrainerConfig& config() const { return config_; }
+    void set_learning_rate(float lr) { config_.learning_rate = lr; }
+
+private:
+    struct Workspace;
+
+    Network& network_;
+    TrainerConfig config_;
+    std::vector<std::unique_ptr<Workspace>> workspaces_;
+    std::vector<float> grad_;
+    std::vector<float> m_;   // Adam first and second moments
+    std::vector<float> v_;
+    std::vector<uint8_t> decay_;   // 1 for weights, 0 for biases
+    uint64_t steps_ = 0;
+
+    TrainLoss run(const float* states, const float* policies, const float* values, size_t n, bool backward);
+    void shard(Workspace& ws, const float* states, const float* policies, const float* values, size_t begin,
+               size_t end, bool backward);
+};
+
+} // namespace nn
@@ -1,21 +1,71 @@
 #pragma once
 
 #include "cl.h"
+#include "opencl/program_cache.hpp"
+#include <memory>
 #include <string>
+#include <vector>
+
+// Throws std::runtime_error naming the failed call if err != CL_SUCCESS
+void check_cl(cl_int err, const char* what);
+
+// Compile and build from source, logging the build log on failure
+cl_program compile_program(cl_context context, cl_device_id device, const std::string& source,
+                           const std::string& options = "");
+
+struct DeviceInfo {
+    cl_platform_id platform;
+    cl_device_id device;
+    cl_device_type type;
+    std::string platform_name;
+    std::string name;
+    std::string vendor;
+    std::string driver_version;
+    cl_uint compute_units;
+};
+
+struct DeviceSelector {
+    cl_device_type type = CL_DEVICE_TYPE_GPU;
+    std::string vendor;          // case-insensitive substring of the platform or device vendor
+    int index = -1;              // position in OpenCLContext::enumerate_devices(); overrides type/vendor
+    bool cpu_fallback = true;    // use a CPU device (e.g. pocl) if nothing else matches
+
+    // "gpu", "cpu", "accelerator", "all", a device index, or a vendor name
+    static DeviceSelector parse(const std::string& spec);
+
+    // Parsed from OTHELLO_CL_DEVICE if set, defaults otherwise
+    static DeviceSelector from_env();
+};
 
 class OpenCLContext {
 public:
-    OpenCLContext();
+    explicit OpenCLContext(const DeviceSelector& selector = DeviceSelector::from_env());
     ~OpenCLContext();
 
+    OpenCLContext(const OpenCLContext&) = delete;
+    OpenCLContext& operator=(const OpenCLContext&) = delete;
+
+    // Every device on every platform; empty if no OpenCL runtime is installed
+    static std::vector<DeviceInfo> enumerate_devices();
+
     cl_context context() const;
     cl_command_queue queue() const;
+    cl_device_id device() const;
+    const DeviceInfo& device_info() const;
+
+    // Compiled binaries are cached on disk (see ProgramCache); pass "" to disable
+    void set_program_cache_directory(const std::string& directory);
+    ProgramCache* program_cache() const;
+
+    cl_program buildProgramFromSource(const std::string& source, const std::string& options = "");
     cl_program buildProgramFromFile(const std::string& path);
     cl_kernel createKernel(cl_program program, const std::string& kernel_name);
 
 private:
+    DeviceInfo info_;
     cl_platform_id platform_;
     cl_device_id device_;
     cl_context context_;
     cl_command_queue queue_;
+    std::unique_ptr<ProgramCache> program_cache_;
 };
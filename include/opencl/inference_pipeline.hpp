@@ -0,0 +1,91 @@
+#pragma once
+
+#include "opencl/context.hpp"
+#include "nn/network.hpp"
+
+#include <cstdint>
+#include <vector>
+
+struct PipelineStats {
+    uint64_t batches = 0;
+    uint64_t positions = 0;
+    double stall_seconds = 0.0;     // host time blocked on device completion
+    double submit_seconds = 0.0;    // host time spent encoding and enqueueing
+};
+
+// Asynchronous nn::Network inference with the kernels in kernels/network.cl.
+//
+// Each of the `depth` slots owns device activations, a command queue and persistently
+// mapped pinned host buffers, so up to `depth` batches are in flight at once:
+//
+//     auto t0 = pipeline.submit(batch0, n0);   // returns after enqueueing
+//     auto t1 = pipeline.submit(batch1, n1);   // overlaps with batch0 on the device
+//     pipeline.wait(t0, policies, values);     // blocks only if batch0 is still running
+//
+// A slot must be collected with wait() before it is reused; submit() throws otherwise.
+// Not thread-safe: one thread submits and collects.
+class InferencePipeline {
+public:
+    InferencePipeline(OpenCLContext& context, const nn::Network& network, int max_batch = 256, int depth = 2);
+    ~InferencePipeline();
+
+    InferencePipeline(const InferencePipeline&) = delete;
+    InferencePipeline& operator=(const InferencePipeline&) = delete;
+
+    // inputs: n tensors of nn::kInputSize floats; returns a ticket for wait()
+    uint64_t submit(const float* inputs, int n);
+
+    // True once the batch has finished on the device (never blocks)
+    bool ready(uint64_t ticket) const;
+
+    // Copies n x 65 policies and n values out of the slot's pinned buffers
+    void wait(uint64_t ticket, float* policies, float* values);
+
+    // Tickets submitted but not yet collected
+    int in_flight() const;
+
+    int depth() const { return static_cast<int>(slots_.size()); }
+    int max_batch_size() const { return max_batch_; }
+    const PipelineStats& stats() const { return stats_; }
+
+private:
+    struct Slot {
+        cl_command_queue queue = nullptr;
+        cl_mem act[2] = {};
+        cl_mem policy_plane = nullptr;
+        cl_mem value_plane = nullptr;
+        cl_mem hidden = nullptr;
+        cl_mem logits = nullptr;
+        cl_mem values = nullptr;
+        cl_mem host_in = nullptr;       // pinned, mapped for the slot's lifetime
+        cl_mem host_out = nullptr;      // pinned: [max_batch][65] policies, then [max_batch] values
+        float* in_ptr = nullptr;
+        float* out_ptr = nullptr;
+        cl_event done = nullptr;
+        uint64_t ticket = 0;
+        int n = 0;
+        bool pending = false;
+    };
+
+    OpenCLContext& context_;
+    nn::NetworkConfig config_;
+    std::vector<nn::LinearSpec> linears_;
+    int max_batch_;
+
+    cl_program program_ = nullptr;
+    cl_kernel conv_kernel_ = nullptr;
+    cl_kernel dense_kernel_ = nullptr;
+    cl_kernel softmax_kernel_ = nullptr;
+    std::vector<cl_mem> weights_;
+    std::vector<cl_mem> biases_;
+
+    std::vector<Slot> slots_;
+    uint64_t next_ticket_ = 0;
+    PipelineStats stats_;
+
+    void release();   // frees whatever has been created; shared by the destructor and a failed constructor
+    cl_mem create_buffer(cl_mem_flags flags, size_t floats, const float* host = nullptr);
+    void enqueue_dense(cl_command_queue queue, size_t layer, cl_mem in, cl_mem out, size_t rows, int activation);
+    void enqueue_forward(Slot& slot);
+    Slot& slot_for(uint64_t ticket);
+};
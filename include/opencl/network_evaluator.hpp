@@ -0,0 +1,29 @@
+#pragma once
+
+#include "opencl/context.hpp"
+#include "opencl/inference_pipeline.hpp"
+#include "othello/evaluator.hpp"
+#include "nn/network.hpp"
+
+// Batched nn::Network inference with the kernels in kernels/network.cl.
+// Runs on whatever device the context selected, including CPU runtimes such as pocl.
+// Up to `depth` batches are in flight (one InferencePipeline slot each): an InferenceBroker
+// gathers batch N+1 while batch N runs. evaluate_batch is the synchronous form.
+// Not thread-safe: one thread submits and collects.
+class OpenCLEvaluator : public othello::AsyncBatchEvaluator {
+public:
+    OpenCLEvaluator(OpenCLContext& context, const nn::Network& network, int max_batch = 256, int depth = 2)
+        : pipeline_(context, network, max_batch, depth) {}
+
+    uint64_t submit_batch(const float* inputs, int n) override { return pipeline_.submit(inputs, n); }
+    void collect(uint64_t ticket, float* policies, float* values) override { pipeline_.wait(ticket, policies, values); }
+    int depth() const override { return pipeline_.depth(); }
+
+    int max_batch_size() const override { return pipeline_.max_batch_size(); }
+    int in_flight() const { return pipeline_.in_flight(); }
+
+    const PipelineStats& stats() const { return pipeline_.stats(); }
+
+private:
+    InferencePipeline pipeline_;
+};
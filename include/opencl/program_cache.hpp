@@ -0,0 +1,34 @@
+#pragma once
+
+#include "cl.h"
+#include <cstdint>
+#include <string>
+
+struct DeviceInfo;
+
+// On-disk cache of compiled OpenCL programs (CL_PROGRAM_BINARIES).
+// Entries are keyed by device name, driver version, build options and a hash of the source;
+// a missing, stale or rejected binary falls back to compiling from source.
+class ProgramCache {
+public:
+    explicit ProgramCache(std::string directory);
+
+    // $OTHELLO_CL_CACHE, else $XDG_CACHE_HOME/othello/opencl, else ~/.cache/othello/opencl.
+    // Returns "" if OTHELLO_CL_CACHE is "off".
+    static std::string default_directory();
+
+    static uint64_t key(const DeviceInfo& device, const std::string& options, const std::string& source);
+
+    // Returns a built program; cache_hit reports whether a cached binary was used
+    cl_program build(cl_context context, const DeviceInfo& device, const std::string& source,
+                     const std::string& options, bool* cache_hit = nullptr);
+
+    const std::string& directory() const { return directory_; }
+
+private:
+    std::string directory_;
+
+    std::string entry_path(uint64_t key) const;
+    cl_program load(cl_context context, const DeviceInfo& device, uint64_t key, const std::string& options);
+    void store(cl_program program, uint64_t key);
+};
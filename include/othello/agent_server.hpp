@@ -0,0 +1,178 @@
+#pragma once
+
+#include "othello/book.hpp"
+#include "othello/inference_broker.hpp"
+#include "othello/mcts.hpp"
+#include "othello/metrics.hpp"
+#include "othello/protocol.hpp"
+#include "nn/model_registry.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace othello {
+
+class PatternEvaluator;
+class RegistryEvaluator;
+
+struct AgentServerConfig {
+    int port = 4000;                 // 0: any free port (see AgentServer::port())
+    std::string unix_path;           // also listen on this Unix socket (and accept shm clients)
+    int workers = 0;                 // search threads, 0: one per hardware thread
+    int simulations = 800;           // MCTS simulations per move
+    float c_puct = 1.5f;
+    int batch_size = 1;              // >1: batch network evaluations across searches (InferenceBroker)
+    int batch_wait_us = 500;         // longest a batch waits to fill
+    bool opencl = false;             // with batching: run the batches on OpenCL (OTHELLO_CL_DEVICE picks it)
+    std::string pattern_weights;     // without a model: search with these PatternEvaluator weights
+    std::string trace_path;          // write a Chrome trace of one move search here (empty: none)
+    int trace_move = 1;              // which one: the server's Nth move search, from 1
+};
+
+struct SessionStats {
+    uint64_t moves = 0;              // replies sent, passes included
+    uint64_t book_moves = 0;
+    metrics::HistogramSnapshot think_us;      // MCTS time of searched moves (othello_search_seconds)
+    metrics::HistogramSnapshot response_us;   // opponent move received -> reply queued
+};
+
+struct AgentServerStats {
+    uint64_t sessions = 0;           // accepted since start
+    uint64_t active = 0;             // currently connected
+    SessionStats totals;             // over all sessions, closed ones included
+};
+
+// Hosts any number of concurrent games on one port. A single thread multiplexes the
+// connections with epoll and handles everything that is cheap (framing, passes, book moves,
+// pings); searches go to a shared pool of worker threads, and their replies are written back
+// by the event loop once they finish, so a long search never holds up another session.
+//
+// Clients speak the framed protocol of othello/protocol.hpp over TCP, a Unix socket, or the
+// shared-memory rings of othello/shm_channel.hpp (attached over the Unix socket). A connection
+// that sends Hello is one game and owns its board, evaluator and search tree; Analyze batches
+// need no Hello and are searched from scratch, in parallel with everything else.
+//
+// A Move's ms_left caps its search at an even share of the clock over the moves still to
+// play; the simulation count applies either way.
+//
+// Sessions, moves, search and evaluator timings and the time budget are recorded into a
+// metrics registry (othello_* metrics, see metrics.hpp) for an Exporter to publish.
+class AgentServer {
+public:
+    // Binds and listens immediately; throws std::runtime_error if that fails.
+    // With a registry, sessions search with its current model, otherwise with the pattern
+    // weights of config.pattern_weights if given, otherwise greedily.
+    // Without a metrics registry the server keeps a private one.
+    AgentServer(const AgentServerConfig& config, nn::ModelRegistry* registry = nullptr,
+                const OpeningBook* book = nullptr, metrics::Registry* metrics = nullptr);
+    ~AgentServer();
+
+    AgentServer(const AgentServer&) = delete;
+    AgentServer& operator=(const AgentServer&) = delete;
+
+    // Serves until stop(); in-flight searches finish before it returns
+    void run();
+
+    // Both only touch atomics and an eventfd, so they are safe from signal handlers
+    void stop();
+    void request_reload();   // force a model reload before the next search
+
+    int port() const { return port_; }
+    // The histograms are read from the metrics registry, so they span every server sharing it
+    AgentServerStats stats() const;
+
+private:
+    struct Session;
+    struct Metrics;
+
+    struct AnalyzePosition {
+        OthelloBoard board;
+        Player side;
+    };
+
+    // A search for the pool: the session's next move, or an Analyze batch
+    struct Job {
+        std::shared_ptr<Session> session;
+        bool analysis = false;
+        uint32_t analysis_id = 0;
+        std::vector<AnalyzePosition> positions;
+    };
+
+    struct Completion {
+        std::shared_ptr<Session> session;
+        Move move = othello::PASS;
+        uint64_t think_us = 0;
+        int simulations = 0;
+        size_t tree_nodes = 0;
+        bool failed = false;
+        bool analysis = false;
+        uint32_t analysis_id = 0;
+        std::vector<std::pair<Move, float>> results;   // best move and root value per position
+    };
+
+    AgentServerConfig config_;
+    nn::ModelRegistry* registry_;
+    const OpeningBook* book_;
+    std::unique_ptr<PatternEvaluator> patterns_;       // loaded once; sessions share its weights
+    std::unique_ptr<BatchEvaluator> broker_backend_;   // with batching: the broker's model
+    std::unique_ptr<InferenceBroker> broker_;
+    int port_ = 0;
+    int listen_fd_ = -1;
+    int unix_fd_ = -1;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;       // eventfd: finished searches and stop()
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> reload_{false};
+    std::atomic<int> searches_{0};    // session searches started, for trace_move
+    uint64_t next_id_ = 1;
+
+    // Event loop thread only; keyed by session id, which is also the epoll token
+    std::unordered_map<uint64_t, std::shared_ptr<Session>> sessions_;
+
+    // Worker pool
+    std::vector<std::thread> workers_;
+    std::mutex jobs_mutex_;
+    std::condition_variable jobs_cv_;
+    std::deque<Job> jobs_;
+    bool workers_stopping_ = false;
+
+    std::mutex done_mutex_;
+    std::vector<Completion> done_;
+
+    mutable std::mutex stats_mutex_;
+    AgentServerStats stats_;
+
+    std::unique_ptr<metrics::Registry> own_metrics_;
+    std::unique_ptr<Metrics> metrics_;
+
+    void worker_loop(int index);
+    void accept_clients(int listen_fd);
+    void read_client(const std::shared_ptr<Session>& session);
+    void read_shm(const std::shared_ptr<Session>& session);
+    void attach_shm(const std::shared_ptr<Session>& session);
+    void process_input(const std::shared_ptr<Session>& session);
+    void handle_frame(const std::shared_ptr<Session>& session, const protocol::Frame& frame);
+    void handle_move(const std::shared_ptr<Session>& session, protocol::PayloadReader& in,
+                     std::chrono::steady_clock::time_point received);
+    void handle_analyze(const std::shared_ptr<Session>& session, protocol::PayloadReader& in);
+    std::unique_ptr<metrics::TimedEvaluator> make_evaluator(RegistryEvaluator** network);
+    void search_analysis(Job& job, Completion& done, std::unique_ptr<metrics::TimedEvaluator>& evaluator,
+                         std::unique_ptr<MCTS>& mcts);
+    void finish_searches();
+    void reply(Session& session, const Move& move, bool book_move);
+    void send_frame(Session& session, protocol::FrameWriter& frame);
+    void flush(Session& session);
+    void close_session(const std::shared_ptr<Session>& session, const char* reason);
+};
+
+} // namespace othello
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "othello/board.hpp"
+#include "othello/evaluator.hpp"
+#include "othello/game_record.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace othello {
+
+// One side of a match: MCTS settings plus how to build its evaluator
+struct EngineSpec {
+    std::string name = "engine";
+    int simulations = 200;       // per move; with move_time set, an upper bound
+    double move_time = 0.0;      // seconds per move (0: simulations only)
+    float c_puct = 1.5f;
+    std::function<std::unique_ptr<Evaluator>()> factory;   // called once per worker thread
+};
+
+// Sequential probability ratio test of H0: elo = elo0 against H1: elo = elo1 for engine A
+struct SprtConfig {
+    bool enabled = true;
+    double elo0 = 0.0;
+    double elo1 = 10.0;
+    double alpha = 0.05;   // false positive rate (accepting H1 when H0 holds)
+    double beta = 0.05;    // false negative rate
+
+    double lower_bound() const;   // accept H0 at or below this LLR
+    double upper_bound() const;   // accept H1 at or above
+};
+
+struct ArenaConfig {
+    int threads = 0;              // 0: one per hardware thread
+    int max_games = 1000;         // rounded up to whole colour-swapped pairs, at most one per opening
+    int opening_plies = 6;        // depth of the generated opening set
+    uint32_t seed = 1;
+    int report_every = 0;         // log progress every N games (0: never)
+    SprtConfig sprt;
+};
+
+// Wins, draws and losses from engine A's point of view
+struct MatchScore {
+    uint64_t wins = 0;
+    uint64_t draws = 0;
+    uint64_t losses = 0;
+
+    uint64_t games() const { return wins + draws + losses; }
+    double score() const;          // (wins + draws / 2) / games
+    double elo() const;            // logistic Elo difference A - B
+    double elo_error() const;      // half-width of the 95% confidence interval, in Elo
+    double llr(double elo0, double elo1) const;   // trinomial GSPRT log-likelihood ratio
+};
+
+double elo_to_score(double elo);
+double score_to_elo(double score);
+
+enum class SprtResult { CONTINUE, ACCEPT_H0, ACCEPT_H1 };
+
+struct ArenaResult {
+    MatchScore score;
+    SprtResult sprt = SprtResult::CONTINUE;
+    double llr = 0.0;
+    uint64_t a_black_games = 0;    // games where A had black (the rest it had white)
+    double seconds = 0.0;
+
+    double games_per_second() const { return seconds > 0 ? score.games() / seconds : 0.0; }
+    std::string summary(const SprtConfig& sprt) const;
+};
+
+// Starting position of a game
+struct Opening {
+    OthelloBoard board;
+    Player to_move = Player::BLACK;
+    std::vector<Move> moves;   // from the standard start, forced passes included
+};
+
+// Every distinct position (up to board symmetry) reachable in `plies` moves, shuffled by seed
+std::vector<Opening> generate_openings(int plies, uint32_t seed);
+
+// One opening per line as a move string such as "f5d6c3" (a-h columns, 1-8 rows);
+// empty lines and '#' comments are skipped. Throws on illegal moves.
+std::vector<Opening> load_openings(const std::string& path);
+
+// Plays engine A against engine B on a pool of worker threads, in-process.
+//
+// Each opening is played twice with colours swapped, so an opening that favours one colour
+// cancels out. Results feed an SPRT after every game; once it accepts either hypothesis the
+// remaining games are not started. Searches are deterministic (no temperature), variety comes
+// from the openings, so a match plays at most two games per opening.
+class Arena {
+public:
+    Arena(EngineSpec a, EngineSpec b, const ArenaConfig& config = {}, std::vector<Opening> openings = {});
+
+    ArenaResult run();
+
+    // Hands every finished game's move list (opening included) to `observer`
+    void set_game_observer(GameObserver observer) { observer_ = std::move(observer); }
+
+    // One game from `opening`; returns the winner (NONE for a draw). `record`, if given,
+    // receives the full move list.
+    static Player play_game(Evaluator& black_eval, const EngineSpec& black, Evaluator& white_eval,
+                            const EngineSpec& white, const Opening& opening, uint32_t seed,
+                            GameRecord* record = nullptr);
+
+private:
+    EngineSpec a_;
+    EngineSpec b_;
+    ArenaConfig config_;
+    std::vector<Opening> openings_;
+    GameObserver observer_;
+};
+
+} // namespace othello
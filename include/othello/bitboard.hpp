@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+
+// Branch-light bitboard primitives. Bit i is square (i % 8, i / 8), as in othello::to_index.
+namespace othello::bitboard {
+
+constexpr uint64_t kNotAFile = 0xfefefefefefefefeULL;   // x != 0
+constexpr uint64_t kNotHFile = 0x7f7f7f7f7f7f7f7fULL;   // x != 7
+
+// Shift every disk one step in direction d (0..7), dropping disks that leave the board.
+// Directions match DX/DY in board.cpp: (-1,-1) (-1,0) (-1,1) (0,1) (1,1) (1,0) (1,-1) (0,-1)
+inline uint64_t shift(uint64_t b, int d) {
+    switch (d) {
+        case 0: return (b >> 9) & kNotHFile;
+        case 1: return (b >> 1) & kNotHFile;
+        case 2: return (b << 7) & kNotHFile;
+        case 3: return b << 8;
+        case 4: return (b << 9) & kNotAFile;
+        case 5: return (b << 1) & kNotAFile;
+        case 6: return (b >> 7) & kNotAFile;
+        default: return b >> 8;
+    }
+}
+
+// Squares where `own` may move against `opp`
+inline uint64_t legal_moves(uint64_t own, uint64_t opp) {
+    const uint64_t empty = ~(own | opp);
+    uint64_t moves = 0;
+    for (int d = 0; d < 8; ++d) {
+        uint64_t run = shift(own, d) & opp;
+        run |= shift(run, d) & opp;
+        run |= shift(run, d) & opp;
+        run |= shift(run, d) & opp;
+        run |= shift(run, d) & opp;
+        run |= shift(run, d) & opp;
+        moves |= shift(run, d) & empty;
+    }
+    return moves;
+}
+
+// Opponent disks flipped by `own` playing on square sq (0 if the move flips nothing)
+inline uint64_t flips(uint64_t own, uint64_t opp, int sq) {
+    const uint64_t move = 1ULL << sq;
+    uint64_t flipped = 0;
+    for (int d = 0; d < 8; ++d) {
+        uint64_t run = 0;
+        uint64_t cur = shift(move, d);
+        while (cur & opp) {
+            run |= cur;
+            cur = shift(cur, d);
+        }
+        if (cur & own) flipped |= run;
+    }
+    return flipped;
+}
+
+inline int popcount(uint64_t b) {
+    return __builtin_popcountll(b);
+}
+
+} // namespace othello::bitboard
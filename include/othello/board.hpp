@@ -33,7 +33,10 @@ namespace othello {
 
 class OthelloBoard {
 public:
+    static constexpr int kTensorSize = 3 * 64;   // own, opponent, legal-move planes
+
     OthelloBoard();
+    OthelloBoard(uint64_t black, uint64_t white, Player to_move = Player::BLACK);
 
     bool is_valid_move(Player player, int x, int y) const;
     std::vector<Move> get_valid_moves(Player player) const;
@@ -46,7 +49,10 @@ public:
     Player current_player() const;
 
     Player at(int x, int y) const;
+    uint64_t bits(Player player) const { return player == Player::BLACK ? black_ : white_; }
+    uint64_t legal_move_mask(Player player) const;  // excludes PASS
     std::vector<float> to_tensor(Player current_player) const;
+    void encode(Player current_player, float* out) const;   // to_tensor into kTensorSize floats
 
     // Getters for unit tests
     public:
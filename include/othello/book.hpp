@@ -0,0 +1,108 @@
+#pragma once
+
+#include "othello/board.hpp"
+#include "othello/game_record.hpp"
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace othello {
+
+// Opening book file: a header followed by fixed-size entries sorted by (key, move), probed
+// by binary search straight from a read-only mapping.
+//
+// Positions are stored once per symmetry class: the key hashes the canonical orientation of
+// (side to move, opponent) and moves are stored in that orientation, so probing maps them
+// back through the position's own symmetry.
+struct BookHeader {
+    char magic[8];          // "OTHBOOK1"
+    uint32_t version;
+    uint32_t entry_bytes;   // sizeof(BookEntry)
+    uint64_t count;
+    uint32_t max_plies;     // deepest ply the builder recorded
+    uint32_t reserved;
+};
+
+struct BookEntry {
+    uint64_t key;
+    uint8_t move;           // canonical square 0..63
+    uint8_t reserved[3];
+    uint32_t weight;        // points scored by the mover: 2 per win, 1 per draw
+};
+
+constexpr uint32_t kBookVersion = 1;
+
+// Hash of a position's symmetry class; `symmetry` receives the transform to canonical form
+uint64_t book_key(uint64_t own, uint64_t opp, int* symmetry = nullptr);
+
+struct BookMove {
+    Move move;
+    uint32_t weight;
+};
+
+class OpeningBook {
+public:
+    // Maps `path` read-only; throws if it is not a valid book
+    explicit OpeningBook(const std::string& path);
+    ~OpeningBook();
+
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    // Book move for `player` to play, or nothing when the position is not in the book.
+    // Moves that never scored (weight 0) are left to the search.
+    // Without an rng the heaviest move is returned, otherwise one sampled by weight.
+    // Never allocates.
+    std::optional<Move> probe(const OthelloBoard& board, Player player, std::mt19937* rng = nullptr) const;
+
+    // Every book move of the position, in board coordinates
+    std::vector<BookMove> moves(const OthelloBoard& board, Player player) const;
+
+    size_t size() const { return count_; }
+    uint32_t max_plies() const { return max_plies_; }
+
+private:
+    void* map_ = nullptr;
+    size_t bytes_ = 0;
+    const BookEntry* entries_ = nullptr;
+    size_t count_ = 0;
+    uint32_t max_plies_ = 0;
+
+    // Entries of a key as [first, last)
+    std::pair<const BookEntry*, const BookEntry*> range(uint64_t key) const;
+};
+
+// Collects move statistics from finished games. Thread-safe, so it can be a SelfPlay or
+// Arena game observer directly.
+class BookBuilder {
+public:
+    explicit BookBuilder(int max_plies = 20);
+
+    void add_game(const GameRecord& game);
+
+    // Writes entries played in at least `min_games` games (via a temporary file and rename)
+    // and returns how many were written
+    size_t write(const std::string& path, uint32_t min_games = 2) const;
+
+    uint64_t games() const;
+    size_t positions() const;   // distinct (position, move) pairs seen
+
+private:
+    struct Stats {
+        uint32_t games = 0;
+        uint32_t points = 0;
+    };
+
+    int max_plies_;
+    mutable std::mutex mutex_;
+    std::map<std::pair<uint64_t, uint8_t>, Stats> stats_;
+    uint64_t games_ = 0;
+};
+
+} // namespace othello
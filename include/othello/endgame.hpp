@@ -0,0 +1,119 @@
+#pragma once
+
+#include "othello/board.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace othello {
+
+// Exact endgame solver over bitboards.
+//
+// Scores are final disc differentials from the side to move, with empty squares going to the
+// winner (the FFO/WTHOR convention), so they lie in [-64, 64].
+//
+// The search is a fail-soft principal variation search. Near the root, children are ordered
+// fastest-first (fewest opponent replies, corners counted twice) behind the transposition
+// table move, and enhanced transposition cutoffs probe every child before any is searched.
+// The last few empties use a cheaper loop without the table: moves into regions with an odd
+// number of empties first, corners first within those.
+//
+// Parallelism follows Young Brothers Wait: a node with enough empties searches its first
+// child alone, then publishes its remaining children as a split point on its thread's stack.
+// Idle threads steal the oldest (largest) split point of another thread, and an owner
+// waiting for its helpers only works on split points below its own. A beta cutoff at a
+// split point stops every thread still searching under it.
+struct EndgameConfig {
+    int threads = 0;              // 0: one per hardware thread
+    int table_bits = 22;          // 2^bits transposition table entries of 16 bytes
+    int split_empties = 12;       // nodes with at least this many empties may be split
+    uint64_t max_nodes = 0;       // give up after about this many nodes (0: no limit)
+};
+
+struct EndgameResult {
+    int score = 0;
+    Move best = PASS;             // PASS when the side to move has no legal move
+    bool complete = true;         // false: max_nodes ran out, score and best are meaningless
+    uint64_t nodes = 0;
+    double seconds = 0.0;
+
+    double nodes_per_second() const { return seconds > 0 ? nodes / seconds : 0.0; }
+};
+
+// Lock-free table shared by every search thread. Each entry stores its key xor its data, so
+// a torn read from two racing writers fails the key check instead of returning mixed bounds.
+class EndgameTable {
+public:
+    struct Bounds {
+        int lower;
+        int upper;
+        int move;                 // best square, or -1
+    };
+
+    explicit EndgameTable(int bits);
+
+    bool probe(uint64_t own, uint64_t opp, Bounds& out) const;
+    // Records the result of a search of (alpha, beta) that returned `score`
+    void store(uint64_t own, uint64_t opp, int alpha, int beta, int score, int move);
+    void clear();
+
+private:
+    struct Entry {
+        std::atomic<uint64_t> check;   // key ^ data
+        std::atomic<uint64_t> data;
+    };
+
+    std::unique_ptr<Entry[]> entries_;
+    uint64_t mask_;
+};
+
+class EndgameSolver {
+public:
+    explicit EndgameSolver(const EndgameConfig& config = {});
+    ~EndgameSolver();
+
+    EndgameSolver(const EndgameSolver&) = delete;
+    EndgameSolver& operator=(const EndgameSolver&) = delete;
+
+    // Perfect-play score and a best move for `player`. The table is kept between calls,
+    // so solving successive positions of one game gets cheaper.
+    EndgameResult solve(const OthelloBoard& board, Player player);
+
+    void clear() { table_.clear(); }
+    int threads() const { return threads_; }
+
+private:
+    int threads_;
+    int split_empties_;
+    uint64_t max_nodes_;
+    EndgameTable table_;
+};
+
+// Parses a position in the FFO test suite layout: 64 squares from a1 along each row to h8,
+// X or * for black, O for white and - or . for empty, then the side to move (X/B or O/W).
+// Throws std::invalid_argument on anything else.
+std::pair<OthelloBoard, Player> parse_position(const std::string& text);
+
+// One entry of a position file, with its known result when the file gives one
+struct ScoredPosition {
+    std::string label;          // e.g. "ffo-40"; "<file>:<line>" when unlabelled
+    OthelloBoard board;
+    Player player = Player::BLACK;
+    std::vector<Move> best;     // every move reaching `score`; empty when unscored
+    int score = 0;
+};
+
+// Reads a position file: one parse_position() position per line, optionally followed by
+// ";"-separated fields, a label and the best moves with the exact score ("a2:+38"):
+//
+//     O--OOOOX-OOOOOOXOOXXOOOXOOXOOOXXOOOOOOXX---OOOOX----O--X-------- X; ffo-40; a2:+38
+//
+// Blank lines and lines starting with '#' are skipped. Throws std::runtime_error if the file
+// cannot be read and std::invalid_argument on a malformed line.
+std::vector<ScoredPosition> load_positions(const std::string& path);
+
+} // namespace othello
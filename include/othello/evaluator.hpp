@@ -1,19 +1,79 @@
 #pragma once
 
 #include "othello/board.hpp"
+#include <algorithm>
+#include <cstdint>
 #include <vector>
 #include <utility>
 
 namespace othello {
 
+constexpr int kPolicySize = 65;   // 64 squares + pass
+
 class Evaluator {
 public:
     virtual ~Evaluator() = default;
 
     // Evaluate a board state and return (policy vector, value)
-    // - policy: vector of size 64 for each board position
+    // - policy: vector of size 65 (64 board positions + pass)
     // - value: scalar in [-1, 1] from current_player's perspective
     virtual std::pair<std::vector<float>, float> evaluate(const OthelloBoard& board, Player current_player) = 0;
+
+    // Non-allocating form used by the search: writes kPolicySize probabilities into `policy`
+    // and returns the value. The default forwards to evaluate(); override it for hot paths.
+    virtual float evaluate_into(const OthelloBoard& board, Player current_player, float* policy) {
+        auto [p, value] = evaluate(board, current_player);
+        std::copy_n(p.begin(), kPolicySize, policy);
+        return value;
+    }
+
+    // Search path hooks for evaluators that update their features incrementally. Each descent
+    // calls begin_path() with the root, then descend() with the position after every move on
+    // the way down (move_index 64: pass); the leaf it reaches is evaluated next. Any other
+    // position can still be evaluated. The defaults ignore the path.
+    virtual void begin_path(const OthelloBoard& /*root*/, Player /*to_move*/) {}
+    virtual void descend(Player /*mover*/, int /*move_index*/, const OthelloBoard& /*board*/) {}
+};
+
+// Evaluator that can score many encoded positions in one call
+class BatchEvaluator : public Evaluator {
+public:
+    // - inputs: n tensors of 192 floats (OthelloBoard::to_tensor)
+    // - policies: receives n x 65 probabilities
+    // - values: receives n values
+    virtual void evaluate_batch(const float* inputs, int n, float* policies, float* values) = 0;
+
+    // Largest n accepted by evaluate_batch
+    virtual int max_batch_size() const = 0;
+
+    std::pair<std::vector<float>, float> evaluate(const OthelloBoard& board, Player current_player) override {
+        std::vector<float> policy(kPolicySize);
+        float value = evaluate_into(board, current_player, policy.data());
+        return {policy, value};
+    }
+
+    float evaluate_into(const OthelloBoard& board, Player current_player, float* policy) override {
+        float input[OthelloBoard::kTensorSize];
+        board.encode(current_player, input);
+        float value = 0.0f;
+        evaluate_batch(input, 1, policy, &value);
+        return value;
+    }
+};
+
+// Batch evaluator that keeps several batches in flight (e.g. a device with one queue per
+// slot): submit_batch() returns once the batch is queued and collect() blocks until it is
+// done, so the caller can gather the next batch meanwhile. Collect in submission order.
+class AsyncBatchEvaluator : public BatchEvaluator {
+public:
+    // At most depth() batches may be submitted and not yet collected; returns a ticket
+    virtual uint64_t submit_batch(const float* inputs, int n) = 0;
+    virtual void collect(uint64_t ticket, float* policies, float* values) = 0;
+    virtual int depth() const = 0;
+
+    void evaluate_batch(const float* inputs, int n, float* policies, float* values) override {
+        collect(submit_batch(inputs, n), policies, values);
+    }
 };
 
-}  // namespace othello
\ No newline at end of file
+}  // namespace othello
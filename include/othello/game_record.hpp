@@ -0,0 +1,21 @@
+#pragma once
+
+#include "othello/board.hpp"
+
+#include <functional>
+#include <vector>
+
+namespace othello {
+
+// Move list of a finished game from the standard starting position. Forced passes are
+// included as PASS, so replaying `moves` in order with alternating colours (black first)
+// reproduces the game.
+struct GameRecord {
+    std::vector<Move> moves;
+    Player winner = Player::NONE;   // NONE for a draw
+};
+
+// Called from worker threads once per finished game; must be thread-safe
+using GameObserver = std::function<void(const GameRecord&)>;
+
+} // namespace othello
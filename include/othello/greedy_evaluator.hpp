@@ -7,30 +7,24 @@ namespace othello {
 class GreedyEvaluator : public Evaluator {
 public:
     std::pair<std::vector<float>, float> evaluate(const OthelloBoard& board, Player current_player) override {
-        // Step 1: create uniform policy over legal moves
-        std::vector<float> policy(65, 0.0f);
-        auto moves = board.get_valid_moves(current_player);
-        float p = 1.0f / static_cast<float>(moves.size());
-
-        for (const auto& move : moves) {
-            int idx = (move == othello::PASS) ? 64 : othello::to_index(move.x, move.y);
-            policy[idx] = p;
-        }
-
-        // Step 2: compute value = normalized disk differential
-        int black = board.count_disks(Player::BLACK);
-        int white = board.count_disks(Player::WHITE);
-
-        float value = 0.0f;
-        if (black + white > 0) {
-            if (current_player == Player::WHITE)
-                value = static_cast<float>(black - white) / (black + white);
-            else
-                value = static_cast<float>(white - black) / (black + white);
-        }
-
+        std::vector<float> policy(kPolicySize);
+        float value = evaluate_into(board, current_player, policy.data());
         return {policy, value};
     }
+
+    float evaluate_into(const OthelloBoard& board, Player current_player, float* policy) override {
+        // Step 1: uniform policy over the legal-move mask (PASS when it is empty)
+        uint64_t moves = board.legal_move_mask(current_player);
+        int count = __builtin_popcountll(moves);
+        float p = count ? 1.0f / static_cast<float>(count) : 0.0f;
+        for (int i = 0; i < 64; ++i) policy[i] = ((moves >> i) & 1) ? p : 0.0f;
+        policy[64] = count ? 0.0f : 1.0f;
+
+        // Step 2: value = normalized disk differential for the side to move
+        int own = board.count_disks(current_player);
+        int opp = board.count_disks(opponent(current_player));
+        return (own + opp > 0) ? static_cast<float>(own - opp) / (own + opp) : 0.0f;
+    }
 };
 
 } // namespace othello
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "othello/evaluator.hpp"
+#include "othello/metrics.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace othello {
+
+struct BrokerConfig {
+    int max_batch = 64;                               // capped by the backend's max_batch_size()
+    std::chrono::microseconds max_wait{500};          // oldest request waits at most this long for company
+};
+
+// A view of the broker's othello_broker_* metrics
+struct BrokerStats {
+    uint64_t batches = 0;
+    uint64_t requests = 0;
+    std::vector<uint64_t> batch_fill;     // batch_fill[n] = batches of size n
+    metrics::HistogramSnapshot queue_us;  // submit -> picked up by the dispatcher
+    metrics::HistogramSnapshot latency_us;   // submit -> result available
+    double stall_seconds = 0.0;           // dispatcher blocked collecting in-flight batches (async backends)
+
+    double mean_batch() const { return batches ? double(requests) / batches : 0.0; }
+    std::string report() const;           // multi-line summary for logs
+};
+
+// A queued evaluation; doubles as the future for its result. Owned by the caller and must stay
+// alive until wait() returns, so submitting does not allocate.
+class InferenceRequest {
+public:
+    bool ready() const { return done_.load(std::memory_order_acquire); }
+
+private:
+    friend class InferenceBroker;
+    const float* input_ = nullptr;
+    float* policy_ = nullptr;
+    float value_ = 0.0f;
+    std::exception_ptr error_;
+    std::chrono::steady_clock::time_point submitted_;
+    std::atomic<bool> done_{false};
+};
+
+// Dynamic batching in front of a BatchEvaluator. Any number of threads submit single positions;
+// one dispatcher thread gathers them into batches of up to max_batch, waiting at most max_wait
+// after the oldest request before running a partial batch:
+//
+//     InferenceRequest req;
+//     broker.submit(req, input, policy);   // enqueue, returns immediately
+//     ...                                  // other work
+//     float value = broker.wait(req);      // policy is filled once this returns
+//
+// The backend is only ever called from the dispatcher thread. With an AsyncBatchEvaluator
+// backend up to its depth() batches are in flight: the dispatcher gathers and submits batch
+// N+1 while batch N runs, and only blocks to collect when every slot is busy or no request is
+// waiting.
+//
+// Batches, queueing and latency are recorded as othello_broker_* metrics in `metrics`, or in a
+// private registry without one; stats() reads them back. Brokers sharing a registry share the
+// series, so give each its own when their stats() must stay apart.
+class InferenceBroker {
+public:
+    explicit InferenceBroker(BatchEvaluator& backend, const BrokerConfig& config = {},
+                             metrics::Registry* metrics = nullptr);
+    ~InferenceBroker();   // drains queued requests, then stops the dispatcher
+
+    InferenceBroker(const InferenceBroker&) = delete;
+    InferenceBroker& operator=(const InferenceBroker&) = delete;
+
+    // - input: 192 floats (OthelloBoard::to_tensor); read by the dispatcher, keep it alive
+    // - policy: receives 65 probabilities
+    void submit(InferenceRequest& request, const float* input, float* policy);
+
+    // Blocks until the request completes; rethrows backend errors
+    float wait(InferenceRequest& request);
+
+    float evaluate(const float* input, float* policy) {
+        InferenceRequest request;
+        submit(request, input, policy);
+        return wait(request);
+    }
+
+    int max_batch() const { return max_batch_; }
+    BrokerStats stats() const;
+
+private:
+    struct Metrics;
+
+    // A batch handed to the backend and not yet published
+    struct InFlight {
+        std::vector<InferenceRequest*> requests;
+        std::chrono::steady_clock::time_point picked;
+        uint64_t ticket = 0;
+        std::exception_ptr error;
+    };
+
+    BatchEvaluator& backend_;
+    AsyncBatchEvaluator* async_;                      // backend_, when it can overlap batches
+    const int depth_;
+    const int max_batch_;
+    const std::chrono::microseconds max_wait_;
+
+    mutable std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::deque<InferenceRequest*> queue_;
+    bool stopping_ = false;
+
+    std::mutex done_mutex_;
+    std::condition_variable done_cv_;
+
+    std::unique_ptr<metrics::Registry> own_metrics_;
+    std::unique_ptr<Metrics> metrics_;
+    mutable std::mutex fill_mutex_;
+    std::vector<uint64_t> batch_fill_;
+
+    std::thread dispatcher_;
+
+    void dispatch_loop();
+    void start_batch(InFlight& flight, std::vector<float>& inputs, std::vector<float>& policies,
+                     std::vector<float>& values);
+    void finish_batch(InFlight& flight, std::vector<float>& policies, std::vector<float>& values);
+};
+
+// Evaluator interface over a shared broker, one per search thread
+class BrokerEvaluator : public Evaluator {
+public:
+    explicit BrokerEvaluator(InferenceBroker& broker) : broker_(broker) {}
+
+    std::pair<std::vector<float>, float> evaluate(const OthelloBoard& board, Player current_player) override {
+        std::vector<float> policy(kPolicySize);
+        float value = evaluate_into(board, current_player, policy.data());
+        return {policy, value};
+    }
+
+    float evaluate_into(const OthelloBoard& board, Player current_player, float* policy) override {
+        float input[OthelloBoard::kTensorSize];
+        board.encode(current_player, input);
+        return broker_.evaluate(input, policy);
+    }
+
+private:
+    InferenceBroker& broker_;
+};
+
+}  // namespace othello
@@ -29,6 +29,25 @@ public:
     std::vector<float> get_policy_target() const;
     float get_value_target() const;
 
+    // Search estimate of the root for its side to move: mean value over the root's visits
+    float root_value() const;
+
+    // Reseed temperature sampling (the default seed is the current time)
+    void seed(uint32_t seed) { rng_.seed(seed); }
+
+    // Per-move search statistics at info level; self-play turns these off
+    void set_log_stats(bool enabled) { log_stats_ = enabled; }
+
+    // Wall-clock budget per run() in seconds (0: none). run() stops at whichever of the
+    // simulation count and the budget is reached first, after at least one simulation.
+    void set_time_limit(double seconds) { time_limit_ = seconds; }
+
+    // Simulations performed by the last run()
+    int last_simulations() const { return last_simulations_; }
+
+    // Nodes in the current tree; walks it, so call it between searches rather than per simulation
+    size_t tree_size() const;
+
 private:
     // Tree structure
     std::unique_ptr<MCTSNode> root_;
@@ -37,12 +56,16 @@ private:
     // MCTS parameters
     int num_simulations_;
     float c_puct_;
+    bool log_stats_ = true;
+    double time_limit_ = 0.0;
+    int last_simulations_ = 0;
 
     // Random generator (for Dirichlet noise, temperature sampling)
     std::mt19937 rng_;
 
     // Internal search steps
     void run_simulation();
+    int select_move(const MCTSNode* node) const;   // PUCT choice among legal moves (or PASS)
     MCTSNode* select_leaf(MCTSNode* node);
     void backpropagate(MCTSNode* node, float value);
 
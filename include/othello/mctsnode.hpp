@@ -1,9 +1,9 @@
 #pragma once
 #include "othello/board.hpp"
+#include <array>
 #include <unordered_map>
 #include <memory>
 #include <cmath>
-#include <functional>
 #include <cassert>
 #include <spdlog/spdlog.h>
 
@@ -16,22 +16,20 @@ struct MCTSNode {
     OthelloBoard board;
     Player current_player;
 
-    std::vector<Move> legal_moves;
-    uint64_t legal_move_mask = 0;
+    uint64_t legal_move_mask = 0;    // empty: the only move is PASS
     std::unordered_map<int, std::unique_ptr<MCTSNode>> children;
 
-    // Move statistics
-    std::vector<float> prior;        // P(s,a)
-    std::vector<float> value_sum;    // Q sum
-    std::vector<int> visit_count;    // N(s,a)
+    // Move statistics, from current_player's perspective
+    std::array<float, kNumMoves> prior{};        // P(s,a)
+    std::array<float, kNumMoves> value_sum{};    // Q sum
+    std::array<int, kNumMoves> visit_count{};    // N(s,a)
 
     bool is_expanded = false;
     MCTSNode* parent = nullptr;
     Move move_from_parent = othello::PASS;
 
     MCTSNode(const OthelloBoard& board, Player player, MCTSNode* parent = nullptr, Move move = othello::PASS)
-        : board(board), current_player(player), parent(parent), move_from_parent(move),
-          prior(kNumMoves, 0.0f), value_sum(kNumMoves, 0.0f), visit_count(kNumMoves, 0) {}
+        : board(board), current_player(player), parent(parent), move_from_parent(move) {}
 
     float get_mean_value(int idx) const {
         int n = visit_count[idx];
@@ -49,38 +47,49 @@ struct MCTSNode {
         return board.is_game_over();
     }
 
-    void expand(std::function<std::pair<std::vector<float>, float>(const OthelloBoard&, Player)> evaluator) {
-        if (is_expanded) return;
+    // True if PASS is the only legal move
+    bool must_pass() const {
+        return legal_move_mask == 0;
+    }
+
+    // Evaluates the node and sets the priors over its legal moves.
+    // `evaluate(board, player, float* policy)` fills kNumMoves probabilities and returns the
+    // value from player's perspective; this call returns that value (0 if already expanded).
+    template <typename EvaluateFn>
+    float expand(EvaluateFn&& evaluate) {
+        if (is_expanded) return 0.0f;
 
         // Step 1: Evaluate with NN
-        auto [policy, value] = evaluator(board, current_player);
-        assert(policy.size() == 65);
+        float policy[kNumMoves];
+        float value = evaluate(board, current_player, policy);
 
         // Step 2: Get legal moves
-        legal_moves = board.get_valid_moves(current_player);
-        legal_move_mask = 0;
+        legal_move_mask = board.legal_move_mask(current_player);
         spdlog::debug("Expanding node for player {}", (current_player == Player::BLACK ? "BLACK" : "WHITE"));
-        spdlog::debug("Legal moves: {}", legal_moves.size());
-
-        float policy_sum = 0.0f;
+        spdlog::debug("Legal moves: {}", __builtin_popcountll(legal_move_mask));
 
-        for (const auto& move : legal_moves) {
-            if (move == othello::PASS) continue;
-            int idx = othello::to_index(move.x, move.y);
-            float p = policy[idx];
+        if (must_pass()) {
+            prior[PASS_INDEX] = 1.0f;
+            is_expanded = true;
+            return value;
+        }
 
-            prior[idx] = p;
-            policy_sum += p;
-            legal_move_mask |= (1ULL << idx);
+        float policy_sum = 0.0f;
+        for (uint64_t m = legal_move_mask; m; m &= m - 1) {
+            int idx = __builtin_ctzll(m);
+            prior[idx] = policy[idx];
+            policy_sum += policy[idx];
         }
 
-        // Step 3: Normalize priors
-        if (policy_sum > 1e-8f) {
-            for (int i = 0; i < 64; ++i)
-                prior[i] /= policy_sum;
+        // Step 3: Normalize priors (uniform if the policy put no mass on legal moves)
+        int count = __builtin_popcountll(legal_move_mask);
+        for (uint64_t m = legal_move_mask; m; m &= m - 1) {
+            int idx = __builtin_ctzll(m);
+            prior[idx] = (policy_sum > 1e-8f) ? prior[idx] / policy_sum : 1.0f / count;
         }
 
         is_expanded = true;
+        return value;
     }
 };
 
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "othello/evaluator.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Metrics for the engine and the agent server, rendered in the Prometheus text format.
+//
+// Recording only touches relaxed atomics and never allocates, so search threads and the event
+// loop record without contention; the registry's lock is taken only to register a metric and
+// to render. Register everything up front and keep the returned references.
+namespace othello::metrics {
+
+class Counter {
+public:
+    void add(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+class Gauge {
+public:
+    void set(int64_t v) { value_.store(v, std::memory_order_relaxed); }
+    void add(int64_t delta) { value_.fetch_add(delta, std::memory_order_relaxed); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+struct HistogramSnapshot {
+    std::vector<uint64_t> counts;   // per bucket, see Histogram
+    uint64_t total = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+
+    double mean() const { return total ? double(sum) / total : 0.0; }
+    uint64_t percentile(double p) const;   // upper bound of the bucket holding the p-quantile
+};
+
+// HDR-style log-linear histogram of non-negative integers. Values below kSubBuckets get a
+// bucket each; above that every power of two is split into kSubBuckets linear buckets, so a
+// reported quantile is within 12.5% of the true value anywhere in the uint64 range, in a
+// fixed 4 KiB of counters.
+class Histogram {
+public:
+    static constexpr int kSubBits = 3;
+    static constexpr int kSubBuckets = 1 << kSubBits;
+    static constexpr int kBuckets = (64 - kSubBits + 1) * kSubBuckets;
+
+    void record(uint64_t value);
+    HistogramSnapshot snapshot() const;
+
+    static int bucket_of(uint64_t value);
+    static uint64_t bucket_upper(int bucket);   // largest value in the bucket
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets> counts_{};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+// Named metrics. Names follow Prometheus conventions (othello_moves_total); `labels` is an
+// optional label set without braces, such as source="book". Registering the same name and
+// labels again returns the existing metric, so several servers can share one registry.
+class Registry {
+public:
+    Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+    Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    // Exported as a summary (quantiles, _sum, _count) plus a _max gauge, each value multiplied
+    // by `scale`: record microseconds with scale 1e-6 for a metric in seconds
+    Histogram& histogram(const std::string& name, const std::string& help, double scale = 1.0,
+                         const std::string& labels = "");
+
+    std::string prometheus_text() const;
+
+private:
+    enum class Type { Counter, Gauge, Summary };
+
+    struct Series {
+        std::string labels;
+        Counter* counter = nullptr;
+        Gauge* gauge = nullptr;
+        Histogram* histogram = nullptr;
+    };
+
+    struct Family {
+        std::string name;
+        std::string help;
+        Type type;
+        double scale = 1.0;
+        std::vector<Series> series;
+    };
+
+    mutable std::mutex mutex_;
+    std::vector<Family> families_;           // in registration order
+    std::deque<Counter> counters_;           // deques keep handed-out references valid
+    std::deque<Gauge> gauges_;
+    std::deque<Histogram> histograms_;
+
+    Series& series(const std::string& name, const std::string& help, Type type, double scale,
+                   const std::string& labels);
+};
+
+// Times every evaluation of the wrapped evaluator into `latency_ns`, in nanoseconds since a
+// cheap evaluator takes well under a microsecond
+class TimedEvaluator : public Evaluator {
+public:
+    TimedEvaluator(std::unique_ptr<Evaluator> inner, Histogram& latency_ns)
+        : inner_(std::move(inner)), latency_ns_(latency_ns) {}
+
+    std::pair<std::vector<float>, float> evaluate(const OthelloBoard& board, Player current_player) override;
+    float evaluate_into(const OthelloBoard& board, Player current_player, float* policy) override;
+    void begin_path(const OthelloBoard& root, Player to_move) override { inner_->begin_path(root, to_move); }
+    void descend(Player mover, int move_index, const OthelloBoard& board) override {
+        inner_->descend(mover, move_index, board);
+    }
+
+    Evaluator& inner() { return *inner_; }
+
+private:
+    std::unique_ptr<Evaluator> inner_;
+    Histogram& latency_ns_;
+};
+
+struct ExporterConfig {
+    int http_port = -1;                          // GET /metrics on 127.0.0.1; 0: any free port, -1: off
+    std::string file_path;                       // rewritten every interval when set
+    std::chrono::milliseconds interval{10000};
+};
+
+// Serves a registry over HTTP and/or flushes it to a file from one background thread. The
+// file is replaced atomically (written beside it, then renamed), so a collector such as
+// node_exporter's textfile reader never sees half of it; the destructor writes it once more.
+class Exporter {
+public:
+    // Throws std::runtime_error if the HTTP port cannot be bound
+    Exporter(const Registry& registry, const ExporterConfig& config);
+    ~Exporter();
+
+    Exporter(const Exporter&) = delete;
+    Exporter& operator=(const Exporter&) = delete;
+
+    int port() const { return port_; }
+
+    // Writes the file now; false if that failed
+    bool flush() const;
+
+private:
+    const Registry& registry_;
+    ExporterConfig config_;
+    int port_ = 0;
+    int listen_fd_ = -1;
+    int stop_fd_ = -1;   // eventfd that wakes the thread to exit
+    std::thread thread_;
+
+    void loop();
+    void serve(int client_fd) const;
+};
+
+} // namespace othello::metrics
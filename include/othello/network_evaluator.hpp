@@ -0,0 +1,70 @@
+#pragma once
+
+#include "othello/evaluator.hpp"
+#include "nn/model_registry.hpp"
+#include "nn/network.hpp"
+#include "nn/quantized.hpp"
+
+#include <memory>
+
+namespace othello {
+
+// fp32 policy/value network on the CPU
+class NetworkEvaluator : public BatchEvaluator {
+public:
+    explicit NetworkEvaluator(const nn::Network& network) : network_(network) {}
+
+    void evaluate_batch(const float* inputs, int n, float* policies, float* values) override {
+        for (int i = 0; i < n; ++i)
+            values[i] = network_.forward(inputs + i * nn::kInputSize, policies + i * nn::kPolicySize);
+    }
+
+    int max_batch_size() const override { return 1 << 16; }
+
+private:
+    const nn::Network& network_;
+};
+
+// Int8 policy/value network on the CPU (see nn::QuantizedNetwork)
+class QuantizedEvaluator : public BatchEvaluator {
+public:
+    explicit QuantizedEvaluator(const nn::QuantizedNetwork& network) : network_(network) {}
+
+    void evaluate_batch(const float* inputs, int n, float* policies, float* values) override {
+        for (int i = 0; i < n; ++i)
+            values[i] = network_.forward(inputs + i * nn::kInputSize, policies + i * nn::kPolicySize);
+    }
+
+    int max_batch_size() const override { return 1 << 16; }
+
+private:
+    const nn::QuantizedNetwork& network_;
+};
+
+// fp32 network taken from a ModelRegistry. The model is pinned until refresh(), so a search
+// started before a reload finishes on the model it started with.
+class RegistryEvaluator : public BatchEvaluator {
+public:
+    explicit RegistryEvaluator(const nn::ModelRegistry& registry) : registry_(registry), network_(registry.current()) {}
+
+    // Picks up the registry's current model; returns true if it changed
+    bool refresh() {
+        auto latest = registry_.current();
+        if (latest == network_) return false;
+        network_ = std::move(latest);
+        return true;
+    }
+
+    void evaluate_batch(const float* inputs, int n, float* policies, float* values) override {
+        for (int i = 0; i < n; ++i)
+            values[i] = network_->forward(inputs + i * nn::kInputSize, policies + i * nn::kPolicySize);
+    }
+
+    int max_batch_size() const override { return 1 << 16; }
+
+private:
+    const nn::ModelRegistry& registry_;
+    std::shared_ptr<const nn::Network> network_;
+};
+
+} // namespace othello
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "othello/evaluator.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace othello {
+
+struct PatternState;
+
+namespace patterns {
+    constexpr int kNumPhases = 12;      // by disk count, 5 disks per phase
+    constexpr int kNumTypes = 11;
+    constexpr int kNumInstances = 46;   // every symmetric placement of every type
+    constexpr int kMaxSquares = 10;
+
+    constexpr int kScalarFeatures = 3;  // mobility, parity, bias
+
+    // Weights per phase: one table of 3^size entries per type, then the scalar features
+    size_t phase_size();
+
+    inline int phase_of(int disks) {
+        int phase = (disks - 4) / 5;
+        return phase < 0 ? 0 : (phase >= kNumPhases ? kNumPhases - 1 : phase);
+    }
+
+    // Offsets within a phase block of the weights touched by a position
+    void table_indices(const PatternState& state, int perspective, uint32_t* out);   // kNumInstances entries
+    void scalar_features(uint64_t own, uint64_t opp, float* out);                    // kScalarFeatures entries
+} // namespace patterns
+
+// Base-3 index of every pattern instance, kept for both colours so that the side to move
+// can always look up its own perspective. Digits: 0 empty, 1 own disk, 2 opponent disk.
+struct PatternState {
+    uint16_t index[2][patterns::kNumInstances];   // [0] black's perspective, [1] white's
+
+    // Perspective 0 is `first`'s, perspective 1 is `second`'s
+    static PatternState from_bits(uint64_t first, uint64_t second);
+    static PatternState from_board(const OthelloBoard& board);
+
+    // Incremental update after `mover` plays on `sq` flipping `flipped`
+    void apply(Player mover, int sq, uint64_t flipped);
+};
+
+// Classic table-lookup evaluator (Logistello/Edax style): edge+2X, 3x3 and 2x5 corners,
+// diagonals and inner lines, with separate weights per game phase plus mobility and parity.
+// Scores are in value units, from the perspective of the side to move.
+//
+// Copies share one weight table (copy-on-write through weights()), so every search thread can
+// own an evaluator for the price of its search-path state. Inside a search the pattern indices
+// follow the path with PatternState::apply instead of being rebuilt for every leaf.
+class PatternEvaluator : public Evaluator {
+public:
+    explicit PatternEvaluator(bool lookahead_policy = true);
+
+    // Raw linear score; perspective selects PatternState::index[perspective] as "own"
+    float score(const PatternState& state, int perspective, uint64_t own, uint64_t opp) const;
+
+    // Value of `board` for `player`, in [-1, 1]
+    float value(const OthelloBoard& board, Player player) const;
+
+    // Policy is a softmax over one-ply scores when lookahead_policy is set, uniform otherwise
+    std::pair<std::vector<float>, float> evaluate(const OthelloBoard& board, Player current_player) override;
+    float evaluate_into(const OthelloBoard& board, Player current_player, float* policy) override;
+
+    void begin_path(const OthelloBoard& root, Player to_move) override;
+    void descend(Player mover, int move_index, const OthelloBoard& board) override;
+
+    // Flat weights: kNumPhases blocks of patterns::phase_size()
+    std::vector<float>& weights();
+    const std::vector<float>& weights() const { return *weights_; }
+
+    void save(const std::string& path) const;
+    void load(const std::string& path);
+
+private:
+    struct Path {
+        PatternState state;
+        uint64_t black = 0;
+        uint64_t white = 0;
+        bool valid = false;
+    };
+
+    // score() over one perspective's kNumInstances indices
+    float score(const uint16_t* index, uint64_t own, uint64_t opp) const;
+
+    std::shared_ptr<std::vector<float>> weights_;
+    bool lookahead_policy_;
+    Path root_;   // the last root, recomputed only when the search moves on
+    Path path_;   // the position the current descent has reached
+};
+
+} // namespace othello
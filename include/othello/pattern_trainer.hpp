@@ -0,0 +1,44 @@
+#pragma once
+
+#include "othello/pattern_evaluator.hpp"
+#include "replay/buffer.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace othello {
+
+// Least-squares fit of PatternEvaluator weights.
+// Each epoch is one Jacobi-preconditioned gradient step on the normal equations:
+// every weight moves by (sum of feature * residual) / (sum of feature^2), shared between the
+// features active in a sample and damped by the learning rate.
+class PatternTrainer {
+public:
+    explicit PatternTrainer(PatternEvaluator& evaluator);
+
+    // target: outcome in [-1, 1] from the perspective of the side owning `own`
+    void add_sample(uint64_t own, uint64_t opp, float target);
+
+    // Replay samples store the side to move's disks in plane 0 and the opponent's in plane 1
+    void add(const TrainSample& sample);
+    void add(const float* state, float value);   // one decoded 192-float state (ReplayBatch)
+
+    size_t size() const { return samples_.size(); }
+
+    // Returns the RMSE after the final epoch
+    float fit(int epochs, float learning_rate = 1.0f, float l2 = 1e-3f);
+
+    float rmse() const;
+
+private:
+    struct Sample {
+        uint64_t own;
+        uint64_t opp;
+        float target;
+    };
+
+    PatternEvaluator& evaluator_;
+    std::vector<Sample> samples_;
+};
+
+} // namespace othello
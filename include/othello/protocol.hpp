@@ -0,0 +1,197 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Binary framing for the link between remote_agent and the engine (othelloplayer).
+// Header-only and free of engine types, so remote_agent can use it without linking the engine.
+//
+// Every message is a frame:
+//
+//   uint16 length     payload bytes, little-endian, at most kMaxPayload
+//   uint8  type       MessageType
+//   payload[length]
+//
+// Payloads (all integers little-endian):
+//
+//   Hello     client -> engine   uint8 version, uint8 side (0 black, 1 white)
+//   Move      client -> engine   int8 x, int8 y (-1 -1: no move), int32 ms_left
+//   Reply     engine -> client   int8 x, int8 y (-1 -1: pass)
+//   Ping      client -> engine   uint64 token
+//   Pong      engine -> client   uint64 token, echoed
+//   Analyze   client -> engine   uint32 id, uint16 n, n x {uint64 black, uint64 white, uint8 side}
+//   Analysis  engine -> client   uint32 id, uint16 n, n x {int8 x, int8 y, float32 value}
+//   ShmAttach client -> engine   empty; Unix socket only, carries the fds of othello/shm_channel.hpp
+//
+// A game session sends Hello first, then one Move per opponent move and waits for the Reply.
+// Analyze requests may be pipelined: any number can be in flight, each answered by the
+// Analysis with the same id, in completion order rather than request order.
+namespace othello::protocol {
+
+constexpr uint8_t kVersion = 1;
+constexpr size_t kHeaderBytes = 3;
+constexpr size_t kMaxPayload = 4096;
+constexpr size_t kMaxFrame = kHeaderBytes + kMaxPayload;
+constexpr size_t kAnalyzeEntryBytes = 17;
+constexpr size_t kAnalysisEntryBytes = 6;
+constexpr int kMaxAnalyzeBatch = static_cast<int>((kMaxPayload - 6) / kAnalyzeEntryBytes);   // 240
+
+enum class MessageType : uint8_t {
+    Hello = 1,
+    Move = 2,
+    Reply = 3,
+    Ping = 4,
+    Pong = 5,
+    Analyze = 6,
+    Analysis = 7,
+    ShmAttach = 8,
+};
+
+// A complete frame inside a FrameReader; the payload pointer is valid until its next write_ptr()
+struct Frame {
+    MessageType type;
+    const uint8_t* payload;
+    size_t size;
+};
+
+// Builds one frame in a fixed buffer:
+//
+//     FrameWriter w(MessageType::Reply);
+//     w.i8(x).i8(y);
+//     send(fd, w.data(), w.size(), 0);
+//
+// Writes past kMaxPayload are dropped and flagged by overflow().
+class FrameWriter {
+public:
+    explicit FrameWriter(MessageType type) { buf_[2] = static_cast<uint8_t>(type); }
+
+    FrameWriter& u8(uint8_t v) { return put(v, 1); }
+    FrameWriter& i8(int8_t v) { return put(static_cast<uint8_t>(v), 1); }
+    FrameWriter& u16(uint16_t v) { return put(v, 2); }
+    FrameWriter& u32(uint32_t v) { return put(v, 4); }
+    FrameWriter& i32(int32_t v) { return put(static_cast<uint32_t>(v), 4); }
+    FrameWriter& u64(uint64_t v) { return put(v, 8); }
+    FrameWriter& f32(float v) {
+        uint32_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        return put(bits, 4);
+    }
+
+    // The frame with its length filled in
+    const uint8_t* data() {
+        const size_t length = size_ - kHeaderBytes;
+        buf_[0] = static_cast<uint8_t>(length);
+        buf_[1] = static_cast<uint8_t>(length >> 8);
+        return buf_;
+    }
+    size_t size() const { return size_; }
+    bool overflow() const { return overflow_; }
+
+private:
+    uint8_t buf_[kMaxFrame];
+    size_t size_ = kHeaderBytes;
+    bool overflow_ = false;
+
+    FrameWriter& put(uint64_t v, size_t bytes) {
+        if (size_ + bytes > kMaxFrame) {
+            overflow_ = true;
+            return *this;
+        }
+        for (size_t i = 0; i < bytes; ++i) buf_[size_++] = static_cast<uint8_t>(v >> (8 * i));
+        return *this;
+    }
+};
+
+// Bounds-checked cursor over a payload; reads past the end return 0 and clear ok()
+class PayloadReader {
+public:
+    explicit PayloadReader(const Frame& frame) : p_(frame.payload), end_(frame.payload + frame.size) {}
+
+    uint8_t u8() { return static_cast<uint8_t>(get(1)); }
+    int8_t i8() { return static_cast<int8_t>(get(1)); }
+    uint16_t u16() { return static_cast<uint16_t>(get(2)); }
+    uint32_t u32() { return static_cast<uint32_t>(get(4)); }
+    int32_t i32() { return static_cast<int32_t>(get(4)); }
+    uint64_t u64() { return get(8); }
+    float f32() {
+        uint32_t bits = u32();
+        float v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+
+    bool ok() const { return ok_; }
+    size_t remaining() const { return static_cast<size_t>(end_ - p_); }
+
+private:
+    const uint8_t* p_;
+    const uint8_t* end_;
+    bool ok_ = true;
+
+    uint64_t get(size_t bytes) {
+        if (remaining() < bytes) {
+            ok_ = false;
+            p_ = end_;
+            return 0;
+        }
+        uint64_t v = 0;
+        for (size_t i = 0; i < bytes; ++i) v |= static_cast<uint64_t>(p_[i]) << (8 * i);
+        p_ += bytes;
+        return v;
+    }
+};
+
+// Reassembles frames from a byte stream, whatever the segmentation. Receive straight into it
+// and parse in place, so nothing is copied or allocated per message:
+//
+//     n = recv(fd, reader.write_ptr(), reader.write_space(), 0);
+//     reader.commit(n);
+//     while (reader.peek(frame) == FrameReader::Ready) { handle(frame); reader.pop(); }
+class FrameReader {
+public:
+    enum Status { Ready, NeedMore, Invalid };
+
+    // Free space after the buffered bytes; compacts first, which moves any frame already peeked
+    uint8_t* write_ptr() {
+        if (begin_ > 0 && end_ + kMaxFrame > sizeof(buf_)) {
+            std::memmove(buf_, buf_ + begin_, end_ - begin_);
+            end_ -= begin_;
+            begin_ = 0;
+        }
+        return buf_ + end_;
+    }
+    size_t write_space() const { return sizeof(buf_) - end_; }
+    void commit(size_t bytes) { end_ += bytes; }
+
+    // Next complete frame without consuming it. Invalid (an oversized length) means the
+    // stream is out of sync and the connection should be dropped.
+    Status peek(Frame& frame) const {
+        const size_t available = end_ - begin_;
+        if (available < kHeaderBytes) return NeedMore;
+        const uint8_t* p = buf_ + begin_;
+        const size_t length = p[0] | (static_cast<size_t>(p[1]) << 8);
+        if (length > kMaxPayload) return Invalid;
+        if (available < kHeaderBytes + length) return NeedMore;
+        frame.type = static_cast<MessageType>(p[2]);
+        frame.payload = p + kHeaderBytes;
+        frame.size = length;
+        return Ready;
+    }
+
+    // Consumes the frame returned by the last successful peek()
+    void pop() {
+        const uint8_t* p = buf_ + begin_;
+        begin_ += kHeaderBytes + (p[0] | (static_cast<size_t>(p[1]) << 8));
+        if (begin_ == end_) begin_ = end_ = 0;
+    }
+
+    size_t buffered() const { return end_ - begin_; }
+
+private:
+    uint8_t buf_[2 * kMaxFrame];
+    size_t begin_ = 0;
+    size_t end_ = 0;
+};
+
+} // namespace othello::protocol
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "othello/agent_server.hpp"
+
+#include <string>
+
+namespace othello {
+
+// YAML runtime profile for othelloplayer, as written by `othelloplayer --tune`:
+//
+//   search:
+//     threads: 8              # AgentServerConfig::workers, 0: one per hardware thread
+//     simulations: 800
+//     c_puct: 1.5
+//   inference:
+//     batch_size: 4           # 1: no batching
+//     batch_wait_us: 500
+//   server:
+//     port: 4000
+//     unix_path: /tmp/othello.sock
+//
+// Every key is optional and keeps the config's current value when absent; unknown keys and
+// malformed values are errors, so a typo cannot silently fall back to a default.
+constexpr const char* kDefaultRuntimeConfigPath = "othello.yaml";
+
+// Applies the file at `path` over `config`; throws std::runtime_error on any problem
+void load_runtime_config(const std::string& path, AgentServerConfig& config);
+
+// Same, from YAML text; `name` only labels error messages
+void parse_runtime_config(const std::string& yaml, const std::string& name, AgentServerConfig& config);
+
+// The search and inference settings as YAML (the server section is left to the command line),
+// preceded by `comment` lines if given
+std::string runtime_config_yaml(const AgentServerConfig& config, const std::string& comment = "");
+
+// Writes runtime_config_yaml to `path`; throws std::runtime_error if that fails
+void save_runtime_config(const std::string& path, const AgentServerConfig& config, const std::string& comment = "");
+
+} // namespace othello
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "othello/evaluator.hpp"
+#include "othello/game_record.hpp"
+#include "replay/buffer.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace othello {
+
+struct SelfPlayConfig {
+    int threads = 0;                 // 0: one per hardware thread
+    int simulations = 200;           // MCTS simulations per move
+    float c_puct = 1.5f;
+    int temperature_plies = 20;      // moves sampled from visit counts before switching to argmax
+    uint32_t seed = 1;               // game g is seeded with seed + g, so runs are reproducible
+    int report_every = 0;            // log progress every N games (0: never)
+    std::string trace_path;          // write a Chrome trace of one game here (empty: none)
+    int trace_game = 0;              // which one, by index
+};
+
+struct SelfPlayStats {
+    uint64_t games = 0;
+    uint64_t positions = 0;
+    uint64_t black_wins = 0;
+    uint64_t white_wins = 0;
+    uint64_t draws = 0;
+    double seconds = 0.0;
+
+    double games_per_second() const { return seconds > 0 ? games / seconds : 0.0; }
+    double positions_per_second() const { return seconds > 0 ? positions / seconds : 0.0; }
+};
+
+// Plays MCTS-vs-itself games on a pool of worker threads and streams the positions into a
+// ReplaySink (ReplayBuffer or the on-disk ReplayStoreBuffer). Every searched position yields
+// one TrainSample: the encoded board, the root visit distribution as the policy target, and
+// the final result from the mover's side.
+class SelfPlay {
+public:
+    // Called once per worker; evaluators are never shared between threads
+    using EvaluatorFactory = std::function<std::unique_ptr<Evaluator>()>;
+
+    SelfPlay(EvaluatorFactory factory, ReplaySink& sink, const SelfPlayConfig& config = {});
+
+    // Plays `games` games and blocks until they finish
+    SelfPlayStats run(int games);
+
+    // Also hands every finished game's move list to `observer` (e.g. an opening book builder)
+    void set_game_observer(GameObserver observer) { observer_ = std::move(observer); }
+
+    // One game; returns the samples with values backfilled and the winner (NONE for a draw).
+    // `record`, if given, receives the full move list.
+    static std::vector<TrainSample> play_game(Evaluator& evaluator, const SelfPlayConfig& config, uint32_t seed,
+                                              Player* winner = nullptr, GameRecord* record = nullptr);
+
+private:
+    EvaluatorFactory factory_;
+    ReplaySink& sink_;
+    SelfPlayConfig config_;
+    GameObserver observer_;
+};
+
+} // namespace othello
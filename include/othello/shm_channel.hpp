@@ -0,0 +1,151 @@
+#pragma once
+
+#ifndef _WIN32
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <new>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <linux/memfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Shared-memory transport between remote_agent and the engine on the same host.
+//
+// The client creates the channel in a memfd and hands it to the engine over the Unix socket
+// (ShmAttach, with the memfd and an eventfd attached as SCM_RIGHTS). From then on frames of
+// othello/protocol.hpp flow through two single-producer single-consumer byte rings instead of
+// the socket, which stays open only so either side notices the other going away.
+//
+// Wakeups: the client blocks on futexes (the to_client head while waiting for a reply, the
+// to_engine tail while that ring is full). The engine never blocks; a futex cannot sit in its
+// epoll set, so the client rings the eventfd ("doorbell") after writing, and after reading
+// when the engine is waiting for space.
+//
+// The memfd is sealed against resizing before it is handed over, and the engine refuses one
+// that is not: a client truncating it would otherwise fault the engine's next ring access.
+namespace othello::shm {
+
+constexpr uint32_t kMagic = 0x4d485348;   // "HSHM"
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kRingBytes = 1 << 16;
+
+struct Ring {
+    // Free-running byte counts; the futex words the client sleeps on
+    alignas(64) std::atomic<uint32_t> head{0};             // bytes written
+    alignas(64) std::atomic<uint32_t> tail{0};             // bytes read
+    alignas(64) std::atomic<uint32_t> reader_waiting{0};
+    std::atomic<uint32_t> writer_waiting{0};
+    alignas(64) uint8_t data[kRingBytes];
+
+    // Copies up to `size` bytes in; returns how many fit
+    size_t write(const uint8_t* src, size_t size) {
+        const uint32_t h = head.load(std::memory_order_relaxed);
+        const uint32_t t = tail.load(std::memory_order_acquire);
+        size_t n = kRingBytes - (h - t);
+        if (n > size) n = size;
+        for (size_t done = 0; done < n;) {
+            const uint32_t at = (h + done) & (kRingBytes - 1);
+            size_t chunk = kRingBytes - at;
+            if (chunk > n - done) chunk = n - done;
+            std::memcpy(data + at, src + done, chunk);
+            done += chunk;
+        }
+        head.store(h + static_cast<uint32_t>(n));   // seq_cst: ordered before the waiting check
+        return n;
+    }
+
+    // Copies up to `size` bytes out; returns how many were available
+    size_t read(uint8_t* dst, size_t size) {
+        const uint32_t t = tail.load(std::memory_order_relaxed);
+        const uint32_t h = head.load(std::memory_order_acquire);
+        size_t n = h - t;
+        if (n > size) n = size;
+        for (size_t done = 0; done < n;) {
+            const uint32_t at = (t + done) & (kRingBytes - 1);
+            size_t chunk = kRingBytes - at;
+            if (chunk > n - done) chunk = n - done;
+            std::memcpy(dst + done, data + at, chunk);
+            done += chunk;
+        }
+        tail.store(t + static_cast<uint32_t>(n));
+        return n;
+    }
+
+    bool empty() const { return head.load() == tail.load(); }
+    bool full() const { return head.load() - tail.load() == kRingBytes; }
+};
+
+struct Channel {
+    uint32_t magic;
+    uint32_t version;
+    Ring to_engine;
+    Ring to_client;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "futex words must be plain shared integers");
+
+// Shared (not FUTEX_PRIVATE) operations: the word lives in a mapping of another process
+inline void futex_wait(std::atomic<uint32_t>& word, uint32_t expected, long timeout_ms) {
+    timespec timeout{timeout_ms / 1000, (timeout_ms % 1000) * 1000000};
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+}
+
+inline void futex_wake(std::atomic<uint32_t>& word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+}
+
+constexpr int kRequiredSeals = F_SEAL_SHRINK | F_SEAL_GROW;
+
+// Client side: a fresh channel in a memfd, sealed at its size. Returns nullptr on failure;
+// `fd` receives the memfd.
+inline Channel* create_channel(int& fd) {
+    fd = static_cast<int>(syscall(SYS_memfd_create, "othello-shm", MFD_ALLOW_SEALING));
+    if (fd < 0) return nullptr;
+    if (ftruncate(fd, sizeof(Channel)) != 0 || fcntl(fd, F_ADD_SEALS, kRequiredSeals | F_SEAL_SEAL) != 0) {
+        close(fd);
+        return nullptr;
+    }
+    void* map = mmap(nullptr, sizeof(Channel), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return nullptr;
+    }
+    Channel* channel = new (map) Channel();
+    channel->magic = kMagic;
+    channel->version = kVersion;
+    return channel;
+}
+
+// Engine side: maps a channel received from a client; nullptr if it is not one or if its
+// size is not sealed
+inline Channel* map_channel(int fd) {
+    const int seals = fcntl(fd, F_GET_SEALS);
+    if (seals < 0 || (seals & kRequiredSeals) != kRequiredSeals) return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) != sizeof(Channel)) return nullptr;
+    void* map = mmap(nullptr, sizeof(Channel), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) return nullptr;
+    Channel* channel = static_cast<Channel*>(map);
+    if (channel->magic != kMagic || channel->version != kVersion) {
+        munmap(map, sizeof(Channel));
+        return nullptr;
+    }
+    return channel;
+}
+
+inline void unmap_channel(Channel* channel) {
+    if (channel) munmap(channel, sizeof(Channel));
+}
+
+} // namespace othello::shm
+
+#endif // _WIN32
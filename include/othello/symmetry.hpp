@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+
+// The 8 symmetries of the board (dihedral group D4) on bitboards and policies.
+// Symmetry t maps square (x, y) to:
+//
+//   0 (x, y)       identity          4 (7-x, y)     mirror left-right
+//   1 (7-y, x)     rotate 90         5 (x, 7-y)     flip top-bottom
+//   2 (7-x, 7-y)   rotate 180        6 (y, x)       transpose (a1-h8 diagonal)
+//   3 (y, 7-x)     rotate 270        7 (7-y, 7-x)   anti-transpose (a8-h1 diagonal)
+//
+// the same numbering as the pattern placements in pattern_evaluator.cpp. The board rules are
+// invariant under all of them, so a position, its legal moves and its policy can be mapped
+// together. The PASS entry of a policy (index 64) is left in place.
+namespace othello::symmetry {
+
+constexpr int kCount = 8;
+
+inline uint64_t flip_vertical(uint64_t b) {       // (x, y) -> (x, 7-y)
+    return __builtin_bswap64(b);
+}
+
+inline uint64_t mirror_horizontal(uint64_t b) {   // (x, y) -> (7-x, y)
+    constexpr uint64_t k1 = 0x5555555555555555ULL;
+    constexpr uint64_t k2 = 0x3333333333333333ULL;
+    constexpr uint64_t k4 = 0x0f0f0f0f0f0f0f0fULL;
+    b = ((b >> 1) & k1) | ((b & k1) << 1);
+    b = ((b >> 2) & k2) | ((b & k2) << 2);
+    b = ((b >> 4) & k4) | ((b & k4) << 4);
+    return b;
+}
+
+inline uint64_t transpose(uint64_t b) {           // (x, y) -> (y, x)
+    constexpr uint64_t k1 = 0x5500550055005500ULL;
+    constexpr uint64_t k2 = 0x3333000033330000ULL;
+    constexpr uint64_t k4 = 0x0f0f0f0f00000000ULL;
+    uint64_t t;
+    t = k4 & (b ^ (b << 28));
+    b ^= t ^ (t >> 28);
+    t = k2 & (b ^ (b << 14));
+    b ^= t ^ (t >> 14);
+    t = k1 & (b ^ (b << 7));
+    b ^= t ^ (t >> 7);
+    return b;
+}
+
+inline uint64_t transform(uint64_t b, int t) {
+    switch (t) {
+        case 0: return b;
+        case 1: return mirror_horizontal(transpose(b));
+        case 2: return mirror_horizontal(flip_vertical(b));
+        case 3: return flip_vertical(transpose(b));
+        case 4: return mirror_horizontal(b);
+        case 5: return flip_vertical(b);
+        case 6: return transpose(b);
+        default: return mirror_horizontal(flip_vertical(transpose(b)));
+    }
+}
+
+// Image of square index sq (0..63) under symmetry t
+inline int square(int sq, int t) {
+    const int x = sq & 7, y = sq >> 3;
+    switch (t) {
+        case 0: return sq;
+        case 1: return (7 - y) + 8 * x;
+        case 2: return (7 - x) + 8 * (7 - y);
+        case 3: return y + 8 * (7 - x);
+        case 4: return (7 - x) + 8 * y;
+        case 5: return x + 8 * (7 - y);
+        case 6: return y + 8 * x;
+        default: return (7 - y) + 8 * (7 - x);
+    }
+}
+
+// Symmetry that undoes t (rotations by 90 and 270 invert each other, the rest are involutions)
+inline int inverse(int t) {
+    return t == 1 ? 3 : (t == 3 ? 1 : t);
+}
+
+// Permutes a 65-entry policy: out[square(i, t)] = in[i], PASS unchanged. in and out must not alias.
+inline void transform_policy(const float* in, float* out, int t) {
+    for (int i = 0; i < 64; ++i) out[square(i, t)] = in[i];
+    out[64] = in[64];
+}
+
+// Canonical representative of a position's symmetry class: the transform with the smallest
+// (first, second) pair. Returns the symmetry used, so moves can be mapped with square().
+inline int canonical(uint64_t& first, uint64_t& second) {
+    int best = 0;
+    uint64_t best_first = first, best_second = second;
+    for (int t = 1; t < kCount; ++t) {
+        uint64_t f = transform(first, t), s = transform(second, t);
+        if (f < best_first || (f == best_first && s < best_second)) {
+            best = t;
+            best_first = f;
+            best_second = s;
+        }
+    }
+    first = best_first;
+    second = best_second;
+    return best;
+}
+
+} // namespace othello::symmetry
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Opt-in search profiler writing Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+//
+// Code marks regions with scoped spans:
+//
+//     trace::Span span("select");
+//
+// Outside a capture a span is one relaxed atomic load and a branch, so the instrumentation
+// stays in release builds. During one (start() .. stop()) each thread appends complete events
+// to its own fixed buffer without locks; collect() merges them afterwards, one track per
+// thread. Span names and argument names must be string literals.
+namespace othello::trace {
+
+struct Event {
+    const char* name;
+    uint64_t start_ns;          // since start()
+    uint64_t duration_ns;
+    const char* arg_name;       // nullptr: no argument
+    int64_t arg;
+    uint32_t tid;
+};
+
+namespace detail {
+    inline std::atomic<bool> capturing{false};
+
+    uint64_t now_ns();
+    void record(const char* name, uint64_t start_ns, const char* arg_name, int64_t arg);
+} // namespace detail
+
+inline bool enabled() { return detail::capturing.load(std::memory_order_relaxed); }
+
+class Span {
+public:
+    explicit Span(const char* name) {
+        if (enabled()) begin(name);
+    }
+    Span(const char* name, const char* arg_name, int64_t arg) : arg_name_(arg_name), arg_(arg) {
+        if (enabled()) begin(name);
+    }
+    ~Span() {
+        if (name_) detail::record(name_, start_ns_, arg_name_, arg_);
+    }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    // Attaches (or replaces) the span's argument, e.g. a count known only at the end
+    void set_arg(const char* arg_name, int64_t arg) {
+        arg_name_ = arg_name;
+        arg_ = arg;
+    }
+
+private:
+    const char* name_ = nullptr;   // nullptr: not recording
+    uint64_t start_ns_ = 0;
+    const char* arg_name_ = nullptr;
+    int64_t arg_ = 0;
+
+    void begin(const char* name) {
+        name_ = name;
+        start_ns_ = detail::now_ns();
+    }
+};
+
+// Events each thread can hold per capture; later ones are dropped and counted
+constexpr size_t kThreadCapacity = 1 << 18;
+
+// Starts a capture on every thread, discarding the previous one
+void start();
+
+// Ends the capture; spans still open finish into it
+void stop();
+
+// Everything recorded by the last capture, ordered by thread then start time. Call it after
+// stop() and not concurrently with start().
+std::vector<Event> collect(uint64_t* dropped = nullptr);
+
+// Names the calling thread's track in the trace
+void set_thread_name(const std::string& name);
+
+// The last capture as Chrome trace JSON; write_chrome_json returns false if the file failed
+std::string chrome_json();
+bool write_chrome_json(const std::string& path);
+
+} // namespace othello::trace
@@ -0,0 +1,232 @@
+#pragma once
+
+#include "othello/protocol.hpp"
+#include "othello/shm_channel.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// Client ends of the engine link, for remote_agent and tests. Header-only like protocol.hpp.
+//
+//   tcp    any host (the only one on Windows)
+//   unix   Unix domain socket on the engine's host (othelloplayer --unix <path>)
+//   shm    shared-memory rings set up over the Unix socket (see shm_channel.hpp)
+namespace othello::transport {
+
+constexpr const char* kDefaultUnixPath = "/tmp/othello.sock";
+
+class ClientTransport {
+public:
+    virtual ~ClientTransport() = default;
+
+    // Sends all `size` bytes; false once the engine is gone
+    virtual bool send(const uint8_t* data, size_t size) = 0;
+
+    // Blocks for at least one byte; returns the count, or 0 once the engine is gone
+    virtual size_t recv(uint8_t* data, size_t size) = 0;
+
+    virtual const char* name() const = 0;
+};
+
+// TCP or Unix stream socket; owns the fd
+class SocketTransport : public ClientTransport {
+public:
+    SocketTransport(int fd, const char* name) : fd_(fd), name_(name) {}
+    ~SocketTransport() override {
+#ifdef _WIN32
+        closesocket(fd_);
+#else
+        close(fd_);
+#endif
+    }
+
+    bool send(const uint8_t* data, size_t size) override {
+        size_t sent = 0;
+        while (sent < size) {
+            int n = ::send(fd_, reinterpret_cast<const char*>(data) + sent, static_cast<int>(size - sent), 0);
+            if (n <= 0) return false;
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    size_t recv(uint8_t* data, size_t size) override {
+        int n = ::recv(fd_, reinterpret_cast<char*>(data), static_cast<int>(size), 0);
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+
+    const char* name() const override { return name_; }
+    int fd() const { return fd_; }
+
+private:
+    int fd_;
+    const char* name_;
+};
+
+#ifndef _WIN32
+
+// Connected Unix stream socket, or -1
+inline int connect_unix(const std::string& path) {
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path)) return -1;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Shared-memory rings; the Unix socket only watches for the engine going away
+class ShmTransport : public ClientTransport {
+public:
+    // Sets up a channel over a connected Unix socket (taking ownership of it); nullptr on failure
+    static std::unique_ptr<ShmTransport> attach(int unix_fd) {
+        int memfd = -1;
+        shm::Channel* channel = shm::create_channel(memfd);
+        int doorbell = eventfd(0, EFD_CLOEXEC);
+        if (!channel || doorbell < 0) {
+            if (channel) {
+                shm::unmap_channel(channel);
+                close(memfd);
+            }
+            if (doorbell >= 0) close(doorbell);
+            close(unix_fd);
+            return nullptr;
+        }
+
+        // ShmAttach with both fds; the engine keeps its own copies
+        protocol::FrameWriter frame(protocol::MessageType::ShmAttach);
+        iovec iov{const_cast<uint8_t*>(frame.data()), frame.size()};
+        alignas(cmsghdr) char control[CMSG_SPACE(2 * sizeof(int))] = {};
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(2 * sizeof(int));
+        const int fds[2] = {memfd, doorbell};
+        std::memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+        bool sent = sendmsg(unix_fd, &msg, MSG_NOSIGNAL) == static_cast<ssize_t>(frame.size());
+        close(memfd);
+        if (!sent) {
+            shm::unmap_channel(channel);
+            close(doorbell);
+            close(unix_fd);
+            return nullptr;
+        }
+        return std::unique_ptr<ShmTransport>(new ShmTransport(unix_fd, channel, doorbell));
+    }
+
+    ~ShmTransport() override {
+        shm::unmap_channel(channel_);
+        close(doorbell_);
+        close(unix_fd_);
+    }
+
+    bool send(const uint8_t* data, size_t size) override {
+        shm::Ring& ring = channel_->to_engine;
+        while (size > 0) {
+            size_t n = ring.write(data, size);
+            data += n;
+            size -= n;
+            if (n) ring_doorbell();
+            if (!size) break;
+
+            // Full: sleep until the engine frees space
+            const uint32_t tail = ring.tail.load();
+            ring.writer_waiting.store(1);
+            if (ring.full() && ring.tail.load() == tail) shm::futex_wait(ring.tail, tail, kPollMs);
+            ring.writer_waiting.store(0);
+            if (!engine_alive()) return false;
+        }
+        return true;
+    }
+
+    size_t recv(uint8_t* data, size_t size) override {
+        shm::Ring& ring = channel_->to_client;
+        while (true) {
+            size_t n = ring.read(data, size);
+            if (n) {
+                if (ring.writer_waiting.exchange(0)) ring_doorbell();   // the engine has more for us
+                return n;
+            }
+
+            // Empty: sleep until the engine writes, checking now and then that it still exists
+            const uint32_t head = ring.head.load();
+            ring.reader_waiting.store(1);
+            if (ring.empty()) shm::futex_wait(ring.head, head, kPollMs);
+            ring.reader_waiting.store(0);
+            if (ring.empty() && !engine_alive()) return 0;
+        }
+    }
+
+    const char* name() const override { return "shm"; }
+
+private:
+    static constexpr long kPollMs = 100;
+
+    int unix_fd_;
+    shm::Channel* channel_;
+    int doorbell_;
+
+    ShmTransport(int unix_fd, shm::Channel* channel, int doorbell)
+        : unix_fd_(unix_fd), channel_(channel), doorbell_(doorbell) {}
+
+    void ring_doorbell() {
+        uint64_t one = 1;
+        ssize_t ignored = write(doorbell_, &one, sizeof(one));
+        (void)ignored;
+    }
+
+    // The engine never writes to the socket after the attach, so readable means closed
+    bool engine_alive() const {
+        pollfd p{unix_fd_, POLLIN, 0};
+        return poll(&p, 1, 0) == 0;
+    }
+};
+
+#endif // _WIN32
+
+// Sends one frame; false once the engine is gone
+inline bool send_frame(ClientTransport& transport, protocol::FrameWriter& frame) {
+    return transport.send(frame.data(), frame.size());
+}
+
+// Blocks until the next frame of `type` arrives, skipping any others; false on disconnect.
+// The frame stays valid until `reader` is popped or refilled.
+inline bool read_frame(ClientTransport& transport, protocol::FrameReader& reader, protocol::MessageType type,
+                       protocol::Frame& frame) {
+    while (true) {
+        protocol::FrameReader::Status status;
+        while ((status = reader.peek(frame)) == protocol::FrameReader::Ready) {
+            if (frame.type == type) return true;
+            reader.pop();
+        }
+        if (status == protocol::FrameReader::Invalid) return false;
+        uint8_t* dst = reader.write_ptr();
+        size_t n = transport.recv(dst, reader.write_space());
+        if (n == 0) return false;
+        reader.commit(n);
+    }
+}
+
+} // namespace othello::transport
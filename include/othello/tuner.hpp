@@ -0,0 +1,65 @@
+#pragma once
+
+#include "othello/agent_server.hpp"
+#include "othello/evaluator.hpp"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace othello {
+
+struct TuneConfig {
+    std::vector<int> threads;         // candidates; empty: 1, 2, 4, ... up to the hardware threads
+    std::vector<int> batch_sizes;     // candidates up to each thread count; empty: powers of two
+    int simulations = 800;            // per benchmark search, and the most the profile asks for
+    float c_puct = 1.5f;
+    int batch_wait_us = 500;
+    double latency_ms = 100.0;        // per-move target, met at the 99th percentile
+    double seconds_per_point = 2.0;
+    uint32_t seed = 1;                // benchmark positions
+};
+
+struct TunePoint {
+    int threads = 0;
+    int batch_size = 1;
+    uint64_t searches = 0;
+    double nodes_per_second = 0.0;    // simulations per second over all threads
+    double p99_move_ms = 0.0;         // time per search of `simulations`
+};
+
+struct TuneResult {
+    AgentServerConfig best;           // workers, simulations, c_puct and batching filled in
+    TunePoint best_point;
+    bool met_target = false;          // false: no point was fast enough; simulations were cut
+    std::vector<TunePoint> points;    // in the order they were run
+};
+
+// Benchmarks concurrent searches on this host over a grid of search thread counts and
+// inference batch sizes, the way AgentServer runs them: each thread searches positions from
+// a fixed set with its own tree, and with a batch size above 1 the threads' evaluations go
+// through one InferenceBroker over `batch_backend`.
+//
+// The chosen point has the best nodes/sec among those whose p99 move time meets the target.
+// If none does, the fastest one is kept and its simulation count scaled down to fit.
+class Tuner {
+public:
+    // Called once per search thread when not batching
+    using EvaluatorFactory = std::function<std::unique_ptr<Evaluator>()>;
+
+    // Without a batch backend only batch size 1 is tried
+    Tuner(EvaluatorFactory factory, BatchEvaluator* batch_backend, const TuneConfig& config = {});
+
+    TuneResult run();
+
+    // One grid point
+    TunePoint measure(int threads, int batch_size);
+
+private:
+    EvaluatorFactory factory_;
+    BatchEvaluator* batch_backend_;
+    TuneConfig config_;
+    std::vector<std::pair<OthelloBoard, Player>> positions_;
+};
+
+} // namespace othello
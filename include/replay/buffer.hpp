@@ -1,26 +1,91 @@
 #pragma once
-#include <vector>
-#include <deque>
+#include "othello/board.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <random>
+#include <vector>
 
 struct TrainSample {
     std::vector<float> state;    // 3x8x8 = 192
-    std::vector<float> policy;   // 64
+    std::vector<float> policy;   // 65 (64 squares + pass)
     float value;                 // scalar
+    Player to_move = Player::NONE;   // colour of the "own" plane, if known
 };
 
-class ReplayBuffer {
+// Destination for generated samples: the in-memory ring or the on-disk store
+class ReplaySink {
 public:
+    virtual ~ReplaySink() = default;
+    virtual void insert_batch(const std::vector<TrainSample>& batch) = 0;
+};
+
+// Fixed-capacity ring of training positions in structure-of-arrays form.
+//
+// A slot packs the position as two bitboards (side to move, opponent), the policy as 65
+// uint16 fixed-point probabilities and the value as a float into 19 words: 156 bytes with
+// its sequence number, all preallocated, so 10M samples take ~1.5 GB no matter how many are
+// inserted.
+//
+// Writers claim slots with an atomic cursor and never share a lock; each slot has a sequence
+// number (odd while being written), so readers detect and retry torn reads instead of
+// blocking writers. The payload words are relaxed atomics, which keeps a read that races a
+// write defined; the sequence check then discards it. The legal-move plane is recomputed from the bitboards when sampling.
+//
+// With augmentation on, every sampled position goes through a random board symmetry (see
+// othello/symmetry.hpp) before it is expanded to planes, which gives 8x the distinct training
+// positions without storing any of them.
+class ReplayBuffer : public ReplaySink {
+public:
+    static constexpr int kStateSize = 192;
+    static constexpr int kPolicySize = 65;
+
     explicit ReplayBuffer(size_t capacity);
 
-    void insert(const TrainSample& sample);
-    void insert_batch(const std::vector<TrainSample>& batch);
+    // Thread-safe; overwrites the oldest slot once full. Returns the sample's id: its global
+    // insertion number, which lives in slot id % capacity() until overwritten.
+    uint64_t insert(uint64_t own, uint64_t opp, const float* policy, float value);
+    uint64_t insert(const TrainSample& sample);     // planes 0 and 1 of state are the bitboards
+    void insert_batch(const std::vector<TrainSample>& batch) override;
+
+    // Gathers batch_size uniformly chosen samples straight into caller tensors:
+    // states [batch][192], policies [batch][65], values [batch]. Thread-safe.
+    // Applies a random symmetry to each sample when augmentation is on.
+    void sample_into(size_t batch_size, float* states, float* policies, float* values, std::mt19937& rng) const;
 
+    // Convenience copy for small batches (uses an internal RNG; not for concurrent callers)
     std::vector<TrainSample> sample(size_t batch_size) const;
+
+    // Reads one slot; returns false if it has never been written
+    bool read(size_t slot, uint64_t& own, uint64_t& opp, float* policy, float& value) const;
+
+    // Same, decoded into a 192-float state, 65-float policy and value, under the given symmetry
+    bool read_into(size_t slot, float* state, float* policy, float* value, int symmetry = 0) const;
+
+    // Same for the sample with the given id; returns false once it has been overwritten
+    bool read_id_into(uint64_t id, float* state, float* policy, float* value, int symmetry = 0) const;
+
+    // Random D4 augmentation in sample_into/sample; off by default. Set before sampling starts.
+    void set_augment(bool augment) { augment_ = augment; }
+    bool augment() const { return augment_; }
+
     size_t size() const;
+    size_t capacity() const { return capacity_; }
+    uint64_t total_inserted() const { return cursor_.load(std::memory_order_relaxed); }
+    size_t memory_bytes() const;
 
 private:
-    std::deque<TrainSample> buffer_;
+    // own, opp, 65 uint16 policy entries in words 2-18, value bits in the top of word 18
+    static constexpr int kSlotWords = 19;
+
+    // expect != 0 fails the read unless the slot's sequence number equals it
+    bool read_slot(size_t slot, uint32_t expect, uint64_t& own, uint64_t& opp, float* policy, float& value) const;
+    bool decode_into(size_t slot, uint32_t expect, float* state, float* policy, float* value, int symmetry) const;
+
     size_t capacity_;
+    std::unique_ptr<std::atomic<uint64_t>[]> words_;   // [capacity][kSlotWords]
+    std::unique_ptr<std::atomic<uint32_t>[]> seq_;   // 0: empty, odd: being written
+    std::atomic<uint64_t> cursor_{0};
+    bool augment_ = false;
     mutable std::mt19937 rng_;
 };
@@ -0,0 +1,80 @@
+#pragma once
+#include "replay/buffer.hpp"
+
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <vector>
+
+namespace replay {
+
+// Binary sum tree over a fixed number of leaves: O(log N) update and prefix-sum search.
+// Internal node i holds the sum of its children 2i and 2i+1; leaves start at index `leaves`.
+class SumTree {
+public:
+    explicit SumTree(size_t size);
+
+    void set(size_t i, double priority);
+    double get(size_t i) const { return nodes_[leaves_ + i]; }
+    double total() const { return nodes_[1]; }
+
+    // Leaf whose cumulative range contains `prefix` (0 <= prefix < total())
+    size_t find(double prefix) const;
+
+    size_t size() const { return size_; }
+
+private:
+    size_t size_;
+    size_t leaves_;                // size rounded up to a power of two
+    std::vector<double> nodes_;
+};
+
+struct PriorityConfig {
+    double alpha = 0.6;      // priority = (|error| + epsilon)^alpha; 0 is uniform
+    double beta = 0.4;       // importance-sampling exponent; 1 fully corrects the bias
+    double epsilon = 1e-3;   // keeps every sample reachable
+};
+
+// Prioritized experience replay over a ReplayBuffer.
+//
+// Each ring slot has a leaf in the sum tree. New samples enter at the highest priority seen so
+// far, so they are replayed at least once soon after insertion; update_priorities() then sets
+// priorities from training errors. Samples are identified by ReplayBuffer ids, so an update for
+// a sample that has since been evicted by the ring is ignored instead of landing on its
+// replacement.
+class PrioritizedReplay : public ReplaySink {
+public:
+    explicit PrioritizedReplay(size_t capacity, const PriorityConfig& config = {});
+
+    uint64_t insert(const TrainSample& sample);
+    uint64_t insert(uint64_t own, uint64_t opp, const float* policy, float value);
+    void insert_batch(const std::vector<TrainSample>& batch) override;
+
+    // Proportional, stratified sampling of batch_size samples into caller tensors:
+    // states [batch][192], policies [batch][65], values [batch], weights [batch] (importance
+    // sampling, normalized so the largest in the batch is 1) and ids [batch] for updates.
+    void sample_into(size_t batch_size, float* states, float* policies, float* values, float* weights,
+                     uint64_t* ids, std::mt19937& rng) const;
+
+    // Batched update after a training step; errors are e.g. |value target - prediction|
+    void update_priorities(const uint64_t* ids, const float* errors, size_t n);
+
+    // Random D4 augmentation of sampled positions (see ReplayBuffer::set_augment)
+    void set_augment(bool augment) { buffer_.set_augment(augment); }
+
+    size_t size() const { return buffer_.size(); }
+    const ReplayBuffer& buffer() const { return buffer_; }
+    double total_priority() const;
+
+private:
+    PriorityConfig config_;
+    ReplayBuffer buffer_;
+    mutable std::mutex mutex_;
+    SumTree tree_;
+    std::vector<uint64_t> slot_id_;   // id currently stored in each slot
+    double max_priority_ = 1.0;
+
+    uint64_t track(uint64_t id);   // gives a freshly inserted sample its leaf
+};
+
+} // namespace replay
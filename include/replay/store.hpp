@@ -0,0 +1,189 @@
+#pragma once
+#include "replay/buffer.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// On-disk replay store.
+//
+// A record is 18 + n bytes, where n is the number of legal moves of the side to move:
+//
+//   uint64 black, uint64 white        bitboards
+//   uint8  side                        0 black, 1 white
+//   int8   value                       round(value * 127)
+//   uint8  policy[n]                   round(p * 255) for each legal move, ascending square;
+//                                      a position without legal moves is a PASS (policy 1)
+//
+// Typical positions take ~30 bytes against ~1 KB for a float TrainSample.
+//
+// Records are appended to segment files. A segment is written as "<name>.tmp" and renamed to
+// "<name>.rps" once sealed, with a footer holding the record offsets, so readers only ever map
+// immutable, complete files:
+//
+//   SegmentHeader | records... | uint32 offsets[count] | SegmentFooter
+namespace replay {
+
+constexpr uint32_t kSegmentMagic = 0x5250534f;   // "OSPR"
+constexpr uint32_t kSegmentVersion = 1;
+constexpr size_t kRecordHeaderBytes = 18;
+
+struct SegmentHeader {
+    uint32_t magic;
+    uint32_t version;
+};
+
+struct SegmentFooter {
+    uint64_t count;
+    uint32_t magic;
+    uint32_t version;
+};
+
+// Encodes one position into `out` (at most kRecordHeaderBytes + 64 bytes); returns the size
+size_t encode_record(uint64_t black, uint64_t white, Player to_move, const float* policy, float value, uint8_t* out);
+
+// Decodes a record into a 192-float state (side to move first), 65-float policy and value,
+// mapped through board symmetry `symmetry` (othello/symmetry.hpp)
+void decode_record(const uint8_t* record, float* state, float* policy, float* value, int symmetry = 0);
+
+// Appends records to segment files in `directory`. Thread-safe.
+class ReplayStoreWriter {
+public:
+    explicit ReplayStoreWriter(std::string directory, size_t records_per_segment = 1 << 20);
+    ~ReplayStoreWriter();   // seals the open segment
+
+    ReplayStoreWriter(const ReplayStoreWriter&) = delete;
+    ReplayStoreWriter& operator=(const ReplayStoreWriter&) = delete;
+
+    void append(uint64_t black, uint64_t white, Player to_move, const float* policy, float value);
+    void append(const TrainSample& sample);   // needs sample.to_move
+
+    // Appends `count` records made by encode_record, stored back to back in `records` with
+    // their sizes in `sizes`, under one lock
+    void append_encoded(const uint8_t* records, const uint8_t* sizes, size_t count);
+
+    // Seals the open segment now so readers can see it
+    void seal();
+
+    uint64_t records_written() const { return written_; }
+    uint64_t segments_sealed() const { return sealed_.load(std::memory_order_acquire); }
+
+private:
+    std::string directory_;
+    size_t records_per_segment_;
+    std::mutex mutex_;
+    std::FILE* file_ = nullptr;
+    std::string tmp_path_;
+    std::vector<uint32_t> offsets_;
+    uint32_t offset_ = 0;
+    uint64_t segments_ = 0;
+    uint64_t written_ = 0;
+    std::atomic<uint64_t> sealed_{0};
+
+    void open_segment();
+    void seal_locked();
+};
+
+// Read-only view of every sealed segment in a directory, memory-mapped
+class ReplayStore {
+public:
+    explicit ReplayStore(std::string directory);
+
+    // Maps segments sealed since the last call; returns the number of new records
+    size_t refresh();
+
+    size_t size() const;
+
+    // Decodes record i (0 <= i < size()) into tensors as in decode_record
+    void read(size_t i, float* state, float* policy, float* value) const;
+
+    // Gathers batch_size uniformly chosen records into [batch][192], [batch][65], [batch],
+    // each under a random symmetry when augmentation is on
+    void sample_into(size_t batch_size, float* states, float* policies, float* values, std::mt19937& rng) const;
+
+    // Random D4 augmentation in sample_into (and so in ReplayLoader); off by default
+    void set_augment(bool augment) { augment_ = augment; }
+
+private:
+    struct Segment;
+    struct Index {
+        std::vector<std::shared_ptr<const Segment>> segments;
+        std::vector<uint64_t> starts;   // first global record index of each segment
+        uint64_t total = 0;
+    };
+
+    std::string directory_;
+    std::mutex refresh_mutex_;
+    std::shared_ptr<const Index> index_;   // swapped atomically by refresh()
+    bool augment_ = false;
+
+    std::shared_ptr<const Index> index() const { return std::atomic_load(&index_); }
+    static void read(const Index& index, uint64_t i, float* state, float* policy, float* value, int symmetry);
+};
+
+struct ReplayBatch {
+    std::vector<float> states;     // [size][192]
+    std::vector<float> policies;   // [size][65]
+    std::vector<float> values;     // [size]
+    size_t size = 0;
+};
+
+// Background minibatch decoding: worker threads sample and decode into a bounded queue of
+// ready batches, so the trainer never waits on decoding
+class ReplayLoader {
+public:
+    ReplayLoader(const ReplayStore& store, size_t batch_size, int threads = 2, size_t prefetch = 4,
+                 uint32_t seed = 1);
+    ~ReplayLoader();
+
+    // Blocks until a batch is ready; `batch` is swapped with a decoded one. Rethrows the first
+    // exception a worker hit, after which every call throws.
+    void next(ReplayBatch& batch);
+
+private:
+    const ReplayStore& store_;
+    size_t batch_size_;
+    size_t prefetch_;
+    std::mutex mutex_;
+    std::condition_variable ready_cv_;
+    std::condition_variable space_cv_;
+    std::deque<ReplayBatch> ready_;
+    bool stopping_ = false;
+    std::exception_ptr error_;
+    std::vector<std::thread> workers_;
+
+    void work(uint32_t seed);
+};
+
+// ReplaySink/ReplayBuffer-style adapter over the store: inserts are appended to disk and
+// sampling reads the sealed segments, so memory use does not grow with the data
+class ReplayStoreBuffer : public ReplaySink {
+public:
+    explicit ReplayStoreBuffer(const std::string& directory, size_t records_per_segment = 1 << 16);
+
+    void insert(const TrainSample& sample) { writer_.append(sample); }
+    void insert_batch(const std::vector<TrainSample>& batch) override;
+
+    // Samples from sealed segments (call flush() to include everything inserted so far)
+    void sample_into(size_t batch_size, float* states, float* policies, float* values, std::mt19937& rng);
+    void flush();
+    size_t size() const { return store_.size(); }
+
+    ReplayStore& store() { return store_; }
+
+private:
+    ReplayStoreWriter writer_;
+    ReplayStore store_;
+    uint64_t seen_segments_ = 0;
+};
+
+} // namespace replay
@@ -0,0 +1,110 @@
+#pragma once
+#include "othello/board.hpp"
+#include "replay/buffer.hpp"
+#include "replay/store.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// WTHOR game databases (.wtb), the French Othello Federation's archive format.
+//
+// A file is a 16-byte header followed by fixed 68-byte game records:
+//
+//   header:  uint8 century, year, month, day     creation date
+//            uint32 games                        little endian, like every field
+//            uint16 records                      0 in game files
+//            uint16 year                         of the games
+//            uint8  board_size                   0 or 8 (10 is the rare 10x10 variant, rejected)
+//            uint8  game_type, depth, reserved
+//   game:    uint16 tournament, black, white     indices into the .JOU/.TRN name files
+//            uint8  black_discs                  final score, empty squares to the winner
+//            uint8  theoretical_black_discs      perfect-play score at the header's depth
+//            uint8  moves[60]                    10 * row + column, both 1-8 (11 = a1, 88 = h8);
+//                                                0 after the last move
+//
+// Passes are not recorded: a side without a legal move simply does not appear.
+namespace replay {
+
+constexpr size_t kWthorHeaderBytes = 16;
+constexpr size_t kWthorGameBytes = 68;
+constexpr int kWthorMoves = 60;
+
+// Read-only mapping of one .wtb file; throws std::runtime_error if it is missing, not an 8x8
+// game file, or shorter than its header claims
+class WthorFile {
+public:
+    explicit WthorFile(const std::string& path);
+    ~WthorFile();
+
+    WthorFile(const WthorFile&) = delete;
+    WthorFile& operator=(const WthorFile&) = delete;
+
+    const std::string& path() const { return path_; }
+    size_t games() const { return games_; }
+    int year() const { return year_; }
+
+    // The 68-byte record of game i < games()
+    const uint8_t* game(size_t i) const { return data_ + kWthorHeaderBytes + i * kWthorGameBytes; }
+
+private:
+    std::string path_;
+    const uint8_t* data_ = nullptr;
+    size_t bytes_ = 0;
+    size_t games_ = 0;
+    int year_ = 0;
+};
+
+// A position from an imported game: the board before `move`, which the side to move played
+struct WthorPosition {
+    uint64_t black;
+    uint64_t white;
+    Player to_move;
+    uint8_t move;     // square index, y * 8 + x
+    float value;      // final disc differential / 64, from to_move's side
+};
+
+enum class WthorGameStatus {
+    Complete,    // played to the end; labelled from the final board
+    Truncated,   // stops early (resignation, time); labelled from the recorded score
+    Invalid      // an illegal or malformed move; nothing is appended
+};
+
+// Replays one game record with OthelloBoard, inserting the passes the format leaves out, and
+// appends one position per move played (forced passes are not positions)
+WthorGameStatus replay_wthor_game(const uint8_t* record, std::vector<WthorPosition>& out);
+
+struct WthorImportConfig {
+    int threads = 0;                  // 0: one per hardware thread
+    size_t games_per_chunk = 4096;    // unit of work handed to a thread
+};
+
+struct WthorImportStats {
+    uint64_t files = 0;
+    uint64_t games = 0;               // complete + truncated
+    uint64_t truncated_games = 0;
+    uint64_t invalid_games = 0;       // skipped
+    uint64_t positions = 0;
+    double seconds = 0.0;
+
+    double positions_per_second() const { return seconds > 0 ? positions / seconds : 0.0; }
+};
+
+// Imports .wtb files on a pool of threads, each replaying chunks of games straight from the
+// mappings. The policy target is the move played; the value target is the final disc
+// differential. Files are opened up front, so a bad path throws before anything is written.
+class WthorImporter {
+public:
+    explicit WthorImporter(const WthorImportConfig& config = {});
+
+    // Into the in-memory ring (lock-free inserts)
+    WthorImportStats import_into(const std::vector<std::string>& paths, ReplayBuffer& buffer);
+
+    // Into replay store segments, one locked append per chunk; the caller seals when done
+    WthorImportStats import_into(const std::vector<std::string>& paths, ReplayStoreWriter& writer);
+
+private:
+    WthorImportConfig config_;
+};
+
+} // namespace replay
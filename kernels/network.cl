@@ -0,0 +1,72 @@
+// Batched policy/value network kernels (see nn::Network for the layout).
+// Activations are NHWC: [batch][square][channel], one row per square or position.
+
+// 3x3 same-padded convolution + ReLU.
+// global: (batch * 64, cout); weights [cout][ky][kx][cin]
+__kernel void conv3x3_relu(__global const float* in,
+                           __global const float* w,
+                           __global const float* b,
+                           __global float* out,
+                           const int cin,
+                           const int cout) {
+    const int row = get_global_id(0);
+    const int o = get_global_id(1);
+    const int sq = row & 63;
+    const int base = row - sq;
+    const int x = sq & 7;
+    const int y = sq >> 3;
+
+    __global const float* wo = w + o * 9 * cin;
+    float acc = b[o];
+    for (int ky = 0; ky < 3; ++ky) {
+        const int ny = y + ky - 1;
+        if (ny < 0 || ny >= 8) continue;
+        for (int kx = 0; kx < 3; ++kx) {
+            const int nx = x + kx - 1;
+            if (nx < 0 || nx >= 8) continue;
+            __global const float* src = in + (base + ny * 8 + nx) * cin;
+            __global const float* wk = wo + (ky * 3 + kx) * cin;
+            for (int c = 0; c < cin; ++c)
+                acc = mad(src[c], wk[c], acc);
+        }
+    }
+    out[row * cout + o] = fmax(acc, 0.0f);
+}
+
+// Dense layer, also used for 1x1 convolutions (one row per square).
+// global: (rows, out_size); activation 0 = none, 1 = ReLU, 2 = tanh
+__kernel void dense(__global const float* in,
+                    __global const float* w,
+                    __global const float* b,
+                    __global float* out,
+                    const int in_size,
+                    const int out_size,
+                    const int activation) {
+    const int row = get_global_id(0);
+    const int o = get_global_id(1);
+
+    __global const float* x = in + row * in_size;
+    __global const float* wo = w + o * in_size;
+    float acc = b[o];
+    for (int i = 0; i < in_size; ++i)
+        acc = mad(x[i], wo[i], acc);
+
+    if (activation == 1) acc = fmax(acc, 0.0f);
+    else if (activation == 2) acc = tanh(acc);
+    out[row * out_size + o] = acc;
+}
+
+// In-place row softmax. global: (rows)
+__kernel void softmax(__global float* x, const int width) {
+    __global float* p = x + get_global_id(0) * width;
+
+    float max_logit = p[0];
+    for (int i = 1; i < width; ++i) max_logit = fmax(max_logit, p[i]);
+
+    float sum = 0.0f;
+    for (int i = 0; i < width; ++i) {
+        p[i] = exp(p[i] - max_logit);
+        sum += p[i];
+    }
+    for (int i = 0; i < width; ++i) p[i] /= sum;
+}
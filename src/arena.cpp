@@ -0,0 +1,106 @@
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "nn/model_file.hpp"
+#include "othello/arena.hpp"
+#include "othello/greedy_evaluator.hpp"
+#include "othello/network_evaluator.hpp"
+#include "othello/pattern_evaluator.hpp"
+
+namespace {
+    // "sims=400,time=0.05,cpuct=1.5,eval=model:weights/weights.bin,name=new"
+    othello::EngineSpec parse_engine(const std::string& text, const std::string& default_name) {
+        othello::EngineSpec spec;
+        spec.name = default_name;
+        std::string eval = "greedy";
+
+        std::istringstream fields(text);
+        std::string field;
+        while (std::getline(fields, field, ',')) {
+            if (field.empty()) continue;
+            size_t eq = field.find('=');
+            if (eq == std::string::npos) throw std::invalid_argument("Engine option without a value: " + field);
+            std::string key = field.substr(0, eq), value = field.substr(eq + 1);
+            if (key == "sims") spec.simulations = std::stoi(value);
+            else if (key == "time") spec.move_time = std::stod(value);
+            else if (key == "cpuct") spec.c_puct = std::stof(value);
+            else if (key == "eval") eval = value;
+            else if (key == "name") spec.name = value;
+            else throw std::invalid_argument("Unknown engine option: " + key);
+        }
+
+        // Loaded once and shared read-only; each worker gets its own evaluator object
+        if (eval == "greedy") {
+            spec.factory = [] { return std::make_unique<othello::GreedyEvaluator>(); };
+        } else if (eval.rfind("model:", 0) == 0) {
+            auto network = std::make_shared<const nn::Network>(nn::load_model(eval.substr(6)));
+            spec.factory = [network] { return std::make_unique<othello::NetworkEvaluator>(*network); };
+        } else if (eval.rfind("pattern:", 0) == 0) {
+            auto pattern = std::make_shared<othello::PatternEvaluator>();
+            pattern->load(eval.substr(8));
+            spec.factory = [pattern] { return std::make_unique<othello::PatternEvaluator>(*pattern); };
+        } else {
+            throw std::invalid_argument("Unknown evaluator " + eval + " (greedy, model:<path>, pattern:<path>)");
+        }
+        if (spec.simulations <= 0) throw std::invalid_argument("Engine " + spec.name + " needs sims > 0");
+        return spec;
+    }
+}
+
+int main(int argc, char** argv) {
+    spdlog::set_level(spdlog::level::info);
+    spdlog::set_pattern("[arena] [%^%l%$] %v");
+
+    othello::ArenaConfig config;
+    config.report_every = 100;
+    std::string spec_a, spec_b, openings_path;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--a" && has_value) spec_a = argv[++i];
+        else if (arg == "--b" && has_value) spec_b = argv[++i];
+        else if (arg == "--games" && has_value) config.max_games = std::stoi(argv[++i]);
+        else if (arg == "--threads" && has_value) config.threads = std::stoi(argv[++i]);
+        else if (arg == "--plies" && has_value) config.opening_plies = std::stoi(argv[++i]);
+        else if (arg == "--openings" && has_value) openings_path = argv[++i];
+        else if (arg == "--seed" && has_value) config.seed = std::stoul(argv[++i]);
+        else if (arg == "--elo0" && has_value) config.sprt.elo0 = std::stod(argv[++i]);
+        else if (arg == "--elo1" && has_value) config.sprt.elo1 = std::stod(argv[++i]);
+        else if (arg == "--alpha" && has_value) config.sprt.alpha = std::stod(argv[++i]);
+        else if (arg == "--beta" && has_value) config.sprt.beta = std::stod(argv[++i]);
+        else if (arg == "--no-sprt") config.sprt.enabled = false;
+        else if (arg == "--report-every" && has_value) config.report_every = std::stoi(argv[++i]);
+        else {
+            spdlog::error("Usage: arena --a <engine> --b <engine> [--games N] [--threads N] [--plies N] "
+                          "[--openings <file>] [--seed N] [--elo0 X] [--elo1 X] [--alpha X] [--beta X] "
+                          "[--no-sprt] [--report-every N]");
+            spdlog::error("  <engine>: comma-separated sims=N, time=<seconds per move>, cpuct=X, name=S, "
+                          "eval=greedy|model:<path>|pattern:<path>");
+            return 1;
+        }
+    }
+
+    try {
+        othello::EngineSpec a = parse_engine(spec_a, "A");
+        othello::EngineSpec b = parse_engine(spec_b, "B");
+        std::vector<othello::Opening> openings;
+        if (!openings_path.empty()) openings = othello::load_openings(openings_path);
+
+        othello::Arena arena(a, b, config, std::move(openings));
+        spdlog::info("{} ({} sims{}) vs {} ({} sims{}), up to {} games", a.name, a.simulations,
+                     a.move_time > 0 ? fmt::format(", {:g}s/move", a.move_time) : "", b.name, b.simulations,
+                     b.move_time > 0 ? fmt::format(", {:g}s/move", b.move_time) : "", config.max_games);
+
+        othello::ArenaResult result = arena.run();
+        spdlog::info("{} vs {}: {}", a.name, b.name, result.summary(config.sprt));
+    } catch (const std::exception& e) {
+        spdlog::error("{}", e.what());
+        return 1;
+    }
+    return 0;
+}
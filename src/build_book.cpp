@@ -0,0 +1,76 @@
+#include <spdlog/spdlog.h>
+#include <memory>
+#include <string>
+
+#include "nn/model_file.hpp"
+#include "othello/arena.hpp"
+#include "othello/book.hpp"
+#include "othello/greedy_evaluator.hpp"
+#include "othello/network_evaluator.hpp"
+#include "othello/selfplay.hpp"
+
+namespace {
+    // Book building only needs the move lists, not the training samples
+    class NullSink : public ReplaySink {
+    public:
+        void insert_batch(const std::vector<TrainSample>&) override {}
+    };
+}
+
+int main(int argc, char** argv) {
+    spdlog::set_level(spdlog::level::info);
+    spdlog::set_pattern("[build_book] [%^%l%$] %v");
+
+    othello::SelfPlayConfig config;
+    config.report_every = 100;
+    int games = 1000;
+    int plies = 20;
+    uint32_t min_games = 2;
+    std::string model_path;
+    std::string out_path = "weights/book.bin";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--games" && has_value) games = std::stoi(argv[++i]);
+        else if (arg == "--threads" && has_value) config.threads = std::stoi(argv[++i]);
+        else if (arg == "--sims" && has_value) config.simulations = std::stoi(argv[++i]);
+        else if (arg == "--plies" && has_value) plies = std::stoi(argv[++i]);
+        else if (arg == "--min-games" && has_value) min_games = std::stoul(argv[++i]);
+        else if (arg == "--seed" && has_value) config.seed = std::stoul(argv[++i]);
+        else if (arg == "--model" && has_value) model_path = argv[++i];
+        else if (arg == "--out" && has_value) out_path = argv[++i];
+        else {
+            spdlog::error("Usage: build_book [--games N] [--threads N] [--sims N] [--plies N] [--min-games N] "
+                          "[--seed N] [--model <model.bin>] [--out <book.bin>]");
+            return 1;
+        }
+    }
+
+    try {
+        std::shared_ptr<const nn::Network> network;
+        if (!model_path.empty()) network = std::make_shared<const nn::Network>(nn::load_model(model_path));
+        othello::SelfPlay::EvaluatorFactory factory = [network]() -> std::unique_ptr<othello::Evaluator> {
+            if (network) return std::make_unique<othello::NetworkEvaluator>(*network);
+            return std::make_unique<othello::GreedyEvaluator>();
+        };
+
+        // Sampling every book ply keeps the games diverse enough to cover the tree
+        config.temperature_plies = plies;
+        othello::BookBuilder builder(plies);
+        NullSink sink;
+        othello::SelfPlay selfplay(factory, sink, config);
+        selfplay.set_game_observer([&builder](const othello::GameRecord& game) { builder.add_game(game); });
+        spdlog::info("Playing {} games with {} simulations per move ({}), recording {} plies", games,
+                     config.simulations, network ? model_path : "greedy evaluator", plies);
+
+        othello::SelfPlayStats stats = selfplay.run(games);
+        size_t written = builder.write(out_path, min_games);
+        spdlog::info("{} games in {:.2f}s: {} of {} moves played at least {} times written to {}", stats.games,
+                     stats.seconds, written, builder.positions(), min_games, out_path);
+    } catch (const std::exception& e) {
+        spdlog::error("{}", e.what());
+        return 1;
+    }
+    return 0;
+}
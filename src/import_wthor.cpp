@@ -0,0 +1,59 @@
+#include <spdlog/spdlog.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "replay/buffer.hpp"
+#include "replay/store.hpp"
+#include "replay/wthor.hpp"
+
+int main(int argc, char** argv) {
+    spdlog::set_level(spdlog::level::info);
+    spdlog::set_pattern("[import_wthor] [%^%l%$] %v");
+
+    replay::WthorImportConfig config;
+    size_t capacity = 1 << 20;
+    size_t segment_records = 1 << 20;
+    std::string out_dir;
+    std::vector<std::string> paths;
+    bool usage_error = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--threads" && has_value) config.threads = std::stoi(argv[++i]);
+        else if (arg == "--out" && has_value) out_dir = argv[++i];
+        else if (arg == "--capacity" && has_value) capacity = std::stoul(argv[++i]);
+        else if (arg == "--segment-records" && has_value) segment_records = std::stoul(argv[++i]);
+        else if (arg.rfind("--", 0) != 0) paths.push_back(arg);
+        else usage_error = true;
+    }
+    if (usage_error || paths.empty()) {
+        spdlog::error("Usage: import_wthor [--threads N] [--out <replay dir> [--segment-records N]] "
+                      "[--capacity N] <file.wtb>...");
+        return 1;
+    }
+
+    // Positions go to an on-disk replay store with --out (what train --data reads), otherwise
+    // to an in-memory ring, which only measures the import
+    try {
+        replay::WthorImporter importer(config);
+        replay::WthorImportStats stats;
+        if (!out_dir.empty()) {
+            replay::ReplayStoreWriter writer(out_dir, segment_records);
+            stats = importer.import_into(paths, writer);
+            writer.seal();
+        } else {
+            ReplayBuffer buffer(capacity);
+            stats = importer.import_into(paths, buffer);
+        }
+        spdlog::info("{} files, {} games ({} cut short, {} invalid and skipped): {} positions in {:.2f}s "
+                     "({:.2f}M positions/s){}",
+                     stats.files, stats.games, stats.truncated_games, stats.invalid_games, stats.positions,
+                     stats.seconds, stats.positions_per_second() / 1e6, out_dir.empty() ? "" : " into " + out_dir);
+    } catch (const std::exception& e) {
+        spdlog::error("{}", e.what());
+        return 1;
+    }
+    return 0;
+}
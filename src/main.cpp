@@ -1,115 +1,168 @@
-#include <sstream>
+#include <chrono>
+#include <csignal>
+#include <filesystem>
+#include <memory>
 #include <string>
-#include <cstring>
-#include <netinet/in.h>
-#include <unistd.h>
 
 #include <spdlog/spdlog.h>
 
-#include "othello/board.hpp"
-#include "othello/mcts.hpp"
+#include "othello/agent_server.hpp"
+#include "othello/book.hpp"
 #include "othello/greedy_evaluator.hpp"
+#include "othello/metrics.hpp"
+#include "othello/network_evaluator.hpp"
+#include "othello/runtime_config.hpp"
+#include "othello/tuner.hpp"
+#include "nn/model_file.hpp"
+#include "nn/model_registry.hpp"
 
-void run_agent_server(int port) {
-    int server_fd = socket(AF_INET, SOCK_STREAM, 0);
-    sockaddr_in address{};
-    // Set SO_REUSEADDR to reuse the port immediately after closing
-    int opt = 1;
-    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-    // Bind to the port
-    address.sin_family = AF_INET;
-    address.sin_addr.s_addr = INADDR_ANY;
-    address.sin_port = htons(port);
+#ifdef OTHELLO_EMBEDDED_MODEL
+#include "generated/weights.hpp"
+#endif
 
-    if (bind(server_fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
-        perror("bind failed");
-        return;
-    }
-    if (listen(server_fd, 1) < 0) {
-        perror("listen failed");
-        return;
-    }
-
-    spdlog::info("Agent server listening on port {}...", port);
+// Signal handlers reach the running server through this
+static othello::AgentServer* running_server = nullptr;
 
-    sockaddr_in client_addr{};
-    socklen_t client_len = sizeof(client_addr);
-    int client_fd = accept(server_fd, (struct sockaddr*)&client_addr, &client_len);
-    spdlog::info("Remote agent connected.");
-
-    // Read side from remote agent
-    char side_buf[16] = {};
-    int side_bytes = read(client_fd, side_buf, sizeof(side_buf) - 1);
-    std::string side_str(side_buf);
-    Player my_side = (side_str.find("White") != std::string::npos) ? Player::WHITE : Player::BLACK;
-    Player opp_side = othello::opponent(my_side);
-    spdlog::info("Assigned side: {}", (my_side == Player::BLACK ? "Black" : "White"));
-
-    // Init the board and MCTS evaluator
-    OthelloBoard board;
-    othello::GreedyEvaluator evaluator;
-    othello::MCTS mcts(evaluator);
+int main(int argc, char** argv) {
+    spdlog::set_level(spdlog::level::info);
+    spdlog::set_pattern("[agent_server] [%^%l%$] %v");
 
-    char buffer[128];
-    while (true) {
-        std::memset(buffer, 0, sizeof(buffer));
-        int bytes = read(client_fd, buffer, sizeof(buffer) - 1);
-        if (bytes == 0) {
-            spdlog::info("Client disconnected.");
-            break;
+    // The runtime profile (--config, else othello.yaml if present) comes first; flags override it.
+    // --tune writes that profile instead of reading it.
+    othello::AgentServerConfig config;
+    std::string config_path = othello::kDefaultRuntimeConfigPath;
+    bool explicit_config = false;
+    bool tune = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--tune") tune = true;
+        else if (arg == "--config" && i + 1 < argc) {
+            config_path = argv[++i];
+            explicit_config = true;
         }
-
-        int x, y, ms;
-        std::istringstream input(buffer);
-        if (!(input >> x >> y >> ms)) {
-            spdlog::error("Malformed input received: {}", buffer);
-            break;
+    }
+    if (!tune && (explicit_config || std::filesystem::exists(config_path))) {
+        try {
+            othello::load_runtime_config(config_path, config);
+            spdlog::info("Loaded runtime profile {}", config_path);
+        } catch (const std::exception& e) {
+            spdlog::error("{}", e.what());
+            return 1;
         }
-        spdlog::info("Received opponent move: {} {} ({} ms left)", x, y, ms); // Server does validation
-
-        // Step 1: Apply opponent move
-        Move opp_move = (x >= 0 && y >= 0) ? Move{x, y} : othello::PASS;
-        board.apply_move(opp_side, opp_move);
-
-        // Step 2: Apply opponent move to MCTS (preserve search tree)
-        mcts.set_root(board, my_side);
-        mcts.apply_move_to_root(opp_move);
+    }
 
-        // Step 3: Check if we need to pass
-        if (!board.has_valid_move(my_side)) {
-            spdlog::info("No valid moves. Passing.");
-            Move pass = othello::PASS;
-            mcts.apply_move_to_root(pass);  // Let MCTS advance internally
-            std::string response = "-1 -1\n";
-            send(client_fd, response.c_str(), response.size(), 0);
-            continue;
+    std::string model_path;
+    std::string book_path;
+    othello::metrics::ExporterConfig metrics_config;
+    othello::TuneConfig tune_config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--config" && has_value) ++i;
+        else if (arg == "--tune") continue;
+        else if (arg == "--latency-ms" && has_value) tune_config.latency_ms = std::stod(argv[++i]);
+        else if (arg == "--model" && has_value) model_path = argv[++i];
+        else if (arg == "--book" && has_value) book_path = argv[++i];
+        else if (arg == "--patterns" && has_value) config.pattern_weights = argv[++i];
+        else if (arg == "--port" && has_value) config.port = std::stoi(argv[++i]);
+        else if (arg == "--unix" && has_value) config.unix_path = argv[++i];
+        else if (arg == "--workers" && has_value) config.workers = std::stoi(argv[++i]);
+        else if (arg == "--sims" && has_value) config.simulations = std::stoi(argv[++i]);
+        else if (arg == "--batch" && has_value) config.batch_size = std::stoi(argv[++i]);
+        else if (arg == "--opencl") config.opencl = true;
+        else if (arg == "--trace" && has_value) config.trace_path = argv[++i];
+        else if (arg == "--trace-move" && has_value) config.trace_move = std::stoi(argv[++i]);
+        else if (arg == "--metrics-port" && has_value) metrics_config.http_port = std::stoi(argv[++i]);
+        else if (arg == "--metrics-file" && has_value) metrics_config.file_path = argv[++i];
+        else if (arg == "--metrics-interval" && has_value)
+            metrics_config.interval = std::chrono::milliseconds(static_cast<long>(std::stod(argv[++i]) * 1000));
+        else {
+            spdlog::error("Usage: othelloplayer [--model <model.bin> | --patterns <patterns.bin>] "
+                          "[--book <book.bin>] [--port N] "
+                          "[--unix <path>] [--workers N] [--sims N] [--batch N [--opencl]] [--metrics-port N] "
+                          "[--metrics-file <path>] [--metrics-interval seconds] "
+                          "[--trace <trace.json> [--trace-move N]] [--config <othello.yaml>] "
+                          "[--tune [--latency-ms X]]");
+            return 1;
         }
+    }
 
-        // Step 4: Run MCTS to find best move
-        mcts.set_root(board, my_side);      // Set current board state
-        mcts.run();                         // Run simulations
-        Move bestMove = mcts.best_move();   // Get best move
-
-        // Step 5: Apply and send our move
-        board.apply_move(my_side, bestMove);
-        mcts.apply_move_to_root(bestMove);  // Advance MCTS tree
-
-        spdlog::info("Sending move: {} {}", bestMove.x, bestMove.y);
+    // The model file is reloaded when it changes on disk or on SIGHUP
+    std::unique_ptr<nn::ModelRegistry> registry;
+    if (!model_path.empty()) {
+        try {
+            registry = std::make_unique<nn::ModelRegistry>(model_path);
+        } catch (const std::exception& e) {
+            spdlog::error("{}", e.what());
+            return 1;
+        }
+    } else {
+#ifdef OTHELLO_EMBEDDED_MODEL
+        try {
+            registry = std::make_unique<nn::ModelRegistry>(nn::load_model(model_data, model_size));
+        } catch (const std::exception& e) {
+            spdlog::error("Embedded model: {}", e.what());
+            return 1;
+        }
+        spdlog::info("Using embedded model");
+#else
+        spdlog::info("No model given, using {}", config.pattern_weights.empty()
+                                                     ? "the greedy evaluator"
+                                                     : "pattern weights " + config.pattern_weights);
+#endif
+    }
 
-        std::ostringstream reply;
-        reply << bestMove.x << " " << bestMove.y << "\n";
-        std::string response = reply.str();
-        send(client_fd, response.c_str(), response.size(), 0);
+    // Benchmark this host and save the best profile for later runs
+    if (tune) {
+        tune_config.simulations = config.simulations;
+        tune_config.c_puct = config.c_puct;
+        tune_config.batch_wait_us = config.batch_wait_us;
+        std::unique_ptr<othello::RegistryEvaluator> backend;
+        othello::Tuner::EvaluatorFactory factory = [] { return std::make_unique<othello::GreedyEvaluator>(); };
+        if (registry) {
+            backend = std::make_unique<othello::RegistryEvaluator>(*registry);
+            factory = [&registry] { return std::make_unique<othello::RegistryEvaluator>(*registry); };
+        }
+        try {
+            othello::TuneResult result = othello::Tuner(factory, backend.get(), tune_config).run();
+            const std::string comment = fmt::format(
+                "Written by othelloplayer --tune: {:.0f} nodes/s at p99 {:.1f} ms per move (target {} ms{})",
+                result.best_point.nodes_per_second, result.best_point.p99_move_ms, tune_config.latency_ms,
+                result.met_target ? "" : ", missed; simulations scaled down");
+            othello::save_runtime_config(config_path, result.best, comment);
+            spdlog::info("Saved {} threads, batch {}, {} simulations to {}", result.best.workers,
+                         result.best.batch_size, result.best.simulations, config_path);
+        } catch (const std::exception& e) {
+            spdlog::error("Tuning failed: {}", e.what());
+            return 1;
+        }
+        return 0;
     }
 
-    close(client_fd);
-    close(server_fd);
-    spdlog::info("Connection closed. Exiting.");
-}
+    // The book stays mapped for the life of the process
+    std::unique_ptr<othello::OpeningBook> book;
+    othello::metrics::Registry metrics;
+    std::unique_ptr<othello::metrics::Exporter> exporter;
+    std::unique_ptr<othello::AgentServer> server;
+    try {
+        if (!book_path.empty()) book = std::make_unique<othello::OpeningBook>(book_path);
+
+        // Prometheus text on 127.0.0.1:<metrics-port>/metrics and/or in a file rewritten every interval
+        if (metrics_config.http_port >= 0 || !metrics_config.file_path.empty())
+            exporter = std::make_unique<othello::metrics::Exporter>(metrics, metrics_config);
+
+        server = std::make_unique<othello::AgentServer>(config, registry.get(), book.get(), &metrics);
+    } catch (const std::exception& e) {
+        spdlog::error("{}", e.what());
+        return 1;
+    }
 
-int main() {
-    spdlog::set_level(spdlog::level::info);
-    spdlog::set_pattern("[agent_server] [%^%l%$] %v");
-    while (1) { run_agent_server(4000); }
+    // One process serves every game; SIGHUP forces a model reload, SIGINT/SIGTERM shut down
+    running_server = server.get();
+    std::signal(SIGHUP, [](int) { running_server->request_reload(); });
+    std::signal(SIGINT, [](int) { running_server->stop(); });
+    std::signal(SIGTERM, [](int) { running_server->stop(); });
+    server->run();
+    running_server = nullptr;
     return 0;
 }
@@ -0,0 +1,174 @@
+#include "nn/model_file.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+namespace nn {
+
+namespace {
+    constexpr char kMagic[8] = {'O', 'T', 'H', 'M', 'O', 'D', 'E', 'L'};
+
+    // Far beyond any network trained here; a header past these is corrupt, and trusting it
+    // would size allocations and loops before the file's length could reject it
+    constexpr uint32_t kMaxChannels = 1024;
+    constexpr uint32_t kMaxTrunkLayers = 256;
+    constexpr uint32_t kMaxValueHidden = 4096;
+
+    // Read-only mapping of a whole file, released when the last network using it goes away
+    struct Mapping {
+        void* data = MAP_FAILED;
+        size_t bytes = 0;
+        ~Mapping() {
+            if (data != MAP_FAILED) munmap(data, bytes);
+        }
+    };
+
+    size_t table_end(uint32_t num_tensors) {
+        return sizeof(ModelHeader) + size_t(num_tensors) * sizeof(TensorEntry);
+    }
+
+    // Validates the image and returns a view of its parameters
+    Network parse(const unsigned char* image, size_t bytes, std::shared_ptr<const void> owner, const std::string& what) {
+        auto fail = [&](const std::string& reason) {
+            return std::runtime_error("Invalid model " + what + ": " + reason);
+        };
+
+        // Step 1: header
+        if (bytes < sizeof(ModelHeader)) throw fail("truncated header");
+        ModelHeader h;
+        std::memcpy(&h, image, sizeof(h));
+        if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0) throw fail("bad magic");
+        if (h.version != kModelVersion)
+            throw fail("unsupported version " + std::to_string(h.version));
+        if (h.header_bytes != sizeof(ModelHeader)) throw fail("unexpected header size");
+        if (h.alignment == 0 || h.data_offset % h.alignment != 0 ||
+            reinterpret_cast<uintptr_t>(image + h.data_offset) % alignof(float) != 0)
+            throw fail("misaligned parameter block");
+        if (h.data_offset < table_end(h.num_tensors) || h.data_offset > bytes || h.data_bytes > bytes - h.data_offset)
+            throw fail("truncated file");
+
+        // Step 2: the tensor table must describe exactly the layout of the header's architecture,
+        // whose parameters must fill the rest of the file
+        if (h.channels == 0 || h.channels > kMaxChannels || h.trunk_layers == 0 || h.trunk_layers > kMaxTrunkLayers ||
+            h.value_hidden == 0 || h.value_hidden > kMaxValueHidden)
+            throw fail("implausible architecture");
+        NetworkConfig config{int(h.channels), int(h.trunk_layers), int(h.value_hidden)};
+        size_t num_params = 0;
+        const std::vector<LinearSpec> linears = Network::layout(config, &num_params);
+        if (num_params > (bytes - h.data_offset) / sizeof(float)) throw fail("truncated parameter block");
+        if (h.num_tensors != linears.size())
+            throw fail("expected " + std::to_string(linears.size()) + " tensors, found " + std::to_string(h.num_tensors));
+        for (size_t i = 0; i < linears.size(); ++i) {
+            TensorEntry t;
+            std::memcpy(&t, image + sizeof(ModelHeader) + i * sizeof(TensorEntry), sizeof(t));
+            const LinearSpec& s = linears[i];
+            if (strncmp(t.name, s.name.c_str(), sizeof(t.name)) != 0 || int(t.out) != s.out || int(t.in) != s.in ||
+                t.weight_offset != s.weight_offset || t.bias_offset != s.bias_offset)
+                throw fail("tensor " + std::to_string(i) + " does not match layer " + s.name);
+        }
+        if (h.data_bytes != num_params * sizeof(float)) throw fail("parameter block size mismatch");
+
+        // Step 3: checksum
+        const unsigned char* data = image + h.data_offset;
+        if (model_checksum(data, h.data_bytes) != h.checksum) throw fail("checksum mismatch");
+
+        return Network::view(reinterpret_cast<const float*>(data), num_params, config, std::move(owner));
+    }
+} // Anonymous namespace
+
+uint64_t model_checksum(const void* data, size_t bytes) {
+    // FNV-1a over 64-bit words (then the tail bytes): fast enough to verify on every load
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t hash = 1469598103934665603ULL;
+    size_t i = 0;
+    for (; i + 8 <= bytes; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, p + i, 8);
+        hash = (hash ^ word) * 1099511628211ULL;
+    }
+    for (; i < bytes; ++i) hash = (hash ^ p[i]) * 1099511628211ULL;
+    return hash;
+}
+
+void save_model(const std::string& path, const Network& network) {
+    const NetworkConfig& config = network.config();
+    const auto& linears = network.linears();
+    const size_t data_bytes = network.num_params() * sizeof(float);
+
+    ModelHeader h{};
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = kModelVersion;
+    h.header_bytes = sizeof(ModelHeader);
+    h.channels = config.channels;
+    h.trunk_layers = config.trunk_layers;
+    h.value_hidden = config.value_hidden;
+    h.num_tensors = static_cast<uint32_t>(linears.size());
+    h.alignment = kModelAlignment;
+    h.data_offset = (table_end(h.num_tensors) + kModelAlignment - 1) / kModelAlignment * kModelAlignment;
+    h.data_bytes = data_bytes;
+    h.checksum = model_checksum(network.params(), data_bytes);
+
+    std::vector<char> image(h.data_offset, 0);
+    std::memcpy(image.data(), &h, sizeof(h));
+    for (size_t i = 0; i < linears.size(); ++i) {
+        const LinearSpec& s = linears[i];
+        TensorEntry t{};
+        if (s.name.size() >= sizeof(t.name)) throw std::invalid_argument("Layer name too long: " + s.name);
+        std::memcpy(t.name, s.name.data(), s.name.size());
+        t.out = s.out;
+        t.in = s.in;
+        t.weight_offset = s.weight_offset;
+        t.bias_offset = s.bias_offset;
+        std::memcpy(image.data() + sizeof(ModelHeader) + i * sizeof(TensorEntry), &t, sizeof(t));
+    }
+
+    // Write next to the destination, then rename over it atomically
+    std::string tmp = path + ".tmp." + std::to_string(getpid());
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) throw std::runtime_error("Failed to open " + tmp + " for writing");
+        out.write(image.data(), image.size());
+        out.write(reinterpret_cast<const char*>(network.params()), data_bytes);
+        if (!out) throw std::runtime_error("Failed to write " + tmp);
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("Failed to rename " + tmp + " to " + path);
+    }
+}
+
+Network load_model(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) throw std::runtime_error("Failed to open model " + path);
+
+    struct stat st{};
+    auto mapping = std::make_shared<Mapping>();
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        mapping->bytes = static_cast<size_t>(st.st_size);
+        mapping->data = mmap(nullptr, mapping->bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (mapping->data == MAP_FAILED) throw std::runtime_error("Failed to map model " + path);
+
+    const auto* image = static_cast<const unsigned char*>(mapping->data);
+    size_t bytes = mapping->bytes;
+    Network net = parse(image, bytes, mapping, path);
+    spdlog::info("[Model] Mapped {} ({} parameters, {}x{} trunk)", path, net.num_params(),
+                 net.config().trunk_layers, net.config().channels);
+    return net;
+}
+
+Network load_model(const void* data, size_t bytes) {
+    return parse(static_cast<const unsigned char*>(data), bytes, nullptr, "image");
+}
+
+} // namespace nn
@@ -0,0 +1,56 @@
+#include "nn/model_registry.hpp"
+#include "nn/model_file.hpp"
+
+#include <stdexcept>
+
+#include <sys/stat.h>
+
+#include <spdlog/spdlog.h>
+
+namespace nn {
+
+ModelRegistry::ModelRegistry(std::string path) : path_(std::move(path)) {
+    stat_file(path_, loaded_id_);
+    current_ = std::make_shared<const Network>(load_model(path_));
+}
+
+ModelRegistry::ModelRegistry(Network network) : current_(std::make_shared<const Network>(std::move(network))) {}
+
+bool ModelRegistry::stat_file(const std::string& path, FileId& id) {
+    struct stat st{};
+    if (::stat(path.c_str(), &st) != 0) return false;
+    id.device = st.st_dev;
+    id.inode = st.st_ino;
+    id.size = st.st_size;
+    id.mtime_ns = int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    return true;
+}
+
+bool ModelRegistry::poll(bool force) {
+    if (path_.empty()) return false;
+    std::lock_guard<std::mutex> lock(reload_mutex_);
+
+    // Step 1: cheap change detection; a rename() shows up as a new inode
+    FileId id;
+    if (!stat_file(path_, id)) return false;
+    if (!force && id == loaded_id_) return false;
+
+    // Step 2: map and validate before publishing
+    std::shared_ptr<const Network> next;
+    try {
+        next = std::make_shared<const Network>(load_model(path_));
+    } catch (const std::exception& e) {
+        spdlog::warn("[Model] Keeping current model, reload of {} failed: {}", path_, e.what());
+        loaded_id_ = id;   // don't retry the same broken file on every poll
+        return false;
+    }
+
+    // Step 3: publish
+    std::atomic_store(&current_, std::move(next));
+    loaded_id_ = id;
+    uint64_t gen = generation_.fetch_add(1, std::memory_order_acq_rel) + 1;
+    spdlog::info("[Model] Reloaded {} (generation {})", path_, gen);
+    return true;
+}
+
+} // namespace nn
@@ -0,0 +1,166 @@
+#include "nn/network.hpp"
+#include "nn/simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+
+namespace nn {
+
+namespace {
+    inline void observe(std::vector<float>* input_max, int layer, const float* x, int n) {
+        if (!input_max) return;
+        float& m = (*input_max)[layer];
+        for (int i = 0; i < n; ++i) m = std::max(m, x[i]);
+    }
+} // Anonymous namespace
+
+void softmax(float* x, int n) {
+    float max_logit = *std::max_element(x, x + n);
+    float sum = 0.0f;
+    for (int i = 0; i < n; ++i) {
+        x[i] = std::exp(x[i] - max_logit);
+        sum += x[i];
+    }
+    for (int i = 0; i < n; ++i) x[i] /= sum;
+}
+
+std::vector<LinearSpec> Network::layout(const NetworkConfig& config, size_t* num_params) {
+    if (config.channels <= 0 || config.trunk_layers <= 0 || config.value_hidden <= 0)
+        throw std::invalid_argument("Network dimensions must be positive");
+
+    std::vector<LinearSpec> linears;
+    size_t offset = 0;
+    auto add = [&](std::string name, int out, int in) {
+        linears.push_back({std::move(name), out, in, offset, offset + size_t(out) * in});
+        offset += size_t(out) * in + out;
+    };
+
+    const int c = config.channels;
+    for (int l = 0; l < config.trunk_layers; ++l)
+        add("trunk." + std::to_string(l), c, 9 * (l == 0 ? kInputPlanes : c));
+    add("policy.conv", 2, c);
+    add("policy.fc", kPolicySize, 2 * kBoardSquares);
+    add("value.conv", 1, c);
+    add("value.fc1", config.value_hidden, kBoardSquares);
+    add("value.fc2", 1, config.value_hidden);
+
+    if (num_params) *num_params = offset;
+    return linears;
+}
+
+Network::Network(const NetworkConfig& config) : Network(config, LayoutOnly{}) {
+    params_.assign(num_params_, 0.0f);
+}
+
+Network::Network(const NetworkConfig& config, LayoutOnly) : config_(config) {
+    linears_ = layout(config, &num_params_);
+}
+
+Network Network::from_buffer(const void* data, size_t bytes, const NetworkConfig& config) {
+    Network net(config);
+    if (bytes != net.params_.size() * sizeof(float))
+        throw std::runtime_error("Model size " + std::to_string(bytes) + " does not match network layout (" +
+                                 std::to_string(net.params_.size() * sizeof(float)) + " bytes)");
+    std::memcpy(net.params_.data(), data, bytes);
+    return net;
+}
+
+Network Network::view(const float* data, size_t count, const NetworkConfig& config,
+                      std::shared_ptr<const void> owner) {
+    Network net(config, LayoutOnly{});
+    if (count != net.num_params_)
+        throw std::runtime_error("Model has " + std::to_string(count) + " parameters, network layout needs " +
+                                 std::to_string(net.num_params_));
+    net.view_ = data;
+    net.owner_ = std::move(owner);
+    return net;
+}
+
+float* Network::mutable_params() {
+    if (view_) throw std::logic_error("Network parameters are a read-only view");
+    return params_.data();
+}
+
+void Network::init_random(uint32_t seed) {
+    std::mt19937 rng(seed);
+    float* params = mutable_params();
+    std::fill(params, params + num_params_, 0.0f);
+    for (const auto& l : linears_) {
+        std::normal_distribution<float> dist(0.0f, std::sqrt(2.0f / l.in));
+        float* w = params + l.weight_offset;
+        for (size_t i = 0; i < size_t(l.out) * l.in; ++i) w[i] = dist(rng);
+    }
+}
+
+float Network::forward(const float* input, float* policy, std::vector<float>* input_max) const {
+    const int c = config_.channels;
+    const int hidden = config_.value_hidden;
+    const float* p = params();
+
+    // Scratch is reused across calls, so steady-state inference does not allocate
+    thread_local std::vector<float> act, next, patch, head;
+    act.resize(kBoardSquares * std::max(c, kInputPlanes));
+    next.resize(kBoardSquares * c);
+    patch.resize(9 * std::max(c, kInputPlanes));
+    head.resize(2 * kBoardSquares + kPolicySize + hidden);
+
+    if (input_max) input_max->resize(linears_.size(), 0.0f);
+
+    // CHW -> HWC
+    for (int sq = 0; sq < kBoardSquares; ++sq)
+        for (int ch = 0; ch < kInputPlanes; ++ch)
+            act[sq * kInputPlanes + ch] = input[ch * kBoardSquares + sq];
+
+    // Step 1: convolutional trunk
+    int cin = kInputPlanes;
+    for (int l = 0; l < config_.trunk_layers; ++l) {
+        const LinearSpec& s = linears_[l];
+        observe(input_max, l, act.data(), kBoardSquares * cin);
+        for (int sq = 0; sq < kBoardSquares; ++sq) {
+            gather_patch(act.data(), cin, cin, sq % 8, sq / 8, patch.data());
+            for (int o = 0; o < c; ++o) {
+                float v = simd::dot(p + s.weight_offset + size_t(o) * s.in, patch.data(), s.in) + p[s.bias_offset + o];
+                next[sq * c + o] = std::max(0.0f, v);
+            }
+        }
+        std::swap(act, next);
+        cin = c;
+    }
+
+    // Step 2: policy head
+    float* pflat = head.data();
+    float* logits = pflat + 2 * kBoardSquares;
+    const LinearSpec& pconv = linears_[head_index(POLICY_CONV)];
+    const LinearSpec& pfc = linears_[head_index(POLICY_FC)];
+    observe(input_max, head_index(POLICY_CONV), act.data(), kBoardSquares * c);
+    for (int sq = 0; sq < kBoardSquares; ++sq)
+        for (int o = 0; o < 2; ++o) {
+            float v = simd::dot(p + pconv.weight_offset + o * c, act.data() + sq * c, c) + p[pconv.bias_offset + o];
+            pflat[sq * 2 + o] = std::max(0.0f, v);
+        }
+    observe(input_max, head_index(POLICY_FC), pflat, 2 * kBoardSquares);
+    for (int o = 0; o < kPolicySize; ++o)
+        logits[o] = simd::dot(p + pfc.weight_offset + size_t(o) * pfc.in, pflat, pfc.in) + p[pfc.bias_offset + o];
+    std::copy(logits, logits + kPolicySize, policy);
+    softmax(policy, kPolicySize);
+
+    // Step 3: value head (reuses the policy flatten buffer)
+    float* vflat = head.data();
+    float* h = logits + kPolicySize;
+    const LinearSpec& vconv = linears_[head_index(VALUE_CONV)];
+    const LinearSpec& fc1 = linears_[head_index(VALUE_FC1)];
+    const LinearSpec& fc2 = linears_[head_index(VALUE_FC2)];
+    observe(input_max, head_index(VALUE_CONV), act.data(), kBoardSquares * c);
+    for (int sq = 0; sq < kBoardSquares; ++sq)
+        vflat[sq] = std::max(0.0f, simd::dot(p + vconv.weight_offset, act.data() + sq * c, c) + p[vconv.bias_offset]);
+    observe(input_max, head_index(VALUE_FC1), vflat, kBoardSquares);
+    for (int o = 0; o < hidden; ++o)
+        h[o] = std::max(0.0f, simd::dot(p + fc1.weight_offset + size_t(o) * fc1.in, vflat, fc1.in) + p[fc1.bias_offset + o]);
+    observe(input_max, head_index(VALUE_FC2), h, hidden);
+    return std::tanh(simd::dot(p + fc2.weight_offset, h, hidden) + p[fc2.bias_offset]);
+}
+
+} // namespace nn
@@ -0,0 +1,168 @@
+#include "nn/quantized.hpp"
+#include "nn/simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace nn {
+
+namespace {
+    constexpr int kActMax = 127;    // 7-bit activations keep AVX2 maddubs from saturating
+
+    inline int pad32(int n) { return (n + 31) & ~31; }
+
+    inline uint8_t quantize(float x, float inv_scale) {
+        int q = static_cast<int>(x * inv_scale + 0.5f);
+        return static_cast<uint8_t>(std::clamp(q, 0, kActMax));
+    }
+} // Anonymous namespace
+
+Calibration Calibration::collect(const Network& net, const std::vector<std::vector<float>>& inputs) {
+    Calibration calib;
+    calib.input_max.assign(net.linears().size(), 0.0f);
+    std::vector<float> policy(kPolicySize);
+    for (const auto& input : inputs)
+        net.forward(input.data(), policy.data(), &calib.input_max);
+    return calib;
+}
+
+void Calibration::save(const std::string& path, const Network& net) const {
+    std::ofstream out(path);
+    if (!out) throw std::runtime_error("Failed to open " + path + " for writing");
+    out << "# othello int8 calibration v1\n";
+    for (size_t i = 0; i < net.linears().size(); ++i)
+        out << net.linears()[i].name << " " << input_max[i] << "\n";
+}
+
+Calibration Calibration::load(const std::string& path, const Network& net) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("Failed to open calibration file " + path);
+
+    Calibration calib;
+    calib.input_max.assign(net.linears().size(), -1.0f);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string name;
+        float max = 0.0f;
+        if (!(fields >> name >> max)) throw std::runtime_error("Malformed calibration line: " + line);
+        for (size_t i = 0; i < net.linears().size(); ++i)
+            if (net.linears()[i].name == name) calib.input_max[i] = max;
+    }
+    for (size_t i = 0; i < calib.input_max.size(); ++i)
+        if (calib.input_max[i] < 0.0f)
+            throw std::runtime_error("Calibration is missing layer " + net.linears()[i].name);
+    return calib;
+}
+
+QuantizedNetwork::QuantizedNetwork(const Network& net, const Calibration& calibration) : config_(net.config()) {
+    const auto& specs = net.linears();
+    if (calibration.input_max.size() != specs.size())
+        throw std::invalid_argument("Calibration does not match network layout");
+
+    for (size_t l = 0; l < specs.size(); ++l) {
+        const LinearSpec& s = specs[l];
+        QLinear q;
+        q.out = s.out;
+        q.in = s.in;
+        q.padded_in = pad32(s.in);
+        // Both heads read the trunk output, so they must agree on its quantization
+        size_t range_idx = (l == size_t(net.head_index(Network::VALUE_CONV))) ? net.head_index(Network::POLICY_CONV) : l;
+        float range = calibration.input_max[range_idx] > 0.0f ? calibration.input_max[range_idx] : 1.0f;
+        q.input_scale = range / kActMax;
+        q.weights.assign(size_t(q.out) * q.padded_in, 0);
+        q.out_scale.resize(q.out);
+        q.bias.assign(net.params() + s.bias_offset, net.params() + s.bias_offset + s.out);
+
+        for (int o = 0; o < s.out; ++o) {
+            const float* w = net.params() + s.weight_offset + size_t(o) * s.in;
+            float max_abs = 0.0f;
+            for (int i = 0; i < s.in; ++i) max_abs = std::max(max_abs, std::fabs(w[i]));
+            float w_scale = max_abs > 0.0f ? max_abs / 127.0f : 1.0f;
+            for (int i = 0; i < s.in; ++i)
+                q.weights[size_t(o) * q.padded_in + i] =
+                    static_cast<int8_t>(std::clamp<int>(std::lround(w[i] / w_scale), -127, 127));
+            q.out_scale[o] = q.input_scale * w_scale;
+        }
+        layers_.push_back(std::move(q));
+    }
+}
+
+float QuantizedNetwork::forward(const float* input, float* policy) const {
+    const int c = config_.channels;
+    const int stride = pad32(c);
+
+    thread_local std::vector<uint8_t> act, next, patch, head_buf;
+    act.resize(kBoardSquares * std::max(stride, kInputPlanes));
+    next.resize(kBoardSquares * stride);
+    patch.resize(pad32(9 * std::max(c, kInputPlanes)));
+    head_buf.resize(2 * kBoardSquares + pad32(config_.value_hidden));
+
+    // Step 1: quantize the input planes (CHW -> HWC)
+    float inv = 1.0f / layers_[0].input_scale;
+    for (int sq = 0; sq < kBoardSquares; ++sq)
+        for (int ch = 0; ch < kInputPlanes; ++ch)
+            act[sq * kInputPlanes + ch] = quantize(input[ch * kBoardSquares + sq], inv);
+
+    // Step 2: trunk, requantizing each output with the next layer's input scale
+    int cin = kInputPlanes, in_stride = kInputPlanes;
+    for (int l = 0; l < config_.trunk_layers; ++l) {
+        const QLinear& q = layers_[l];
+        float next_inv = 1.0f / (l + 1 < config_.trunk_layers ? layers_[l + 1].input_scale
+                                                               : head(Network::POLICY_CONV).input_scale);
+        std::fill(patch.begin() + q.in, patch.begin() + q.padded_in, 0);
+        for (int sq = 0; sq < kBoardSquares; ++sq) {
+            gather_patch(act.data(), cin, in_stride, sq % 8, sq / 8, patch.data());
+            for (int o = 0; o < q.out; ++o) {
+                int32_t acc = simd::dot_u8s8(patch.data(), q.weights.data() + size_t(o) * q.padded_in, q.padded_in);
+                next[sq * stride + o] = quantize(acc * q.out_scale[o] + q.bias[o], next_inv);
+            }
+            std::fill(next.begin() + sq * stride + q.out, next.begin() + (sq + 1) * stride, 0);
+        }
+        std::swap(act, next);
+        cin = c;
+        in_stride = stride;
+    }
+
+    // Step 3: policy head
+    const QLinear& pconv = head(Network::POLICY_CONV);
+    const QLinear& pfc = head(Network::POLICY_FC);
+    uint8_t* pflat = head_buf.data();
+    float pinv = 1.0f / pfc.input_scale;
+    for (int sq = 0; sq < kBoardSquares; ++sq)
+        for (int o = 0; o < 2; ++o) {
+            int32_t acc = simd::dot_u8s8(act.data() + sq * stride, pconv.weights.data() + o * pconv.padded_in, pconv.padded_in);
+            pflat[sq * 2 + o] = quantize(acc * pconv.out_scale[o] + pconv.bias[o], pinv);
+        }
+    for (int o = 0; o < kPolicySize; ++o) {
+        int32_t acc = simd::dot_u8s8(pflat, pfc.weights.data() + size_t(o) * pfc.padded_in, pfc.padded_in);
+        policy[o] = acc * pfc.out_scale[o] + pfc.bias[o];
+    }
+    softmax(policy, kPolicySize);
+
+    // Step 4: value head
+    const QLinear& vconv = head(Network::VALUE_CONV);
+    const QLinear& fc1 = head(Network::VALUE_FC1);
+    const QLinear& fc2 = head(Network::VALUE_FC2);
+    uint8_t* vflat = head_buf.data();
+    uint8_t* hidden = vflat + 2 * kBoardSquares;
+    float vinv = 1.0f / fc1.input_scale;
+    for (int sq = 0; sq < kBoardSquares; ++sq) {
+        int32_t acc = simd::dot_u8s8(act.data() + sq * stride, vconv.weights.data(), vconv.padded_in);
+        vflat[sq] = quantize(acc * vconv.out_scale[0] + vconv.bias[0], vinv);
+    }
+    float hinv = 1.0f / fc2.input_scale;
+    std::fill(hidden + fc1.out, hidden + fc2.padded_in, 0);
+    for (int o = 0; o < fc1.out; ++o) {
+        int32_t acc = simd::dot_u8s8(vflat, fc1.weights.data() + size_t(o) * fc1.padded_in, fc1.padded_in);
+        hidden[o] = quantize(acc * fc1.out_scale[o] + fc1.bias[o], hinv);
+    }
+    int32_t acc = simd::dot_u8s8(hidden, fc2.weights.data(), fc2.padded_in);
+    return std::tanh(acc * fc2.out_scale[0] + fc2.bias[0]);
+}
+
+} // namespace nn
@@ -0,0 +1,263 @@
+#include "nn/trainer.hpp"
+#include "nn/simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+
+namespace nn {
+
+// Per-thread gradient accumulator and the activations of the position being trained
+struct Trainer::Workspace {
+    std::vector<float> grad;
+    std::vector<std::vector<float>> trunk;   // [layer + 1][64 * channels], HWC; [0] is the input
+    std::vector<float> pflat, probs, vflat, hidden;
+    std::vector<float> dact, dprev, patch, dpatch;
+    double policy_loss = 0.0;
+    double value_loss = 0.0;
+
+    Workspace(const Network& net) : grad(net.num_params()) {
+        const NetworkConfig& cfg = net.config();
+        const int widest = std::max(cfg.channels, kInputPlanes);
+        trunk.resize(cfg.trunk_layers + 1);
+        trunk[0].resize(kBoardSquares * kInputPlanes);
+        for (int l = 1; l <= cfg.trunk_layers; ++l) trunk[l].resize(kBoardSquares * cfg.channels);
+        pflat.resize(2 * kBoardSquares);
+        probs.resize(kPolicySize);
+        vflat.resize(kBoardSquares);
+        hidden.resize(cfg.value_hidden);
+        dact.resize(kBoardSquares * widest);
+        dprev.resize(kBoardSquares * widest);
+        patch.resize(9 * widest);
+        dpatch.resize(9 * widest);
+    }
+};
+
+Trainer::Trainer(Network& network, const TrainerConfig& config)
+    : network_(network), config_(config)
+{
+    if (network.is_view()) throw std::invalid_argument("Cannot train a read-only network view");
+    if (config_.threads <= 0) config_.threads = std::max(1u, std::thread::hardware_concurrency());
+
+    const size_t n = network.num_params();
+    grad_.assign(n, 0.0f);
+    m_.assign(n, 0.0f);
+    v_.assign(n, 0.0f);
+    decay_.assign(n, 0);
+    for (const auto& l : network.linears())
+        std::fill(decay_.begin() + l.weight_offset, decay_.begin() + l.bias_offset, 1);
+    for (int t = 0; t < config_.threads; ++t) workspaces_.push_back(std::make_unique<Workspace>(network));
+}
+
+Trainer::~Trainer() = default;
+
+void Trainer::shard(Workspace& ws, const float* states, const float* policies, const float* values, size_t begin,
+                    size_t end, bool backward) {
+    const NetworkConfig& cfg = network_.config();
+    const auto& linears = network_.linears();
+    const int c = cfg.channels;
+    const int hidden = cfg.value_hidden;
+    const float* p = network_.params();
+    float* g = ws.grad.data();
+    const LinearSpec& pconv = linears[network_.head_index(Network::POLICY_CONV)];
+    const LinearSpec& pfc = linears[network_.head_index(Network::POLICY_FC)];
+    const LinearSpec& vconv = linears[network_.head_index(Network::VALUE_CONV)];
+    const LinearSpec& fc1 = linears[network_.head_index(Network::VALUE_FC1)];
+    const LinearSpec& fc2 = linears[network_.head_index(Network::VALUE_FC2)];
+
+    for (size_t b = begin; b < end; ++b) {
+        const float* input = states + b * kInputSize;
+        const float* target_policy = policies + b * kPolicySize;
+        const float target_value = values[b];
+
+        // Step 1: forward pass, keeping every layer's output (same arithmetic as Network::forward)
+        for (int sq = 0; sq < kBoardSquares; ++sq)
+            for (int ch = 0; ch < kInputPlanes; ++ch)
+                ws.trunk[0][sq * kInputPlanes + ch] = input[ch * kBoardSquares + sq];
+        int cin = kInputPlanes;
+        for (int l = 0; l < cfg.trunk_layers; ++l) {
+            const LinearSpec& s = linears[l];
+            const float* in = ws.trunk[l].data();
+            float* out = ws.trunk[l + 1].data();
+            for (int sq = 0; sq < kBoardSquares; ++sq) {
+                gather_patch(in, cin, cin, sq % 8, sq / 8, ws.patch.data());
+                for (int o = 0; o < c; ++o) {
+                    float v = simd::dot(p + s.weight_offset + size_t(o) * s.in, ws.patch.data(), s.in) + p[s.bias_offset + o];
+                    out[sq * c + o] = std::max(0.0f, v);
+                }
+            }
+            cin = c;
+        }
+        const float* act = ws.trunk[cfg.trunk_layers].data();
+
+        for (int sq = 0; sq < kBoardSquares; ++sq)
+            for (int o = 0; o < 2; ++o) {
+                float v = simd::dot(p + pconv.weight_offset + o * c, act + sq * c, c) + p[pconv.bias_offset + o];
+                ws.pflat[sq * 2 + o] = std::max(0.0f, v);
+            }
+        for (int o = 0; o < kPolicySize; ++o)
+            ws.probs[o] = simd::dot(p + pfc.weight_offset + size_t(o) * pfc.in, ws.pflat.data(), pfc.in) + p[pfc.bias_offset + o];
+        softmax(ws.probs.data(), kPolicySize);
+
+        for (int sq = 0; sq < kBoardSquares; ++sq)
+            ws.vflat[sq] = std::max(0.0f, simd::dot(p + vconv.weight_offset, act + sq * c, c) + p[vconv.bias_offset]);
+        for (int o = 0; o < hidden; ++o)
+            ws.hidden[o] = std::max(0.0f, simd::dot(p + fc1.weight_offset + size_t(o) * fc1.in, ws.vflat.data(), fc1.in) +
+                                              p[fc1.bias_offset + o]);
+        const float value = std::tanh(simd::dot(p + fc2.weight_offset, ws.hidden.data(), hidden) + p[fc2.bias_offset]);
+
+        // Step 2: losses. Cross-entropy -sum(pi log p), value (v - z)^2
+        float target_mass = 0.0f;
+        for (int o = 0; o < kPolicySize; ++o) {
+            target_mass += target_policy[o];
+            if (target_policy[o] > 0.0f) ws.policy_loss -= target_policy[o] * std::log(std::max(ws.probs[o], 1e-12f));
+        }
+        const float error = value - target_value;
+        ws.value_loss += error * error;
+        if (!backward) continue;
+
+        // Step 3: policy head backward. d(CE)/d(logit) = p * sum(pi) - pi
+        std::fill(ws.dact.begin(), ws.dact.begin() + kBoardSquares * c, 0.0f);
+        float* dpflat = ws.dprev.data();
+        std::fill(dpflat, dpflat + 2 * kBoardSquares, 0.0f);
+        for (int o = 0; o < kPolicySize; ++o) {
+            float d = ws.probs[o] * target_mass - target_policy[o];
+            if (d == 0.0f) continue;
+            simd::axpy(d, ws.pflat.data(), g + pfc.weight_offset + size_t(o) * pfc.in, pfc.in);
+            g[pfc.bias_offset + o] += d;
+            simd::axpy(d, p + pfc.weight_offset + size_t(o) * pfc.in, dpflat, pfc.in);
+        }
+        for (int sq = 0; sq < kBoardSquares; ++sq)
+            for (int o = 0; o < 2; ++o) {
+                float d = ws.pflat[sq * 2 + o] > 0.0f ? dpflat[sq * 2 + o] : 0.0f;
+                if (d == 0.0f) continue;
+                simd::axpy(d, act + sq * c, g + pconv.weight_offset + o * c, c);
+                g[pconv.bias_offset + o] += d;
+                simd::axpy(d, p + pconv.weight_offset + o * c, ws.dact.data() + sq * c, c);
+            }
+
+        // Step 4: value head backward through tanh, fc2, fc1 and the 1x1 conv
+        const float dpre = 2.0f * config_.value_weight * error * (1.0f - value * value);
+        simd::axpy(dpre, ws.hidden.data(), g + fc2.weight_offset, hidden);
+        g[fc2.bias_offset] += dpre;
+        float* dvflat = ws.dprev.data();
+        std::fill(dvflat, dvflat + kBoardSquares, 0.0f);
+        for (int o = 0; o < hidden; ++o) {
+            float d = ws.hidden[o] > 0.0f ? dpre * p[fc2.weight_offset + o] : 0.0f;
+            if (d == 0.0f) continue;
+            simd::axpy(d, ws.vflat.data(), g + fc1.weight_offset + size_t(o) * fc1.in, fc1.in);
+            g[fc1.bias_offset + o] += d;
+            simd::axpy(d, p + fc1.weight_offset + size_t(o) * fc1.in, dvflat, fc1.in);
+        }
+        for (int sq = 0; sq < kBoardSquares; ++sq) {
+            float d = ws.vflat[sq] > 0.0f ? dvflat[sq] : 0.0f;
+            if (d == 0.0f) continue;
+            simd::axpy(d, act + sq * c, g + vconv.weight_offset, c);
+            g[vconv.bias_offset] += d;
+            simd::axpy(d, p + vconv.weight_offset, ws.dact.data() + sq * c, c);
+        }
+
+        // Step 5: trunk backward. dact holds d(loss)/d(output of layer l) on entry.
+        for (int l = cfg.trunk_layers - 1; l >= 0; --l) {
+            const LinearSpec& s = linears[l];
+            const int in_ch = (l == 0) ? kInputPlanes : c;
+            const float* in = ws.trunk[l].data();
+            const float* out = ws.trunk[l + 1].data();
+            if (l > 0) std::fill(ws.dprev.begin(), ws.dprev.begin() + kBoardSquares * in_ch, 0.0f);
+
+            for (int sq = 0; sq < kBoardSquares; ++sq) {
+                const int x = sq % 8, y = sq / 8;
+                gather_patch(in, in_ch, in_ch, x, y, ws.patch.data());
+                if (l > 0) std::fill(ws.dpatch.begin(), ws.dpatch.begin() + s.in, 0.0f);
+                bool any = false;
+                for (int o = 0; o < c; ++o) {
+                    float d = out[sq * c + o] > 0.0f ? ws.dact[sq * c + o] : 0.0f;
+                    if (d == 0.0f) continue;
+                    any = true;
+                    simd::axpy(d, ws.patch.data(), g + s.weight_offset + size_t(o) * s.in, s.in);
+                    g[s.bias_offset + o] += d;
+                    if (l > 0) simd::axpy(d, p + s.weight_offset + size_t(o) * s.in, ws.dpatch.data(), s.in);
+                }
+                if (l == 0 || !any) continue;
+
+                // Scatter the patch gradient back onto the on-board neighbours
+                for (int ky = 0; ky < 3; ++ky)
+                    for (int kx = 0; kx < 3; ++kx) {
+                        int nx = x + kx - 1, ny = y + ky - 1;
+                        if (nx < 0 || nx >= 8 || ny < 0 || ny >= 8) continue;
+                        const float* src = ws.dpatch.data() + (ky * 3 + kx) * in_ch;
+                        float* dst = ws.dprev.data() + (ny * 8 + nx) * in_ch;
+                        for (int ch = 0; ch < in_ch; ++ch) dst[ch] += src[ch];
+                    }
+            }
+            if (l > 0) std::swap(ws.dact, ws.dprev);
+        }
+    }
+}
+
+TrainLoss Trainer::run(const float* states, const float* policies, const float* values, size_t n, bool backward) {
+    if (n == 0) throw std::invalid_argument("Empty training batch");
+
+    // Step 1: one contiguous shard per worker; the calling thread takes the first
+    const size_t shards = std::min<size_t>(workspaces_.size(), n);
+    auto work = [&](size_t t) {
+        Workspace& ws = *workspaces_[t];
+        if (backward) std::fill(ws.grad.begin(), ws.grad.end(), 0.0f);
+        ws.policy_loss = ws.value_loss = 0.0;
+        shard(ws, states, policies, values, n * t / shards, n * (t + 1) / shards, backward);
+    };
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < shards; ++t) threads.emplace_back(work, t);
+    work(0);
+    for (auto& t : threads) t.join();
+
+    // Step 2: reduce losses and gradients into the batch mean
+    double policy_loss = 0.0, value_loss = 0.0;
+    for (size_t t = 0; t < shards; ++t) {
+        policy_loss += workspaces_[t]->policy_loss;
+        value_loss += workspaces_[t]->value_loss;
+    }
+    if (backward) {
+        const float scale = 1.0f / n;
+        std::fill(grad_.begin(), grad_.end(), 0.0f);
+        for (size_t t = 0; t < shards; ++t)
+            simd::axpy(scale, workspaces_[t]->grad.data(), grad_.data(), static_cast<int>(grad_.size()));
+    }
+    return {static_cast<float>(policy_loss / n), static_cast<float>(config_.value_weight * value_loss / n)};
+}
+
+TrainLoss Trainer::loss(const float* states, const float* policies, const float* values, size_t n) {
+    return run(states, policies, values, n, false);
+}
+
+TrainLoss Trainer::gradient(const float* states, const float* policies, const float* values, size_t n, float* grad) {
+    TrainLoss result = run(states, policies, values, n, true);
+    std::copy(grad_.begin(), grad_.end(), grad);
+    return result;
+}
+
+TrainLoss Trainer::step(const float* states, const float* policies, const float* values, size_t n) {
+    TrainLoss result = run(states, policies, values, n, true);
+
+    // AdamW with bias correction folded into the step size
+    ++steps_;
+    const float b1 = config_.beta1, b2 = config_.beta2;
+    const float correction1 = 1.0f - std::pow(b1, static_cast<float>(steps_));
+    const float correction2 = 1.0f - std::pow(b2, static_cast<float>(steps_));
+    const float step_size = config_.learning_rate * std::sqrt(correction2) / correction1;
+    const float decay = config_.learning_rate * config_.weight_decay;
+    const float eps = config_.epsilon * std::sqrt(correction2);
+
+    float* w = network_.mutable_params();
+    const size_t count = grad_.size();
+    for (size_t i = 0; i < count; ++i) {
+        const float gi = grad_[i];
+        m_[i] = b1 * m_[i] + (1.0f - b1) * gi;
+        v_[i] = b2 * v_[i] + (1.0f - b2) * gi * gi;
+        w[i] -= step_size * m_[i] / (std::sqrt(v_[i]) + eps) + (decay_[i] ? decay * w[i] : 0.0f);
+    }
+    return result;
+}
+
+} // namespace nn
@@ -1,37 +1,183 @@
 #include "opencl/context.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
 #include <fstream>
-#include <iostream>
+#include <stdexcept>
 #include <vector>
 
 #include <spdlog/spdlog.h>
 
-OpenCLContext::OpenCLContext() {
+namespace {
+    std::string platform_string(cl_platform_id platform, cl_platform_info param) {
+        size_t size = 0;
+        if (clGetPlatformInfo(platform, param, 0, nullptr, &size) != CL_SUCCESS || size == 0) return "";
+        std::string value(size, '\0');
+        clGetPlatformInfo(platform, param, size, value.data(), nullptr);
+        value.resize(size - 1);  // drop terminator
+        return value;
+    }
+
+    std::string device_string(cl_device_id device, cl_device_info param) {
+        size_t size = 0;
+        if (clGetDeviceInfo(device, param, 0, nullptr, &size) != CL_SUCCESS || size == 0) return "";
+        std::string value(size, '\0');
+        clGetDeviceInfo(device, param, size, value.data(), nullptr);
+        value.resize(size - 1);
+        return value;
+    }
+
+    std::string lower(std::string s) {
+        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+        return s;
+    }
+
+    const char* type_name(cl_device_type type) {
+        if (type & CL_DEVICE_TYPE_GPU) return "GPU";
+        if (type & CL_DEVICE_TYPE_CPU) return "CPU";
+        if (type & CL_DEVICE_TYPE_ACCELERATOR) return "accelerator";
+        return "other";
+    }
+} // Anonymous namespace
+
+void check_cl(cl_int err, const char* what) {
+    if (err != CL_SUCCESS)
+        throw std::runtime_error(std::string(what) + " failed with OpenCL error " + std::to_string(err));
+}
+
+cl_program compile_program(cl_context context, cl_device_id device, const std::string& source,
+                           const std::string& options) {
+    const char* src_cstr = source.c_str();
+    size_t length = source.size();
+
     cl_int err;
+    cl_program program = clCreateProgramWithSource(context, 1, &src_cstr, &length, &err);
+    check_cl(err, "clCreateProgramWithSource");
+    err = clBuildProgram(program, 1, &device, options.c_str(), nullptr, nullptr);
 
-    // Platform
-    cl_uint num_platforms;
-    clGetPlatformIDs(0, nullptr, &num_platforms);
+    if (err != CL_SUCCESS) {
+        // Print build log
+        size_t log_size = 0;
+        clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, 0, nullptr, &log_size);
+        std::string log(log_size, '\0');
+        clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, log_size, log.data(), nullptr);
+        spdlog::error("OpenCL build error:\n{}", log);
+        clReleaseProgram(program);
+        check_cl(err, "clBuildProgram");
+    }
+
+    return program;
+}
+
+DeviceSelector DeviceSelector::parse(const std::string& spec) {
+    DeviceSelector selector;
+    std::string s = lower(spec);
+    if (s.empty() || s == "gpu") {
+        selector.type = CL_DEVICE_TYPE_GPU;
+    } else if (s == "cpu") {
+        selector.type = CL_DEVICE_TYPE_CPU;
+    } else if (s == "accelerator") {
+        selector.type = CL_DEVICE_TYPE_ACCELERATOR;
+    } else if (s == "all" || s == "any") {
+        selector.type = CL_DEVICE_TYPE_ALL;
+    } else if (std::all_of(s.begin(), s.end(), [](unsigned char c) { return std::isdigit(c); })) {
+        selector.index = std::stoi(s);
+    } else {
+        selector.type = CL_DEVICE_TYPE_ALL;
+        selector.vendor = s;
+    }
+    return selector;
+}
+
+DeviceSelector DeviceSelector::from_env() {
+    const char* spec = std::getenv("OTHELLO_CL_DEVICE");
+    return spec ? parse(spec) : DeviceSelector{};
+}
+
+std::vector<DeviceInfo> OpenCLContext::enumerate_devices() {
+    std::vector<DeviceInfo> result;
+
+    // No ICD installed reports CL_PLATFORM_NOT_FOUND_KHR rather than zero platforms
+    cl_uint num_platforms = 0;
+    if (clGetPlatformIDs(0, nullptr, &num_platforms) != CL_SUCCESS || num_platforms == 0) return result;
     std::vector<cl_platform_id> platforms(num_platforms);
     clGetPlatformIDs(num_platforms, platforms.data(), nullptr);
-    platform_ = platforms[0];
 
-    // Device
-    cl_uint num_devices;
-    clGetDeviceIDs(platform_, CL_DEVICE_TYPE_GPU, 0, nullptr, &num_devices);
-    std::vector<cl_device_id> devices(num_devices);
-    clGetDeviceIDs(platform_, CL_DEVICE_TYPE_GPU, num_devices, devices.data(), nullptr);
-    device_ = devices[0];
+    for (cl_platform_id platform : platforms) {
+        cl_uint num_devices = 0;
+        if (clGetDeviceIDs(platform, CL_DEVICE_TYPE_ALL, 0, nullptr, &num_devices) != CL_SUCCESS) continue;
+        std::vector<cl_device_id> devices(num_devices);
+        clGetDeviceIDs(platform, CL_DEVICE_TYPE_ALL, num_devices, devices.data(), nullptr);
+
+        for (cl_device_id device : devices) {
+            DeviceInfo info{};
+            info.platform = platform;
+            info.device = device;
+            clGetDeviceInfo(device, CL_DEVICE_TYPE, sizeof(info.type), &info.type, nullptr);
+            clGetDeviceInfo(device, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(info.compute_units), &info.compute_units, nullptr);
+            info.platform_name = platform_string(platform, CL_PLATFORM_NAME);
+            info.name = device_string(device, CL_DEVICE_NAME);
+            info.vendor = device_string(device, CL_DEVICE_VENDOR);
+            info.driver_version = device_string(device, CL_DRIVER_VERSION);
+            result.push_back(std::move(info));
+        }
+    }
+    return result;
+}
+
+OpenCLContext::OpenCLContext(const DeviceSelector& selector) {
+    cl_int err;
+
+    // Step 1: pick a device
+    auto devices = enumerate_devices();
+    if (devices.empty()) throw std::runtime_error("No OpenCL platforms or devices found");
+
+    const DeviceInfo* chosen = nullptr;
+    if (selector.index >= 0) {
+        if (selector.index >= static_cast<int>(devices.size()))
+            throw std::runtime_error("OpenCL device index " + std::to_string(selector.index) + " out of range (" +
+                                     std::to_string(devices.size()) + " devices)");
+        chosen = &devices[selector.index];
+    } else {
+        std::string vendor = lower(selector.vendor);
+        for (const auto& d : devices) {
+            if (!(d.type & selector.type)) continue;
+            if (!vendor.empty() && lower(d.vendor).find(vendor) == std::string::npos &&
+                lower(d.platform_name).find(vendor) == std::string::npos) continue;
+            chosen = &d;
+            break;
+        }
+        if (!chosen && selector.cpu_fallback) {
+            for (const auto& d : devices) {
+                if (d.type & CL_DEVICE_TYPE_CPU) { chosen = &d; break; }
+            }
+            if (chosen) spdlog::warn("No matching OpenCL device; falling back to CPU device {}", chosen->name);
+        }
+        if (!chosen) throw std::runtime_error("No OpenCL device matches the requested type/vendor");
+    }
 
-    // Context
+    info_ = *chosen;
+    platform_ = info_.platform;
+    device_ = info_.device;
+
+    // Step 2: context and command queue
     context_ = clCreateContext(nullptr, 1, &device_, nullptr, nullptr, &err);
-    spdlog::info("OpenCL context created successfully");
+    check_cl(err, "clCreateContext");
 
-    // Command queue
     #ifdef CL_VERSION_2_0
     queue_ = clCreateCommandQueueWithProperties(context_, device_, nullptr, &err);
     #else
     queue_ = clCreateCommandQueue(context_, device_, 0, &err);
     #endif
+    if (err != CL_SUCCESS) {
+        clReleaseContext(context_);
+        check_cl(err, "clCreateCommandQueue");
+    }
+
+    set_program_cache_directory(ProgramCache::default_directory());
+
+    spdlog::info("OpenCL context created on {} device \"{}\" ({}, driver {})",
+                 type_name(info_.type), info_.name, info_.platform_name, info_.driver_version);
 }
 
 OpenCLContext::~OpenCLContext() {
@@ -41,29 +187,31 @@ OpenCLContext::~OpenCLContext() {
 
 cl_context OpenCLContext::context() const { return context_; }
 cl_command_queue OpenCLContext::queue() const { return queue_; }
+cl_device_id OpenCLContext::device() const { return device_; }
+const DeviceInfo& OpenCLContext::device_info() const { return info_; }
 
-cl_program OpenCLContext::buildProgramFromFile(const std::string& path) {
-    std::ifstream file(path);
-    std::string src((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-    const char* src_cstr = src.c_str();
-    size_t length = src.size();
+void OpenCLContext::set_program_cache_directory(const std::string& directory) {
+    if (directory.empty()) program_cache_.reset();
+    else program_cache_ = std::make_unique<ProgramCache>(directory);
+}
 
-    cl_int err;
-    cl_program program = clCreateProgramWithSource(context_, 1, &src_cstr, &length, &err);
-    err = clBuildProgram(program, 1, &device_, nullptr, nullptr, nullptr);
+ProgramCache* OpenCLContext::program_cache() const { return program_cache_.get(); }
 
-    if (err != CL_SUCCESS) {
-        // Print build log
-        char buffer[2048];
-        clGetProgramBuildInfo(program, device_, CL_PROGRAM_BUILD_LOG, sizeof(buffer), buffer, nullptr);
-        std::cerr << "OpenCL build error:\n" << buffer << std::endl;
-    }
+cl_program OpenCLContext::buildProgramFromSource(const std::string& source, const std::string& options) {
+    if (program_cache_) return program_cache_->build(context_, info_, source, options);
+    return compile_program(context_, device_, source, options);
+}
 
-    return program;
+cl_program OpenCLContext::buildProgramFromFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("Failed to open OpenCL source " + path);
+    std::string src((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return buildProgramFromSource(src);
 }
 
 cl_kernel OpenCLContext::createKernel(cl_program program, const std::string& kernel_name) {
     cl_int err;
     cl_kernel kernel = clCreateKernel(program, kernel_name.c_str(), &err);
+    check_cl(err, ("clCreateKernel(" + kernel_name + ")").c_str());
     return kernel;
 }
@@ -0,0 +1,242 @@
+#include "opencl/inference_pipeline.hpp"
+#include "generated/kernels.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    enum Activation { NONE = 0, RELU = 1, TANH = 2 };
+
+    using Clock = std::chrono::steady_clock;
+
+    double seconds_since(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+} // Anonymous namespace
+
+InferencePipeline::InferencePipeline(OpenCLContext& context, const nn::Network& network, int max_batch, int depth)
+    : context_(context), config_(network.config()), linears_(network.linears()), max_batch_(max_batch)
+{
+    if (max_batch <= 0 || depth <= 0) throw std::invalid_argument("InferencePipeline needs max_batch and depth > 0");
+
+    // Any CL call below can throw; the destructor would not run, so release what exists first
+    try {
+        program_ = context_.buildProgramFromSource(kernel_sources.at("network.cl"));
+        conv_kernel_ = context_.createKernel(program_, "conv3x3_relu");
+        dense_kernel_ = context_.createKernel(program_, "dense");
+        softmax_kernel_ = context_.createKernel(program_, "softmax");
+
+        // Parameters are uploaded once and shared by every slot
+        for (const auto& spec : linears_) {
+            weights_.push_back(create_buffer(CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, size_t(spec.out) * spec.in,
+                                             network.params() + spec.weight_offset));
+            biases_.push_back(create_buffer(CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, spec.out,
+                                            network.params() + spec.bias_offset));
+        }
+
+        const size_t batch = max_batch_;
+        const size_t trunk = batch * nn::kBoardSquares * std::max(config_.channels, nn::kInputPlanes);
+        const size_t in_floats = batch * nn::kBoardSquares * nn::kInputPlanes;
+        const size_t out_floats = batch * (nn::kPolicySize + 1);
+
+        slots_.resize(depth);
+        for (Slot& slot : slots_) {
+            cl_int err;
+            #ifdef CL_VERSION_2_0
+            slot.queue = clCreateCommandQueueWithProperties(context_.context(), context_.device(), nullptr, &err);
+            #else
+            slot.queue = clCreateCommandQueue(context_.context(), context_.device(), 0, &err);
+            #endif
+            check_cl(err, "clCreateCommandQueue");
+
+            slot.act[0] = create_buffer(CL_MEM_READ_WRITE, trunk);
+            slot.act[1] = create_buffer(CL_MEM_READ_WRITE, trunk);
+            slot.policy_plane = create_buffer(CL_MEM_READ_WRITE, batch * nn::kBoardSquares * 2);
+            slot.value_plane = create_buffer(CL_MEM_READ_WRITE, batch * nn::kBoardSquares);
+            slot.hidden = create_buffer(CL_MEM_READ_WRITE, batch * config_.value_hidden);
+            slot.logits = create_buffer(CL_MEM_READ_WRITE, batch * nn::kPolicySize);
+            slot.values = create_buffer(CL_MEM_READ_WRITE, batch);
+
+            // Pinned staging buffers stay mapped, so transfers are DMA from host memory with no extra copy
+            slot.host_in = create_buffer(CL_MEM_READ_ONLY | CL_MEM_ALLOC_HOST_PTR, in_floats);
+            slot.host_out = create_buffer(CL_MEM_WRITE_ONLY | CL_MEM_ALLOC_HOST_PTR, out_floats);
+            slot.in_ptr = static_cast<float*>(clEnqueueMapBuffer(slot.queue, slot.host_in, CL_TRUE, CL_MAP_WRITE,
+                                                                 0, in_floats * sizeof(float), 0, nullptr, nullptr,
+                                                                 &err));
+            check_cl(err, "clEnqueueMapBuffer(input)");
+            slot.out_ptr = static_cast<float*>(clEnqueueMapBuffer(slot.queue, slot.host_out, CL_TRUE, CL_MAP_READ,
+                                                                  0, out_floats * sizeof(float), 0, nullptr, nullptr,
+                                                                  &err));
+            check_cl(err, "clEnqueueMapBuffer(output)");
+        }
+    } catch (...) {
+        release();
+        throw;
+    }
+}
+
+InferencePipeline::~InferencePipeline() {
+    release();
+}
+
+void InferencePipeline::release() {
+    for (Slot& slot : slots_) {
+        if (slot.queue) clFinish(slot.queue);
+        if (slot.done) clReleaseEvent(slot.done);
+        if (slot.in_ptr) clEnqueueUnmapMemObject(slot.queue, slot.host_in, slot.in_ptr, 0, nullptr, nullptr);
+        if (slot.out_ptr) clEnqueueUnmapMemObject(slot.queue, slot.host_out, slot.out_ptr, 0, nullptr, nullptr);
+        if (slot.queue) clFinish(slot.queue);
+        for (cl_mem m : {slot.act[0], slot.act[1], slot.policy_plane, slot.value_plane, slot.hidden,
+                         slot.logits, slot.values, slot.host_in, slot.host_out})
+            if (m) clReleaseMemObject(m);
+        if (slot.queue) clReleaseCommandQueue(slot.queue);
+    }
+    slots_.clear();
+    for (cl_mem m : weights_) clReleaseMemObject(m);
+    for (cl_mem m : biases_) clReleaseMemObject(m);
+    weights_.clear();
+    biases_.clear();
+    for (cl_kernel k : {conv_kernel_, dense_kernel_, softmax_kernel_})
+        if (k) clReleaseKernel(k);
+    if (program_) clReleaseProgram(program_);
+    conv_kernel_ = dense_kernel_ = softmax_kernel_ = nullptr;
+    program_ = nullptr;
+}
+
+cl_mem InferencePipeline::create_buffer(cl_mem_flags flags, size_t floats, const float* host) {
+    cl_int err;
+    cl_mem mem = clCreateBuffer(context_.context(), flags, floats * sizeof(float), const_cast<float*>(host), &err);
+    check_cl(err, "clCreateBuffer");
+    return mem;
+}
+
+void InferencePipeline::enqueue_dense(cl_command_queue queue, size_t layer, cl_mem in, cl_mem out,
+                                      size_t rows, int activation) {
+    const nn::LinearSpec& spec = linears_[layer];
+    cl_int err = clSetKernelArg(dense_kernel_, 0, sizeof(cl_mem), &in);
+    err |= clSetKernelArg(dense_kernel_, 1, sizeof(cl_mem), &weights_[layer]);
+    err |= clSetKernelArg(dense_kernel_, 2, sizeof(cl_mem), &biases_[layer]);
+    err |= clSetKernelArg(dense_kernel_, 3, sizeof(cl_mem), &out);
+    err |= clSetKernelArg(dense_kernel_, 4, sizeof(int), &spec.in);
+    err |= clSetKernelArg(dense_kernel_, 5, sizeof(int), &spec.out);
+    err |= clSetKernelArg(dense_kernel_, 6, sizeof(int), &activation);
+    check_cl(err, "clSetKernelArg(dense)");
+
+    size_t global[2] = {rows, static_cast<size_t>(spec.out)};
+    check_cl(clEnqueueNDRangeKernel(queue, dense_kernel_, 2, nullptr, global, nullptr, 0, nullptr, nullptr),
+             "clEnqueueNDRangeKernel(dense)");
+}
+
+void InferencePipeline::enqueue_forward(Slot& slot) {
+    // Kernel arguments are captured at enqueue time, so slots can share kernel objects
+    cl_command_queue queue = slot.queue;
+    const size_t batch = slot.n;
+    const size_t squares = batch * nn::kBoardSquares;
+
+    check_cl(clEnqueueWriteBuffer(queue, slot.act[0], CL_FALSE, 0, squares * nn::kInputPlanes * sizeof(float),
+                                  slot.in_ptr, 0, nullptr, nullptr), "clEnqueueWriteBuffer(input)");
+
+    // Trunk
+    int cin = nn::kInputPlanes;
+    int cur = 0;
+    for (int l = 0; l < config_.trunk_layers; ++l) {
+        cl_int err = clSetKernelArg(conv_kernel_, 0, sizeof(cl_mem), &slot.act[cur]);
+        err |= clSetKernelArg(conv_kernel_, 1, sizeof(cl_mem), &weights_[l]);
+        err |= clSetKernelArg(conv_kernel_, 2, sizeof(cl_mem), &biases_[l]);
+        err |= clSetKernelArg(conv_kernel_, 3, sizeof(cl_mem), &slot.act[1 - cur]);
+        err |= clSetKernelArg(conv_kernel_, 4, sizeof(int), &cin);
+        err |= clSetKernelArg(conv_kernel_, 5, sizeof(int), &config_.channels);
+        check_cl(err, "clSetKernelArg(conv3x3_relu)");
+
+        size_t global[2] = {squares, static_cast<size_t>(config_.channels)};
+        check_cl(clEnqueueNDRangeKernel(queue, conv_kernel_, 2, nullptr, global, nullptr, 0, nullptr, nullptr),
+                 "clEnqueueNDRangeKernel(conv3x3_relu)");
+        cur = 1 - cur;
+        cin = config_.channels;
+    }
+
+    // Heads (1x1 convolutions are dense layers over squares)
+    auto head = [&](nn::Network::Head h) { return static_cast<size_t>(config_.trunk_layers + h); };
+    enqueue_dense(queue, head(nn::Network::POLICY_CONV), slot.act[cur], slot.policy_plane, squares, RELU);
+    enqueue_dense(queue, head(nn::Network::POLICY_FC), slot.policy_plane, slot.logits, batch, NONE);
+    enqueue_dense(queue, head(nn::Network::VALUE_CONV), slot.act[cur], slot.value_plane, squares, RELU);
+    enqueue_dense(queue, head(nn::Network::VALUE_FC1), slot.value_plane, slot.hidden, batch, RELU);
+    enqueue_dense(queue, head(nn::Network::VALUE_FC2), slot.hidden, slot.values, batch, TANH);
+
+    int width = nn::kPolicySize;
+    cl_int err = clSetKernelArg(softmax_kernel_, 0, sizeof(cl_mem), &slot.logits);
+    err |= clSetKernelArg(softmax_kernel_, 1, sizeof(int), &width);
+    check_cl(err, "clSetKernelArg(softmax)");
+    check_cl(clEnqueueNDRangeKernel(queue, softmax_kernel_, 1, nullptr, &batch, nullptr, 0, nullptr, nullptr),
+             "clEnqueueNDRangeKernel(softmax)");
+
+    // Non-blocking reads into pinned memory; the last one marks the slot done (in-order queue)
+    check_cl(clEnqueueReadBuffer(queue, slot.logits, CL_FALSE, 0, batch * nn::kPolicySize * sizeof(float),
+                                 slot.out_ptr, 0, nullptr, nullptr), "clEnqueueReadBuffer(policy)");
+    check_cl(clEnqueueReadBuffer(queue, slot.values, CL_FALSE, 0, batch * sizeof(float),
+                                 slot.out_ptr + size_t(max_batch_) * nn::kPolicySize, 0, nullptr, &slot.done),
+             "clEnqueueReadBuffer(value)");
+    check_cl(clFlush(queue), "clFlush");
+}
+
+InferencePipeline::Slot& InferencePipeline::slot_for(uint64_t ticket) {
+    Slot& slot = slots_[ticket % slots_.size()];
+    if (!slot.pending || slot.ticket != ticket) throw std::invalid_argument("Unknown or already collected ticket");
+    return slot;
+}
+
+uint64_t InferencePipeline::submit(const float* inputs, int n) {
+    if (n <= 0 || n > max_batch_) throw std::invalid_argument("Batch size out of range for InferencePipeline");
+    auto start = Clock::now();
+
+    uint64_t ticket = next_ticket_;
+    Slot& slot = slots_[ticket % slots_.size()];
+    if (slot.pending) throw std::logic_error("InferencePipeline slot reused before wait()");
+
+    // CHW -> HWC straight into the pinned upload buffer
+    for (int b = 0; b < n; ++b)
+        for (int sq = 0; sq < nn::kBoardSquares; ++sq)
+            for (int ch = 0; ch < nn::kInputPlanes; ++ch)
+                slot.in_ptr[(b * nn::kBoardSquares + sq) * nn::kInputPlanes + ch] =
+                    inputs[size_t(b) * nn::kInputSize + ch * nn::kBoardSquares + sq];
+
+    slot.n = n;
+    slot.ticket = ticket;
+    enqueue_forward(slot);
+    slot.pending = true;
+    ++next_ticket_;
+
+    stats_.batches++;
+    stats_.positions += n;
+    stats_.submit_seconds += seconds_since(start);
+    return ticket;
+}
+
+bool InferencePipeline::ready(uint64_t ticket) const {
+    const Slot& slot = slots_[ticket % slots_.size()];
+    if (!slot.pending || slot.ticket != ticket) return false;
+    cl_int status = 1;
+    clGetEventInfo(slot.done, CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(status), &status, nullptr);
+    return status == CL_COMPLETE;
+}
+
+void InferencePipeline::wait(uint64_t ticket, float* policies, float* values) {
+    Slot& slot = slot_for(ticket);
+
+    auto start = Clock::now();
+    check_cl(clWaitForEvents(1, &slot.done), "clWaitForEvents");
+    stats_.stall_seconds += seconds_since(start);
+
+    std::memcpy(policies, slot.out_ptr, size_t(slot.n) * nn::kPolicySize * sizeof(float));
+    std::memcpy(values, slot.out_ptr + size_t(max_batch_) * nn::kPolicySize, size_t(slot.n) * sizeof(float));
+
+    clReleaseEvent(slot.done);
+    slot.done = nullptr;
+    slot.pending = false;
+}
+
+int InferencePipeline::in_flight() const {
+    return static_cast<int>(std::count_if(slots_.begin(), slots_.end(), [](const Slot& s) { return s.pending; }));
+}
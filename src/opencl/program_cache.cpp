@@ -0,0 +1,155 @@
+#include "opencl/program_cache.hpp"
+#include "opencl/context.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+namespace {
+    constexpr char kMagic[4] = {'O', 'C', 'L', 'B'};
+    constexpr uint32_t kFormatVersion = 1;
+
+    struct EntryHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t key;
+        uint64_t binary_size;
+    };
+
+    uint64_t fnv1a(uint64_t hash, const std::string& data) {
+        for (unsigned char c : data) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        // Field separator, so ("ab", "c") and ("a", "bc") differ
+        hash ^= 0xff;
+        hash *= 1099511628211ULL;
+        return hash;
+    }
+
+    double elapsed_ms(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+} // Anonymous namespace
+
+ProgramCache::ProgramCache(std::string directory) : directory_(std::move(directory)) {
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    if (ec) spdlog::warn("OpenCL program cache directory {} unavailable: {}", directory_, ec.message());
+}
+
+std::string ProgramCache::default_directory() {
+    if (const char* dir = std::getenv("OTHELLO_CL_CACHE"))
+        return std::string(dir) == "off" ? "" : dir;
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"))
+        return std::string(xdg) + "/othello/opencl";
+    if (const char* home = std::getenv("HOME"))
+        return std::string(home) + "/.cache/othello/opencl";
+    return ".othello_cl_cache";
+}
+
+uint64_t ProgramCache::key(const DeviceInfo& device, const std::string& options, const std::string& source) {
+    uint64_t hash = 14695981039346656037ULL;
+    hash = fnv1a(hash, device.name);
+    hash = fnv1a(hash, device.driver_version);
+    hash = fnv1a(hash, options);
+    hash = fnv1a(hash, source);
+    return hash;
+}
+
+std::string ProgramCache::entry_path(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return directory_ + "/" + name;
+}
+
+cl_program ProgramCache::build(cl_context context, const DeviceInfo& device, const std::string& source,
+                               const std::string& options, bool* cache_hit) {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t k = key(device, options, source);
+
+    if (cl_program program = load(context, device, k, options)) {
+        spdlog::info("Loaded cached OpenCL program {:016x} in {:.1f} ms", k, elapsed_ms(start));
+        if (cache_hit) *cache_hit = true;
+        return program;
+    }
+
+    cl_program program = compile_program(context, device.device, source, options);
+    spdlog::info("Compiled OpenCL program {:016x} from source in {:.1f} ms", k, elapsed_ms(start));
+    store(program, k);
+    if (cache_hit) *cache_hit = false;
+    return program;
+}
+
+cl_program ProgramCache::load(cl_context context, const DeviceInfo& device, uint64_t key, const std::string& options) {
+    std::string path = entry_path(key);
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return nullptr;
+
+    EntryHeader header{};
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kFormatVersion ||
+        header.key != key || header.binary_size == 0) {
+        spdlog::warn("Discarding malformed OpenCL cache entry {}", path);
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        return nullptr;
+    }
+
+    std::vector<unsigned char> binary(header.binary_size);
+    in.read(reinterpret_cast<char*>(binary.data()), binary.size());
+    if (!in) return nullptr;
+
+    // The driver may still reject the binary (e.g. after an in-place driver update)
+    const unsigned char* data = binary.data();
+    size_t size = binary.size();
+    cl_int binary_status = CL_SUCCESS, err = CL_SUCCESS;
+    cl_program program = clCreateProgramWithBinary(context, 1, &device.device, &size, &data, &binary_status, &err);
+    if (err == CL_SUCCESS && binary_status == CL_SUCCESS)
+        err = clBuildProgram(program, 1, &device.device, options.c_str(), nullptr, nullptr);
+    if (err != CL_SUCCESS || binary_status != CL_SUCCESS) {
+        spdlog::warn("OpenCL rejected cached binary {} (error {}); rebuilding from source", path, err);
+        if (program) clReleaseProgram(program);
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        return nullptr;
+    }
+    return program;
+}
+
+void ProgramCache::store(cl_program program, uint64_t key) {
+    size_t size = 0;
+    if (clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, sizeof(size), &size, nullptr) != CL_SUCCESS || size == 0)
+        return;
+    std::vector<unsigned char> binary(size);
+    unsigned char* data = binary.data();
+    if (clGetProgramInfo(program, CL_PROGRAM_BINARIES, sizeof(data), &data, nullptr) != CL_SUCCESS)
+        return;
+
+    EntryHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.key = key;
+    header.binary_size = size;
+
+    // Write then rename, so concurrent processes never read a partial entry
+    std::string path = entry_path(key);
+    std::string tmp = path + ".tmp." + std::to_string(getpid());
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        if (!out) return;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+        if (!out) return;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) std::filesystem::remove(tmp, ec);
+}
@@ -0,0 +1,915 @@
+#include "othello/agent_server.hpp"
+#include "opencl/network_evaluator.hpp"
+#include "othello/greedy_evaluator.hpp"
+#include "othello/mcts.hpp"
+#include "othello/network_evaluator.hpp"
+#include "othello/pattern_evaluator.hpp"
+#include "othello/shm_channel.hpp"
+#include "othello/trace.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+namespace othello {
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t micros_between(Clock::time_point start, Clock::time_point end) {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        return us > 0 ? static_cast<uint64_t>(us) : 0;
+    }
+
+    // epoll tokens besides session ids (which start at 1)
+    constexpr uint64_t kListenToken = 0;
+    constexpr uint64_t kUnixListenToken = ~0ULL - 1;
+    constexpr uint64_t kWakeToken = ~0ULL;
+    constexpr uint64_t kDoorbellBit = 1ULL << 62;   // session id | bit: its shm doorbell
+
+    // Clients wait for each reply before moving again, so a longer queue is a protocol violation
+    constexpr size_t kMaxQueuedMoves = 8;
+
+    // Broker backend following the registry: the model switches between batches, on the
+    // dispatcher thread, since searches no longer own their evaluator
+    class LatestModelBackend : public BatchEvaluator {
+    public:
+        explicit LatestModelBackend(const nn::ModelRegistry& registry) : network_(registry) {}
+
+        void evaluate_batch(const float* inputs, int n, float* policies, float* values) override {
+            network_.refresh();
+            network_.evaluate_batch(inputs, n, policies, values);
+        }
+
+        int max_batch_size() const override { return network_.max_batch_size(); }
+
+    private:
+        RegistryEvaluator network_;
+    };
+
+    // The same on an OpenCL device. Its pipeline keeps two batches in flight, so the broker
+    // gathers the next batch while one runs. A new model is uploaded between batches, once
+    // nothing is in flight. Host time blocked on the device goes to `device_wait_us`.
+    class LatestModelOpenCLBackend : public AsyncBatchEvaluator {
+    public:
+        LatestModelOpenCLBackend(const nn::ModelRegistry& registry, int max_batch, metrics::Histogram& device_wait_us)
+            : registry_(registry), max_batch_(max_batch), device_wait_us_(device_wait_us), network_(registry.current()),
+              device_(std::make_unique<OpenCLEvaluator>(context_, *network_, max_batch)) {
+            spdlog::info("Batches run on OpenCL device {}", context_.device_info().name);
+        }
+
+        uint64_t submit_batch(const float* inputs, int n) override {
+            if (device_->in_flight() == 0) upload_latest();
+            return device_->submit_batch(inputs, n);
+        }
+
+        void collect(uint64_t ticket, float* policies, float* values) override {
+            const double stalled = device_->stats().stall_seconds;
+            device_->collect(ticket, policies, values);
+            device_wait_us_.record(static_cast<uint64_t>((device_->stats().stall_seconds - stalled) * 1e6));
+        }
+
+        int depth() const override { return device_->depth(); }
+        int max_batch_size() const override { return max_batch_; }
+
+    private:
+        const nn::ModelRegistry& registry_;
+        const int max_batch_;
+        metrics::Histogram& device_wait_us_;
+        OpenCLContext context_;
+        std::shared_ptr<const nn::Network> network_;   // the model on the device
+        std::unique_ptr<OpenCLEvaluator> device_;
+
+        void upload_latest() {
+            auto latest = registry_.current();
+            if (latest == network_) return;
+            try {
+                device_ = std::make_unique<OpenCLEvaluator>(context_, *latest, max_batch_);
+            } catch (const std::exception& e) {
+                spdlog::error("Keeping the previous model on the OpenCL device: {}", e.what());
+            }
+            network_ = std::move(latest);   // either way, do not retry this model every batch
+        }
+    };
+
+    void watch(int epoll_fd, int op, int fd, uint32_t events, uint64_t token) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.u64 = token;
+        if (epoll_ctl(epoll_fd, op, fd, &ev) != 0)
+            throw std::runtime_error(fmt::format("epoll_ctl failed: {}", std::strerror(errno)));
+    }
+} // Anonymous namespace
+
+struct AgentServer::Session {
+    enum class State { AwaitSide, Idle, Searching };
+
+    uint64_t id = 0;
+    int fd = -1;
+    bool unix_socket = false;
+    State state = State::AwaitSide;
+    bool closed = false;
+    bool want_write = false;
+
+    protocol::FrameReader in;       // received, not yet handled
+    std::string out;                // replies not yet accepted by the socket
+    size_t out_sent = 0;
+
+    // Shared-memory transport, once attached: frames go through the channel's rings
+    shm::Channel* shm = nullptr;
+    int doorbell_fd = -1;
+    std::vector<int> passed_fds;    // SCM_RIGHTS fds awaiting their ShmAttach
+
+    Player side = Player::BLACK;
+    OthelloBoard board;
+    std::unique_ptr<Evaluator> evaluator;
+    RegistryEvaluator* network = nullptr;   // evaluator, when it is registry-backed
+    std::unique_ptr<MCTS> mcts;
+    bool tree_synced = false;       // the MCTS root follows `board`
+
+    Clock::time_point received;     // arrival of the move being answered
+
+    // Moves that arrived during a search, answered in order once it finishes
+    struct QueuedMove {
+        std::vector<uint8_t> payload;
+        Clock::time_point received;
+    };
+    std::deque<QueuedMove> queued_moves;
+    uint64_t budget_us = 0;         // time budget of the current search, 0: none
+
+    // This game's share of the server-wide metrics, for the log line when it closes
+    uint64_t moves = 0;
+    uint64_t book_moves = 0;
+    metrics::Histogram think_us;
+    metrics::Histogram response_us;
+};
+
+struct AgentServer::Metrics {
+    explicit Metrics(metrics::Registry& r)
+        : sessions(r.counter("othello_sessions_total", "Client connections accepted")),
+          active(r.gauge("othello_sessions_active", "Client connections open")),
+          shm_sessions(r.counter("othello_shm_sessions_total", "Connections switched to shared memory")),
+          session_moves(r.histogram("othello_session_moves", "Replies sent per closed session")),
+          search_moves(r.counter("othello_moves_total", "Replies sent", "source=\"search\"")),
+          book_moves(r.counter("othello_moves_total", "Replies sent", "source=\"book\"")),
+          pass_moves(r.counter("othello_moves_total", "Replies sent", "source=\"pass\"")),
+          response_us(r.histogram("othello_move_response_seconds", "Opponent move received to reply queued", 1e-6)),
+          think_us(r.histogram("othello_search_seconds", "Search time per searched move", 1e-6)),
+          simulations(r.counter("othello_search_simulations_total", "MCTS simulations of searched moves")),
+          simulations_per_second(r.histogram("othello_search_simulations_per_second",
+                                             "Simulation rate per searched move")),
+          tree_nodes(r.histogram("othello_search_tree_nodes", "Search tree size after each searched move")),
+          eval_ns(r.histogram("othello_evaluator_seconds", "Latency of one position evaluation", 1e-9)),
+          budget_us(r.histogram("othello_move_budget_seconds", "Time budget given to each searched move", 1e-6)),
+          budget_used_percent(r.histogram("othello_move_budget_used_percent",
+                                          "Search time as a percentage of its budget")),
+          budget_overruns(r.counter("othello_move_budget_overruns_total", "Searches that ran past their budget")),
+          pings(r.counter("othello_pings_total", "Pings answered")),
+          analyzed(r.counter("othello_analyzed_positions_total", "Positions searched for Analyze requests")),
+          analyze_us(r.histogram("othello_analyze_seconds", "Search time per Analyze batch", 1e-6)),
+          device_wait_us(r.histogram("othello_broker_device_wait_seconds",
+                                     "Broker blocked on the OpenCL device per collected batch", 1e-6)) {}
+
+    metrics::Counter& sessions;
+    metrics::Gauge& active;
+    metrics::Counter& shm_sessions;
+    metrics::Histogram& session_moves;
+    metrics::Counter& search_moves;
+    metrics::Counter& book_moves;
+    metrics::Counter& pass_moves;
+    metrics::Histogram& response_us;
+    metrics::Histogram& think_us;
+    metrics::Counter& simulations;
+    metrics::Histogram& simulations_per_second;
+    metrics::Histogram& tree_nodes;
+    metrics::Histogram& eval_ns;
+    metrics::Histogram& budget_us;
+    metrics::Histogram& budget_used_percent;
+    metrics::Counter& budget_overruns;
+    metrics::Counter& pings;
+    metrics::Counter& analyzed;
+    metrics::Histogram& analyze_us;
+    metrics::Histogram& device_wait_us;
+};
+
+AgentServer::AgentServer(const AgentServerConfig& config, nn::ModelRegistry* registry, const OpeningBook* book,
+                         metrics::Registry* metrics)
+    : config_(config), registry_(registry), book_(book)
+{
+    if (config_.workers <= 0) config_.workers = std::max(1u, std::thread::hardware_concurrency());
+    if (!metrics) {
+        own_metrics_ = std::make_unique<metrics::Registry>();
+        metrics = own_metrics_.get();
+    }
+    metrics_ = std::make_unique<Metrics>(*metrics);
+    if (registry_ && config_.batch_size > 1) {
+        if (config_.opencl)
+            broker_backend_ = std::make_unique<LatestModelOpenCLBackend>(*registry_, config_.batch_size,
+                                                                         metrics_->device_wait_us);
+        else
+            broker_backend_ = std::make_unique<LatestModelBackend>(*registry_);
+        BrokerConfig broker_config;
+        broker_config.max_batch = config_.batch_size;
+        broker_config.max_wait = std::chrono::microseconds(config_.batch_wait_us);
+        broker_ = std::make_unique<InferenceBroker>(*broker_backend_, broker_config, metrics);
+    }
+    if (!registry_ && !config_.pattern_weights.empty()) {
+        patterns_ = std::make_unique<PatternEvaluator>();
+        patterns_->load(config_.pattern_weights);
+    }
+
+    // Step 1: non-blocking listening socket
+    listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) throw std::runtime_error(fmt::format("socket failed: {}", std::strerror(errno)));
+    int opt = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));   // rebind right after a restart
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = INADDR_ANY;
+    address.sin_port = htons(static_cast<uint16_t>(config_.port));
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        listen(listen_fd_, SOMAXCONN) < 0) {
+        std::string error = std::strerror(errno);
+        close(listen_fd_);
+        throw std::runtime_error(fmt::format("Failed to listen on port {}: {}", config_.port, error));
+    }
+    socklen_t len = sizeof(address);
+    getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address), &len);
+    port_ = ntohs(address.sin_port);
+
+    // Step 2: epoll set with the listener and the wakeup eventfd. From here on a failure closes
+    // every descriptor opened so far, since the destructor will not run.
+    try {
+        epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+        wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epoll_fd_ < 0 || wake_fd_ < 0)
+            throw std::runtime_error(fmt::format("Failed to set up epoll: {}", std::strerror(errno)));
+        watch(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, EPOLLIN, kListenToken);
+        watch(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, EPOLLIN, kWakeToken);
+
+        // Step 3: optional Unix socket for same-host clients, replacing a stale one
+        if (!config_.unix_path.empty()) {
+            sockaddr_un unix_address{};
+            unix_address.sun_family = AF_UNIX;
+            if (config_.unix_path.size() >= sizeof(unix_address.sun_path))
+                throw std::runtime_error(fmt::format("Failed to listen on {}: path too long", config_.unix_path));
+            std::memcpy(unix_address.sun_path, config_.unix_path.c_str(), config_.unix_path.size() + 1);
+            unlink(config_.unix_path.c_str());
+            unix_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (unix_fd_ < 0 ||
+                bind(unix_fd_, reinterpret_cast<sockaddr*>(&unix_address), sizeof(unix_address)) != 0 ||
+                listen(unix_fd_, SOMAXCONN) != 0) {
+                std::string error = std::strerror(errno);
+                throw std::runtime_error(fmt::format("Failed to listen on {}: {}", config_.unix_path, error));
+            }
+            watch(epoll_fd_, EPOLL_CTL_ADD, unix_fd_, EPOLLIN, kUnixListenToken);
+        }
+    } catch (...) {
+        if (unix_fd_ >= 0) {
+            close(unix_fd_);
+            unlink(config_.unix_path.c_str());
+        }
+        for (int fd : {wake_fd_, epoll_fd_, listen_fd_})
+            if (fd >= 0) close(fd);
+        throw;
+    }
+}
+
+AgentServer::~AgentServer() {
+    for (auto& [id, session] : sessions_) close(session->fd);
+    if (unix_fd_ >= 0) {
+        close(unix_fd_);
+        unlink(config_.unix_path.c_str());
+    }
+    close(wake_fd_);
+    close(epoll_fd_);
+    close(listen_fd_);
+}
+
+void AgentServer::stop() {
+    stopping_.store(true);
+    uint64_t one = 1;
+    ssize_t ignored = write(wake_fd_, &one, sizeof(one));
+    (void)ignored;
+}
+
+void AgentServer::request_reload() {
+    reload_.store(true);
+}
+
+AgentServerStats AgentServer::stats() const {
+    AgentServerStats stats;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats = stats_;
+    }
+    stats.totals.think_us = metrics_->think_us.snapshot();
+    stats.totals.response_us = metrics_->response_us.snapshot();
+    return stats;
+}
+
+void AgentServer::run() {
+    trace::set_thread_name("event loop");
+    spdlog::info("Agent server listening on port {} ({} search threads)", port_, config_.workers);
+    workers_stopping_ = false;
+    for (int t = 0; t < config_.workers; ++t) workers_.emplace_back(&AgentServer::worker_loop, this, t);
+
+    epoll_event events[64];
+    while (!stopping_.load()) {
+        int n = epoll_wait(epoll_fd_, events, 64, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            spdlog::error("epoll_wait failed: {}", std::strerror(errno));
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            const uint64_t token = events[i].data.u64;
+            if (token == kListenToken) {
+                accept_clients(listen_fd_);
+            } else if (token == kUnixListenToken) {
+                accept_clients(unix_fd_);
+            } else if (token == kWakeToken) {
+                uint64_t count;
+                while (read(wake_fd_, &count, sizeof(count)) > 0) {}
+                finish_searches();
+            } else {
+                // A session closed earlier in this batch leaves stale events behind
+                auto it = sessions_.find(token & ~kDoorbellBit);
+                if (it == sessions_.end()) continue;
+                std::shared_ptr<Session> session = it->second;
+                if (token & kDoorbellBit) {
+                    read_shm(session);
+                    continue;
+                }
+                if (events[i].events & EPOLLOUT) flush(*session);
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) read_client(session);
+            }
+        }
+    }
+
+    // Let queued searches finish, answer them, then hang up on everyone
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex_);
+        workers_stopping_ = true;
+    }
+    jobs_cv_.notify_all();
+    for (auto& worker : workers_) worker.join();
+    workers_.clear();
+    finish_searches();
+    while (!sessions_.empty()) close_session(sessions_.begin()->second, "server stopping");
+    spdlog::info("Agent server stopped");
+}
+
+void AgentServer::accept_clients(int listen_fd) {
+    const bool unix_socket = listen_fd == unix_fd_;
+    while (true) {
+        sockaddr_in peer{};
+        socklen_t len = sizeof(peer);
+        sockaddr* peer_address = unix_socket ? nullptr : reinterpret_cast<sockaddr*>(&peer);
+        int fd = accept4(listen_fd, peer_address, unix_socket ? nullptr : &len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) spdlog::warn("accept failed: {}", std::strerror(errno));
+            return;
+        }
+
+        // Replies are small and latency-bound
+        int nodelay = 1;
+        if (!unix_socket) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+        auto session = std::make_shared<Session>();
+        session->id = next_id_++;
+        session->fd = fd;
+        session->unix_socket = unix_socket;
+        watch(epoll_fd_, EPOLL_CTL_ADD, fd, EPOLLIN, session->id);
+        sessions_[session->id] = session;
+        {
+            std::lock_guard<std::mutex> lock(stats_mutex_);
+            ++stats_.sessions;
+            ++stats_.active;
+        }
+        metrics_->sessions.add();
+        metrics_->active.add(1);
+
+        if (unix_socket) {
+            spdlog::info("Session {}: connected on {}", session->id, config_.unix_path);
+            continue;
+        }
+        char host[INET_ADDRSTRLEN] = "?";
+        inet_ntop(AF_INET, &peer.sin_addr, host, sizeof(host));
+        spdlog::info("Session {}: connected from {}:{}", session->id, host, ntohs(peer.sin_port));
+    }
+}
+
+void AgentServer::read_client(const std::shared_ptr<Session>& session) {
+    // Level-triggered, but drain anyway so one wakeup handles a burst
+    while (true) {
+        uint8_t* dst = session->in.write_ptr();
+        if (session->in.write_space() == 0) {
+            close_session(session, "input overflow");   // only a client ignoring our replies gets here
+            return;
+        }
+
+        // Unix clients may pass fds (ShmAttach); collect them alongside the bytes
+        iovec iov{dst, session->in.write_space()};
+        alignas(cmsghdr) char control[CMSG_SPACE(4 * sizeof(int))];
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        if (session->unix_socket) {
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+        }
+        ssize_t bytes = recvmsg(session->fd, &msg, MSG_CMSG_CLOEXEC);
+        cmsghdr* c = (bytes > 0 && msg.msg_controllen) ? CMSG_FIRSTHDR(&msg) : nullptr;
+        for (; c; c = CMSG_NXTHDR(&msg, c)) {
+            if (c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_RIGHTS) continue;
+            const size_t count = (c->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            for (size_t k = 0; k < count; ++k) {
+                int passed;
+                std::memcpy(&passed, CMSG_DATA(c) + k * sizeof(int), sizeof(int));
+                session->passed_fds.push_back(passed);
+            }
+        }
+        if (bytes > 0) {
+            session->in.commit(static_cast<size_t>(bytes));
+            continue;
+        }
+        if (bytes == 0) {
+            close_session(session, "client disconnected");
+            return;
+        }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        close_session(session, std::strerror(errno));
+        return;
+    }
+    process_input(session);
+}
+
+void AgentServer::attach_shm(const std::shared_ptr<Session>& session) {
+    Session& s = *session;
+    if (!s.unix_socket || s.shm || s.passed_fds.size() != 2) {
+        close_session(session, "bad shm attach");
+        return;
+    }
+    s.shm = shm::map_channel(s.passed_fds[0]);
+    close(s.passed_fds[0]);   // the mapping keeps the memory alive
+    s.doorbell_fd = s.passed_fds[1];
+    s.passed_fds.clear();
+    if (!s.shm) {
+        close(s.doorbell_fd);
+        close_session(session, "bad shm channel");
+        return;
+    }
+    fcntl(s.doorbell_fd, F_SETFL, fcntl(s.doorbell_fd, F_GETFL) | O_NONBLOCK);   // the client made it blocking
+    watch(epoll_fd_, EPOLL_CTL_ADD, s.doorbell_fd, EPOLLIN, s.id | kDoorbellBit);
+    metrics_->shm_sessions.add();
+    spdlog::info("Session {}: switched to shared memory", s.id);
+}
+
+void AgentServer::read_shm(const std::shared_ptr<Session>& session) {
+    Session& s = *session;
+    uint64_t count;
+    while (read(s.doorbell_fd, &count, sizeof(count)) > 0) {}
+
+    // The doorbell also means the client made room for replies we could not fit
+    flush(s);
+
+    shm::Ring& ring = s.shm->to_engine;
+    while (!ring.empty()) {
+        uint8_t* dst = s.in.write_ptr();
+        if (s.in.write_space() == 0) {
+            close_session(session, "input overflow");
+            return;
+        }
+        s.in.commit(ring.read(dst, s.in.write_space()));
+    }
+    if (ring.writer_waiting.exchange(0)) shm::futex_wake(ring.tail);
+    process_input(session);
+}
+
+void AgentServer::process_input(const std::shared_ptr<Session>& session) {
+    protocol::Frame frame;
+    while (!session->closed) {
+        protocol::FrameReader::Status status = session->in.peek(frame);
+        if (status == protocol::FrameReader::NeedMore) return;
+        if (status == protocol::FrameReader::Invalid) {
+            close_session(session, "oversized frame");
+            return;
+        }
+        handle_frame(session, frame);
+        if (!session->closed) session->in.pop();
+    }
+}
+
+void AgentServer::handle_frame(const std::shared_ptr<Session>& session, const protocol::Frame& frame) {
+    using protocol::MessageType;
+    Session& s = *session;
+    protocol::PayloadReader in(frame);
+
+    switch (frame.type) {
+    case MessageType::Hello: {
+        // Our side; sets up the session's search
+        uint8_t version = in.u8();
+        uint8_t side = in.u8();
+        if (!in.ok() || version != protocol::kVersion || side > 1 || s.state != Session::State::AwaitSide) {
+            close_session(session, "bad hello");
+            return;
+        }
+        s.side = side ? Player::WHITE : Player::BLACK;
+        s.evaluator = make_evaluator(&s.network);
+        s.mcts = std::make_unique<MCTS>(*s.evaluator, config_.simulations, config_.c_puct);
+        s.mcts->set_log_stats(false);   // per-move lines of concurrent games would interleave
+        s.state = Session::State::Idle;
+        spdlog::info("Session {}: playing {}", s.id, s.side == Player::BLACK ? "Black" : "White");
+        return;
+    }
+    case MessageType::Move:
+        if (s.state == Session::State::AwaitSide) {
+            close_session(session, "move before hello");
+            return;
+        }
+        // Moves are answered in order, so one arriving mid-search waits for it; frames behind
+        // it (pings, analysis) are still handled right away
+        if (s.state == Session::State::Searching) {
+            if (s.queued_moves.size() >= kMaxQueuedMoves) {
+                close_session(session, "too many queued moves");
+                return;
+            }
+            s.queued_moves.push_back({std::vector<uint8_t>(frame.payload, frame.payload + frame.size), Clock::now()});
+            return;
+        }
+        handle_move(session, in, Clock::now());
+        return;
+    case MessageType::Ping: {
+        uint64_t token = in.u64();
+        protocol::FrameWriter pong(MessageType::Pong);
+        pong.u64(token);
+        send_frame(s, pong);
+        metrics_->pings.add();
+        return;
+    }
+    case MessageType::Analyze:
+        handle_analyze(session, in);
+        return;
+    case MessageType::ShmAttach:
+        attach_shm(session);
+        return;
+    default:
+        spdlog::error("Session {}: unexpected message type {}", s.id, static_cast<int>(frame.type));
+        close_session(session, "protocol error");
+        return;
+    }
+}
+
+void AgentServer::handle_move(const std::shared_ptr<Session>& session, protocol::PayloadReader& in,
+                              Clock::time_point received) {
+    Session& s = *session;
+
+    // Step 1: apply the opponent's move (-1 -1 when there is none)
+    int x = in.i8();
+    int y = in.i8();
+    int32_t ms_left = in.i32();
+    if (!in.ok()) {
+        close_session(session, "malformed move");
+        return;
+    }
+    s.received = received;
+    Move opp_move = (x >= 0 && y >= 0) ? Move{x, y} : othello::PASS;
+    if (!s.board.apply_move(opponent(s.side), opp_move)) {
+        spdlog::warn("Session {}: ignoring illegal opponent move {} {}", s.id, x, y);
+        s.tree_synced = false;
+    } else if (s.tree_synced) {
+        s.mcts->apply_move_to_root(opp_move);   // keep the subtree below the opponent's move
+    }
+
+    // Step 2: passes and book moves are answered right here
+    if (!s.board.has_valid_move(s.side)) {
+        reply(s, othello::PASS, false);
+        return;
+    }
+    if (book_) {
+        if (std::optional<Move> move = book_->probe(s.board, s.side)) {
+            reply(s, *move, true);
+            return;
+        }
+    }
+
+    // Step 3: everything else is searched on the pool, within an even share of the clock over
+    // our remaining moves (two held in reserve) when the client sent one
+    if (!s.tree_synced) {
+        s.mcts->set_root(s.board, s.side);
+        s.tree_synced = true;
+    }
+    const int empties = 64 - s.board.count_disks(Player::BLACK) - s.board.count_disks(Player::WHITE);
+    s.budget_us = ms_left > 0 ? static_cast<uint64_t>(ms_left) * 1000 / ((empties + 1) / 2 + 2) : 0;
+    s.mcts->set_time_limit(s.budget_us / 1e6);
+    s.state = Session::State::Searching;
+    Job job;
+    job.session = session;
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex_);
+        jobs_.push_back(std::move(job));
+    }
+    jobs_cv_.notify_one();
+}
+
+void AgentServer::handle_analyze(const std::shared_ptr<Session>& session, protocol::PayloadReader& in) {
+    Job job;
+    job.session = session;
+    job.analysis = true;
+    job.analysis_id = in.u32();
+    const int count = in.u16();
+    if (!in.ok() || count > protocol::kMaxAnalyzeBatch || in.remaining() != count * protocol::kAnalyzeEntryBytes) {
+        close_session(session, "malformed analyze request");
+        return;
+    }
+    job.positions.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        uint64_t black = in.u64();
+        uint64_t white = in.u64();
+        Player side = in.u8() ? Player::WHITE : Player::BLACK;
+        if (black & white) {
+            close_session(session, "overlapping bitboards");
+            return;
+        }
+        job.positions.push_back({OthelloBoard(black, white, side), side});
+    }
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex_);
+        jobs_.push_back(std::move(job));
+    }
+    jobs_cv_.notify_one();
+}
+
+void AgentServer::worker_loop(int index) {
+    trace::set_thread_name(fmt::format("search worker {}", index));
+
+    // Analysis has no session tree to reuse; each worker keeps one search for it
+    std::unique_ptr<metrics::TimedEvaluator> analysis_evaluator;
+    std::unique_ptr<MCTS> analysis_mcts;
+
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(jobs_mutex_);
+            jobs_cv_.wait(lock, [&] { return workers_stopping_ || !jobs_.empty(); });
+            if (jobs_.empty()) return;
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        // The event loop leaves a searching session's board and tree alone
+        Session& s = *job.session;
+        Completion done;
+        done.session = job.session;
+        done.analysis = job.analysis;
+        done.analysis_id = job.analysis_id;
+        try {
+            // Swap in a new model between moves, never during a search
+            if (registry_) registry_->poll(reload_.exchange(false));
+            auto start = Clock::now();
+            if (job.analysis) {
+                search_analysis(job, done, analysis_evaluator, analysis_mcts);
+            } else {
+                if (s.network && s.network->refresh())
+                    spdlog::info("Session {}: using model generation {}", s.id, registry_->generation());
+                // Searches on other workers meanwhile land in the same capture, on their own tracks
+                const bool traced = searches_.fetch_add(1) + 1 == config_.trace_move && !config_.trace_path.empty();
+                if (traced) trace::start();
+                s.mcts->run();
+                if (traced) {
+                    trace::stop();
+                    trace::write_chrome_json(config_.trace_path);
+                }
+                done.move = s.mcts->best_move();
+                done.simulations = s.mcts->last_simulations();
+            }
+            done.think_us = micros_between(start, Clock::now());
+            if (!job.analysis) done.tree_nodes = s.mcts->tree_size();   // not part of the think time
+        } catch (const std::exception& e) {
+            spdlog::error("Session {}: search failed: {}", s.id, e.what());
+            done.failed = true;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(done_mutex_);
+            done_.push_back(std::move(done));
+        }
+        uint64_t one = 1;
+        ssize_t ignored = write(wake_fd_, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+std::unique_ptr<metrics::TimedEvaluator> AgentServer::make_evaluator(RegistryEvaluator** network) {
+    // Registry-backed evaluators are the session's own unless a broker batches them
+    std::unique_ptr<Evaluator> evaluator;
+    *network = nullptr;
+    if (broker_) {
+        evaluator = std::make_unique<BrokerEvaluator>(*broker_);
+    } else if (registry_) {
+        auto registry_evaluator = std::make_unique<RegistryEvaluator>(*registry_);
+        *network = registry_evaluator.get();
+        evaluator = std::move(registry_evaluator);
+    } else if (patterns_) {
+        evaluator = std::make_unique<PatternEvaluator>(*patterns_);
+    } else {
+        evaluator = std::make_unique<GreedyEvaluator>();
+    }
+    return std::make_unique<metrics::TimedEvaluator>(std::move(evaluator), metrics_->eval_ns);
+}
+
+void AgentServer::search_analysis(Job& job, Completion& done, std::unique_ptr<metrics::TimedEvaluator>& evaluator,
+                                  std::unique_ptr<MCTS>& mcts) {
+    if (!evaluator) {
+        RegistryEvaluator* network;
+        evaluator = make_evaluator(&network);
+        mcts = std::make_unique<MCTS>(*evaluator, config_.simulations, config_.c_puct);
+        mcts->set_log_stats(false);
+    }
+    if (auto* network = dynamic_cast<RegistryEvaluator*>(&evaluator->inner())) network->refresh();
+
+    done.results.reserve(job.positions.size());
+    for (const AnalyzePosition& position : job.positions) {
+        if (position.board.is_game_over() || !position.board.has_valid_move(position.side)) {
+            done.results.push_back({othello::PASS, 0.0f});
+            continue;
+        }
+        mcts->set_root(position.board, position.side);
+        mcts->run();
+        done.results.push_back({mcts->best_move(), mcts->root_value()});
+    }
+}
+
+void AgentServer::finish_searches() {
+    std::vector<Completion> finished;
+    {
+        std::lock_guard<std::mutex> lock(done_mutex_);
+        finished.swap(done_);
+    }
+    for (Completion& done : finished) {
+        Session& s = *done.session;
+        if (s.closed) continue;   // the client left mid-search
+        if (done.failed) {
+            close_session(done.session, "search failed");
+            continue;
+        }
+
+        if (done.analysis) {
+            protocol::FrameWriter analysis(protocol::MessageType::Analysis);
+            analysis.u32(done.analysis_id).u16(static_cast<uint16_t>(done.results.size()));
+            for (const auto& [move, value] : done.results)
+                analysis.i8(static_cast<int8_t>(move.x)).i8(static_cast<int8_t>(move.y)).f32(value);
+            send_frame(s, analysis);
+            metrics_->analyzed.add(done.results.size());
+            metrics_->analyze_us.record(done.think_us);
+            spdlog::info("Session {}: analysed {} positions in {:.1f} ms", s.id, done.results.size(),
+                         done.think_us / 1000.0);
+            continue;
+        }
+
+        s.state = Session::State::Idle;
+        s.think_us.record(done.think_us);
+        metrics_->think_us.record(done.think_us);
+        metrics_->simulations.add(static_cast<uint64_t>(done.simulations));
+        metrics_->simulations_per_second.record(done.simulations * 1000000ULL / std::max<uint64_t>(done.think_us, 1));
+        metrics_->tree_nodes.record(done.tree_nodes);
+        if (s.budget_us) {
+            metrics_->budget_us.record(s.budget_us);
+            metrics_->budget_used_percent.record(done.think_us * 100 / s.budget_us);
+            if (done.think_us > s.budget_us) metrics_->budget_overruns.add();
+        }
+        spdlog::info("Session {}: {} {} after {} simulations in {:.1f} ms", s.id, done.move.x, done.move.y,
+                     done.simulations, done.think_us / 1000.0);
+        reply(s, done.move, false);
+
+        // Moves queued behind the search; book moves and passes are answered without one
+        while (!s.closed && s.state == Session::State::Idle && !s.queued_moves.empty()) {
+            Session::QueuedMove next = std::move(s.queued_moves.front());
+            s.queued_moves.pop_front();
+            protocol::Frame frame{protocol::MessageType::Move, next.payload.data(), next.payload.size()};
+            protocol::PayloadReader in(frame);
+            handle_move(done.session, in, next.received);
+        }
+        process_input(done.session);
+    }
+}
+
+void AgentServer::reply(Session& s, const Move& move, bool book_move) {
+    s.board.apply_move(s.side, move);
+    if (s.tree_synced) s.mcts->apply_move_to_root(move);
+
+    const uint64_t response_us = micros_between(s.received, Clock::now());
+    ++s.moves;
+    s.response_us.record(response_us);
+    if (book_move) ++s.book_moves;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        ++stats_.totals.moves;
+        if (book_move) ++stats_.totals.book_moves;
+    }
+    metrics_->response_us.record(response_us);
+    if (book_move) metrics_->book_moves.add();
+    else if (move == othello::PASS) metrics_->pass_moves.add();
+    else metrics_->search_moves.add();
+    if (book_move) spdlog::info("Session {}: book move {} {}", s.id, move.x, move.y);
+
+    protocol::FrameWriter frame(protocol::MessageType::Reply);
+    frame.i8(static_cast<int8_t>(move.x)).i8(static_cast<int8_t>(move.y));
+    send_frame(s, frame);
+}
+
+void AgentServer::send_frame(Session& s, protocol::FrameWriter& frame) {
+    s.out.append(reinterpret_cast<const char*>(frame.data()), frame.size());
+    flush(s);
+}
+
+void AgentServer::flush(Session& s) {
+    if (s.shm) {
+        // Whatever does not fit waits for the client's doorbell after it reads
+        shm::Ring& ring = s.shm->to_client;
+        for (int attempt = 0; attempt < 2 && s.out_sent < s.out.size(); ++attempt) {
+            const auto* data = reinterpret_cast<const uint8_t*>(s.out.data());
+            s.out_sent += ring.write(data + s.out_sent, s.out.size() - s.out_sent);
+            if (ring.reader_waiting.load()) shm::futex_wake(ring.head);
+            if (s.out_sent < s.out.size()) ring.writer_waiting.store(1);   // then retry once
+        }
+        if (s.out_sent == s.out.size()) {
+            s.out.clear();
+            s.out_sent = 0;
+        }
+        return;
+    }
+
+    while (s.out_sent < s.out.size()) {
+        ssize_t bytes = send(s.fd, s.out.data() + s.out_sent, s.out.size() - s.out_sent, MSG_NOSIGNAL);
+        if (bytes > 0) {
+            s.out_sent += static_cast<size_t>(bytes);
+            continue;
+        }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // Finish when the socket drains
+            if (!s.want_write) watch(epoll_fd_, EPOLL_CTL_MOD, s.fd, EPOLLIN | EPOLLOUT, s.id);
+            s.want_write = true;
+            return;
+        }
+        // Broken connection: the read side reports it and closes the session
+        shutdown(s.fd, SHUT_RDWR);
+        return;
+    }
+    s.out.clear();   // keeps its capacity, so steady-state replies do not allocate
+    s.out_sent = 0;
+    if (s.want_write) watch(epoll_fd_, EPOLL_CTL_MOD, s.fd, EPOLLIN, s.id);
+    s.want_write = false;
+}
+
+void AgentServer::close_session(const std::shared_ptr<Session>& session, const char* reason) {
+    std::shared_ptr<Session> keep = session;   // `session` may be the map entry erased below
+    Session& s = *keep;
+    if (s.closed) return;
+    s.closed = true;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, s.fd, nullptr);
+    close(s.fd);
+    if (s.shm) {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, s.doorbell_fd, nullptr);
+        close(s.doorbell_fd);
+        shm::unmap_channel(s.shm);
+        s.shm = nullptr;
+    }
+    for (int fd : s.passed_fds) close(fd);
+    s.passed_fds.clear();
+    sessions_.erase(s.id);
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        --stats_.active;
+    }
+    metrics_->active.add(-1);
+    if (s.state != Session::State::AwaitSide) metrics_->session_moves.record(s.moves);
+    spdlog::info("Session {}: closed ({}) after {} moves ({} from book), think mean {:.1f} ms, "
+                 "response p99 < {:.1f} ms", s.id, reason, s.moves, s.book_moves,
+                 s.think_us.snapshot().mean() / 1000.0, s.response_us.snapshot().percentile(0.99) / 1000.0);
+}
+
+} // namespace othello
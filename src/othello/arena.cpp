@@ -0,0 +1,275 @@
+#include "othello/arena.hpp"
+#include "othello/mcts.hpp"
+#include "othello/symmetry.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+namespace othello {
+
+namespace {
+    constexpr double kZ95 = 1.959964;
+
+    void expand_openings(const OthelloBoard& board, Player player, std::vector<Move>& line, int plies,
+                         std::set<std::tuple<uint64_t, uint64_t, int>>& seen, std::vector<Opening>& out) {
+        if (board.is_game_over()) return;
+        if (!board.has_valid_move(player)) {
+            line.push_back(othello::PASS);   // a pass is not a ply
+            expand_openings(board, opponent(player), line, plies, seen, out);
+            line.pop_back();
+            return;
+        }
+        if (plies == 0) {
+            uint64_t own = board.bits(player), opp = board.bits(opponent(player));
+            symmetry::canonical(own, opp);
+            if (seen.emplace(own, opp, player == Player::BLACK ? 0 : 1).second) out.push_back({board, player, line});
+            return;
+        }
+        for (const Move& m : board.get_valid_moves(player)) {
+            line.push_back(m);
+            expand_openings(board.apply_move_copy(player, m), opponent(player), line, plies - 1, seen, out);
+            line.pop_back();
+        }
+    }
+} // Anonymous namespace
+
+double SprtConfig::lower_bound() const {
+    return std::log(beta / (1.0 - alpha));
+}
+
+double SprtConfig::upper_bound() const {
+    return std::log((1.0 - beta) / alpha);
+}
+
+double elo_to_score(double elo) {
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+double score_to_elo(double score) {
+    score = std::clamp(score, 1e-6, 1.0 - 1e-6);
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+double MatchScore::score() const {
+    return games() ? (wins + 0.5 * draws) / games() : 0.5;
+}
+
+double MatchScore::elo() const {
+    return score_to_elo(score());
+}
+
+double MatchScore::elo_error() const {
+    const uint64_t n = games();
+    if (n == 0) return 0.0;
+    const double s = score();
+    const double variance = (wins * (1.0 - s) * (1.0 - s) + draws * (0.5 - s) * (0.5 - s) + losses * s * s) / n;
+    const double margin = kZ95 * std::sqrt(variance / n);
+    return (score_to_elo(s + margin) - score_to_elo(s - margin)) / 2.0;
+}
+
+double MatchScore::llr(double elo0, double elo1) const {
+    // Normal approximation of the trinomial GSPRT: LLR = N (s1 - s0)(2s - s0 - s1) / (2 var).
+    // The variance gets half a game of each outcome, so a one-sided start (all wins) still
+    // has a finite, conservative LLR.
+    const uint64_t n = games();
+    if (n == 0) return 0.0;
+    const double s = score();
+    const double w = wins + 0.5, d = draws + 0.5, l = losses + 0.5;
+    const double variance = (w * (1.0 - s) * (1.0 - s) + d * (0.5 - s) * (0.5 - s) + l * s * s) / (w + d + l);
+    const double s0 = elo_to_score(elo0), s1 = elo_to_score(elo1);
+    return n * (s1 - s0) * (2.0 * s - s0 - s1) / (2.0 * variance);
+}
+
+std::string ArenaResult::summary(const SprtConfig& sprt_config) const {
+    std::string text = fmt::format("{} games: +{} ={} -{} (score {:.1f}%), Elo {:+.1f} +/- {:.1f}, {:.2f} games/s",
+                                   score.games(), score.wins, score.draws, score.losses, 100.0 * score.score(),
+                                   score.elo(), score.elo_error(), games_per_second());
+    if (!sprt_config.enabled) return text;
+    const char* verdict = sprt == SprtResult::ACCEPT_H1 ? "H1 accepted" :
+                          sprt == SprtResult::ACCEPT_H0 ? "H0 accepted" : "inconclusive";
+    return text + fmt::format("; SPRT [{}, {}] LLR {:.2f} ({:.2f}, {:.2f}): {}", sprt_config.elo0, sprt_config.elo1,
+                              llr, sprt_config.lower_bound(), sprt_config.upper_bound(), verdict);
+}
+
+std::vector<Opening> generate_openings(int plies, uint32_t seed) {
+    std::vector<Opening> openings;
+    std::set<std::tuple<uint64_t, uint64_t, int>> seen;
+    std::vector<Move> line;
+    expand_openings(OthelloBoard(), Player::BLACK, line, std::max(0, plies), seen, openings);
+    std::shuffle(openings.begin(), openings.end(), std::mt19937(seed));
+    return openings;
+}
+
+std::vector<Opening> load_openings(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("Failed to open openings file " + path);
+
+    std::vector<Opening> openings;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(in, line)) {
+        ++line_number;
+        line = line.substr(0, line.find('#'));
+        line.erase(std::remove_if(line.begin(), line.end(), [](unsigned char c) { return std::isspace(c); }), line.end());
+        if (line.empty()) continue;
+        if (line.size() % 2 != 0) throw std::runtime_error(fmt::format("{}:{}: odd move string", path, line_number));
+
+        Opening opening;
+        auto skip_pass = [&] {
+            if (opening.board.has_valid_move(opening.to_move)) return;
+            opening.moves.push_back(othello::PASS);
+            opening.to_move = opponent(opening.to_move);
+        };
+        for (size_t i = 0; i < line.size(); i += 2) {
+            skip_pass();
+            int x = std::tolower(static_cast<unsigned char>(line[i])) - 'a';
+            int y = line[i + 1] - '1';
+            Move move(x, y);
+            if (x < 0 || x >= 8 || y < 0 || y >= 8 || !opening.board.apply_move(opening.to_move, move))
+                throw std::runtime_error(fmt::format("{}:{}: illegal move {}", path, line_number, line.substr(i, 2)));
+            opening.moves.push_back(move);
+            opening.to_move = opponent(opening.to_move);
+        }
+        skip_pass();
+        openings.push_back(std::move(opening));
+    }
+    return openings;
+}
+
+Arena::Arena(EngineSpec a, EngineSpec b, const ArenaConfig& config, std::vector<Opening> openings)
+    : a_(std::move(a)), b_(std::move(b)), config_(config), openings_(std::move(openings))
+{
+    if (!a_.factory || !b_.factory) throw std::invalid_argument("Arena engines need an evaluator factory");
+    if (config_.threads <= 0) config_.threads = std::max(1u, std::thread::hardware_concurrency());
+    if (openings_.empty()) openings_ = generate_openings(config_.opening_plies, config_.seed);
+    if (openings_.empty()) throw std::invalid_argument("Arena has no openings to play");
+}
+
+Player Arena::play_game(Evaluator& black_eval, const EngineSpec& black, Evaluator& white_eval,
+                        const EngineSpec& white, const Opening& opening, uint32_t seed, GameRecord* record) {
+    // Each engine keeps its own tree, advanced by both sides' moves
+    MCTS black_mcts(black_eval, black.simulations, black.c_puct);
+    MCTS white_mcts(white_eval, white.simulations, white.c_puct);
+    for (MCTS* mcts : {&black_mcts, &white_mcts}) {
+        mcts->seed(seed);
+        mcts->set_log_stats(false);
+        mcts->set_root(opening.board, opening.to_move);
+    }
+    black_mcts.set_time_limit(black.move_time);
+    white_mcts.set_time_limit(white.move_time);
+
+    OthelloBoard board = opening.board;
+    Player player = opening.to_move;
+    if (record) record->moves = opening.moves;
+    while (!board.is_game_over()) {
+        Move move = othello::PASS;
+        if (board.has_valid_move(player)) {
+            MCTS& mover = (player == Player::BLACK) ? black_mcts : white_mcts;
+            mover.run();
+            move = mover.best_move(false);
+        }
+        if (!board.apply_move(player, move)) throw std::logic_error("Engine chose an illegal move");
+        if (record) record->moves.push_back(move);
+        black_mcts.apply_move_to_root(move);
+        white_mcts.apply_move_to_root(move);
+        player = opponent(player);
+    }
+    if (record) record->winner = board.get_winner();
+    return board.get_winner();
+}
+
+ArenaResult Arena::run() {
+    ArenaResult result;
+    std::mutex mutex;
+    std::atomic<int> next_pair{0};
+    std::atomic<bool> stop{false};
+    std::exception_ptr error;
+    int pairs = (std::max(config_.max_games, 1) + 1) / 2;
+    // Searches are deterministic, so a second pair from the same opening would replay the first
+    // move for move and count the same result twice in the SPRT
+    if (pairs > static_cast<int>(openings_.size())) {
+        spdlog::warn("[Arena] Only {} openings: stopping at {} games instead of {}", openings_.size(),
+                     2 * openings_.size(), 2 * pairs);
+        pairs = static_cast<int>(openings_.size());
+    }
+    const SprtConfig& sprt = config_.sprt;
+    auto start = std::chrono::steady_clock::now();
+
+    // A pair is counted whole or not at all, so a stop between its games never leaves an
+    // unpaired result biasing the score towards whoever had the first move
+    auto record = [&](Player a_black_winner, Player a_white_winner) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (result.sprt != SprtResult::CONTINUE) return;   // decided while this pair was running
+        for (auto [winner, a_colour] :
+             {std::pair{a_black_winner, Player::BLACK}, std::pair{a_white_winner, Player::WHITE}}) {
+            if (winner == Player::NONE) ++result.score.draws;
+            else if (winner == a_colour) ++result.score.wins;
+            else ++result.score.losses;
+        }
+        ++result.a_black_games;
+
+        if (sprt.enabled) {
+            result.llr = result.score.llr(sprt.elo0, sprt.elo1);
+            if (result.llr >= sprt.upper_bound()) result.sprt = SprtResult::ACCEPT_H1;
+            else if (result.llr <= sprt.lower_bound()) result.sprt = SprtResult::ACCEPT_H0;
+            if (result.sprt != SprtResult::CONTINUE) stop.store(true);
+        }
+
+        const uint64_t games = result.score.games();
+        if (config_.report_every > 0 && games / config_.report_every != (games - 2) / config_.report_every) {
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            spdlog::info("[Arena] {} games: +{} ={} -{}, Elo {:+.1f} +/- {:.1f}, LLR {:.2f}, {:.2f} games/s", games,
+                         result.score.wins, result.score.draws, result.score.losses, result.score.elo(),
+                         result.score.elo_error(), result.llr, games / elapsed);
+        }
+    };
+
+    auto worker = [&] {
+        try {
+            std::unique_ptr<Evaluator> eval_a = a_.factory();
+            std::unique_ptr<Evaluator> eval_b = b_.factory();
+            for (int p = next_pair.fetch_add(1); p < pairs && !stop.load(); p = next_pair.fetch_add(1)) {
+                // Step 1: same opening, A as black then as white
+                const Opening& opening = openings_[p];
+                const uint32_t seed = config_.seed + static_cast<uint32_t>(p);
+                GameRecord game;
+                GameRecord* game_ptr = observer_ ? &game : nullptr;
+                Player a_black_winner = play_game(*eval_a, a_, *eval_b, b_, opening, seed, game_ptr);
+                if (observer_) observer_(game);
+                if (stop.load()) break;   // the unpaired game is dropped
+                Player a_white_winner = play_game(*eval_b, b_, *eval_a, a_, opening, seed, game_ptr);
+                if (observer_) observer_(game);
+                record(a_black_winner, a_white_winner);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) error = std::current_exception();
+            stop.store(true);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < std::min(config_.threads, pairs); ++t) threads.emplace_back(worker);
+    for (auto& t : threads) t.join();
+    if (error) std::rethrow_exception(error);
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+} // namespace othello
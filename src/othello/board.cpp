@@ -1,4 +1,5 @@
 #include "othello/board.hpp"
+#include "othello/bitboard.hpp"
 #include <vector>
 #include <algorithm>
 #include <stdexcept>
@@ -11,6 +12,12 @@ namespace {
 OthelloBoard::OthelloBoard() {
     black_ = (1ULL << othello::to_index(4, 3)) | (1ULL << othello::to_index(3, 4));
     white_ = (1ULL << othello::to_index(3, 3)) | (1ULL << othello::to_index(4, 4));
+    current_player_ = Player::BLACK;
+}
+
+OthelloBoard::OthelloBoard(uint64_t black, uint64_t white, Player to_move)
+    : black_(black), white_(white), current_player_(to_move) {
+    if (black & white) throw std::invalid_argument("Black and white bitboards overlap");
 }
 
 bool OthelloBoard::is_on_board(int x, int y) const {
@@ -29,7 +36,7 @@ bool OthelloBoard::is_valid_move(Player player, int x, int y) const {
     // Check for forced pass
     if (x == -1 && y == -1) {
         // Only valid if the player has no other legal moves
-        return get_valid_moves(player).size() == 1 && get_valid_moves(player)[0] == othello::PASS;
+        return !has_valid_move(player);
     }
 
     if (!is_on_board(x, y)) return false;
@@ -53,6 +60,11 @@ bool OthelloBoard::is_valid_move(Player player, int x, int y) const {
     return false;
 }
 
+uint64_t OthelloBoard::legal_move_mask(Player player) const {
+    return player == Player::BLACK ? othello::bitboard::legal_moves(black_, white_)
+                                   : othello::bitboard::legal_moves(white_, black_);
+}
+
 std::vector<Move> OthelloBoard::get_valid_moves(Player player) const {
     std::vector<Move> moves;
     for (int y = 0; y < 8; ++y)
@@ -147,8 +159,7 @@ int OthelloBoard::flip_disks(Player player, int x, int y) {
 }
 
 bool OthelloBoard::has_valid_move(Player player) const {
-    const auto& moves = get_valid_moves(player);
-    return !(moves.size() == 1 && moves[0] == othello::PASS);
+    return legal_move_mask(player) != 0;
 }
 
 bool OthelloBoard::is_game_over() const {
@@ -169,27 +180,21 @@ Player OthelloBoard::get_winner() const {
 }
 
 std::vector<float> OthelloBoard::to_tensor(Player current_player) const {
-    std::vector<float> tensor(8 * 8 * 3, 0.0f);
+    std::vector<float> tensor(kTensorSize);
+    encode(current_player, tensor.data());
+    return tensor;
+}
+
+void OthelloBoard::encode(Player current_player, float* out) const {
     uint64_t cur = (current_player == Player::BLACK) ? black_ : white_;
     uint64_t opp = (current_player == Player::BLACK) ? white_ : black_;
+    uint64_t moves = legal_move_mask(current_player);
 
     for (int i = 0; i < 64; ++i) {
-        if ((cur >> i) & 1) tensor[i] = 1.0f;             // channel 0
-        if ((opp >> i) & 1) tensor[64 + i] = 1.0f;        // channel 1
+        out[i] = static_cast<float>((cur >> i) & 1);              // channel 0
+        out[64 + i] = static_cast<float>((opp >> i) & 1);         // channel 1
+        out[128 + i] = static_cast<float>((moves >> i) & 1);      // channel 2: valid move mask
     }
-
-    float turn_val = (current_player == Player::BLACK) ? 1.0f : 0.0f;
-    // channel 2: valid move mask
-    for (int y = 0; y < 8; ++y) {
-        for (int x = 0; x < 8; ++x) {
-            if (is_valid_move(current_player, x, y)) {
-                int idx = y * 8 + x;
-                tensor[128 + idx] = 1.0f;
-            }
-        }
-    }
-
-    return tensor;
 }
 
 Player OthelloBoard::current_player() const {
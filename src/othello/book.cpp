@@ -0,0 +1,235 @@
+#include "othello/book.hpp"
+#include "othello/symmetry.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+namespace othello {
+
+namespace {
+    constexpr char kBookMagic[8] = {'O', 'T', 'H', 'B', 'O', 'O', 'K', '1'};
+
+    uint64_t mix(uint64_t x) {   // splitmix64 finalizer
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    bool entry_less(const BookEntry& a, const BookEntry& b) {
+        return a.key < b.key || (a.key == b.key && a.move < b.move);
+    }
+} // Anonymous namespace
+
+uint64_t book_key(uint64_t own, uint64_t opp, int* symmetry) {
+    int t = symmetry::canonical(own, opp);
+    if (symmetry) *symmetry = t;
+    return mix(own ^ mix(opp + 0x9e3779b97f4a7c15ULL));
+}
+
+// ==== Prober ====
+
+OpeningBook::OpeningBook(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("Failed to open opening book " + path);
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw std::runtime_error("Failed to stat opening book " + path);
+    }
+    bytes_ = static_cast<size_t>(st.st_size);
+    if (bytes_ < sizeof(BookHeader)) {
+        close(fd);
+        throw std::runtime_error("Invalid opening book " + path + ": truncated header");
+    }
+    map_ = mmap(nullptr, bytes_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map_ == MAP_FAILED) {
+        map_ = nullptr;
+        throw std::runtime_error("Failed to map opening book " + path);
+    }
+
+    BookHeader h;
+    std::memcpy(&h, map_, sizeof(h));
+    const char* reason = nullptr;
+    if (std::memcmp(h.magic, kBookMagic, sizeof(kBookMagic)) != 0) reason = "bad magic";
+    else if (h.version != kBookVersion) reason = "unsupported version";
+    else if (h.entry_bytes != sizeof(BookEntry)) reason = "unexpected entry size";
+    else if (h.count > (bytes_ - sizeof(BookHeader)) / sizeof(BookEntry)) reason = "truncated entries";
+    if (reason) {
+        munmap(map_, bytes_);
+        map_ = nullptr;
+        throw std::runtime_error("Invalid opening book " + path + ": " + reason);
+    }
+
+    entries_ = reinterpret_cast<const BookEntry*>(static_cast<const char*>(map_) + sizeof(BookHeader));
+    count_ = h.count;
+    max_plies_ = h.max_plies;
+    madvise(map_, bytes_, MADV_RANDOM);
+    spdlog::info("[Book] Mapped {} ({} entries, {} plies)", path, count_, max_plies_);
+}
+
+OpeningBook::~OpeningBook() {
+    if (map_) munmap(map_, bytes_);
+}
+
+std::pair<const BookEntry*, const BookEntry*> OpeningBook::range(uint64_t key) const {
+    const BookEntry* first = std::lower_bound(entries_, entries_ + count_, key,
+                                              [](const BookEntry& e, uint64_t k) { return e.key < k; });
+    const BookEntry* last = first;
+    while (last != entries_ + count_ && last->key == key) ++last;
+    return {first, last};
+}
+
+std::optional<Move> OpeningBook::probe(const OthelloBoard& board, Player player, std::mt19937* rng) const {
+    int t;
+    const uint64_t key = book_key(board.bits(player), board.bits(opponent(player)), &t);
+    auto [first, last] = range(key);
+    const uint64_t legal = board.legal_move_mask(player);
+    const int back = symmetry::inverse(t);
+
+    // Step 1: total weight of the entries that are legal here (a hash collision is not)
+    uint64_t total = 0;
+    const BookEntry* best = nullptr;
+    for (const BookEntry* e = first; e != last; ++e) {
+        if (!((legal >> symmetry::square(e->move, back)) & 1) || e->weight == 0) continue;
+        total += e->weight;
+        if (!best || e->weight > best->weight) best = e;
+    }
+    if (!best) return std::nullopt;
+
+    // Step 2: heaviest, or sampled proportionally to weight
+    const BookEntry* chosen = best;
+    if (rng) {
+        uint64_t pick = std::uniform_int_distribution<uint64_t>(0, total - 1)(*rng);
+        for (const BookEntry* e = first; e != last; ++e) {
+            if (!((legal >> symmetry::square(e->move, back)) & 1) || e->weight == 0) continue;
+            if (pick < e->weight) {
+                chosen = e;
+                break;
+            }
+            pick -= e->weight;
+        }
+    }
+    int sq = symmetry::square(chosen->move, back);
+    return Move(sq % 8, sq / 8);
+}
+
+std::vector<BookMove> OpeningBook::moves(const OthelloBoard& board, Player player) const {
+    int t;
+    const uint64_t key = book_key(board.bits(player), board.bits(opponent(player)), &t);
+    auto [first, last] = range(key);
+    const uint64_t legal = board.legal_move_mask(player);
+    const int back = symmetry::inverse(t);
+
+    std::vector<BookMove> out;
+    for (const BookEntry* e = first; e != last; ++e) {
+        int sq = symmetry::square(e->move, back);
+        if ((legal >> sq) & 1) out.push_back({Move(sq % 8, sq / 8), e->weight});
+    }
+    std::sort(out.begin(), out.end(), [](const BookMove& a, const BookMove& b) { return a.weight > b.weight; });
+    return out;
+}
+
+// ==== Builder ====
+
+BookBuilder::BookBuilder(int max_plies) : max_plies_(max_plies) {}
+
+void BookBuilder::add_game(const GameRecord& game) {
+    // Step 1: replay the game, keying each early move by its position's symmetry class
+    std::vector<std::pair<std::pair<uint64_t, uint8_t>, Player>> seen;
+    OthelloBoard board;
+    Player player = Player::BLACK;
+    int ply = 0;
+    for (const Move& move : game.moves) {
+        if (ply >= max_plies_) break;
+        if (move != othello::PASS) {
+            const uint64_t own = board.bits(player), opp = board.bits(opponent(player));
+            uint64_t canon_own = own, canon_opp = opp;
+            symmetry::canonical(canon_own, canon_opp);
+
+            // A position with symmetries of its own (the start, say) reaches its canonical form
+            // through several transforms; the smallest image merges equivalent moves.
+            int sq = 64;
+            for (int t = 0; t < symmetry::kCount; ++t) {
+                if (symmetry::transform(own, t) == canon_own && symmetry::transform(opp, t) == canon_opp)
+                    sq = std::min(sq, symmetry::square(to_index(move.x, move.y), t));
+            }
+            seen.push_back({{book_key(own, opp), static_cast<uint8_t>(sq)}, player});
+            ++ply;
+        }
+        if (!board.apply_move(player, move)) throw std::invalid_argument("Game record contains an illegal move");
+        player = opponent(player);
+    }
+
+    // Step 2: credit every move with the mover's result
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++games_;
+    for (const auto& [entry, mover] : seen) {
+        Stats& s = stats_[entry];
+        ++s.games;
+        s.points += (game.winner == Player::NONE) ? 1 : (game.winner == mover ? 2 : 0);
+    }
+}
+
+size_t BookBuilder::write(const std::string& path, uint32_t min_games) const {
+    std::vector<BookEntry> entries;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [entry, s] : stats_) {
+            if (s.games < min_games) continue;
+            BookEntry e{};
+            e.key = entry.first;
+            e.move = entry.second;
+            e.weight = s.points;
+            entries.push_back(e);
+        }
+    }
+    std::sort(entries.begin(), entries.end(), entry_less);
+
+    BookHeader h{};
+    std::memcpy(h.magic, kBookMagic, sizeof(kBookMagic));
+    h.version = kBookVersion;
+    h.entry_bytes = sizeof(BookEntry);
+    h.count = entries.size();
+    h.max_plies = static_cast<uint32_t>(max_plies_);
+
+    // Write next to the destination, then rename over it atomically
+    std::string tmp = path + ".tmp." + std::to_string(getpid());
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) throw std::runtime_error("Failed to open " + tmp + " for writing");
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(BookEntry));
+        if (!out) throw std::runtime_error("Failed to write " + tmp);
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        throw std::runtime_error("Failed to rename " + tmp + " to " + path);
+    }
+    return entries.size();
+}
+
+uint64_t BookBuilder::games() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return games_;
+}
+
+size_t BookBuilder::positions() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_.size();
+}
+
+} // namespace othello
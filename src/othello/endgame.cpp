@@ -0,0 +1,499 @@
+#include "othello/endgame.hpp"
+#include "othello/bitboard.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace othello {
+
+namespace {
+    using bitboard::flips;
+    using bitboard::legal_moves;
+    using bitboard::popcount;
+
+    constexpr int kInfinity = 65;           // outside every final score
+    constexpr int kSortedEmpties = 7;       // below: parity and corner-first loop, no table
+    constexpr int kEtcEmpties = 10;         // at and above: enhanced transposition cutoffs
+    constexpr int kMaxChildren = 64;        // legal moves of any board, reachable or not
+    constexpr uint64_t kCorners = 0x8100000000000081ULL;
+    constexpr uint64_t kQuadrants[4] = {0x000000000f0f0f0fULL, 0x00000000f0f0f0f0ULL, 0x0f0f0f0f00000000ULL,
+                                        0xf0f0f0f000000000ULL};
+
+    uint64_t mix(uint64_t x) {   // splitmix64 finalizer
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    uint64_t position_key(uint64_t own, uint64_t opp) {
+        return mix(own ^ mix(opp + 0x9e3779b97f4a7c15ULL));
+    }
+
+    int final_score(uint64_t own, uint64_t opp) {
+        const int mine = popcount(own), theirs = popcount(opp);
+        const int empties = 64 - mine - theirs;
+        const int diff = mine - theirs;
+        return diff > 0 ? diff + empties : diff < 0 ? diff - empties : 0;
+    }
+
+    // A move already played: the position it leads to, from the opponent's side
+    struct Child {
+        uint64_t own;
+        uint64_t opp;
+        int square;
+        int order;   // lower is searched first
+    };
+
+    Child play(uint64_t own, uint64_t opp, int square) {
+        const uint64_t flipped = flips(own, opp, square);
+        return {opp & ~flipped, own | flipped | 1ULL << square, square, 0};
+    }
+
+    // Remaining children of a node, shared between its owner and any helpers
+    struct SplitPoint {
+        SplitPoint* parent = nullptr;     // split point the owner was searching under
+        Child children[kMaxChildren];
+        int count = 0;
+        int beta = 0;
+        std::atomic<int> next{0};
+        std::atomic<int> alpha{0};
+        std::atomic<int> helpers{0};
+        std::atomic<bool> cutoff{false};
+        std::mutex mutex;                 // guards best and best_move
+        int best = -kInfinity;
+        int best_move = -1;
+
+        bool descends_from(const SplitPoint* ancestor) const {
+            for (const SplitPoint* sp = this; sp; sp = sp->parent)
+                if (sp == ancestor) return true;
+            return false;
+        }
+    };
+
+    // Split points a thread has published, oldest first
+    struct SplitStack {
+        std::mutex mutex;
+        std::vector<SplitPoint*> points;
+    };
+
+    struct Shared {
+        EndgameTable& table;
+        int split_empties;
+        uint64_t node_budget;             // per thread, 0: none
+        std::vector<SplitStack> stacks;
+        std::atomic<bool> done{false};
+        std::atomic<bool> out_of_nodes{false};
+
+        Shared(EndgameTable& table, int split_empties, uint64_t max_nodes, int threads)
+            : table(table), split_empties(split_empties),
+              node_budget(max_nodes ? (max_nodes + threads - 1) / threads : 0), stacks(threads) {}
+    };
+
+    class Worker {
+    public:
+        Worker(Shared& shared, int id) : shared_(shared), id_(id) {}
+
+        uint64_t nodes() const { return nodes_; }
+
+        int search_root(uint64_t own, uint64_t opp, int& best_move);
+
+        // Idle loop of a helper thread: steal work until the root search is done
+        void run() {
+            while (!shared_.done.load(std::memory_order_acquire))
+                if (!steal(nullptr)) std::this_thread::yield();
+        }
+
+    private:
+        Shared& shared_;
+        int id_;
+        uint64_t nodes_ = 0;
+        SplitPoint* active_ = nullptr;   // innermost split point this thread is working under
+
+        // True once a beta cutoff anywhere above makes the current search pointless, or the
+        // node budget is spent
+        bool aborted() const {
+            if (shared_.out_of_nodes.load(std::memory_order_relaxed)) return true;
+            for (const SplitPoint* sp = active_; sp; sp = sp->parent)
+                if (sp->cutoff.load(std::memory_order_relaxed)) return true;
+            return false;
+        }
+
+        int search(uint64_t own, uint64_t opp, int alpha, int beta, bool passed, int* best_move = nullptr);
+        int search_shallow(uint64_t own, uint64_t opp, int alpha, int beta, bool passed, int empties);
+        int search_last(uint64_t own, uint64_t opp, int square);
+        int split(const Child* children, int count, int alpha, int beta, int best, int& best_move);
+        void help(SplitPoint& sp);
+        bool steal(const SplitPoint* below);
+    };
+
+    // ==== Search ====
+
+    int Worker::search_root(uint64_t own, uint64_t opp, int& best_move) {
+        best_move = -1;
+        if (!legal_moves(own, opp)) {
+            if (!legal_moves(opp, own)) return final_score(own, opp);
+            int ignored;
+            return -search(opp, own, -kInfinity, kInfinity, true, &ignored);
+        }
+        return search(own, opp, -kInfinity, kInfinity, false, &best_move);
+    }
+
+    int Worker::search(uint64_t own, uint64_t opp, int alpha, int beta, bool passed, int* best_move) {
+        const int empties = 64 - popcount(own | opp);
+        if (empties < kSortedEmpties && !best_move) return search_shallow(own, opp, alpha, beta, passed, empties);
+        if (++nodes_ >= shared_.node_budget && shared_.node_budget)   // shallow nodes count too
+            shared_.out_of_nodes.store(true, std::memory_order_relaxed);
+
+        const uint64_t moves = legal_moves(own, opp);
+        if (!moves) {
+            if (passed) return final_score(own, opp);
+            return -search(opp, own, -beta, -alpha, true);
+        }
+
+        // Step 1: the table may settle the node outright
+        EndgameTable& table = shared_.table;
+        EndgameTable::Bounds bounds{-kInfinity, kInfinity, -1};
+        if (table.probe(own, opp, bounds)) {
+            if (bounds.lower >= beta && !best_move) return bounds.lower;
+            if (bounds.upper <= alpha && !best_move) return bounds.upper;
+            if (bounds.lower == bounds.upper && !best_move) return bounds.lower;
+        }
+
+        // Step 2: children, with enhanced transposition cutoffs on the way
+        Child children[kMaxChildren];
+        int count = 0;
+        for (uint64_t m = moves; m; m &= m - 1) {
+            Child& child = children[count++] = play(own, opp, __builtin_ctzll(m));
+            EndgameTable::Bounds cb;
+            if (empties >= kEtcEmpties && !best_move && table.probe(child.own, child.opp, cb) && -cb.upper >= beta) {
+                table.store(own, opp, alpha, beta, -cb.upper, child.square);
+                return -cb.upper;
+            }
+            // Fastest first: fewest replies, the opponent's corner moves counted twice
+            const uint64_t replies = legal_moves(child.own, child.opp);
+            child.order = child.square == bounds.move ? -1 : popcount(replies) + popcount(replies & kCorners);
+        }
+        std::sort(children, children + count, [](const Child& a, const Child& b) { return a.order < b.order; });
+
+        // Step 3: the eldest brother alone, then the rest, in parallel if the node is big enough
+        const int alpha0 = alpha;
+        int best = -search(children[0].own, children[0].opp, -beta, -alpha, false);
+        int move = children[0].square;
+        if (aborted()) return 0;
+        if (best > alpha) alpha = best;
+        if (best < beta && count > 1) {
+            if (empties >= shared_.split_empties && shared_.stacks.size() > 1) {
+                best = split(children + 1, count - 1, alpha, beta, best, move);
+                if (aborted()) return 0;
+            } else {
+                for (int i = 1; i < count && best < beta; ++i) {
+                    const Child& child = children[i];
+                    int score = -search(child.own, child.opp, -alpha - 1, -alpha, false);
+                    if (score > alpha && score < beta) score = -search(child.own, child.opp, -beta, -alpha, false);
+                    if (aborted()) return 0;
+                    if (score > best) {
+                        best = score;
+                        move = child.square;
+                        if (best > alpha) alpha = best;
+                    }
+                }
+            }
+        }
+
+        table.store(own, opp, alpha0, beta, best, move);
+        if (best_move) *best_move = move;
+        return best;
+    }
+
+    int Worker::search_shallow(uint64_t own, uint64_t opp, int alpha, int beta, bool passed, int empties) {
+        ++nodes_;
+        const uint64_t moves = legal_moves(own, opp);
+        if (!moves) {
+            if (passed) return final_score(own, opp);
+            return -search_shallow(opp, own, -beta, -alpha, true, empties);
+        }
+
+        // Moves into quadrants with an odd number of empties first (the side that moves last in
+        // a region tends to keep it), corners first within each
+        const uint64_t empty = ~(own | opp);
+        uint64_t odd = 0;
+        for (uint64_t quadrant : kQuadrants)
+            if (popcount(empty & quadrant) & 1) odd |= quadrant;
+        int best = -kInfinity;
+        for (uint64_t group : {moves & odd & kCorners, moves & odd & ~kCorners, moves & ~odd & kCorners,
+                               moves & ~odd & ~kCorners}) {
+            for (; group; group &= group - 1) {
+                const Child child = play(own, opp, __builtin_ctzll(group));
+                const int score = empties == 2
+                    ? -search_last(child.own, child.opp, __builtin_ctzll(~(child.own | child.opp)))
+                    : -search_shallow(child.own, child.opp, -beta, -alpha, false, empties - 1);
+                if (score > best) {
+                    best = score;
+                    if (best > alpha) alpha = best;
+                    if (best >= beta) return best;
+                }
+            }
+        }
+        return best;
+    }
+
+    // One empty square left: whoever can play it does, the side to move first
+    int Worker::search_last(uint64_t own, uint64_t opp, int square) {
+        ++nodes_;
+        const uint64_t bit = 1ULL << square;
+        if (uint64_t flipped = flips(own, opp, square)) return final_score(own | flipped | bit, opp & ~flipped);
+        if (uint64_t flipped = flips(opp, own, square)) return final_score(own & ~flipped, opp | flipped | bit);
+        return final_score(own, opp);
+    }
+
+    // ==== Young Brothers Wait ====
+
+    int Worker::split(const Child* children, int count, int alpha, int beta, int best, int& best_move) {
+        SplitPoint sp;
+        sp.parent = active_;
+        std::copy(children, children + count, sp.children);
+        sp.count = count;
+        sp.beta = beta;
+        sp.alpha.store(alpha);
+        sp.best = best;
+        sp.best_move = best_move;
+
+        SplitStack& stack = shared_.stacks[id_];
+        {
+            std::lock_guard<std::mutex> lock(stack.mutex);
+            stack.points.push_back(&sp);
+        }
+        help(sp);
+        {
+            std::lock_guard<std::mutex> lock(stack.mutex);
+            stack.points.pop_back();
+        }
+
+        // No helper can join any more; work below this node until the last one leaves
+        while (sp.helpers.load(std::memory_order_acquire) > 0)
+            if (!steal(&sp)) std::this_thread::yield();
+
+        std::lock_guard<std::mutex> lock(sp.mutex);
+        best_move = sp.best_move;
+        return sp.best;
+    }
+
+    void Worker::help(SplitPoint& sp) {
+        SplitPoint* saved = active_;
+        active_ = &sp;
+        for (int i; !aborted() && (i = sp.next.fetch_add(1)) < sp.count;) {
+            const Child& child = sp.children[i];
+            const int alpha = sp.alpha.load();
+            int score = -search(child.own, child.opp, -alpha - 1, -alpha, false);
+            if (score > alpha && score < sp.beta && !aborted())
+                score = -search(child.own, child.opp, -sp.beta, -std::max(alpha, sp.alpha.load()), false);
+            if (aborted()) break;
+
+            std::lock_guard<std::mutex> lock(sp.mutex);
+            if (score > sp.best) {
+                sp.best = score;
+                sp.best_move = child.square;
+                if (score > sp.alpha.load()) sp.alpha.store(score);
+                if (score >= sp.beta) sp.cutoff.store(true);
+            }
+        }
+        active_ = saved;
+    }
+
+    // Joins the oldest open split point of another thread (one below `below`, if given)
+    bool Worker::steal(const SplitPoint* below) {
+        const int threads = static_cast<int>(shared_.stacks.size());
+        for (int k = 1; k < threads; ++k) {
+            SplitStack& victim = shared_.stacks[(id_ + k) % threads];
+            SplitPoint* target = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                for (SplitPoint* sp : victim.points) {
+                    if (sp->next.load() >= sp->count || sp->cutoff.load()) continue;
+                    if (below && !sp->descends_from(below)) continue;
+                    target = sp;
+                    target->helpers.fetch_add(1);
+                    break;
+                }
+            }
+            if (target) {
+                help(*target);
+                target->helpers.fetch_sub(1, std::memory_order_release);
+                return true;
+            }
+        }
+        return false;
+    }
+} // Anonymous namespace
+
+// ==== Table ====
+
+// data: lower + 64 (bits 0-7), upper + 64 (8-15), move + 1 (16-23), in use (24)
+EndgameTable::EndgameTable(int bits)
+    : entries_(new Entry[size_t{1} << std::clamp(bits, 10, 32)]),
+      mask_((uint64_t{1} << std::clamp(bits, 10, 32)) - 1) {
+    clear();
+}
+
+bool EndgameTable::probe(uint64_t own, uint64_t opp, Bounds& out) const {
+    const uint64_t key = position_key(own, opp);
+    const Entry& e = entries_[key & mask_];
+    const uint64_t data = e.data.load(std::memory_order_relaxed);
+    if (!(data >> 24 & 1) || (e.check.load(std::memory_order_relaxed) ^ data) != key) return false;
+    out.lower = static_cast<int>(data & 0xff) - 64;
+    out.upper = static_cast<int>(data >> 8 & 0xff) - 64;
+    out.move = static_cast<int>(data >> 16 & 0xff) - 1;
+    return true;
+}
+
+void EndgameTable::store(uint64_t own, uint64_t opp, int alpha, int beta, int score, int move) {
+    int lower = score > alpha ? score : -64;
+    int upper = score < beta ? score : 64;
+
+    // Tighten what is already known about the same position rather than forget it
+    Bounds old;
+    if (probe(own, opp, old)) {
+        lower = std::max(lower, old.lower);
+        upper = std::min(upper, old.upper);
+        if (lower > upper) lower = upper = score;   // a lost race; keep the newer result
+    }
+    const uint64_t key = position_key(own, opp);
+    const uint64_t data = static_cast<uint64_t>(lower + 64) | static_cast<uint64_t>(upper + 64) << 8 |
+                          static_cast<uint64_t>(move + 1) << 16 | uint64_t{1} << 24;
+    Entry& e = entries_[key & mask_];
+    e.check.store(key ^ data, std::memory_order_relaxed);
+    e.data.store(data, std::memory_order_relaxed);
+}
+
+void EndgameTable::clear() {
+    for (uint64_t i = 0; i <= mask_; ++i) {
+        entries_[i].check.store(0, std::memory_order_relaxed);
+        entries_[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+// ==== Solver ====
+
+EndgameSolver::EndgameSolver(const EndgameConfig& config)
+    : threads_(config.threads > 0 ? config.threads : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))),
+      split_empties_(std::max(kSortedEmpties, config.split_empties)),
+      max_nodes_(config.max_nodes),
+      table_(config.table_bits) {}
+
+EndgameSolver::~EndgameSolver() = default;
+
+EndgameResult EndgameSolver::solve(const OthelloBoard& board, Player player) {
+    const auto start = std::chrono::steady_clock::now();
+    const uint64_t own = board.bits(player), opp = board.bits(opponent(player));
+
+    Shared shared(table_, split_empties_, max_nodes_, threads_);
+    std::vector<Worker> workers;
+    workers.reserve(threads_);
+    for (int t = 0; t < threads_; ++t) workers.emplace_back(shared, t);
+    std::vector<std::thread> helpers;
+    for (int t = 1; t < threads_; ++t) helpers.emplace_back([&workers, t] { workers[t].run(); });
+
+    EndgameResult result;
+    int square;
+    result.score = workers[0].search_root(own, opp, square);
+    shared.done.store(true, std::memory_order_release);
+    for (auto& t : helpers) t.join();
+
+    result.complete = !shared.out_of_nodes.load();
+    if (square >= 0 && result.complete) result.best = Move(square % 8, square / 8);
+    if (!result.complete) result.score = 0;
+    for (const Worker& w : workers) result.nodes += w.nodes();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+std::pair<OthelloBoard, Player> parse_position(const std::string& text) {
+    uint64_t black = 0, white = 0;
+    int square = 0;
+    size_t i = 0;
+    for (; i < text.size() && square < 64; ++i) {
+        const char c = text[i];
+        if (std::isspace(static_cast<unsigned char>(c))) continue;
+        if (c == 'X' || c == 'x' || c == '*') black |= 1ULL << square;
+        else if (c == 'O' || c == 'o') white |= 1ULL << square;
+        else if (c != '-' && c != '.') throw std::invalid_argument("Unexpected square '" + std::string(1, c) + "' in position");
+        ++square;
+    }
+    while (i < text.size() && std::isspace(static_cast<unsigned char>(text[i]))) ++i;
+    if (square < 64 || i >= text.size()) throw std::invalid_argument("Position needs 64 squares and a side to move: " + text);
+    const char side = static_cast<char>(std::toupper(static_cast<unsigned char>(text[i])));
+    if (side != 'X' && side != 'B' && side != 'O' && side != 'W')
+        throw std::invalid_argument("Unknown side to move '" + std::string(1, text[i]) + "'");
+    const Player player = side == 'X' || side == 'B' ? Player::BLACK : Player::WHITE;
+    return {OthelloBoard(black, white, player), player};
+}
+
+std::vector<ScoredPosition> load_positions(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("Failed to open " + path);
+
+    auto trim = [](const std::string& text) {
+        const size_t begin = text.find_first_not_of(" \t\r");
+        if (begin == std::string::npos) return std::string();
+        return text.substr(begin, text.find_last_not_of(" \t\r") - begin + 1);
+    };
+
+    std::vector<ScoredPosition> positions;
+    int number = 0;
+    for (std::string line; std::getline(in, line);) {
+        ++number;
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+
+        // Step 1: the position, then each ';' field is either "<move>:<score>" or the label
+        ScoredPosition entry;
+        size_t end = line.find(';');
+        std::tie(entry.board, entry.player) = parse_position(line.substr(0, end));
+        entry.label = path + ":" + std::to_string(number);
+        bool labelled = false;
+        while (end != std::string::npos) {
+            const size_t start = end + 1;
+            end = line.find(';', start);
+            const std::string field = trim(line.substr(start, end == std::string::npos ? end : end - start));
+            const size_t colon = field.find(':');
+            if (field.empty()) continue;
+            if (colon == std::string::npos) {
+                if (labelled) throw std::invalid_argument("Second label '" + field + "' on " + entry.label);
+                entry.label = field;
+                labelled = true;
+                continue;
+            }
+
+            // Step 2: a best move; all of them must agree on the score
+            const std::string square = field.substr(0, colon);
+            const int x = square.size() == 2 ? std::tolower(static_cast<unsigned char>(square[0])) - 'a' : -1;
+            const int y = square.size() == 2 ? square[1] - '1' : -1;
+            if (x < 0 || x >= 8 || y < 0 || y >= 8)
+                throw std::invalid_argument("Bad move '" + square + "' on " + entry.label);
+            int score;
+            try {
+                score = std::stoi(field.substr(colon + 1));
+            } catch (const std::exception&) {
+                throw std::invalid_argument("Bad score in '" + field + "' on " + entry.label);
+            }
+            if (!entry.best.empty() && score != entry.score)
+                throw std::invalid_argument("Best moves disagree on the score on " + entry.label);
+            entry.best.emplace_back(x, y);
+            entry.score = score;
+        }
+        positions.push_back(std::move(entry));
+    }
+    return positions;
+}
+
+} // namespace othello
@@ -0,0 +1,246 @@
+#include "othello/inference_broker.hpp"
+#include "othello/trace.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include <spdlog/spdlog.h>
+
+namespace othello {
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t micros_between(Clock::time_point start, Clock::time_point end) {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        return us > 0 ? static_cast<uint64_t>(us) : 0;
+    }
+
+    constexpr int kInputSize = OthelloBoard::kTensorSize;
+} // Anonymous namespace
+
+std::string BrokerStats::report() const {
+    std::ostringstream out;
+    out << "batches " << batches << ", requests " << requests << ", mean batch " << mean_batch() << "\n";
+
+    out << "  batch fill:";
+    for (size_t n = 1; n < batch_fill.size(); ++n)
+        if (batch_fill[n]) out << " " << n << "x" << batch_fill[n];
+    out << "\n";
+
+    auto line = [&](const char* name, const metrics::HistogramSnapshot& h) {
+        out << "  " << name << " us: mean " << h.mean() << ", p50 <" << h.percentile(0.5) << ", p99 <"
+            << h.percentile(0.99) << ", max <" << h.percentile(1.0) << "\n";
+    };
+    line("queue  ", queue_us);
+    line("latency", latency_us);
+    if (stall_seconds > 0.0) out << "  stalled on the backend " << stall_seconds << " s\n";
+    return out.str();
+}
+
+struct InferenceBroker::Metrics {
+    explicit Metrics(metrics::Registry& r)
+        : batches(r.counter("othello_broker_batches_total", "Batches run by the inference broker")),
+          requests(r.counter("othello_broker_requests_total", "Positions evaluated through the inference broker")),
+          batch_size(r.histogram("othello_broker_batch_size", "Positions per broker batch")),
+          queue_us(r.histogram("othello_broker_queue_seconds", "Request submitted to picked up by the dispatcher",
+                               1e-6)),
+          latency_us(r.histogram("othello_broker_latency_seconds", "Request submitted to result available", 1e-6)),
+          stall_us(r.histogram("othello_broker_stall_seconds",
+                               "Dispatcher blocked collecting an in-flight batch from the backend", 1e-6)) {}
+
+    metrics::Counter& batches;
+    metrics::Counter& requests;
+    metrics::Histogram& batch_size;
+    metrics::Histogram& queue_us;
+    metrics::Histogram& latency_us;
+    metrics::Histogram& stall_us;
+};
+
+InferenceBroker::InferenceBroker(BatchEvaluator& backend, const BrokerConfig& config, metrics::Registry* metrics)
+    : backend_(backend),
+      async_(dynamic_cast<AsyncBatchEvaluator*>(&backend)),
+      depth_(async_ ? std::max(1, async_->depth()) : 1),
+      max_batch_(std::min(config.max_batch, backend.max_batch_size())),
+      max_wait_(config.max_wait)
+{
+    if (max_batch_ <= 0) throw std::invalid_argument("InferenceBroker needs max_batch > 0");
+    if (!metrics) {
+        own_metrics_ = std::make_unique<metrics::Registry>();
+        metrics = own_metrics_.get();
+    }
+    metrics_ = std::make_unique<Metrics>(*metrics);
+    batch_fill_.assign(max_batch_ + 1, 0);
+    dispatcher_ = std::thread(&InferenceBroker::dispatch_loop, this);
+}
+
+InferenceBroker::~InferenceBroker() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        stopping_ = true;
+    }
+    queue_cv_.notify_all();
+    dispatcher_.join();
+}
+
+void InferenceBroker::submit(InferenceRequest& request, const float* input, float* policy) {
+    request.input_ = input;
+    request.policy_ = policy;
+    request.error_ = nullptr;
+    request.done_.store(false, std::memory_order_relaxed);
+    request.submitted_ = Clock::now();
+
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (stopping_) throw std::logic_error("InferenceBroker is shutting down");
+        queue_.push_back(&request);
+        // The dispatcher only needs waking for the first request and for a full batch
+        wake = queue_.size() == 1 || queue_.size() == static_cast<size_t>(max_batch_);
+    }
+    if (wake) queue_cv_.notify_one();
+}
+
+float InferenceBroker::wait(InferenceRequest& request) {
+    if (!request.ready()) {
+        std::unique_lock<std::mutex> lock(done_mutex_);
+        done_cv_.wait(lock, [&] { return request.ready(); });
+    }
+    if (request.error_) std::rethrow_exception(request.error_);
+    return request.value_;
+}
+
+BrokerStats InferenceBroker::stats() const {
+    BrokerStats stats;
+    stats.batches = metrics_->batches.value();
+    stats.requests = metrics_->requests.value();
+    stats.queue_us = metrics_->queue_us.snapshot();
+    stats.latency_us = metrics_->latency_us.snapshot();
+    stats.stall_seconds = metrics_->stall_us.snapshot().sum * 1e-6;
+    std::lock_guard<std::mutex> lock(fill_mutex_);
+    stats.batch_fill = batch_fill_;
+    return stats;
+}
+
+void InferenceBroker::dispatch_loop() {
+    trace::set_thread_name("inference broker");
+    std::vector<float> inputs(size_t(max_batch_) * kInputSize);
+    std::vector<float> policies(size_t(max_batch_) * kPolicySize);
+    std::vector<float> values(max_batch_);
+
+    // Ring of in-flight batches, oldest at `head`
+    std::vector<InFlight> flights(depth_);
+    for (auto& flight : flights) flight.requests.reserve(max_batch_);
+    int head = 0, count = 0;
+
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    while (true) {
+        // Step 1: wait for work, unless batches are still out
+        if (count == 0) {
+            queue_cv_.wait(lock, [&] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) break;   // stopping and drained
+        }
+
+        // Step 2: while a slot is free, give the next batch until the oldest request's deadline
+        // to fill up (so a batch already in flight waits at most max_wait longer to be
+        // collected), then start it without holding the queue lock
+        if (!queue_.empty() && count < depth_) {
+            auto deadline = queue_.front()->submitted_ + max_wait_;
+            queue_cv_.wait_until(lock, deadline, [&] {
+                return stopping_ || queue_.size() >= static_cast<size_t>(max_batch_);
+            });
+
+            InFlight& flight = flights[(head + count) % depth_];
+            size_t n = std::min(queue_.size(), static_cast<size_t>(max_batch_));
+            flight.requests.assign(queue_.begin(), queue_.begin() + n);
+            queue_.erase(queue_.begin(), queue_.begin() + n);
+            lock.unlock();
+            start_batch(flight, inputs, policies, values);
+            ++count;
+            lock.lock();
+        }
+
+        // Step 3: collect the oldest batch once every slot is busy or nothing else is waiting
+        if (count == depth_ || (count > 0 && queue_.empty())) {
+            lock.unlock();
+            finish_batch(flights[head], policies, values);
+            head = (head + 1) % depth_;
+            --count;
+            lock.lock();
+        }
+    }
+}
+
+void InferenceBroker::start_batch(InFlight& flight, std::vector<float>& inputs, std::vector<float>& policies,
+                                  std::vector<float>& values) {
+    const int n = static_cast<int>(flight.requests.size());
+    flight.picked = Clock::now();
+    flight.error = nullptr;
+
+    for (int i = 0; i < n; ++i)
+        std::memcpy(inputs.data() + size_t(i) * kInputSize, flight.requests[i]->input_, kInputSize * sizeof(float));
+
+    // An asynchronous backend copies the inputs and returns; otherwise the results are ready
+    // in `policies` and `values` before the next batch starts (depth 1)
+    try {
+        if (async_) {
+            trace::Span span("submit_batch", "size", n);
+            flight.ticket = async_->submit_batch(inputs.data(), n);
+        } else {
+            trace::Span span("evaluate_batch", "size", n);
+            backend_.evaluate_batch(inputs.data(), n, policies.data(), values.data());
+        }
+    } catch (...) {
+        flight.error = std::current_exception();
+        spdlog::error("[Broker] Backend failed on a batch of {}", n);
+    }
+}
+
+void InferenceBroker::finish_batch(InFlight& flight, std::vector<float>& policies, std::vector<float>& values) {
+    const int n = static_cast<int>(flight.requests.size());
+
+    if (async_ && !flight.error) {
+        const auto start = Clock::now();
+        try {
+            trace::Span span("collect", "size", n);
+            async_->collect(flight.ticket, policies.data(), values.data());
+        } catch (...) {
+            flight.error = std::current_exception();
+            spdlog::error("[Broker] Backend failed on a batch of {}", n);
+        }
+        metrics_->stall_us.record(micros_between(start, Clock::now()));
+    }
+    const auto finished = Clock::now();
+
+    metrics_->batches.add();
+    metrics_->requests.add(n);
+    metrics_->batch_size.record(n);
+    for (const auto* r : flight.requests) {
+        metrics_->queue_us.record(micros_between(r->submitted_, flight.picked));
+        metrics_->latency_us.record(micros_between(r->submitted_, finished));
+    }
+    {
+        std::lock_guard<std::mutex> lock(fill_mutex_);
+        ++batch_fill_[n];
+    }
+
+    // Publish results; the lock pairs with the waiters' predicate check so no wakeup is lost
+    {
+        std::lock_guard<std::mutex> lock(done_mutex_);
+        for (int i = 0; i < n; ++i) {
+            InferenceRequest* r = flight.requests[i];
+            if (flight.error) {
+                r->error_ = flight.error;
+            } else {
+                std::memcpy(r->policy_, policies.data() + size_t(i) * kPolicySize, kPolicySize * sizeof(float));
+                r->value_ = values[i];
+            }
+            r->done_.store(true, std::memory_order_release);
+        }
+    }
+    done_cv_.notify_all();
+}
+
+}  // namespace othello
@@ -1,4 +1,7 @@
 #include "othello/mcts.hpp"
+#include "othello/trace.hpp"
+#include <algorithm>
+#include <chrono>
 #include <ctime>
 #include <stdexcept>
 
@@ -20,41 +23,26 @@ void MCTS::run() {
     long long total_depth = 0;
     int terminal_count = 0;
 
+    trace::Span search_span("search");
     auto start = high_resolution_clock::now();
+    const auto deadline = start + duration_cast<high_resolution_clock::duration>(duration<double>(time_limit_));
 
-    for (int i = 0; i < num_simulations_; ++i) {
+    int simulations = 0;
+    for (; simulations < num_simulations_; ++simulations) {
+        if (time_limit_ > 0.0 && simulations > 0 && high_resolution_clock::now() >= deadline) break;
+        trace::Span simulation_span("simulation");
         int depth = 0;
         MCTSNode* node = root_.get();
 
         // Estimate depth before expansion
-        while (node->is_expanded && !node->is_terminal()) {
-            int total_visits = std::accumulate(node->visit_count.begin(), node->visit_count.end(), 0);
-            float best_score = -1e9;
-            int best_move_idx = -1;
-
-            for (int j = 0; j < 64; ++j) {
-                if ((node->legal_move_mask >> j) & 1) {
-                    float score = node->ucb_score(j, total_visits, c_puct_);
-                    if (score > best_score) {
-                        best_score = score;
-                        best_move_idx = j;
-                    }
-                }
+        {
+            trace::Span span("estimate_depth");
+            while (node->is_expanded && !node->is_terminal()) {
+                auto it = node->children.find(select_move(node));
+                if (it == node->children.end()) break;
+                node = it->second.get();
+                depth++;
             }
-
-            if (node->visit_count.size() == 65) {
-                float score = node->ucb_score(64, total_visits, c_puct_);
-                if (score > best_score) {
-                    best_score = score;
-                    best_move_idx = 64;
-                }
-            }
-
-            if (best_move_idx == -1 || node->children.find(best_move_idx) == node->children.end())
-                break;
-
-            node = node->children[best_move_idx].get();
-            depth++;
         }
 
         if (node->is_terminal()) {
@@ -69,10 +57,13 @@ void MCTS::run() {
 
     auto end = high_resolution_clock::now();
     duration<double> elapsed = end - start;
+    last_simulations_ = simulations;
+    search_span.set_arg("simulations", simulations);
 
+    if (!log_stats_) return;
     spdlog::info("[MCTS Stats] Max depth: {}, Avg depth: {:.2f}, Terminal leaves: {}, Time: {:.3f}s",
                  max_depth,
-                 static_cast<float>(total_depth) / num_simulations_,
+                 static_cast<float>(total_depth) / std::max(simulations, 1),
                  terminal_count,
                  elapsed.count());
 }
@@ -82,20 +73,21 @@ Move MCTS::best_move(bool temperature) {
     assert(root_ && "Must call set_root() and run() before best_move()");
 
     const auto& visits = root_->visit_count;
-    const auto& moves = root_->legal_moves;
+    const uint64_t legal = root_->board.legal_move_mask(root_->current_player);
+    if (!legal) return othello::PASS;   // PASS only valid if no other moves are
 
-    if (!temperature) {
-        // Deterministic: choose move with max visits
+    // Nothing is visited after a single simulation; sampling would then pick illegal moves
+    const bool visited = std::any_of(visits.begin(), visits.end() - 1, [](int n) { return n > 0; });
+    if (!temperature || !visited) {
+        // Deterministic: most visited legal move, priors break ties
         int best_idx = -1;
-        int max_visits = -1;
-        for (int i = 0; i < visits.size()-1; ++i) {
-            if (visits[i] > max_visits) {
-                max_visits = visits[i];
+        for (uint64_t m = legal; m; m &= m - 1) {
+            int i = __builtin_ctzll(m);
+            if (best_idx < 0 || visits[i] > visits[best_idx] ||
+                (visits[i] == visits[best_idx] && root_->prior[i] > root_->prior[best_idx]))
                 best_idx = i;
-            }
         }
-        if (max_visits == 0) { best_idx = 64; } // PASS only valid if no other moves are
-        return (best_idx == 64) ? othello::PASS : Move(best_idx % 8, best_idx / 8);
+        return Move(best_idx % 8, best_idx / 8);
     } else {
         // Stochastic: sample from visit count distribution
         std::discrete_distribution<int> dist(visits.begin(), visits.end());
@@ -161,10 +153,34 @@ float MCTS::get_value_target() const {
     return current_wins ? 1.0f : -1.0f;
 }
 
+float MCTS::root_value() const {
+    assert(root_);
+    float sum = std::accumulate(root_->value_sum.begin(), root_->value_sum.end(), 0.0f);
+    int visits = std::accumulate(root_->visit_count.begin(), root_->visit_count.end(), 0);
+    return visits ? sum / visits : 0.0f;
+}
+
+size_t MCTS::tree_size() const {
+    if (!root_) return 0;
+    size_t nodes = 0;
+    std::vector<const MCTSNode*> stack{root_.get()};
+    while (!stack.empty()) {
+        const MCTSNode* node = stack.back();
+        stack.pop_back();
+        ++nodes;
+        for (const auto& [move, child] : node->children) stack.push_back(child.get());
+    }
+    return nodes;
+}
+
 
 void MCTS::run_simulation() {
     // 1. Selection: follow UCB until a leaf node
-    MCTSNode* node = select_leaf(root_.get());
+    MCTSNode* node;
+    {
+        trace::Span span("select");
+        node = select_leaf(root_.get());
+    }
 
     // 2. Check if terminal node
     if (node->is_terminal()) {
@@ -174,67 +190,69 @@ void MCTS::run_simulation() {
         float value = (node->current_player == Player::BLACK)
                         ? static_cast<float>(black - white) / 64.0f
                         : static_cast<float>(white - black) / 64.0f;
+        trace::Span span("backpropagate");
         backpropagate(node, value);
         return;
     }
 
-    // 3. Expansion and evaluation
-    node->expand([&](const OthelloBoard& board, Player player) {
-        return evaluator_.evaluate(board, player);
-    });
-
-    // 4. Re-evaluate the leaf after expansion
-    // This will be the value from the current player's perspective
-    auto [_, value] = evaluator_.evaluate(node->board, node->current_player);
+    // 3. Expansion and evaluation: one call yields both the priors and the leaf value
+    // (from the current player's perspective)
+    float value;
+    {
+        trace::Span span("expand");
+        value = node->expand([this](const OthelloBoard& board, Player player, float* policy) {
+            trace::Span evaluate_span("evaluate");
+            return evaluator_.evaluate_into(board, player, policy);
+        });
+    }
 
-    // 5. Backpropagate value up the tree
+    // 4. Backpropagate value up the tree
+    trace::Span span("backpropagate");
     backpropagate(node, value);
 }
 
-MCTSNode* MCTS::select_leaf(MCTSNode* node) {
-    while (node->is_expanded && !node->is_terminal()) {
-        int total_visits = 0;
-        for (int n : node->visit_count)
-            total_visits += n;
-
-        float best_score = -1e9;
-        int best_move_idx = -1;
-
-        for (int i = 0; i < 64; ++i) {
-            if ((node->legal_move_mask >> i) & 1) {
-                float score = node->ucb_score(i, total_visits, c_puct_);
-                if (score > best_score) {
-                    best_score = score;
-                    best_move_idx = i;
-                }
-            }
-        }
-
-        // Handle PASS separately
-        if (node->visit_count.size() == 65) {
-            float score = node->ucb_score(64, total_visits, c_puct_);
-            if (score > best_score) {
-                best_score = score;
-                best_move_idx = 64;
-            }
+int MCTS::select_move(const MCTSNode* node) const {
+    // A forced pass is the only child
+    if (node->must_pass()) return PASS_INDEX;
+
+    int total_visits = 0;
+    for (int n : node->visit_count)
+        total_visits += n;
+
+    float best_score = -1e9;
+    int best_move_idx = -1;
+    for (uint64_t m = node->legal_move_mask; m; m &= m - 1) {
+        int i = __builtin_ctzll(m);
+        float score = node->ucb_score(i, total_visits, c_puct_);
+        if (score > best_score) {
+            best_score = score;
+            best_move_idx = i;
         }
+    }
+    return best_move_idx;
+}
 
-        // Defensive fallback
-        if (best_move_idx == -1) return node;
+MCTSNode* MCTS::select_leaf(MCTSNode* node) {
+    evaluator_.begin_path(node->board, node->current_player);
+    while (node->is_expanded && !node->is_terminal()) {
+        int best_move_idx = select_move(node);
 
         // Create or follow child node
         auto it = node->children.find(best_move_idx);
         if (it == node->children.end()) {
-            Move move = (best_move_idx == 64) ? othello::PASS :
+            Move move = (best_move_idx == PASS_INDEX) ? othello::PASS :
                          Move(best_move_idx % 8, best_move_idx / 8);
             OthelloBoard next_board = node->board;
             next_board.apply_move(node->current_player, move);
             Player next_player = othello::opponent(node->current_player);
 
             auto child = std::make_unique<MCTSNode>(next_board, next_player, node, move);
-            node->children[best_move_idx] = std::move(child);
-            return node->children[best_move_idx].get();
+            MCTSNode* leaf = child.get();
+            node->children.emplace(best_move_idx, std::move(child));
+            evaluator_.descend(node->current_player, best_move_idx, leaf->board);
+            return leaf;
         } else {
+            evaluator_.descend(node->current_player, best_move_idx, it->second->board);
             node = it->second.get();
         }
     }
@@ -253,12 +271,13 @@ void MCTS::backpropagate(MCTSNode* node, float value) {
             move_idx = othello::to_index(node->move_from_parent.x, node->move_from_parent.y);
         }
 
+        // Flip value for the parent’s perspective: the parent's edge stats are from the
+        // parent's side, which is always the opponent of this node's side to move
+        value = -value;
+
         parent->visit_count[move_idx] += 1;
         parent->value_sum[move_idx] += value;
 
-        // Flip value for the parent’s perspective
-        value = -value;
-
         node = parent;
     }
 }
@@ -0,0 +1,314 @@
+#include "othello/metrics.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+namespace othello::metrics {
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t nanos_between(Clock::time_point start, Clock::time_point end) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        return ns > 0 ? static_cast<uint64_t>(ns) : 0;
+    }
+
+    constexpr double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+    // {labels} or {labels,extra}, or nothing when both are empty
+    std::string label_set(const std::string& labels, const std::string& extra = "") {
+        if (labels.empty() && extra.empty()) return "";
+        if (labels.empty()) return "{" + extra + "}";
+        if (extra.empty()) return "{" + labels + "}";
+        return "{" + labels + "," + extra + "}";
+    }
+
+    void write_all(int fd, const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) return;
+            sent += static_cast<size_t>(n);
+        }
+    }
+} // Anonymous namespace
+
+int Histogram::bucket_of(uint64_t value) {
+    if (value < kSubBuckets) return static_cast<int>(value);
+    const int exponent = 63 - __builtin_clzll(value);
+    const int shift = exponent - kSubBits;
+    const int sub = static_cast<int>((value >> shift) & (kSubBuckets - 1));
+    return (shift + 1) * kSubBuckets + sub;
+}
+
+uint64_t Histogram::bucket_upper(int bucket) {
+    if (bucket < kSubBuckets) return static_cast<uint64_t>(bucket);
+    const int shift = bucket / kSubBuckets - 1;
+    const uint64_t lower = static_cast<uint64_t>(kSubBuckets + bucket % kSubBuckets) << shift;
+    return lower + ((1ULL << shift) - 1);
+}
+
+void Histogram::record(uint64_t value) {
+    counts_[bucket_of(value)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    uint64_t seen = max_.load(std::memory_order_relaxed);
+    while (value > seen && !max_.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {}
+}
+
+HistogramSnapshot Histogram::snapshot() const {
+    // Not one atomic cut: a concurrent record() may show in sum or max but not yet in counts
+    HistogramSnapshot snap;
+    snap.counts.resize(kBuckets);
+    for (int b = 0; b < kBuckets; ++b) {
+        snap.counts[b] = counts_[b].load(std::memory_order_relaxed);
+        snap.total += snap.counts[b];
+    }
+    snap.sum = sum_.load(std::memory_order_relaxed);
+    snap.max = max_.load(std::memory_order_relaxed);
+    return snap;
+}
+
+uint64_t HistogramSnapshot::percentile(double p) const {
+    if (!total) return 0;
+    const uint64_t rank = static_cast<uint64_t>(p * (total - 1));
+    uint64_t seen = 0;
+    for (size_t b = 0; b < counts.size(); ++b) {
+        seen += counts[b];
+        if (seen > rank) return std::min(Histogram::bucket_upper(static_cast<int>(b)), max);
+    }
+    return max;
+}
+
+Registry::Series& Registry::series(const std::string& name, const std::string& help, Type type, double scale,
+                                   const std::string& labels) {
+    auto family = std::find_if(families_.begin(), families_.end(), [&](const Family& f) { return f.name == name; });
+    if (family == families_.end()) {
+        families_.push_back({name, help, type, scale, {}});
+        family = families_.end() - 1;
+    } else if (family->type != type) {
+        throw std::invalid_argument(fmt::format("Metric {} is already registered with another type", name));
+    }
+
+    for (Series& s : family->series)
+        if (s.labels == labels) return s;
+    family->series.push_back({labels});
+    return family->series.back();
+}
+
+Counter& Registry::counter(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series& s = series(name, help, Type::Counter, 1.0, labels);
+    if (!s.counter) s.counter = &counters_.emplace_back();
+    return *s.counter;
+}
+
+Gauge& Registry::gauge(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series& s = series(name, help, Type::Gauge, 1.0, labels);
+    if (!s.gauge) s.gauge = &gauges_.emplace_back();
+    return *s.gauge;
+}
+
+Histogram& Registry::histogram(const std::string& name, const std::string& help, double scale,
+                               const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series& s = series(name, help, Type::Summary, scale, labels);
+    if (!s.histogram) s.histogram = &histograms_.emplace_back();
+    return *s.histogram;
+}
+
+std::string Registry::prometheus_text() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fmt::memory_buffer out;
+    auto it = std::back_inserter(out);
+    for (const Family& f : families_) {
+        switch (f.type) {
+        case Type::Counter:
+            fmt::format_to(it, "# HELP {} {}\n# TYPE {} counter\n", f.name, f.help, f.name);
+            for (const Series& s : f.series)
+                fmt::format_to(it, "{}{} {}\n", f.name, label_set(s.labels), s.counter->value());
+            break;
+        case Type::Gauge:
+            fmt::format_to(it, "# HELP {} {}\n# TYPE {} gauge\n", f.name, f.help, f.name);
+            for (const Series& s : f.series)
+                fmt::format_to(it, "{}{} {}\n", f.name, label_set(s.labels), s.gauge->value());
+            break;
+        case Type::Summary: {
+            // One snapshot per series, so the quantiles and the _max gauge below agree
+            std::vector<HistogramSnapshot> snaps;
+            for (const Series& s : f.series) snaps.push_back(s.histogram->snapshot());
+
+            fmt::format_to(it, "# HELP {} {}\n# TYPE {} summary\n", f.name, f.help, f.name);
+            for (size_t i = 0; i < f.series.size(); ++i) {
+                const std::string& labels = f.series[i].labels;
+                for (double q : kQuantiles)
+                    fmt::format_to(it, "{}{} {:.9g}\n", f.name, label_set(labels, fmt::format("quantile=\"{}\"", q)),
+                                   snaps[i].percentile(q) * f.scale);
+                fmt::format_to(it, "{}_sum{} {:.9g}\n", f.name, label_set(labels), snaps[i].sum * f.scale);
+                fmt::format_to(it, "{}_count{} {}\n", f.name, label_set(labels), snaps[i].total);
+            }
+            fmt::format_to(it, "# HELP {}_max Largest value recorded\n# TYPE {}_max gauge\n", f.name, f.name);
+            for (size_t i = 0; i < f.series.size(); ++i)
+                fmt::format_to(it, "{}_max{} {:.9g}\n", f.name, label_set(f.series[i].labels), snaps[i].max * f.scale);
+            break;
+        }
+        }
+    }
+    return fmt::to_string(out);
+}
+
+std::pair<std::vector<float>, float> TimedEvaluator::evaluate(const OthelloBoard& board, Player current_player) {
+    auto start = Clock::now();
+    auto result = inner_->evaluate(board, current_player);
+    latency_ns_.record(nanos_between(start, Clock::now()));
+    return result;
+}
+
+float TimedEvaluator::evaluate_into(const OthelloBoard& board, Player current_player, float* policy) {
+    auto start = Clock::now();
+    float value = inner_->evaluate_into(board, current_player, policy);
+    latency_ns_.record(nanos_between(start, Clock::now()));
+    return value;
+}
+
+Exporter::Exporter(const Registry& registry, const ExporterConfig& config)
+    : registry_(registry), config_(config)
+{
+    if (config_.interval.count() <= 0) throw std::invalid_argument("Metrics flush interval must be positive");
+
+    // Step 1: loopback listener; the endpoint is for a local scraper, not the network
+    if (config_.http_port >= 0) {
+        listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listen_fd_ < 0) throw std::runtime_error(fmt::format("socket failed: {}", std::strerror(errno)));
+        int opt = 1;
+        setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(static_cast<uint16_t>(config_.http_port));
+        if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+            listen(listen_fd_, 16) < 0) {
+            std::string error = std::strerror(errno);
+            close(listen_fd_);
+            throw std::runtime_error(fmt::format("Failed to serve metrics on port {}: {}", config_.http_port, error));
+        }
+        socklen_t len = sizeof(address);
+        getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address), &len);
+        port_ = ntohs(address.sin_port);
+    }
+
+    // Step 2: the thread, if there is anything for it to do
+    if (listen_fd_ < 0 && config_.file_path.empty()) return;
+    stop_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (stop_fd_ < 0) {
+        std::string error = std::strerror(errno);
+        if (listen_fd_ >= 0) close(listen_fd_);
+        throw std::runtime_error(fmt::format("eventfd failed: {}", error));
+    }
+    thread_ = std::thread(&Exporter::loop, this);
+    if (listen_fd_ >= 0) spdlog::info("Serving metrics on http://127.0.0.1:{}/metrics", port_);
+}
+
+Exporter::~Exporter() {
+    if (thread_.joinable()) {
+        uint64_t one = 1;
+        ssize_t ignored = write(stop_fd_, &one, sizeof(one));
+        (void)ignored;
+        thread_.join();
+    }
+    if (stop_fd_ >= 0) close(stop_fd_);
+    if (listen_fd_ >= 0) close(listen_fd_);
+    if (!config_.file_path.empty()) flush();
+}
+
+bool Exporter::flush() const {
+    if (config_.file_path.empty()) return false;
+    const std::string tmp = config_.file_path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        out << registry_.prometheus_text();
+        if (!out.flush()) {
+            spdlog::warn("Failed to write metrics to {}", tmp);
+            return false;
+        }
+    }
+    if (std::rename(tmp.c_str(), config_.file_path.c_str()) != 0) {
+        spdlog::warn("Failed to replace {}: {}", config_.file_path, std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+void Exporter::loop() {
+    auto next_flush = Clock::now() + config_.interval;
+    while (true) {
+        int timeout_ms = -1;
+        if (!config_.file_path.empty()) {
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(next_flush - Clock::now()).count();
+            timeout_ms = static_cast<int>(std::max<long long>(wait, 0));
+        }
+        pollfd fds[2] = {{stop_fd_, POLLIN, 0}, {listen_fd_, POLLIN, 0}};
+        int n = poll(fds, listen_fd_ >= 0 ? 2 : 1, timeout_ms);
+        if (n < 0 && errno != EINTR) {
+            spdlog::error("Metrics exporter poll failed: {}", std::strerror(errno));
+            return;
+        }
+        if (n > 0 && fds[0].revents) return;
+
+        // Scrapes are rare and tiny, so each is answered inline
+        if (n > 0 && listen_fd_ >= 0 && (fds[1].revents & POLLIN)) {
+            int client_fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client_fd >= 0) {
+                serve(client_fd);
+                close(client_fd);
+            }
+        }
+
+        if (!config_.file_path.empty() && Clock::now() >= next_flush) {
+            flush();
+            next_flush = std::max(next_flush + config_.interval, Clock::now());
+        }
+    }
+}
+
+void Exporter::serve(int client_fd) const {
+    // A stalled client must not hold up the file flush for long
+    timeval timeout{1, 0};
+    setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    // Only the request line matters; read until the end of the headers
+    std::string request;
+    char buf[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+        ssize_t n = recv(client_fd, buf, sizeof(buf), 0);
+        if (n <= 0) break;
+        request.append(buf, static_cast<size_t>(n));
+    }
+
+    const bool found = request.rfind("GET /metrics ", 0) == 0 || request.rfind("GET / ", 0) == 0;
+    const std::string body = found ? registry_.prometheus_text() : "not found\n";
+    write_all(client_fd, fmt::format("HTTP/1.1 {}\r\n"
+                                     "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                                     "Content-Length: {}\r\n"
+                                     "Connection: close\r\n\r\n",
+                                     found ? "200 OK" : "404 Not Found", body.size()));
+    write_all(client_fd, body);
+}
+
+} // namespace othello::metrics
@@ -0,0 +1,319 @@
+#include "othello/pattern_evaluator.hpp"
+#include "othello/bitboard.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace othello {
+
+namespace {
+    struct Sq { int x, y; };
+
+    // One orientation of every pattern type; the other placements are its D4 images
+    const std::vector<std::vector<Sq>>& base_patterns() {
+        static const std::vector<std::vector<Sq>> base = {
+            {{0,0},{1,0},{2,0},{3,0},{4,0},{5,0},{6,0},{7,0},{1,1},{6,1}},   // edge + 2X
+            {{0,0},{1,0},{2,0},{0,1},{1,1},{2,1},{0,2},{1,2},{2,2}},         // corner 3x3
+            {{0,0},{1,0},{2,0},{3,0},{4,0},{0,1},{1,1},{2,1},{3,1},{4,1}},   // corner 2x5
+            {{0,1},{1,1},{2,1},{3,1},{4,1},{5,1},{6,1},{7,1}},               // line 2
+            {{0,2},{1,2},{2,2},{3,2},{4,2},{5,2},{6,2},{7,2}},               // line 3
+            {{0,3},{1,3},{2,3},{3,3},{4,3},{5,3},{6,3},{7,3}},               // line 4
+            {{0,0},{1,1},{2,2},{3,3},{4,4},{5,5},{6,6},{7,7}},               // diagonal 8
+            {{0,1},{1,2},{2,3},{3,4},{4,5},{5,6},{6,7}},                     // diagonal 7
+            {{0,2},{1,3},{2,4},{3,5},{4,6},{5,7}},                           // diagonal 6
+            {{0,3},{1,4},{2,5},{3,6},{4,7}},                                 // diagonal 5
+            {{0,4},{1,5},{2,6},{3,7}},                                       // diagonal 4
+        };
+        return base;
+    }
+
+    Sq transform(Sq s, int t) {
+        switch (t) {
+            case 0: return {s.x, s.y};
+            case 1: return {7 - s.y, s.x};
+            case 2: return {7 - s.x, 7 - s.y};
+            case 3: return {s.y, 7 - s.x};
+            case 4: return {7 - s.x, s.y};
+            case 5: return {s.x, 7 - s.y};
+            case 6: return {s.y, s.x};
+            default: return {7 - s.y, 7 - s.x};
+        }
+    }
+
+    struct Tables {
+        struct Instance {
+            int type;
+            int size;
+            int squares[patterns::kMaxSquares];
+        };
+        struct Ref {
+            uint16_t instance;
+            uint16_t pow3;
+        };
+        static constexpr int kMaxRefs = 8;
+
+        std::vector<Instance> instances;
+        size_t type_offset[patterns::kNumTypes];
+        size_t phase_size;
+        Ref refs[64][kMaxRefs];
+        int ref_count[64] = {};
+
+        Tables() {
+            size_t offset = 0;
+            const auto& base = base_patterns();
+            for (int type = 0; type < patterns::kNumTypes; ++type) {
+                const auto& pattern = base[type];
+                type_offset[type] = offset;
+                offset += static_cast<size_t>(std::pow(3, pattern.size()));
+
+                // Keep one placement per distinct square set
+                std::vector<uint64_t> seen;
+                for (int t = 0; t < 8; ++t) {
+                    Instance inst{type, static_cast<int>(pattern.size()), {}};
+                    uint64_t mask = 0;
+                    for (size_t i = 0; i < pattern.size(); ++i) {
+                        Sq s = transform(pattern[i], t);
+                        inst.squares[i] = to_index(s.x, s.y);
+                        mask |= 1ULL << inst.squares[i];
+                    }
+                    if (std::find(seen.begin(), seen.end(), mask) != seen.end()) continue;
+                    seen.push_back(mask);
+                    instances.push_back(inst);
+                }
+            }
+            phase_size = offset + patterns::kScalarFeatures;
+            assert(instances.size() == patterns::kNumInstances);
+
+            for (size_t i = 0; i < instances.size(); ++i) {
+                int pow3 = 1;
+                for (int j = 0; j < instances[i].size; ++j) {
+                    int sq = instances[i].squares[j];
+                    assert(ref_count[sq] < kMaxRefs);
+                    refs[sq][ref_count[sq]++] = {static_cast<uint16_t>(i), static_cast<uint16_t>(pow3)};
+                    pow3 *= 3;
+                }
+            }
+        }
+    };
+
+    const Tables& tables() {
+        static const Tables t;
+        return t;
+    }
+
+    constexpr uint32_t kFileMagic = 0x5048544f;   // "OTHP"
+    constexpr uint32_t kFileVersion = 1;
+    constexpr float kPolicySharpness = 8.0f;       // softmax temperature for one-ply priors
+} // Anonymous namespace
+
+size_t patterns::phase_size() {
+    return tables().phase_size;
+}
+
+void patterns::table_indices(const PatternState& state, int perspective, uint32_t* out) {
+    const Tables& t = tables();
+    for (int i = 0; i < kNumInstances; ++i)
+        out[i] = static_cast<uint32_t>(t.type_offset[t.instances[i].type] + state.index[perspective][i]);
+}
+
+void patterns::scalar_features(uint64_t own, uint64_t opp, float* out) {
+    int mobility = bitboard::popcount(bitboard::legal_moves(own, opp)) -
+                   bitboard::popcount(bitboard::legal_moves(opp, own));
+    int empties = 64 - bitboard::popcount(own | opp);
+    out[0] = static_cast<float>(mobility);
+    out[1] = (empties & 1) ? 1.0f : -1.0f;  // odd: the side to move gets the last move
+    out[2] = 1.0f;
+}
+
+PatternState PatternState::from_bits(uint64_t first, uint64_t second) {
+    // Every disk adds its digit to the instances through its square: 1 for its owner's
+    // perspective, 2 for the other one
+    const Tables& t = tables();
+    PatternState state{};
+    for (int p = 0; p < 2; ++p) {
+        for (uint64_t disks = p == 0 ? first : second; disks; disks &= disks - 1) {
+            int sq = __builtin_ctzll(disks);
+            for (int r = 0; r < t.ref_count[sq]; ++r) {
+                const auto& ref = t.refs[sq][r];
+                state.index[p][ref.instance] += ref.pow3;
+                state.index[1 - p][ref.instance] += 2 * ref.pow3;
+            }
+        }
+    }
+    return state;
+}
+
+PatternState PatternState::from_board(const OthelloBoard& board) {
+    return from_bits(board.bits(Player::BLACK), board.bits(Player::WHITE));
+}
+
+void PatternState::apply(Player mover, int sq, uint64_t flipped) {
+    const Tables& t = tables();
+    const int mover_persp = (mover == Player::BLACK) ? 0 : 1;
+
+    // Placed disk: "own" (1) for the mover, "opponent" (2) for the other side
+    for (int r = 0; r < t.ref_count[sq]; ++r) {
+        const auto& ref = t.refs[sq][r];
+        index[mover_persp][ref.instance] += ref.pow3;
+        index[1 - mover_persp][ref.instance] += 2 * ref.pow3;
+    }
+
+    // Flipped disks go 2 -> 1 for the mover and 1 -> 2 for the other side
+    while (flipped) {
+        int f = __builtin_ctzll(flipped);
+        flipped &= flipped - 1;
+        for (int r = 0; r < t.ref_count[f]; ++r) {
+            const auto& ref = t.refs[f][r];
+            index[mover_persp][ref.instance] -= ref.pow3;
+            index[1 - mover_persp][ref.instance] += ref.pow3;
+        }
+    }
+}
+
+PatternEvaluator::PatternEvaluator(bool lookahead_policy)
+    : weights_(std::make_shared<std::vector<float>>(patterns::kNumPhases * patterns::phase_size(), 0.0f)),
+      lookahead_policy_(lookahead_policy) {}
+
+std::vector<float>& PatternEvaluator::weights() {
+    // Detach from the copies before anything writes
+    if (weights_.use_count() > 1) weights_ = std::make_shared<std::vector<float>>(*weights_);
+    return *weights_;
+}
+
+float PatternEvaluator::score(const PatternState& state, int perspective, uint64_t own, uint64_t opp) const {
+    return score(state.index[perspective], own, opp);
+}
+
+float PatternEvaluator::score(const uint16_t* index, uint64_t own, uint64_t opp) const {
+    const Tables& t = tables();
+    const int phase = patterns::phase_of(bitboard::popcount(own | opp));
+    const float* w = weights_->data() + phase * t.phase_size;
+
+    float sum = 0.0f;
+    for (int i = 0; i < patterns::kNumInstances; ++i)
+        sum += w[t.type_offset[t.instances[i].type] + index[i]];
+
+    float scalars[patterns::kScalarFeatures];
+    patterns::scalar_features(own, opp, scalars);
+    const float* ws = w + t.phase_size - patterns::kScalarFeatures;
+    for (int i = 0; i < patterns::kScalarFeatures; ++i) sum += ws[i] * scalars[i];
+    return sum;
+}
+
+float PatternEvaluator::value(const OthelloBoard& board, Player player) const {
+    PatternState state = PatternState::from_board(board);
+    float s = score(state, player == Player::BLACK ? 0 : 1, board.bits(player), board.bits(opponent(player)));
+    return std::clamp(s, -1.0f, 1.0f);
+}
+
+std::pair<std::vector<float>, float> PatternEvaluator::evaluate(const OthelloBoard& board, Player current_player) {
+    std::vector<float> policy(kPolicySize);
+    float value = evaluate_into(board, current_player, policy.data());
+    return {policy, value};
+}
+
+void PatternEvaluator::begin_path(const OthelloBoard& root, Player /*to_move*/) {
+    const uint64_t black = root.bits(Player::BLACK), white = root.bits(Player::WHITE);
+    if (!root_.valid || root_.black != black || root_.white != white)
+        root_ = {PatternState::from_bits(black, white), black, white, true};
+    path_ = root_;
+}
+
+void PatternEvaluator::descend(Player mover, int move_index, const OthelloBoard& board) {
+    if (!path_.valid || move_index == 64) return;   // a pass changes no disk
+    const uint64_t before = (mover == Player::BLACK) ? path_.black : path_.white;
+    const uint64_t placed = 1ULL << move_index;
+    path_.state.apply(mover, move_index, board.bits(mover) & ~before & ~placed);
+    path_.black = board.bits(Player::BLACK);
+    path_.white = board.bits(Player::WHITE);
+}
+
+float PatternEvaluator::evaluate_into(const OthelloBoard& board, Player current_player, float* policy) {
+    const int persp = (current_player == Player::BLACK) ? 0 : 1;
+    const uint64_t own = board.bits(current_player);
+    const uint64_t opp = board.bits(opponent(current_player));
+
+    // The search path's indices when it ends here, otherwise built from scratch
+    PatternState fresh;
+    const PatternState* path_state = &path_.state;
+    if (!path_.valid || path_.black != board.bits(Player::BLACK) || path_.white != board.bits(Player::WHITE)) {
+        fresh = PatternState::from_board(board);
+        path_state = &fresh;
+    }
+    const PatternState& state = *path_state;
+
+    std::fill(policy, policy + kPolicySize, 0.0f);
+    float value = std::clamp(score(state, persp, own, opp), -1.0f, 1.0f);
+
+    uint64_t moves = bitboard::legal_moves(own, opp);
+    if (!moves) {
+        policy[64] = 1.0f;
+        return value;
+    }
+
+    if (!lookahead_policy_) {
+        float p = 1.0f / bitboard::popcount(moves);
+        for (uint64_t m = moves; m; m &= m - 1) policy[__builtin_ctzll(m)] = p;
+        return value;
+    }
+
+    // One-ply lookahead: prior ~ exp(-sharpness * opponent's score after the move). Only the
+    // opponent's perspective is scored, so only its indices are updated (as in PatternState::apply).
+    const Tables& t = tables();
+    float max_logit = -1e30f;
+    for (uint64_t m = moves; m; m &= m - 1) {
+        int sq = __builtin_ctzll(m);
+        uint64_t flipped = bitboard::flips(own, opp, sq);
+        uint16_t child[patterns::kNumInstances];
+        std::memcpy(child, state.index[1 - persp], sizeof(child));
+        for (int r = 0; r < t.ref_count[sq]; ++r) child[t.refs[sq][r].instance] += 2 * t.refs[sq][r].pow3;
+        for (uint64_t f = flipped; f; f &= f - 1) {
+            int fsq = __builtin_ctzll(f);
+            for (int r = 0; r < t.ref_count[fsq]; ++r) child[t.refs[fsq][r].instance] += t.refs[fsq][r].pow3;
+        }
+        uint64_t child_own = own | flipped | (1ULL << sq);
+        uint64_t child_opp = opp & ~flipped;
+        float logit = -kPolicySharpness * score(child, child_opp, child_own);
+        policy[sq] = logit;
+        max_logit = std::max(max_logit, logit);
+    }
+    float sum = 0.0f;
+    for (uint64_t m = moves; m; m &= m - 1) {
+        int sq = __builtin_ctzll(m);
+        policy[sq] = std::exp(policy[sq] - max_logit);
+        sum += policy[sq];
+    }
+    for (uint64_t m = moves; m; m &= m - 1) policy[__builtin_ctzll(m)] /= sum;
+
+    return value;
+}
+
+void PatternEvaluator::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) throw std::runtime_error("Failed to open " + path + " for writing");
+    uint32_t header[4] = {kFileMagic, kFileVersion, patterns::kNumPhases, static_cast<uint32_t>(patterns::phase_size())};
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(weights_->data()), weights_->size() * sizeof(float));
+    if (!out) throw std::runtime_error("Failed to write pattern weights " + path);
+}
+
+void PatternEvaluator::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("Failed to open pattern weights " + path);
+    uint32_t header[4] = {};
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!in || header[0] != kFileMagic || header[1] != kFileVersion || header[2] != patterns::kNumPhases ||
+        header[3] != patterns::phase_size())
+        throw std::runtime_error("Incompatible pattern weights file " + path);
+    auto weights = std::make_shared<std::vector<float>>(weights_->size());
+    in.read(reinterpret_cast<char*>(weights->data()), weights->size() * sizeof(float));
+    if (!in) throw std::runtime_error("Truncated pattern weights file " + path);
+    weights_ = std::move(weights);
+}
+
+} // namespace othello
@@ -0,0 +1,88 @@
+#include "othello/pattern_trainer.hpp"
+#include "othello/bitboard.hpp"
+
+#include <cmath>
+
+#include <spdlog/spdlog.h>
+
+namespace othello {
+
+namespace {
+    constexpr int kActiveFeatures = patterns::kNumInstances + patterns::kScalarFeatures;
+} // Anonymous namespace
+
+PatternTrainer::PatternTrainer(PatternEvaluator& evaluator) : evaluator_(evaluator) {}
+
+void PatternTrainer::add_sample(uint64_t own, uint64_t opp, float target) {
+    samples_.push_back({own, opp, target});
+}
+
+void PatternTrainer::add(const TrainSample& sample) {
+    add(sample.state.data(), sample.value);
+}
+
+void PatternTrainer::add(const float* state, float value) {
+    uint64_t own = 0, opp = 0;
+    for (int i = 0; i < 64; ++i) {
+        if (state[i] > 0.5f) own |= 1ULL << i;
+        if (state[64 + i] > 0.5f) opp |= 1ULL << i;
+    }
+    add_sample(own, opp, value);
+}
+
+float PatternTrainer::rmse() const {
+    if (samples_.empty()) return 0.0f;
+    double sq = 0.0;
+    for (const auto& s : samples_) {
+        float err = s.target - evaluator_.score(PatternState::from_bits(s.own, s.opp), 0, s.own, s.opp);
+        sq += double(err) * err;
+    }
+    return static_cast<float>(std::sqrt(sq / samples_.size()));
+}
+
+float PatternTrainer::fit(int epochs, float learning_rate, float l2) {
+    const size_t phase_size = patterns::phase_size();
+    std::vector<float>& w = evaluator_.weights();
+    std::vector<double> grad(w.size()), diag(w.size());
+    uint32_t idx[patterns::kNumInstances];
+    float scalars[patterns::kScalarFeatures];
+
+    for (int epoch = 0; epoch < epochs; ++epoch) {
+        std::fill(grad.begin(), grad.end(), 0.0);
+        std::fill(diag.begin(), diag.end(), 0.0);
+        double sq_err = 0.0;
+
+        // Step 1: accumulate gradient and diagonal of the normal equations
+        for (const auto& s : samples_) {
+            PatternState state = PatternState::from_bits(s.own, s.opp);
+            float residual = s.target - evaluator_.score(state, 0, s.own, s.opp);
+            sq_err += double(residual) * residual;
+
+            size_t base = patterns::phase_of(bitboard::popcount(s.own | s.opp)) * phase_size;
+            patterns::table_indices(state, 0, idx);
+            for (uint32_t i : idx) {
+                grad[base + i] += residual;
+                diag[base + i] += 1.0;
+            }
+            patterns::scalar_features(s.own, s.opp, scalars);
+            size_t sbase = base + phase_size - patterns::kScalarFeatures;
+            for (int i = 0; i < patterns::kScalarFeatures; ++i) {
+                grad[sbase + i] += residual * scalars[i];
+                diag[sbase + i] += double(scalars[i]) * scalars[i];
+            }
+        }
+
+        // Step 2: preconditioned, ridge-regularized update of every weight that was seen.
+        // All active features of a sample move together, so the step is shared between them.
+        const double step = learning_rate / kActiveFeatures;
+        for (size_t i = 0; i < w.size(); ++i) {
+            if (diag[i] == 0.0) continue;
+            w[i] += static_cast<float>(step * (grad[i] - l2 * w[i]) / (diag[i] + l2));
+        }
+
+        spdlog::debug("[Pattern fit] epoch {} rmse {:.4f}", epoch, std::sqrt(sq_err / std::max<size_t>(1, samples_.size())));
+    }
+    return rmse();
+}
+
+} // namespace othello
@@ -0,0 +1,120 @@
+#include "othello/runtime_config.hpp"
+
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <ryml.hpp>
+#include <ryml_std.hpp>
+
+#include <fmt/format.h>
+
+namespace othello {
+
+namespace {
+    std::string to_string(ryml::csubstr s) {
+        return std::string(s.str ? s.str : "", s.len);
+    }
+
+    long parse_int(ryml::ConstNodeRef node, const std::string& where, long min, long max) {
+        const std::string text = to_string(node.val());
+        char* end = nullptr;
+        errno = 0;
+        const long value = std::strtol(text.c_str(), &end, 10);
+        if (text.empty() || *end || errno || value < min || value > max)
+            throw std::runtime_error(fmt::format("{} must be an integer in [{}, {}], got '{}'", where, min, max, text));
+        return value;
+    }
+
+    float parse_positive(ryml::ConstNodeRef node, const std::string& where) {
+        const std::string text = to_string(node.val());
+        char* end = nullptr;
+        errno = 0;
+        const float value = std::strtof(text.c_str(), &end);
+        if (text.empty() || *end || errno || !std::isfinite(value) || value <= 0.0f)
+            throw std::runtime_error(fmt::format("{} must be a positive number, got '{}'", where, text));
+        return value;
+    }
+
+    void apply_setting(const std::string& section, const std::string& key, ryml::ConstNodeRef node,
+                       const std::string& where, AgentServerConfig& config) {
+        if (section == "search" && key == "threads") config.workers = parse_int(node, where, 0, 1024);
+        else if (section == "search" && key == "simulations") config.simulations = parse_int(node, where, 1, 100000000);
+        else if (section == "search" && key == "c_puct") config.c_puct = parse_positive(node, where);
+        else if (section == "inference" && key == "batch_size") config.batch_size = parse_int(node, where, 1, 4096);
+        else if (section == "inference" && key == "batch_wait_us") config.batch_wait_us = parse_int(node, where, 0, 1000000);
+        else if (section == "server" && key == "port") config.port = parse_int(node, where, 0, 65535);
+        else if (section == "server" && key == "unix_path") config.unix_path = to_string(node.val());
+        else throw std::runtime_error(fmt::format("unknown setting {}", where));
+    }
+} // Anonymous namespace
+
+void parse_runtime_config(const std::string& yaml, const std::string& name, AgentServerConfig& config) {
+    // Step 1: parse; syntax errors surface as exceptions from rapidyaml's callbacks
+    ryml::Tree tree;
+    try {
+        tree = ryml::parse_in_arena(ryml::to_csubstr(name), ryml::to_csubstr(yaml));
+    } catch (const std::exception& e) {
+        throw std::runtime_error(fmt::format("{}: {}", name, e.what()));
+    }
+
+    // Step 2: a mapping of sections (or nothing at all)
+    ryml::ConstNodeRef root = tree.crootref();
+    if (!root.is_map()) {
+        if (root.has_children() || (root.has_val() && !root.val().empty()))
+            throw std::runtime_error(fmt::format("{}: expected a mapping of sections", name));
+        return;
+    }
+
+    // Step 3: apply into a copy, so a bad file leaves `config` untouched
+    AgentServerConfig updated = config;
+    for (ryml::ConstNodeRef section : root.children()) {
+        const std::string section_name = to_string(section.key());
+        if (!section.is_map())
+            throw std::runtime_error(fmt::format("{}: {} must be a mapping", name, section_name));
+        for (ryml::ConstNodeRef setting : section.children()) {
+            const std::string key = to_string(setting.key());
+            const std::string where = fmt::format("{}: {}.{}", name, section_name, key);
+            if (!setting.is_keyval()) throw std::runtime_error(fmt::format("{} must be a single value", where));
+            apply_setting(section_name, key, setting, where, updated);
+        }
+    }
+    config = updated;
+}
+
+void load_runtime_config(const std::string& path, AgentServerConfig& config) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error(fmt::format("Cannot open runtime config {}", path));
+    std::stringstream text;
+    text << in.rdbuf();
+    parse_runtime_config(text.str(), path, config);
+}
+
+std::string runtime_config_yaml(const AgentServerConfig& config, const std::string& comment) {
+    ryml::Tree tree;
+    ryml::NodeRef root = tree.rootref();
+    root |= ryml::MAP;
+    root["search"] |= ryml::MAP;
+    root["search"]["threads"] << config.workers;
+    root["search"]["simulations"] << config.simulations;
+    root["search"]["c_puct"] << config.c_puct;
+    root["inference"] |= ryml::MAP;
+    root["inference"]["batch_size"] << config.batch_size;
+    root["inference"]["batch_wait_us"] << config.batch_wait_us;
+
+    std::string out;
+    std::istringstream lines(comment);
+    for (std::string line; std::getline(lines, line);) out += line.empty() ? "#\n" : "# " + line + "\n";
+    return out + ryml::emitrs_yaml<std::string>(tree);
+}
+
+void save_runtime_config(const std::string& path, const AgentServerConfig& config, const std::string& comment) {
+    std::ofstream out(path, std::ios::trunc);
+    out << runtime_config_yaml(config, comment);
+    if (!out.flush()) throw std::runtime_error(fmt::format("Failed to write runtime config {}", path));
+}
+
+} // namespace othello
@@ -0,0 +1,125 @@
+#include "othello/selfplay.hpp"
+#include "othello/mcts.hpp"
+#include "othello/trace.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+namespace othello {
+
+SelfPlay::SelfPlay(EvaluatorFactory factory, ReplaySink& sink, const SelfPlayConfig& config)
+    : factory_(std::move(factory)), sink_(sink), config_(config)
+{
+    if (config_.threads <= 0) config_.threads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+std::vector<TrainSample> SelfPlay::play_game(Evaluator& evaluator, const SelfPlayConfig& config, uint32_t seed,
+                                             Player* winner, GameRecord* record) {
+    MCTS mcts(evaluator, config.simulations, config.c_puct);
+    mcts.seed(seed);
+    mcts.set_log_stats(false);
+
+    OthelloBoard board;
+    Player player = Player::BLACK;
+    mcts.set_root(board, player);
+
+    std::vector<TrainSample> samples;
+    std::vector<Player> movers;
+    int ply = 0;
+    if (record) record->moves.clear();
+
+    while (!board.is_game_over()) {
+        // Step 1: forced passes are not decisions, so they produce no sample
+        if (!board.has_valid_move(player)) {
+            board.apply_move(player, othello::PASS);
+            mcts.apply_move_to_root(othello::PASS);
+            if (record) record->moves.push_back(othello::PASS);
+            player = opponent(player);
+            continue;
+        }
+
+        // Step 2: search and record the visit distribution
+        mcts.run();
+        samples.push_back({board.to_tensor(player), mcts.get_policy_target(), 0.0f, player});
+        movers.push_back(player);
+
+        // Step 3: sample early moves for diversity, then play the most visited move
+        Move move = mcts.best_move(ply < config.temperature_plies);
+        board.apply_move(player, move);
+        if (record) record->moves.push_back(move);
+        mcts.apply_move_to_root(move);
+        player = opponent(player);
+        ++ply;
+    }
+
+    // Step 4: backfill the result from each mover's perspective
+    Player result = board.get_winner();
+    for (size_t i = 0; i < samples.size(); ++i)
+        samples[i].value = (result == Player::NONE) ? 0.0f : (movers[i] == result ? 1.0f : -1.0f);
+    if (winner) *winner = result;
+    if (record) record->winner = result;
+    return samples;
+}
+
+SelfPlayStats SelfPlay::run(int games) {
+    SelfPlayStats stats;
+    std::mutex stats_mutex;
+    std::atomic<int> next_game{0};
+    std::exception_ptr error;
+    auto start = std::chrono::steady_clock::now();
+
+    std::atomic<int> worker_count{0};
+    auto worker = [&] {
+        trace::set_thread_name(fmt::format("selfplay {}", worker_count.fetch_add(1)));
+        try {
+            std::unique_ptr<Evaluator> evaluator = factory_();
+            for (int g = next_game.fetch_add(1); g < games; g = next_game.fetch_add(1)) {
+                // The traced game shares the capture with whatever the other workers play meanwhile
+                const bool traced = g == config_.trace_game && !config_.trace_path.empty();
+                if (traced) trace::start();
+                Player winner;
+                GameRecord record;
+                auto samples = play_game(*evaluator, config_, config_.seed + g, &winner, observer_ ? &record : nullptr);
+                if (traced) {
+                    trace::stop();
+                    trace::write_chrome_json(config_.trace_path);
+                }
+                sink_.insert_batch(samples);
+                if (observer_) observer_(record);
+
+                std::lock_guard<std::mutex> lock(stats_mutex);
+                ++stats.games;
+                stats.positions += samples.size();
+                if (winner == Player::BLACK) ++stats.black_wins;
+                else if (winner == Player::WHITE) ++stats.white_wins;
+                else ++stats.draws;
+
+                if (config_.report_every > 0 && stats.games % config_.report_every == 0) {
+                    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                    spdlog::info("[SelfPlay] {}/{} games, {:.2f} games/s, {:.1f} positions/s", stats.games, games,
+                                 stats.games / elapsed.count(), stats.positions / elapsed.count());
+                }
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(stats_mutex);
+            if (!error) error = std::current_exception();
+            next_game.store(games);   // stop the other workers
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < std::min(config_.threads, std::max(games, 1)); ++t) threads.emplace_back(worker);
+    for (auto& t : threads) t.join();
+    if (error) std::rethrow_exception(error);
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+} // namespace othello
@@ -0,0 +1,178 @@
+#include "othello/trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+namespace othello::trace {
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct ThreadBuffer {
+        uint32_t tid = 0;
+        std::string name;                          // guarded by registry_mutex
+        std::atomic<uint64_t> generation{0};       // capture the contents belong to
+        std::atomic<size_t> count{0};
+        std::atomic<uint64_t> dropped{0};
+        std::unique_ptr<Event[]> events;           // allocated by the thread's first capture
+        std::atomic<bool> exited{false};
+    };
+
+    std::mutex registry_mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;   // outlive their threads until the next start()
+    uint32_t next_tid = 1;
+
+    std::atomic<uint64_t> generation{0};
+    std::atomic<int64_t> epoch_ns{0};
+
+    int64_t steady_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    }
+
+    // The calling thread's buffer, registered on first use and flagged when the thread exits
+    struct ThreadHandle {
+        std::shared_ptr<ThreadBuffer> buffer;
+
+        ~ThreadHandle() {
+            if (buffer) buffer->exited.store(true);
+        }
+
+        ThreadBuffer& get() {
+            if (!buffer) {
+                buffer = std::make_shared<ThreadBuffer>();
+                std::lock_guard<std::mutex> lock(registry_mutex);
+                buffer->tid = next_tid++;
+                buffers.push_back(buffer);
+            }
+            return *buffer;
+        }
+    };
+
+    thread_local ThreadHandle this_thread;
+
+    std::string escape(const std::string& s) {
+        std::string out;
+        for (char c : s) {
+            if (c == '"' || c == '\\') out += '\\';
+            if (static_cast<unsigned char>(c) >= 0x20) out += c;
+        }
+        return out;
+    }
+} // Anonymous namespace
+
+uint64_t detail::now_ns() {
+    const int64_t ns = steady_ns() - epoch_ns.load(std::memory_order_relaxed);
+    return ns > 0 ? static_cast<uint64_t>(ns) : 0;
+}
+
+void detail::record(const char* name, uint64_t start_ns, const char* arg_name, int64_t arg) {
+    const uint64_t end_ns = now_ns();
+    ThreadBuffer& b = this_thread.get();
+
+    // First event of a new capture on this thread: the old contents are stale
+    const uint64_t current = generation.load(std::memory_order_acquire);
+    if (b.generation.load(std::memory_order_relaxed) != current) {
+        if (!b.events) b.events.reset(new Event[kThreadCapacity]);
+        b.count.store(0, std::memory_order_relaxed);
+        b.dropped.store(0, std::memory_order_relaxed);
+        b.generation.store(current, std::memory_order_release);
+    }
+
+    const size_t n = b.count.load(std::memory_order_relaxed);
+    if (n == kThreadCapacity) {
+        b.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    b.events[n] = {name, start_ns, end_ns > start_ns ? end_ns - start_ns : 0, arg_name, arg, b.tid};
+    b.count.store(n + 1, std::memory_order_release);   // publishes the event to collect()
+}
+
+void start() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+                                 [](const std::shared_ptr<ThreadBuffer>& b) { return b->exited.load(); }),
+                  buffers.end());
+    epoch_ns.store(steady_ns());
+    generation.fetch_add(1, std::memory_order_release);
+    detail::capturing.store(true);
+}
+
+void stop() {
+    detail::capturing.store(false);
+}
+
+std::vector<Event> collect(uint64_t* dropped) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    const uint64_t current = generation.load();
+    std::vector<Event> events;
+    if (dropped) *dropped = 0;
+    for (const auto& b : buffers) {
+        if (b->generation.load(std::memory_order_acquire) != current) continue;
+        const size_t n = b->count.load(std::memory_order_acquire);
+        events.insert(events.end(), b->events.get(), b->events.get() + n);
+        if (dropped) *dropped += b->dropped.load(std::memory_order_relaxed);
+    }
+    std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+        return a.tid != b.tid ? a.tid < b.tid : a.start_ns < b.start_ns;
+    });
+    return events;
+}
+
+void set_thread_name(const std::string& name) {
+    ThreadBuffer& b = this_thread.get();
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    b.name = name;
+}
+
+std::string chrome_json() {
+    uint64_t dropped = 0;
+    std::vector<Event> events = collect(&dropped);
+    if (dropped) spdlog::warn("Trace dropped {} events (over {} on a thread)", dropped, kThreadCapacity);
+
+    fmt::memory_buffer out;
+    auto it = std::back_inserter(out);
+    fmt::format_to(it, "{{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+    // Step 1: track names for the threads that recorded anything
+    bool first = true;
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        for (const auto& b : buffers) {
+            if (b->generation.load() != generation.load() || b->count.load() == 0) continue;
+            const std::string name = b->name.empty() ? fmt::format("thread {}", b->tid) : escape(b->name);
+            fmt::format_to(it, "{}{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}",
+                           first ? "" : ",\n", b->tid, name);
+            first = false;
+        }
+    }
+
+    // Step 2: one complete ("X") event per span, times in microseconds
+    for (const Event& e : events) {
+        fmt::format_to(it, "{}{{\"name\":\"{}\",\"cat\":\"search\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}",
+                       first ? "" : ",\n", e.name, e.tid, e.start_ns / 1000.0, e.duration_ns / 1000.0);
+        if (e.arg_name) fmt::format_to(it, ",\"args\":{{\"{}\":{}}}", e.arg_name, e.arg);
+        fmt::format_to(it, "}}");
+        first = false;
+    }
+    fmt::format_to(it, "\n]}}\n");
+    return fmt::to_string(out);
+}
+
+bool write_chrome_json(const std::string& path) {
+    std::ofstream out(path, std::ios::trunc);
+    out << chrome_json();
+    if (!out.flush()) {
+        spdlog::error("Failed to write trace to {}", path);
+        return false;
+    }
+    spdlog::info("Wrote search trace to {}", path);
+    return true;
+}
+
+} // namespace othello::trace
@@ -0,0 +1,161 @@
+#include "othello/tuner.hpp"
+#include "othello/inference_broker.hpp"
+#include "othello/mcts.hpp"
+#include "othello/metrics.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+
+namespace othello {
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int kPositions = 64;
+
+    // Candidates 1, 2, 4, ... up to `limit`, which is always included
+    std::vector<int> powers_of_two(int limit) {
+        std::vector<int> values;
+        for (int v = 1; v < limit; v *= 2) values.push_back(v);
+        values.push_back(limit);
+        return values;
+    }
+} // Anonymous namespace
+
+Tuner::Tuner(EvaluatorFactory factory, BatchEvaluator* batch_backend, const TuneConfig& config)
+    : factory_(std::move(factory)), batch_backend_(batch_backend), config_(config)
+{
+    if (config_.simulations <= 0 || config_.latency_ms <= 0.0 || config_.seconds_per_point <= 0.0)
+        throw std::invalid_argument("Tuner needs positive simulations, latency target and duration");
+
+    // Openings and middle games from random play, always with a move to search
+    std::mt19937 rng(config_.seed);
+    while (positions_.size() < kPositions) {
+        OthelloBoard board;
+        Player player = Player::BLACK;
+        const int plies = 4 + static_cast<int>(positions_.size() * 7 % 40);
+        for (int ply = 0; ply < plies && !board.is_game_over(); ++ply) {
+            auto moves = board.get_valid_moves(player);
+            Move move = moves.empty() ? othello::PASS : moves[rng() % moves.size()];
+            board.apply_move(player, move);
+            player = opponent(player);
+        }
+        if (board.has_valid_move(player)) positions_.push_back({board, player});
+    }
+}
+
+TunePoint Tuner::measure(int threads, int batch_size) {
+    TunePoint point;
+    point.threads = threads;
+    point.batch_size = batch_size;
+
+    // Step 1: the threads share a broker when batching, like the server's workers
+    std::unique_ptr<InferenceBroker> broker;
+    if (batch_size > 1) {
+        if (!batch_backend_) throw std::invalid_argument("Batching needs a batch backend");
+        BrokerConfig broker_config;
+        broker_config.max_batch = batch_size;
+        broker_config.max_wait = std::chrono::microseconds(config_.batch_wait_us);
+        broker = std::make_unique<InferenceBroker>(*batch_backend_, broker_config);
+    }
+
+    // Step 2: search until the time is up; every thread finishes at least one search
+    metrics::Histogram move_us;
+    std::atomic<uint64_t> simulations{0};
+    std::atomic<uint64_t> searches{0};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    const auto start = Clock::now();
+    const auto deadline = start + std::chrono::duration_cast<Clock::duration>(
+                                      std::chrono::duration<double>(config_.seconds_per_point));
+
+    auto worker = [&](int index) {
+        try {
+            std::unique_ptr<Evaluator> evaluator;
+            if (broker) evaluator = std::make_unique<BrokerEvaluator>(*broker);
+            else evaluator = factory_();
+            MCTS mcts(*evaluator, config_.simulations, config_.c_puct);
+            mcts.set_log_stats(false);
+            for (size_t i = index;; i += threads) {
+                const auto& [board, player] = positions_[i % positions_.size()];
+                const auto begin = Clock::now();
+                mcts.set_root(board, player);
+                mcts.run();
+                const auto end = Clock::now();
+                move_us.record(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
+                simulations.fetch_add(mcts.last_simulations());
+                searches.fetch_add(1);
+                if (end >= deadline) break;
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) error = std::current_exception();
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) pool.emplace_back(worker, t);
+    for (auto& t : pool) t.join();
+    if (error) std::rethrow_exception(error);
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    point.searches = searches.load();
+    point.nodes_per_second = simulations.load() / seconds;
+    point.p99_move_ms = move_us.snapshot().percentile(0.99) / 1000.0;
+    return point;
+}
+
+TuneResult Tuner::run() {
+    TuneResult result;
+    const int hardware = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    const std::vector<int> thread_counts = config_.threads.empty() ? powers_of_two(hardware) : config_.threads;
+
+    // Step 1: the grid. Each search has one evaluation in flight, so a batch larger than the
+    // thread count could never fill and is skipped.
+    for (int threads : thread_counts) {
+        std::vector<int> batch_sizes{1};
+        if (batch_backend_) {
+            for (int b : config_.batch_sizes.empty() ? powers_of_two(threads) : config_.batch_sizes)
+                if (b > 1 && b <= threads && b <= batch_backend_->max_batch_size()) batch_sizes.push_back(b);
+        }
+        for (int batch_size : batch_sizes) {
+            TunePoint point = measure(threads, batch_size);
+            spdlog::info("[Tune] {} threads, batch {}: {:.0f} nodes/s, p99 move {:.1f} ms over {} searches",
+                         threads, batch_size, point.nodes_per_second, point.p99_move_ms, point.searches);
+            result.points.push_back(point);
+        }
+    }
+
+    // Step 2: best throughput within the latency target, or failing that the quickest moves
+    const TunePoint* best = nullptr;
+    for (const TunePoint& p : result.points)
+        if (p.p99_move_ms <= config_.latency_ms && (!best || p.nodes_per_second > best->nodes_per_second)) best = &p;
+    result.met_target = best != nullptr;
+    if (!best) {
+        for (const TunePoint& p : result.points)
+            if (!best || p.p99_move_ms < best->p99_move_ms) best = &p;
+    }
+
+    result.best_point = *best;
+    result.best.workers = best->threads;
+    result.best.batch_size = best->batch_size;
+    result.best.batch_wait_us = config_.batch_wait_us;
+    result.best.c_puct = config_.c_puct;
+    result.best.simulations = config_.simulations;
+    if (!result.met_target) {
+        const double fraction = config_.latency_ms / best->p99_move_ms;
+        result.best.simulations = std::max(1, static_cast<int>(config_.simulations * fraction));
+        spdlog::warn("[Tune] No configuration meets {} ms per move; cutting simulations to {}", config_.latency_ms,
+                     result.best.simulations);
+    }
+    return result;
+}
+
+} // namespace othello
@@ -1,8 +1,11 @@
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <string>
-#include <sstream>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
+#include <vector>
 #ifdef _WIN32
 #include <stdio.h>
 #include <winsock2.h>
@@ -14,9 +17,16 @@
 #include <unistd.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <sys/socket.h>
 #endif
 
+#include "othello/protocol.hpp"
+#include "othello/transport.hpp"
+
+namespace protocol = othello::protocol;
+namespace transport = othello::transport;
+
 enum Side { BLACK, WHITE };
 
 const char REMOTE_ADDR[] = "127.0.0.1";
@@ -62,9 +72,63 @@ int connectToAgent(const std::string& hostname, int port) {
         exit(1);
     }
 
+    // One small message per move: send it now rather than waiting to coalesce
+    int nodelay = 1;
+    setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&nodelay), sizeof(nodelay));
+
     return sockfd;
 }
 
+// Connects with the named transport ("tcp", "unix" or "shm"); exits on failure
+std::unique_ptr<transport::ClientTransport> connectTransport(const std::string& kind, const std::string& host,
+                                                             const std::string& unix_path) {
+    if (kind == "tcp") return std::make_unique<transport::SocketTransport>(connectToAgent(host, REMOTE_PORT), "tcp");
+    #ifndef _WIN32
+    if (kind == "unix" || kind == "shm") {
+        int fd = transport::connect_unix(unix_path);
+        if (fd < 0) {
+            perror(("ERROR connecting to " + unix_path).c_str());
+            exit(1);
+        }
+        if (kind == "unix") return std::make_unique<transport::SocketTransport>(fd, "unix");
+        auto shm = transport::ShmTransport::attach(fd);
+        if (!shm) {
+            std::cerr << "ERROR: failed to set up shared memory" << std::endl;
+            exit(1);
+        }
+        return shm;
+    }
+    #endif
+    std::cerr << "ERROR: unsupported transport " << kind << std::endl;
+    exit(1);
+}
+
+// Round trips of `count` sequential pings, reported on stdout
+int pingBenchmark(transport::ClientTransport& link, int count) {
+    protocol::FrameReader reader;
+    std::vector<double> micros;
+    micros.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        protocol::FrameWriter ping(protocol::MessageType::Ping);
+        ping.u64(static_cast<uint64_t>(i));
+        protocol::Frame pong;
+        if (!transport::send_frame(link, ping) ||
+            !transport::read_frame(link, reader, protocol::MessageType::Pong, pong)) {
+            std::cerr << "ERROR: connection lost during ping " << i << std::endl;
+            return 1;
+        }
+        reader.pop();
+        micros.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(micros.begin(), micros.end());
+    double sum = 0.0;
+    for (double us : micros) sum += us;
+    std::cout << link.name() << ": " << count << " pings, mean " << sum / count << " us, p50 " << micros[count / 2]
+              << " us, p99 " << micros[(count - 1) * 99 / 100] << " us, max " << micros.back() << " us" << std::endl;
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     #ifdef _WIN32
     // Retrieve WSL Address
@@ -89,11 +153,6 @@ int main(int argc, char* argv[]) {
         std::cerr << "Unable to retrieve WSL address: " << wsl_addr << std::endl;
     }
     #endif
-    if (argc != 2) {
-        std::cerr << "usage: " << argv[0] << " side" << std::endl;
-        return 1;
-    }
-
     for (int i = 0; i < argc; i++) {
         if (std::string(argv[i]) == "--version") {
             std::cerr << "remote_agent compiled for " << (WIN32_BUILD ? "WIN32" : "Unix") << std::endl;
@@ -101,20 +160,59 @@ int main(int argc, char* argv[]) {
 	}
     }
 
-    Side side = (!strcmp(argv[1], "Black")) ? BLACK : WHITE;
-    const std::string color = (side == BLACK) ? "Black" : "White";
+    // side | --ping N, then [--transport tcp|unix|shm] [--unix <path>]
+    std::string first = argc > 1 ? argv[1] : "";
+    int pings = 0;
+    int next = 2;
+    if (first == "--ping" && argc > 2) {
+        pings = std::max(1, atoi(argv[2]));
+        next = 3;
+    }
+    std::string kind;
+    std::string unix_path = transport::kDefaultUnixPath;
+    bool usage = argc < 2;
+    for (int i = next; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--transport" && i + 1 < argc) kind = argv[++i];
+        else if (arg == "--unix" && i + 1 < argc) unix_path = argv[++i];
+        else usage = true;
+    }
+    if (usage) {
+        std::cerr << "usage: " << argv[0] << " (side | --ping N) [--transport tcp|unix|shm] [--unix path]" << std::endl;
+        return 1;
+    }
 
-    // Connect to remote RL agent
     #ifdef _WIN32
-    int sockfd = connectToAgent(wsl_addr, REMOTE_PORT);
-    #endif
-    #ifndef _WIN32
-    int sockfd = connectToAgent(std::string(REMOTE_ADDR), REMOTE_PORT);
+    const std::string host = wsl_addr;
+    #else
+    const std::string host = REMOTE_ADDR;
     #endif
 
+    // Without --transport the ping benchmark compares every transport of this platform
+    if (pings) {
+        #ifdef _WIN32
+        std::vector<std::string> kinds = {"tcp"};
+        #else
+        std::vector<std::string> kinds = {"tcp", "unix", "shm"};
+        #endif
+        if (!kind.empty()) kinds = {kind};
+        int status = 0;
+        for (const std::string& k : kinds) {
+            auto link = connectTransport(k, host, unix_path);
+            status |= pingBenchmark(*link, pings);
+        }
+        return status;
+    }
+
+    Side side = (first == "Black") ? BLACK : WHITE;
+
+    // Connect to remote RL agent (TCP unless told otherwise, for remote setups)
+    auto link = connectTransport(kind.empty() ? "tcp" : kind, host, unix_path);
+
     // Send the side once after connecting
-    std::string side_msg = color + "\n";
-    if (send(sockfd, side_msg.c_str(), side_msg.size(), 0) < 0) {
+    protocol::FrameWriter hello(protocol::MessageType::Hello);
+    hello.u8(protocol::kVersion).u8(side == BLACK ? 0 : 1);
+    if (!transport::send_frame(*link, hello)) {
         perror("ERROR sending side to agent");
         return 1;
     }
@@ -124,39 +222,36 @@ int main(int argc, char* argv[]) {
     std::cout.flush();
 
     // Main game loop
+    protocol::FrameReader reader;
     int moveX, moveY, msLeft;
     while (std::cin >> moveX >> moveY >> msLeft) {
-        std::ostringstream msg;
-        msg << moveX << " " << moveY << " " << msLeft << std::endl;;
-        std::string msgStr = msg.str();
+        protocol::FrameWriter move(protocol::MessageType::Move);
+        move.i8(static_cast<int8_t>(moveX)).i8(static_cast<int8_t>(moveY)).i32(msLeft);
 
         // Send to remote agent
-        if (send(sockfd, msgStr.c_str(), msgStr.size(), 0) < 0) {
+        if (!transport::send_frame(*link, move)) {
             perror("ERROR writing to socket");
             break;
         }
 
         // Read response
-        char buffer[256] = {0};
-        int n = recv(sockfd, buffer, 255, 0);
-        if (n <= 0) {
+        protocol::Frame reply;
+        if (!transport::read_frame(*link, reader, protocol::MessageType::Reply, reply)) {
             std::cerr << "ERROR reading from socket or remote disconnected" << std::endl;
             break;
         }
-
-        int x, y;
-        std::istringstream respStream((std::string(buffer))); // Double parenthesis to mitigate aggressive intellisense; C++ spec is vague
-        respStream >> x >> y;
+        protocol::PayloadReader in(reply);
+        int x = in.i8();
+        int y = in.i8();
+        reader.pop();
 
         std::cout << x << " " << y << std::endl;
         std::cout.flush();
     }
 
+    link.reset();
     #ifdef _WIN32
-    closesocket(sockfd);
     WSACleanup();
-    #else
-    close(sockfd);
     #endif
 
     return 0;
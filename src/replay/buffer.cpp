@@ -1,16 +1,71 @@
 #include "replay/buffer.hpp"
+#include "othello/bitboard.hpp"
+#include "othello/symmetry.hpp"
 #include <algorithm>
-#include <random>
 #include <cassert>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    constexpr float kPolicyScale = 65535.0f;
+
+    uint64_t plane_bits(const float* plane) {
+        uint64_t bits = 0;
+        for (int i = 0; i < 64; ++i)
+            if (plane[i] > 0.5f) bits |= 1ULL << i;
+        return bits;
+    }
+} // Anonymous namespace
 
 ReplayBuffer::ReplayBuffer(size_t capacity)
-    : capacity_(capacity), rng_(std::random_device{}()) {}
+    : capacity_(capacity),
+      words_(new std::atomic<uint64_t>[capacity * kSlotWords]()),
+      seq_(new std::atomic<uint32_t>[capacity]),
+      rng_(std::random_device{}())
+{
+    if (capacity == 0) throw std::invalid_argument("ReplayBuffer capacity must be positive");
+    for (size_t i = 0; i < capacity; ++i) seq_[i].store(0, std::memory_order_relaxed);
+}
+
+uint64_t ReplayBuffer::insert(uint64_t own, uint64_t opp, const float* policy, float value) {
+    const uint64_t id = cursor_.fetch_add(1, std::memory_order_relaxed);
+    const size_t slot = id % capacity_;
+
+    // Step 1: take the slot (even -> odd). Two writers only meet here if the ring wrapped
+    // during a single write, in which case the later one waits.
+    std::atomic<uint32_t>& seq = seq_[slot];
+    uint32_t s = seq.load(std::memory_order_relaxed);
+    while ((s & 1) || !seq.compare_exchange_weak(s, s + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+        if (s & 1) {
+            std::this_thread::yield();
+            s = seq.load(std::memory_order_relaxed);
+        }
+    }
+    std::atomic_thread_fence(std::memory_order_release);
 
-void ReplayBuffer::insert(const TrainSample& sample) {
-    if (buffer_.size() >= capacity_) {
-        buffer_.pop_front(); // Remove the oldest sample
+    // Step 2: write the payload, a word at a time so that a racing reader's loads stay defined
+    uint64_t packed[kSlotWords] = {own, opp};
+    for (int i = 0; i < kPolicySize; ++i) {
+        const uint64_t q = static_cast<uint64_t>(std::lround(std::clamp(policy[i], 0.0f, 1.0f) * kPolicyScale));
+        packed[2 + i / 4] |= q << (16 * (i % 4));
     }
-    buffer_.push_back(sample);
+    uint32_t value_bits;
+    std::memcpy(&value_bits, &value, sizeof(value_bits));
+    packed[kSlotWords - 1] |= uint64_t{value_bits} << 32;
+    std::atomic<uint64_t>* words = words_.get() + slot * kSlotWords;
+    for (int w = 0; w < kSlotWords; ++w) words[w].store(packed[w], std::memory_order_relaxed);
+
+    // Step 3: publish (odd -> even)
+    seq.store(s + 2, std::memory_order_release);
+    return id;
+}
+
+uint64_t ReplayBuffer::insert(const TrainSample& sample) {
+    assert(sample.state.size() >= 128 && sample.policy.size() >= kPolicySize);
+    return insert(plane_bits(sample.state.data()), plane_bits(sample.state.data() + 64), sample.policy.data(), sample.value);
 }
 
 void ReplayBuffer::insert_batch(const std::vector<TrainSample>& batch) {
@@ -19,22 +74,101 @@ void ReplayBuffer::insert_batch(const std::vector<TrainSample>& batch) {
     }
 }
 
-std::vector<TrainSample> ReplayBuffer::sample(size_t batch_size) const {
-    assert(buffer_.size() >= batch_size);
+bool ReplayBuffer::read(size_t slot, uint64_t& own, uint64_t& opp, float* policy, float& value) const {
+    return read_slot(slot, 0, own, opp, policy, value);
+}
 
-    std::vector<TrainSample> batch;
-    batch.reserve(batch_size);
+bool ReplayBuffer::read_into(size_t slot, float* state, float* policy, float* value, int symmetry) const {
+    return decode_into(slot, 0, state, policy, value, symmetry);
+}
 
-    std::uniform_int_distribution<size_t> dist(0, buffer_.size() - 1);
+bool ReplayBuffer::read_id_into(uint64_t id, float* state, float* policy, float* value, int symmetry) const {
+    // Every write to a slot adds 2 to its sequence number, and id is the slot's (id / capacity)-th
+    // write, so the sequence number identifies which sample the slot holds
+    return decode_into(id % capacity_, static_cast<uint32_t>(2 * (id / capacity_ + 1)), state, policy, value, symmetry);
+}
 
-    for (size_t i = 0; i < batch_size; ++i) {
-        size_t idx = dist(rng_);
-        batch.push_back(buffer_[idx]);
+bool ReplayBuffer::read_slot(size_t slot, uint32_t expect, uint64_t& own, uint64_t& opp, float* policy,
+                             float& value) const {
+    const std::atomic<uint32_t>& seq = seq_[slot];
+    const std::atomic<uint64_t>* words = words_.get() + slot * kSlotWords;
+    uint64_t packed[kSlotWords];
+    while (true) {
+        uint32_t before = seq.load(std::memory_order_acquire);
+        if (before == 0) return false;
+        if (before & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (expect && before != expect) return false;
+        for (int w = 0; w < kSlotWords; ++w) packed[w] = words[w].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq.load(std::memory_order_relaxed) == before) break;   // not overwritten meanwhile
     }
+    own = packed[0];
+    opp = packed[1];
+    for (int i = 0; i < kPolicySize; ++i)
+        policy[i] = static_cast<uint16_t>(packed[2 + i / 4] >> (16 * (i % 4))) / kPolicyScale;
+    const uint32_t value_bits = static_cast<uint32_t>(packed[kSlotWords - 1] >> 32);
+    std::memcpy(&value, &value_bits, sizeof(value));
+    return true;
+}
 
+void ReplayBuffer::sample_into(size_t batch_size, float* states, float* policies, float* values,
+                               std::mt19937& rng) const {
+    const size_t filled = size();
+    assert(filled > 0);
+    std::uniform_int_distribution<size_t> dist(0, filled - 1);
+    std::uniform_int_distribution<int> symmetry(0, othello::symmetry::kCount - 1);
+
+    for (size_t b = 0; b < batch_size; ++b) {
+        const int t = augment_ ? symmetry(rng) : 0;
+        while (!read_into(dist(rng), states + b * kStateSize, policies + b * kPolicySize, values + b, t)) {}
+    }
+}
+
+bool ReplayBuffer::decode_into(size_t slot, uint32_t expect, float* state, float* policy, float* value,
+                               int symmetry) const {
+    uint64_t own, opp;
+    if (symmetry == 0) {
+        if (!read_slot(slot, expect, own, opp, policy, *value)) return false;
+    } else {
+        // Permute the compact form; planes are then expanded from the transformed bitboards
+        float raw[kPolicySize];
+        if (!read_slot(slot, expect, own, opp, raw, *value)) return false;
+        own = othello::symmetry::transform(own, symmetry);
+        opp = othello::symmetry::transform(opp, symmetry);
+        othello::symmetry::transform_policy(raw, policy, symmetry);
+    }
+
+    const uint64_t moves = othello::bitboard::legal_moves(own, opp);
+    for (int i = 0; i < 64; ++i) {
+        state[i] = static_cast<float>((own >> i) & 1);
+        state[64 + i] = static_cast<float>((opp >> i) & 1);
+        state[128 + i] = static_cast<float>((moves >> i) & 1);
+    }
+    return true;
+}
+
+std::vector<TrainSample> ReplayBuffer::sample(size_t batch_size) const {
+    assert(size() >= batch_size);
+
+    std::vector<float> states(batch_size * kStateSize), policies(batch_size * kPolicySize), values(batch_size);
+    sample_into(batch_size, states.data(), policies.data(), values.data(), rng_);
+
+    std::vector<TrainSample> batch(batch_size);
+    for (size_t i = 0; i < batch_size; ++i) {
+        batch[i].state.assign(states.begin() + i * kStateSize, states.begin() + (i + 1) * kStateSize);
+        batch[i].policy.assign(policies.begin() + i * kPolicySize, policies.begin() + (i + 1) * kPolicySize);
+        batch[i].value = values[i];
+    }
     return batch;
 }
 
 size_t ReplayBuffer::size() const {
-    return buffer_.size();
-}
\ No newline at end of file
+    return static_cast<size_t>(std::min<uint64_t>(cursor_.load(std::memory_order_relaxed), capacity_));
+}
+
+size_t ReplayBuffer::memory_bytes() const {
+    return capacity_ * (kSlotWords * sizeof(uint64_t) + sizeof(uint32_t));
+}
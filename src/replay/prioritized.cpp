@@ -0,0 +1,131 @@
+#include "replay/prioritized.hpp"
+#include "othello/symmetry.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace replay {
+
+namespace {
+    constexpr uint64_t kEmptySlot = std::numeric_limits<uint64_t>::max();
+} // Anonymous namespace
+
+SumTree::SumTree(size_t size) : size_(size), leaves_(1) {
+    if (size == 0) throw std::invalid_argument("SumTree size must be positive");
+    while (leaves_ < size) leaves_ <<= 1;
+    nodes_.assign(2 * leaves_, 0.0);
+}
+
+void SumTree::set(size_t i, double priority) {
+    assert(i < size_ && priority >= 0.0);
+    size_t node = leaves_ + i;
+    nodes_[node] = priority;
+    // Recompute rather than add the delta, so rounding errors do not accumulate
+    for (node >>= 1; node >= 1; node >>= 1) nodes_[node] = nodes_[2 * node] + nodes_[2 * node + 1];
+}
+
+size_t SumTree::find(double prefix) const {
+    size_t node = 1;
+    while (node < leaves_) {
+        double left = nodes_[2 * node];
+        if (prefix < left || nodes_[2 * node + 1] <= 0.0) {
+            node = 2 * node;
+        } else {
+            prefix -= left;
+            node = 2 * node + 1;
+        }
+    }
+    return std::min(node - leaves_, size_ - 1);
+}
+
+PrioritizedReplay::PrioritizedReplay(size_t capacity, const PriorityConfig& config)
+    : config_(config), buffer_(capacity), tree_(capacity), slot_id_(capacity, kEmptySlot) {}
+
+uint64_t PrioritizedReplay::insert(uint64_t own, uint64_t opp, const float* policy, float value) {
+    return track(buffer_.insert(own, opp, policy, value));
+}
+
+uint64_t PrioritizedReplay::insert(const TrainSample& sample) {
+    return track(buffer_.insert(sample));
+}
+
+uint64_t PrioritizedReplay::track(uint64_t id) {
+    size_t slot = id % buffer_.capacity();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    // If the ring wrapped during a concurrent insert, the newer id owns the slot
+    if (slot_id_[slot] == kEmptySlot || id > slot_id_[slot]) {
+        slot_id_[slot] = id;
+        tree_.set(slot, max_priority_);
+    }
+    return id;
+}
+
+void PrioritizedReplay::insert_batch(const std::vector<TrainSample>& batch) {
+    for (const auto& sample : batch) insert(sample);
+}
+
+void PrioritizedReplay::sample_into(size_t batch_size, float* states, float* policies, float* values, float* weights,
+                                    uint64_t* ids, std::mt19937& rng) const {
+    std::vector<size_t> slots(batch_size);
+    std::vector<double> probabilities(batch_size);
+    size_t filled;
+
+    // Step 1: stratified proportional draws: one uniform point per equal slice of the total
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const double total = tree_.total();
+        if (total <= 0.0) throw std::logic_error("Sampling from an empty prioritized replay");
+        filled = buffer_.size();
+        const double slice = total / batch_size;
+        std::uniform_real_distribution<double> offset(0.0, slice);
+        for (size_t b = 0; b < batch_size; ++b) {
+            double prefix = std::min(b * slice + offset(rng), std::nextafter(total, 0.0));
+            slots[b] = tree_.find(prefix);
+            ids[b] = slot_id_[slots[b]];
+            probabilities[b] = tree_.get(slots[b]) / total;
+        }
+    }
+
+    // Step 2: importance-sampling weights (N * P)^-beta, scaled so the batch maximum is 1
+    double max_weight = 0.0;
+    std::vector<double> w(batch_size);
+    for (size_t b = 0; b < batch_size; ++b) {
+        w[b] = std::pow(double(filled) * probabilities[b], -config_.beta);
+        max_weight = std::max(max_weight, w[b]);
+    }
+    for (size_t b = 0; b < batch_size; ++b) weights[b] = static_cast<float>(w[b] / max_weight);
+
+    // Step 3: decode outside the lock. An insert may overwrite a drawn slot meanwhile; the
+    // read then fails and the slot's current sample (and id) stands in for it.
+    std::uniform_int_distribution<int> symmetry(0, othello::symmetry::kCount - 1);
+    for (size_t b = 0; b < batch_size; ++b) {
+        const int t = buffer_.augment() ? symmetry(rng) : 0;
+        while (!buffer_.read_id_into(ids[b], states + b * ReplayBuffer::kStateSize,
+                                     policies + b * ReplayBuffer::kPolicySize, values + b, t)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ids[b] = slot_id_[slots[b]];
+        }
+    }
+}
+
+void PrioritizedReplay::update_priorities(const uint64_t* ids, const float* errors, size_t n) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < n; ++i) {
+        size_t slot = ids[i] % buffer_.capacity();
+        if (slot_id_[slot] != ids[i]) continue;   // evicted since it was sampled
+        double priority = std::pow(std::fabs(double(errors[i])) + config_.epsilon, config_.alpha);
+        max_priority_ = std::max(max_priority_, priority);
+        tree_.set(slot, priority);
+    }
+}
+
+double PrioritizedReplay::total_priority() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tree_.total();
+}
+
+} // namespace replay
@@ -0,0 +1,401 @@
+#include "replay/store.hpp"
+#include "othello/bitboard.hpp"
+#include "othello/symmetry.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+namespace replay {
+
+namespace {
+    constexpr const char* kSegmentExtension = ".rps";
+
+    uint8_t quantize_probability(float p) {
+        return static_cast<uint8_t>(std::lround(std::clamp(p, 0.0f, 1.0f) * 255.0f));
+    }
+
+    // Length of an encoded record, read from its header
+    size_t record_bytes(const uint8_t* record) {
+        uint64_t black, white;
+        std::memcpy(&black, record, 8);
+        std::memcpy(&white, record + 8, 8);
+        const bool white_to_move = record[16] != 0;
+        const uint64_t own = white_to_move ? white : black;
+        const uint64_t opp = white_to_move ? black : white;
+        const uint64_t moves = othello::bitboard::legal_moves(own, opp);
+        return kRecordHeaderBytes + othello::bitboard::popcount(moves);
+    }
+} // Anonymous namespace
+
+size_t encode_record(uint64_t black, uint64_t white, Player to_move, const float* policy, float value, uint8_t* out) {
+    std::memcpy(out, &black, 8);
+    std::memcpy(out + 8, &white, 8);
+    out[16] = (to_move == Player::WHITE) ? 1 : 0;
+    out[17] = static_cast<uint8_t>(static_cast<int8_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 127.0f)));
+
+    uint64_t own = (to_move == Player::WHITE) ? white : black;
+    uint64_t opp = (to_move == Player::WHITE) ? black : white;
+    size_t n = 0;
+    for (uint64_t m = othello::bitboard::legal_moves(own, opp); m; m &= m - 1)
+        out[kRecordHeaderBytes + n++] = quantize_probability(policy[__builtin_ctzll(m)]);
+    return kRecordHeaderBytes + n;
+}
+
+void decode_record(const uint8_t* record, float* state, float* policy, float* value, int symmetry) {
+    uint64_t black, white;
+    std::memcpy(&black, record, 8);
+    std::memcpy(&white, record + 8, 8);
+    const bool white_to_move = record[16] != 0;
+    *value = static_cast<int8_t>(record[17]) / 127.0f;
+
+    // The policy bytes follow the stored position's legal moves; each lands on its image square
+    const uint64_t own = white_to_move ? white : black;
+    const uint64_t opp = white_to_move ? black : white;
+    const uint64_t moves = othello::bitboard::legal_moves(own, opp);
+    const uint64_t own_t = othello::symmetry::transform(own, symmetry);
+    const uint64_t opp_t = othello::symmetry::transform(opp, symmetry);
+    const uint64_t moves_t = othello::symmetry::transform(moves, symmetry);
+    for (int i = 0; i < 64; ++i) {
+        state[i] = static_cast<float>((own_t >> i) & 1);
+        state[64 + i] = static_cast<float>((opp_t >> i) & 1);
+        state[128 + i] = static_cast<float>((moves_t >> i) & 1);
+    }
+
+    // Sparse policy back to 65 entries, renormalized after quantization
+    std::fill(policy, policy + 65, 0.0f);
+    if (!moves) {
+        policy[64] = 1.0f;
+        return;
+    }
+    const uint8_t* p = record + kRecordHeaderBytes;
+    float sum = 0.0f;
+    size_t n = 0;
+    for (uint64_t m = moves; m; m &= m - 1, ++n) sum += p[n];
+    const float uniform = 1.0f / n;
+    n = 0;
+    for (uint64_t m = moves; m; m &= m - 1, ++n) {
+        int sq = othello::symmetry::square(__builtin_ctzll(m), symmetry);
+        policy[sq] = (sum > 0.0f) ? p[n] / sum : uniform;
+    }
+}
+
+// ==== Writer ====
+
+ReplayStoreWriter::ReplayStoreWriter(std::string directory, size_t records_per_segment)
+    : directory_(std::move(directory)), records_per_segment_(records_per_segment)
+{
+    if (records_per_segment_ == 0) throw std::invalid_argument("records_per_segment must be positive");
+    std::filesystem::create_directories(directory_);
+}
+
+ReplayStoreWriter::~ReplayStoreWriter() {
+    try {
+        seal();
+    } catch (const std::exception& e) {
+        spdlog::error("[ReplayStore] Failed to seal segment: {}", e.what());
+    }
+}
+
+void ReplayStoreWriter::open_segment() {
+    // pid + counter keeps names unique across concurrent writer processes
+    char name[64];
+    std::snprintf(name, sizeof(name), "segment-%d-%06llu", static_cast<int>(getpid()),
+                  static_cast<unsigned long long>(segments_++));
+    tmp_path_ = directory_ + "/" + name + ".tmp";
+    file_ = std::fopen(tmp_path_.c_str(), "wb");
+    if (!file_) throw std::runtime_error("Failed to create replay segment " + tmp_path_);
+
+    SegmentHeader header{kSegmentMagic, kSegmentVersion};
+    std::fwrite(&header, sizeof(header), 1, file_);
+    offset_ = sizeof(header);
+    offsets_.clear();
+}
+
+void ReplayStoreWriter::append(uint64_t black, uint64_t white, Player to_move, const float* policy, float value) {
+    uint8_t record[kRecordHeaderBytes + 64];
+    size_t bytes = encode_record(black, white, to_move, policy, value, record);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_) open_segment();
+    if (std::fwrite(record, 1, bytes, file_) != bytes) throw std::runtime_error("Failed to write " + tmp_path_);
+    offsets_.push_back(offset_);
+    offset_ += static_cast<uint32_t>(bytes);
+    ++written_;
+    if (offsets_.size() >= records_per_segment_) seal_locked();
+}
+
+void ReplayStoreWriter::append(const TrainSample& sample) {
+    if (sample.to_move == Player::NONE) throw std::invalid_argument("Replay store needs the side to move");
+    assert(sample.state.size() >= 128 && sample.policy.size() >= 65);
+
+    uint64_t own = 0, opp = 0;
+    for (int i = 0; i < 64; ++i) {
+        if (sample.state[i] > 0.5f) own |= 1ULL << i;
+        if (sample.state[64 + i] > 0.5f) opp |= 1ULL << i;
+    }
+    bool black = sample.to_move == Player::BLACK;
+    append(black ? own : opp, black ? opp : own, sample.to_move, sample.policy.data(), sample.value);
+}
+
+void ReplayStoreWriter::append_encoded(const uint8_t* records, const uint8_t* sizes, size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < count; ++i) {
+        if (!file_) open_segment();
+        if (std::fwrite(records, 1, sizes[i], file_) != sizes[i]) throw std::runtime_error("Failed to write " + tmp_path_);
+        records += sizes[i];
+        offsets_.push_back(offset_);
+        offset_ += sizes[i];
+        ++written_;
+        if (offsets_.size() >= records_per_segment_) seal_locked();
+    }
+}
+
+void ReplayStoreWriter::seal() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    seal_locked();
+}
+
+void ReplayStoreWriter::seal_locked() {
+    if (!file_) return;
+
+    SegmentFooter footer{offsets_.size(), kSegmentMagic, kSegmentVersion};
+    std::fwrite(offsets_.data(), sizeof(uint32_t), offsets_.size(), file_);
+    std::fwrite(&footer, sizeof(footer), 1, file_);
+    bool ok = std::fflush(file_) == 0;
+    std::fclose(file_);
+    file_ = nullptr;
+    if (!ok) throw std::runtime_error("Failed to write " + tmp_path_);
+
+    std::string final_path = tmp_path_.substr(0, tmp_path_.size() - 4) + kSegmentExtension;
+    if (std::rename(tmp_path_.c_str(), final_path.c_str()) != 0)
+        throw std::runtime_error("Failed to seal " + tmp_path_);
+    sealed_.fetch_add(1, std::memory_order_release);
+}
+
+// ==== Reader ====
+
+struct ReplayStore::Segment {
+    std::string path;
+    const uint8_t* data = nullptr;
+    size_t bytes = 0;
+    const uint8_t* offsets = nullptr;   // uint32 table at an arbitrary byte after the records
+    uint64_t count = 0;
+
+    ~Segment() {
+        if (data) munmap(const_cast<uint8_t*>(data), bytes);
+    }
+
+    // Records are variable length, so the table need not be 4-byte aligned: copy each entry out
+    uint32_t offset(uint64_t i) const {
+        uint32_t value;
+        std::memcpy(&value, offsets + i * sizeof(uint32_t), sizeof(value));
+        return value;
+    }
+
+    static std::shared_ptr<const Segment> open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) throw std::runtime_error("Failed to open replay segment " + path);
+        struct stat st{};
+        void* map = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+            map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) throw std::runtime_error("Failed to map replay segment " + path);
+
+        auto seg = std::make_shared<Segment>();
+        seg->path = path;
+        seg->data = static_cast<const uint8_t*>(map);
+        seg->bytes = static_cast<size_t>(st.st_size);
+
+        SegmentHeader header;
+        SegmentFooter footer;
+        if (seg->bytes < sizeof(header) + sizeof(footer)) throw std::runtime_error("Truncated replay segment " + path);
+        std::memcpy(&header, seg->data, sizeof(header));
+        std::memcpy(&footer, seg->data + seg->bytes - sizeof(footer), sizeof(footer));
+        if (header.magic != kSegmentMagic || footer.magic != kSegmentMagic || header.version != kSegmentVersion ||
+            footer.version != kSegmentVersion)
+            throw std::runtime_error("Not a replay segment: " + path);
+
+        if (footer.count > (seg->bytes - sizeof(header) - sizeof(footer)) / sizeof(uint32_t))
+            throw std::runtime_error("Corrupt replay segment " + path);
+        size_t table = footer.count * sizeof(uint32_t);
+        seg->offsets = seg->data + seg->bytes - sizeof(footer) - table;
+        seg->count = footer.count;
+
+        // The offset table follows the last record; every record, header plus one policy byte
+        // per legal move, must end before the next one starts
+        const size_t records_end = seg->bytes - sizeof(footer) - table;
+        for (uint64_t i = 0; i < seg->count; ++i) {
+            const size_t start = seg->offset(i);
+            const size_t end = (i + 1 < seg->count) ? seg->offset(i + 1) : records_end;
+            if (start < sizeof(header) || end > records_end || start + kRecordHeaderBytes > end ||
+                start + record_bytes(seg->data + start) > end)
+                throw std::runtime_error("Corrupt replay segment " + path);
+        }
+        madvise(const_cast<uint8_t*>(seg->data), seg->bytes, MADV_RANDOM);
+        return seg;
+    }
+};
+
+ReplayStore::ReplayStore(std::string directory)
+    : directory_(std::move(directory)), index_(std::make_shared<const Index>())
+{
+    refresh();
+}
+
+size_t ReplayStore::refresh() {
+    std::lock_guard<std::mutex> lock(refresh_mutex_);
+    auto current = index();
+
+    std::vector<std::string> known;
+    for (const auto& seg : current->segments) known.push_back(seg->path);
+
+    std::vector<std::string> fresh;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory_, ec)) {
+        if (entry.path().extension() != kSegmentExtension) continue;
+        std::string path = entry.path().string();
+        if (std::find(known.begin(), known.end(), path) == known.end()) fresh.push_back(path);
+    }
+    if (fresh.empty()) return 0;
+    std::sort(fresh.begin(), fresh.end());
+
+    // Copy-on-write: readers keep using the old index until they load the new one
+    auto next = std::make_shared<Index>(*current);
+    size_t added = 0;
+    for (const auto& path : fresh) {
+        try {
+            auto seg = Segment::open(path);
+            next->starts.push_back(next->total);
+            next->total += seg->count;
+            added += seg->count;
+            next->segments.push_back(std::move(seg));
+        } catch (const std::exception& e) {
+            spdlog::warn("[ReplayStore] Skipping {}: {}", path, e.what());
+        }
+    }
+    std::atomic_store(&index_, std::shared_ptr<const Index>(std::move(next)));
+    return added;
+}
+
+size_t ReplayStore::size() const {
+    return index()->total;
+}
+
+void ReplayStore::read(const Index& index, uint64_t i, float* state, float* policy, float* value, int symmetry) {
+    assert(i < index.total);
+    size_t s = std::upper_bound(index.starts.begin(), index.starts.end(), i) - index.starts.begin() - 1;
+    const Segment& seg = *index.segments[s];
+    decode_record(seg.data + seg.offset(i - index.starts[s]), state, policy, value, symmetry);
+}
+
+void ReplayStore::read(size_t i, float* state, float* policy, float* value) const {
+    auto snapshot = index();
+    if (i >= snapshot->total) throw std::out_of_range("Replay record index out of range");
+    read(*snapshot, i, state, policy, value, 0);
+}
+
+void ReplayStore::sample_into(size_t batch_size, float* states, float* policies, float* values,
+                              std::mt19937& rng) const {
+    auto snapshot = index();
+    if (snapshot->total == 0) throw std::logic_error("Sampling from an empty replay store");
+    std::uniform_int_distribution<uint64_t> dist(0, snapshot->total - 1);
+    std::uniform_int_distribution<int> symmetry(0, othello::symmetry::kCount - 1);
+    for (size_t b = 0; b < batch_size; ++b) {
+        const int t = augment_ ? symmetry(rng) : 0;
+        read(*snapshot, dist(rng), states + b * 192, policies + b * 65, values + b, t);
+    }
+}
+
+// ==== Loader ====
+
+ReplayLoader::ReplayLoader(const ReplayStore& store, size_t batch_size, int threads, size_t prefetch, uint32_t seed)
+    : store_(store), batch_size_(batch_size), prefetch_(std::max<size_t>(1, prefetch))
+{
+    if (store.size() == 0) throw std::logic_error("ReplayLoader needs a non-empty store");
+    for (int t = 0; t < std::max(1, threads); ++t) workers_.emplace_back(&ReplayLoader::work, this, seed + t);
+}
+
+ReplayLoader::~ReplayLoader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    space_cv_.notify_all();
+    for (auto& w : workers_) w.join();
+}
+
+void ReplayLoader::work(uint32_t seed) {
+    std::mt19937 rng(seed);
+    try {
+        while (true) {
+            // Step 1: decode outside the lock
+            ReplayBatch batch;
+            batch.size = batch_size_;
+            batch.states.resize(batch_size_ * 192);
+            batch.policies.resize(batch_size_ * 65);
+            batch.values.resize(batch_size_);
+            store_.sample_into(batch_size_, batch.states.data(), batch.policies.data(), batch.values.data(), rng);
+
+            // Step 2: hand it over once there is room
+            std::unique_lock<std::mutex> lock(mutex_);
+            space_cv_.wait(lock, [&] { return stopping_ || ready_.size() < prefetch_; });
+            if (stopping_) return;
+            ready_.push_back(std::move(batch));
+            ready_cv_.notify_one();
+        }
+    } catch (...) {
+        // An escaping exception would terminate the process; next() rethrows it instead
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!error_) error_ = std::current_exception();
+        ready_cv_.notify_all();
+    }
+}
+
+void ReplayLoader::next(ReplayBatch& batch) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    ready_cv_.wait(lock, [&] { return !ready_.empty() || error_; });
+    if (error_) std::rethrow_exception(error_);
+    std::swap(batch, ready_.front());
+    ready_.pop_front();
+    space_cv_.notify_one();
+}
+
+// ==== ReplaySink adapter ====
+
+ReplayStoreBuffer::ReplayStoreBuffer(const std::string& directory, size_t records_per_segment)
+    : writer_(directory, records_per_segment), store_(directory) {}
+
+void ReplayStoreBuffer::insert_batch(const std::vector<TrainSample>& batch) {
+    for (const auto& sample : batch) writer_.append(sample);
+}
+
+void ReplayStoreBuffer::flush() {
+    writer_.seal();
+    seen_segments_ = writer_.segments_sealed();
+    store_.refresh();
+}
+
+void ReplayStoreBuffer::sample_into(size_t batch_size, float* states, float* policies, float* values,
+                                    std::mt19937& rng) {
+    // Only rescan the directory after our writer sealed a segment
+    uint64_t sealed = writer_.segments_sealed();
+    if (sealed != seen_segments_) {
+        seen_segments_ = sealed;
+        store_.refresh();
+    }
+    store_.sample_into(batch_size, states, policies, values, rng);
+}
+
+} // namespace replay
@@ -0,0 +1,225 @@
+#include "replay/wthor.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+namespace replay {
+
+namespace {
+    uint16_t read_u16(const uint8_t* p) {
+        return static_cast<uint16_t>(p[0] | p[1] << 8);
+    }
+
+    uint32_t read_u32(const uint8_t* p) {
+        return p[0] | p[1] << 8 | p[2] << 16 | static_cast<uint32_t>(p[3]) << 24;
+    }
+
+    struct Chunk {
+        const WthorFile* file;
+        size_t begin;
+        size_t end;
+    };
+
+    // Replays every file's games on config.threads threads, handing each chunk's positions to
+    // `emit` (called concurrently, from the worker that replayed them)
+    template <typename Emit>
+    WthorImportStats run_import(const std::vector<std::string>& paths, const WthorImportConfig& config, Emit&& emit) {
+        const auto start = std::chrono::steady_clock::now();
+        WthorImportStats stats;
+
+        // Step 1: map every file before writing anything
+        std::vector<std::unique_ptr<WthorFile>> files;
+        std::vector<Chunk> chunks;
+        const size_t per_chunk = std::max<size_t>(1, config.games_per_chunk);
+        for (const std::string& path : paths) {
+            files.push_back(std::make_unique<WthorFile>(path));
+            const WthorFile& file = *files.back();
+            for (size_t g = 0; g < file.games(); g += per_chunk)
+                chunks.push_back({&file, g, std::min(file.games(), g + per_chunk)});
+        }
+        stats.files = files.size();
+
+        // Step 2: workers take chunks in order until none are left
+        std::atomic<size_t> next{0};
+        std::atomic<uint64_t> games{0}, truncated{0}, invalid{0}, positions{0};
+        std::mutex error_mutex;
+        std::exception_ptr error;
+        auto worker = [&] {
+            std::vector<WthorPosition> out;
+            try {
+                for (size_t c; (c = next.fetch_add(1)) < chunks.size();) {
+                    const Chunk& chunk = chunks[c];
+                    out.clear();
+                    uint64_t chunk_truncated = 0, chunk_invalid = 0;
+                    for (size_t g = chunk.begin; g < chunk.end; ++g) {
+                        switch (replay_wthor_game(chunk.file->game(g), out)) {
+                        case WthorGameStatus::Complete: break;
+                        case WthorGameStatus::Truncated: ++chunk_truncated; break;
+                        case WthorGameStatus::Invalid:
+                            ++chunk_invalid;
+                            spdlog::debug("{}: game {} has an illegal move, skipped", chunk.file->path(), g);
+                            break;
+                        }
+                    }
+                    emit(out);
+                    games.fetch_add(chunk.end - chunk.begin - chunk_invalid, std::memory_order_relaxed);
+                    truncated.fetch_add(chunk_truncated, std::memory_order_relaxed);
+                    invalid.fetch_add(chunk_invalid, std::memory_order_relaxed);
+                    positions.fetch_add(out.size(), std::memory_order_relaxed);
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) error = std::current_exception();
+                next.store(chunks.size());
+            }
+        };
+        const int threads = config.threads > 0 ? config.threads : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        std::vector<std::thread> pool;
+        for (int t = 0; t < std::min<int>(threads, std::max<size_t>(1, chunks.size())); ++t) pool.emplace_back(worker);
+        for (auto& t : pool) t.join();
+        if (error) std::rethrow_exception(error);
+
+        stats.games = games.load();
+        stats.truncated_games = truncated.load();
+        stats.invalid_games = invalid.load();
+        stats.positions = positions.load();
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return stats;
+    }
+} // Anonymous namespace
+
+// ==== File ====
+
+WthorFile::WthorFile(const std::string& path) : path_(path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) throw std::runtime_error("Failed to open WTHOR file " + path);
+    struct stat st{};
+    void* map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) throw std::runtime_error("Failed to map WTHOR file " + path);
+    data_ = static_cast<const uint8_t*>(map);
+    bytes_ = static_cast<size_t>(st.st_size);
+    madvise(map, bytes_, MADV_SEQUENTIAL);
+
+    // The destructor does not run for a constructor that throws, so unmap here
+    try {
+        if (bytes_ < kWthorHeaderBytes) throw std::runtime_error(path + " is too short for a WTHOR header");
+        const uint8_t board_size = data_[12];
+        if (board_size != 0 && board_size != 8) throw std::runtime_error(path + " is not an 8x8 WTHOR game file");
+        games_ = read_u32(data_ + 4);
+        year_ = read_u16(data_ + 10);
+        if (bytes_ < kWthorHeaderBytes + games_ * kWthorGameBytes)
+            throw std::runtime_error(path + " holds fewer games than its header claims");
+    } catch (...) {
+        munmap(map, bytes_);
+        data_ = nullptr;
+        throw;
+    }
+}
+
+WthorFile::~WthorFile() {
+    if (data_) munmap(const_cast<uint8_t*>(data_), bytes_);
+}
+
+// ==== Games ====
+
+WthorGameStatus replay_wthor_game(const uint8_t* record, std::vector<WthorPosition>& out) {
+    const size_t first = out.size();
+    const uint8_t* moves = record + 8;
+    OthelloBoard board;
+    Player player = Player::BLACK;
+
+    // Step 1: replay, passing for a side without moves; two passes in a row mean the game
+    // ended with moves still listed, so the record is invalid
+    for (int i = 0; i < kWthorMoves && moves[i] != 0; ++i) {
+        const int row = moves[i] / 10;
+        const int column = moves[i] % 10;
+        uint64_t legal = board.legal_move_mask(player);
+        if (!legal) {
+            player = othello::opponent(player);
+            legal = board.legal_move_mask(player);
+        }
+        const int square = othello::to_index(column - 1, row - 1);
+        if (row < 1 || row > 8 || column < 1 || column > 8 || !(legal >> square & 1)) {
+            out.resize(first);
+            return WthorGameStatus::Invalid;
+        }
+        out.push_back({board.bits(Player::BLACK), board.bits(Player::WHITE), player, static_cast<uint8_t>(square), 0.0f});
+        board.apply_move(player, Move(column - 1, row - 1));
+        player = othello::opponent(player);
+    }
+
+    // Step 2: black's disc differential, empty squares going to the winner as in WTHOR scores
+    WthorGameStatus status;
+    int differential;
+    if (board.is_game_over()) {
+        const int black = board.count_disks(Player::BLACK);
+        const int white = board.count_disks(Player::WHITE);
+        const int empties = 64 - black - white;
+        differential = black - white + (black > white ? empties : black < white ? -empties : 0);
+        status = WthorGameStatus::Complete;
+    } else {
+        const int black_discs = record[6];
+        if (black_discs > 64) {
+            out.resize(first);
+            return WthorGameStatus::Invalid;
+        }
+        differential = 2 * black_discs - 64;
+        status = WthorGameStatus::Truncated;
+    }
+
+    // Step 3: label every position from its mover's side
+    for (size_t i = first; i < out.size(); ++i)
+        out[i].value = (out[i].to_move == Player::BLACK ? differential : -differential) / 64.0f;
+    return status;
+}
+
+// ==== Importer ====
+
+WthorImporter::WthorImporter(const WthorImportConfig& config) : config_(config) {}
+
+WthorImportStats WthorImporter::import_into(const std::vector<std::string>& paths, ReplayBuffer& buffer) {
+    return run_import(paths, config_, [&buffer](const std::vector<WthorPosition>& positions) {
+        float policy[ReplayBuffer::kPolicySize] = {};
+        for (const WthorPosition& p : positions) {
+            const bool black = p.to_move == Player::BLACK;
+            policy[p.move] = 1.0f;
+            buffer.insert(black ? p.black : p.white, black ? p.white : p.black, policy, p.value);
+            policy[p.move] = 0.0f;
+        }
+    });
+}
+
+WthorImportStats WthorImporter::import_into(const std::vector<std::string>& paths, ReplayStoreWriter& writer) {
+    return run_import(paths, config_, [&writer](const std::vector<WthorPosition>& positions) {
+        // Encoded here, in parallel, so the writer's lock only covers the copy to disk
+        std::vector<uint8_t> records(positions.size() * (kRecordHeaderBytes + 64));
+        std::vector<uint8_t> sizes(positions.size());
+        float policy[ReplayBuffer::kPolicySize] = {};
+        size_t used = 0;
+        for (size_t i = 0; i < positions.size(); ++i) {
+            const WthorPosition& p = positions[i];
+            policy[p.move] = 1.0f;
+            sizes[i] = static_cast<uint8_t>(encode_record(p.black, p.white, p.to_move, policy, p.value, records.data() + used));
+            policy[p.move] = 0.0f;
+            used += sizes[i];
+        }
+        writer.append_encoded(records.data(), sizes.data(), positions.size());
+    });
+}
+
+} // namespace replay
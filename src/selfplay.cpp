@@ -0,0 +1,72 @@
+#include <spdlog/spdlog.h>
+#include <memory>
+#include <string>
+
+#include "nn/model_file.hpp"
+#include "othello/greedy_evaluator.hpp"
+#include "othello/network_evaluator.hpp"
+#include "othello/selfplay.hpp"
+#include "replay/buffer.hpp"
+#include "replay/store.hpp"
+
+int main(int argc, char** argv) {
+    spdlog::set_level(spdlog::level::info);
+    spdlog::set_pattern("[selfplay] [%^%l%$] %v");
+
+    othello::SelfPlayConfig config;
+    config.report_every = 10;
+    int games = 100;
+    size_t capacity = 1 << 20;
+    std::string model_path;
+    std::string out_dir;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--games" && has_value) games = std::stoi(argv[++i]);
+        else if (arg == "--threads" && has_value) config.threads = std::stoi(argv[++i]);
+        else if (arg == "--sims" && has_value) config.simulations = std::stoi(argv[++i]);
+        else if (arg == "--temperature-plies" && has_value) config.temperature_plies = std::stoi(argv[++i]);
+        else if (arg == "--seed" && has_value) config.seed = std::stoul(argv[++i]);
+        else if (arg == "--capacity" && has_value) capacity = std::stoul(argv[++i]);
+        else if (arg == "--model" && has_value) model_path = argv[++i];
+        else if (arg == "--out" && has_value) out_dir = argv[++i];
+        else if (arg == "--trace" && has_value) config.trace_path = argv[++i];
+        else if (arg == "--trace-game" && has_value) config.trace_game = std::stoi(argv[++i]);
+        else {
+            spdlog::error("Usage: selfplay [--games N] [--threads N] [--sims N] [--temperature-plies N] "
+                          "[--seed N] [--capacity N] [--model <model.bin>] [--out <replay dir>] "
+                          "[--trace <trace.json> [--trace-game N]]");
+            return 1;
+        }
+    }
+
+    // The network is shared read-only; forward() keeps its scratch per thread
+    std::shared_ptr<const nn::Network> network;
+    if (!model_path.empty()) network = std::make_shared<const nn::Network>(nn::load_model(model_path));
+
+    othello::SelfPlay::EvaluatorFactory factory = [network]() -> std::unique_ptr<othello::Evaluator> {
+        if (network) return std::make_unique<othello::NetworkEvaluator>(*network);
+        return std::make_unique<othello::GreedyEvaluator>();
+    };
+
+    // Samples go to an on-disk replay store with --out, otherwise to an in-memory ring
+    std::unique_ptr<replay::ReplayStoreBuffer> store;
+    std::unique_ptr<ReplayBuffer> buffer;
+    if (!out_dir.empty()) store = std::make_unique<replay::ReplayStoreBuffer>(out_dir);
+    else buffer = std::make_unique<ReplayBuffer>(capacity);
+    othello::SelfPlay selfplay(factory, store ? static_cast<ReplaySink&>(*store) : *buffer, config);
+    spdlog::info("Playing {} games with {} simulations per move ({})", games, config.simulations,
+                 network ? model_path : "greedy evaluator");
+
+    othello::SelfPlayStats stats = selfplay.run(games);
+
+    spdlog::info("{} games, {} positions in {:.2f}s: {:.2f} games/s, {:.1f} positions/s", stats.games,
+                 stats.positions, stats.seconds, stats.games_per_second(), stats.positions_per_second());
+    spdlog::info("Results: black {} / white {} / draws {}", stats.black_wins, stats.white_wins, stats.draws);
+    if (store) {
+        store->flush();
+        spdlog::info("Replay store {} holds {} samples", out_dir, store->size());
+    }
+    return 0;
+}
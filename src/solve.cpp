@@ -0,0 +1,84 @@
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "othello/endgame.hpp"
+
+namespace {
+    std::string square_name(const Move& move) {
+        if (move == othello::PASS) return "pass";
+        return std::string(1, static_cast<char>('a' + move.x)) + std::to_string(move.y + 1);
+    }
+}
+
+int main(int argc, char** argv) {
+    spdlog::set_level(spdlog::level::info);
+    spdlog::set_pattern("[solve] [%^%l%$] %v");
+
+    othello::EndgameConfig config;
+    std::string file_path;
+    std::string position;
+    bool usage_error = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--threads" && has_value) config.threads = std::stoi(argv[++i]);
+        else if (arg == "--table-bits" && has_value) config.table_bits = std::stoi(argv[++i]);
+        else if (arg == "--split-empties" && has_value) config.split_empties = std::stoi(argv[++i]);
+        else if (arg == "--file" && has_value) file_path = argv[++i];
+        else if (arg.rfind("--", 0) != 0) position += (position.empty() ? "" : " ") + arg;
+        else usage_error = true;
+    }
+    if (usage_error || file_path.empty() == position.empty()) {
+        spdlog::error("Usage: solve [--threads N] [--table-bits N] [--split-empties N] "
+                      "(<64 squares> <X|O> | --file <positions>)");
+        return 1;
+    }
+
+    try {
+        // A file holds one position per line, optionally with its known result (see
+        // othello::load_positions), which the solve is then checked against
+        std::vector<othello::ScoredPosition> positions;
+        if (!file_path.empty()) {
+            positions = othello::load_positions(file_path);
+        } else {
+            othello::ScoredPosition entry;
+            std::tie(entry.board, entry.player) = othello::parse_position(position);
+            positions.push_back(std::move(entry));
+        }
+
+        othello::EndgameSolver solver(config);
+        spdlog::info("{} positions on {} threads", positions.size(), solver.threads());
+        uint64_t nodes = 0;
+        double seconds = 0.0;
+        int wrong = 0;
+        for (const othello::ScoredPosition& entry : positions) {
+            const OthelloBoard& board = entry.board;
+            const int empties = 64 - board.count_disks(Player::BLACK) - board.count_disks(Player::WHITE);
+            const othello::EndgameResult result = solver.solve(board, entry.player);
+            spdlog::info("{}{} empties, {} to move: {:+d} by {} ({} nodes in {:.3f}s, {:.1f}M nodes/s)",
+                         entry.label.empty() ? "" : entry.label + ": ", empties,
+                         entry.player == Player::BLACK ? "black" : "white", result.score, square_name(result.best),
+                         result.nodes, result.seconds, result.nodes_per_second() / 1e6);
+            const bool known_best = std::find(entry.best.begin(), entry.best.end(), result.best) != entry.best.end();
+            if (!entry.best.empty() && (result.score != entry.score || !known_best)) {
+                spdlog::error("{}: expected {:+d} by {}", entry.label, entry.score, square_name(entry.best.front()));
+                ++wrong;
+            }
+            nodes += result.nodes;
+            seconds += result.seconds;
+            solver.clear();   // positions are unrelated; keep each timing independent
+        }
+        if (positions.size() > 1)
+            spdlog::info("Total: {} nodes in {:.3f}s ({:.1f}M nodes/s)", nodes, seconds,
+                         seconds > 0 ? nodes / seconds / 1e6 : 0.0);
+        if (wrong) return 1;
+    } catch (const std::exception& e) {
+        spdlog::error("{}", e.what());
+        return 1;
+    }
+    return 0;
+}
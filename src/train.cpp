@@ -1,37 +1,157 @@
 #include <spdlog/spdlog.h>
+#include <chrono>
+#include <filesystem>
 #include <fstream>
-#include <vector>
+#include <functional>
+#include <memory>
 #include <random>
-#include <filesystem>
+#include <string>
+#include <vector>
 
-// Simulate a dummy model with fixed size (e.g., 512 floats)
-constexpr size_t NUM_WEIGHTS = 512;
+#include "nn/model_file.hpp"
+#include "nn/network.hpp"
+#include "nn/trainer.hpp"
+#include "othello/greedy_evaluator.hpp"
+#include "othello/network_evaluator.hpp"
+#include "othello/selfplay.hpp"
+#include "replay/buffer.hpp"
+#include "replay/store.hpp"
 
-int main() {
-    spdlog::info("Starting training simulation...");
+int main(int argc, char** argv) {
+    spdlog::set_level(spdlog::level::info);
+    spdlog::set_pattern("[train] [%^%l%$] %v");
 
-    // Generate dummy weights (random floats)
-    std::vector<float> weights(NUM_WEIGHTS);
-    std::mt19937 rng(std::random_device{}());
-    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    nn::TrainerConfig config;
+    std::string data_dir;
+    std::string init_path;
+    std::string out_path = "weights/weights.bin";
+    std::string csv_path = "weights/loss.csv";
+    int steps = 1000;
+    size_t batch_size = 256;
+    int games = 200;
+    int report_every = 50;
+    uint32_t seed = 1;
+    bool augment = true;
 
-    for (auto& w : weights) {
-        w = dist(rng);
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--data" && has_value) data_dir = argv[++i];
+        else if (arg == "--init" && has_value) init_path = argv[++i];
+        else if (arg == "--out" && has_value) out_path = argv[++i];
+        else if (arg == "--loss-csv" && has_value) csv_path = argv[++i];
+        else if (arg == "--steps" && has_value) steps = std::stoi(argv[++i]);
+        else if (arg == "--batch" && has_value) batch_size = std::stoul(argv[++i]);
+        else if (arg == "--lr" && has_value) config.learning_rate = std::stof(argv[++i]);
+        else if (arg == "--threads" && has_value) config.threads = std::stoi(argv[++i]);
+        else if (arg == "--games" && has_value) games = std::stoi(argv[++i]);
+        else if (arg == "--report-every" && has_value) report_every = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--seed" && has_value) seed = std::stoul(argv[++i]);
+        else if (arg == "--no-augment") augment = false;
+        else {
+            spdlog::error("Usage: train [--data <replay dir>] [--games N] [--init <model.bin>] [--out <model.bin>] "
+                          "[--steps N] [--batch N] [--lr X] [--threads N] [--loss-csv <path>] "
+                          "[--report-every N] [--seed N] [--no-augment]");
+            return 1;
+        }
     }
 
-    // Create output directory if needed
-    std::filesystem::create_directories("weights");
+    try {
+        // Step 1: starting point, an existing model (copied out of its mapping) or fresh weights
+        nn::Network net;
+        if (!init_path.empty()) {
+            nn::Network init = nn::load_model(init_path);
+            net = nn::Network::from_buffer(init.params(), init.num_params() * sizeof(float), init.config());
+            spdlog::info("Continuing from {}", init_path);
+        } else {
+            net.init_random(seed);
+        }
 
-    // Save weights to binary file
-    std::ofstream out("weights/weights.bin", std::ios::binary);
-    if (!out) {
-        spdlog::error("Failed to open weights/weights.bin for writing.");
-        return 1;
-    }
+        // Step 2: training data, from a replay store written by selfplay --out, or generated here
+        std::unique_ptr<replay::ReplayStore> store;
+        std::unique_ptr<replay::ReplayLoader> loader;
+        std::unique_ptr<ReplayBuffer> buffer;
+        std::mt19937 rng(seed);
+        replay::ReplayBatch batch;
+        std::function<void()> next_batch;
 
-    out.write(reinterpret_cast<const char*>(weights.data()), weights.size() * sizeof(float));
-    out.close();
+        if (!data_dir.empty()) {
+            store = std::make_unique<replay::ReplayStore>(data_dir);
+            store->refresh();
+            if (store->size() == 0) throw std::runtime_error("No sealed replay segments in " + data_dir);
+            store->set_augment(augment);
+            loader = std::make_unique<replay::ReplayLoader>(*store, batch_size, 2, 4, seed);
+            spdlog::info("Training on {} samples from {}", store->size(), data_dir);
+            next_batch = [&] { loader->next(batch); };
+        } else {
+            auto network = std::make_shared<const nn::Network>(net);
+            buffer = std::make_unique<ReplayBuffer>(1 << 20);
+            othello::SelfPlayConfig sp;
+            sp.seed = seed;
+            othello::SelfPlay selfplay([&]() -> std::unique_ptr<othello::Evaluator> {
+                if (!init_path.empty()) return std::make_unique<othello::NetworkEvaluator>(*network);
+                return std::make_unique<othello::GreedyEvaluator>();
+            }, *buffer, sp);
+            othello::SelfPlayStats stats = selfplay.run(games);
+            spdlog::info("Generated {} positions from {} self-play games in {:.1f}s", stats.positions, stats.games,
+                         stats.seconds);
+            buffer->set_augment(augment);
+            batch.size = batch_size;
+            batch.states.resize(batch_size * ReplayBuffer::kStateSize);
+            batch.policies.resize(batch_size * ReplayBuffer::kPolicySize);
+            batch.values.resize(batch_size);
+            next_batch = [&] {
+                buffer->sample_into(batch_size, batch.states.data(), batch.policies.data(), batch.values.data(), rng);
+            };
+        }
 
-    spdlog::info("Training complete. Weights written to weights/weights.bin");
+        // Step 3: optimize, logging the loss curve
+        std::filesystem::path out_dir = std::filesystem::path(out_path).parent_path();
+        if (!out_dir.empty()) std::filesystem::create_directories(out_dir);
+        std::ofstream csv(csv_path);
+        if (!csv) throw std::runtime_error("Failed to open " + csv_path + " for writing");
+        csv << "step,samples,policy_loss,value_loss,samples_per_sec\n";
+
+        nn::Trainer trainer(net, config);
+        spdlog::info("Training {} parameters: {} steps of {} samples, lr {}, {} threads{}", net.num_params(), steps,
+                     batch_size, config.learning_rate, trainer.config().threads, augment ? ", D4 augmentation" : "");
+
+        using Clock = std::chrono::steady_clock;
+        auto window_start = Clock::now();
+        double window_policy = 0.0, window_value = 0.0;
+        double compute_seconds = 0.0;
+        int window = 0;
+        for (int step = 1; step <= steps; ++step) {
+            next_batch();
+            auto t0 = Clock::now();
+            nn::TrainLoss loss = trainer.step(batch.states.data(), batch.policies.data(), batch.values.data(), batch.size);
+            compute_seconds += std::chrono::duration<double>(Clock::now() - t0).count();
+            window_policy += loss.policy;
+            window_value += loss.value;
+            ++window;
+
+            if (step % report_every == 0 || step == steps) {
+                double seconds = std::chrono::duration<double>(Clock::now() - window_start).count();
+                double rate = window * batch_size / seconds;
+                spdlog::info("step {:>6}  policy {:.4f}  value {:.4f}  {:.0f} samples/s", step, window_policy / window,
+                             window_value / window, rate);
+                csv << step << "," << uint64_t(step) * batch_size << "," << window_policy / window << ","
+                    << window_value / window << "," << rate << "\n";
+                csv.flush();
+                window_start = Clock::now();
+                window_policy = window_value = 0.0;
+                window = 0;
+            }
+        }
+        spdlog::info("{:.0f} samples/s in the optimizer ({:.2f}s for {} samples)", steps * batch_size / compute_seconds,
+                     compute_seconds, uint64_t(steps) * batch_size);
+
+        // Step 4: write the model the player loads (atomic, safe to hot-reload)
+        nn::save_model(out_path, net);
+        spdlog::info("Training complete. Model written to {}, loss curve to {}", out_path, csv_path);
+    } catch (const std::exception& e) {
+        spdlog::error("{}", e.what());
+        return 1;
+    }
     return 0;
 }
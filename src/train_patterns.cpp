@@ -0,0 +1,98 @@
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include "othello/pattern_evaluator.hpp"
+#include "othello/pattern_trainer.hpp"
+#include "replay/store.hpp"
+
+int main(int argc, char** argv) {
+    spdlog::set_level(spdlog::level::info);
+    spdlog::set_pattern("[train_patterns] [%^%l%$] %v");
+
+    std::string data_dir;
+    std::string init_path;
+    std::string out_path = "weights/patterns.bin";
+    size_t samples = 0;
+    size_t batch_size = 4096;
+    int epochs = 20;
+    float learning_rate = 1.0f;
+    float l2 = 1e-3f;
+    uint32_t seed = 1;
+    bool augment = true;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--data" && has_value) data_dir = argv[++i];
+        else if (arg == "--init" && has_value) init_path = argv[++i];
+        else if (arg == "--out" && has_value) out_path = argv[++i];
+        else if (arg == "--samples" && has_value) samples = std::stoul(argv[++i]);
+        else if (arg == "--batch" && has_value) batch_size = std::max<size_t>(1, std::stoul(argv[++i]));
+        else if (arg == "--epochs" && has_value) epochs = std::stoi(argv[++i]);
+        else if (arg == "--lr" && has_value) learning_rate = std::stof(argv[++i]);
+        else if (arg == "--l2" && has_value) l2 = std::stof(argv[++i]);
+        else if (arg == "--seed" && has_value) seed = std::stoul(argv[++i]);
+        else if (arg == "--no-augment") augment = false;
+        else {
+            spdlog::error("Usage: train_patterns --data <replay dir> [--samples N] [--init <patterns.bin>] "
+                          "[--out <patterns.bin>] [--epochs N] [--lr X] [--l2 X] [--batch N] [--seed N] "
+                          "[--no-augment]");
+            return 1;
+        }
+    }
+    if (data_dir.empty()) {
+        spdlog::error("train_patterns needs --data <replay dir> (selfplay --out or import_wthor --out)");
+        return 1;
+    }
+
+    try {
+        // Step 1: starting point, existing weights or zeros
+        othello::PatternEvaluator evaluator;
+        if (!init_path.empty()) {
+            evaluator.load(init_path);
+            spdlog::info("Continuing from {}", init_path);
+        }
+
+        // Step 2: draw the samples through the background loader (default: as many as the store holds)
+        replay::ReplayStore store(data_dir);
+        store.refresh();
+        if (store.size() == 0) throw std::runtime_error("No sealed replay segments in " + data_dir);
+        store.set_augment(augment);
+        if (samples == 0) samples = store.size();
+
+        othello::PatternTrainer trainer(evaluator);
+        {
+            replay::ReplayLoader loader(store, batch_size, 2, 4, seed);
+            replay::ReplayBatch batch;
+            while (trainer.size() < samples) {
+                loader.next(batch);
+                const size_t take = std::min(batch.size, samples - trainer.size());
+                for (size_t i = 0; i < take; ++i)
+                    trainer.add(batch.states.data() + i * OthelloBoard::kTensorSize, batch.values[i]);
+            }
+        }
+        spdlog::info("Fitting {} samples from {} ({} stored){}", trainer.size(), data_dir, store.size(),
+                     augment ? ", D4 augmentation" : "");
+
+        // Step 3: least-squares fit
+        auto start = std::chrono::steady_clock::now();
+        float before = trainer.rmse();
+        float after = trainer.fit(epochs, learning_rate, l2);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        spdlog::info("RMSE {:.4f} -> {:.4f} after {} epochs ({:.1f}s)", before, after, epochs, seconds);
+
+        // Step 4: the file arena (eval=pattern:<path>) and othelloplayer (--patterns) load
+        std::filesystem::path out_dir = std::filesystem::path(out_path).parent_path();
+        if (!out_dir.empty()) std::filesystem::create_directories(out_dir);
+        evaluator.save(out_path);
+        spdlog::info("Pattern weights written to {}", out_path);
+    } catch (const std::exception& e) {
+        spdlog::error("{}", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,362 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "othello/agent_server.hpp"
+#include "othello/transport.hpp"
+
+namespace protocol = othello::protocol;
+
+namespace {
+    othello::AgentServerConfig small_config() {
+        othello::AgentServerConfig config;
+        config.port = 0;
+        config.workers = 2;
+        config.simulations = 16;
+        return config;
+    }
+
+    // Blocking client speaking the framed protocol
+    class Client {
+    public:
+        explicit Client(int port) {
+            fd_ = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(static_cast<uint16_t>(port));
+            inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+            connected_ = connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        }
+        ~Client() { close(fd_); }
+
+        bool connected() const { return connected_; }
+        void send_raw(const uint8_t* data, size_t size) { send(fd_, data, size, MSG_NOSIGNAL); }
+        void send_frame(protocol::FrameWriter& frame) { send_raw(frame.data(), frame.size()); }
+
+        void hello(Player side) {
+            protocol::FrameWriter frame(protocol::MessageType::Hello);
+            frame.u8(protocol::kVersion).u8(side == Player::WHITE ? 1 : 0);
+            send_frame(frame);
+        }
+
+        void move(const Move& m, int32_t ms_left = 1000) {
+            protocol::FrameWriter frame(protocol::MessageType::Move);
+            frame.i8(static_cast<int8_t>(m.x)).i8(static_cast<int8_t>(m.y)).i32(ms_left);
+            send_frame(frame);
+        }
+
+        // Next frame's type and payload; false once the server hangs up
+        bool read(protocol::MessageType& type, std::vector<uint8_t>& payload) {
+            protocol::Frame frame;
+            while (reader_.peek(frame) != protocol::FrameReader::Ready) {
+                ssize_t bytes = recv(fd_, reader_.write_ptr(), reader_.write_space(), 0);
+                if (bytes <= 0) return false;
+                reader_.commit(static_cast<size_t>(bytes));
+            }
+            type = frame.type;
+            payload.assign(frame.payload, frame.payload + frame.size);
+            reader_.pop();
+            return true;
+        }
+
+        bool read_reply(Move& reply) {
+            protocol::MessageType type;
+            std::vector<uint8_t> payload;
+            if (!read(type, payload) || type != protocol::MessageType::Reply || payload.size() != 2) return false;
+            reply = Move(static_cast<int8_t>(payload[0]), static_cast<int8_t>(payload[1]));
+            return true;
+        }
+
+    private:
+        int fd_ = -1;
+        bool connected_ = false;
+        protocol::FrameReader reader_;
+    };
+
+    // Plays a full game against the server (which plays `server_side`) with the client taking
+    // its first legal move each turn; returns the number of illegal server replies
+    int play_game(int port, Player server_side) {
+        Client client(port);
+        if (!client.connected()) return 1;
+        client.hello(server_side);
+
+        OthelloBoard board;
+        Player client_side = othello::opponent(server_side);
+        Move last = othello::PASS;   // Black opens with "-1 -1"
+        int illegal = 0;
+        if (server_side == Player::WHITE) {
+            last = board.get_valid_moves(client_side).front();
+            board.apply_move(client_side, last);
+        }
+        while (!board.is_game_over()) {
+            client.move(last);
+            Move reply = othello::PASS;
+            if (!client.read_reply(reply)) return illegal + 1;
+            bool must_pass = !board.has_valid_move(server_side);
+            if (must_pass != (reply == othello::PASS) || !board.apply_move(server_side, reply)) ++illegal;
+            if (board.is_game_over()) break;
+
+            auto moves = board.get_valid_moves(client_side);
+            last = moves.empty() ? othello::PASS : moves.front();
+            board.apply_move(client_side, last);
+        }
+        return illegal;
+    }
+}
+
+TEST(AgentServerTest, ServesConcurrentGames) {
+    othello::metrics::Registry metrics;
+    othello::AgentServer server(small_config(), nullptr, nullptr, &metrics);
+    ASSERT_GT(server.port(), 0);
+    std::thread loop([&] { server.run(); });
+
+    std::atomic<int> illegal{0};
+    std::vector<std::thread> clients;
+    for (int g = 0; g < 6; ++g)
+        clients.emplace_back([&, g] { illegal += play_game(server.port(), g % 2 ? Player::WHITE : Player::BLACK); });
+    for (auto& c : clients) c.join();
+
+    server.stop();
+    loop.join();
+    EXPECT_EQ(illegal.load(), 0);
+    othello::AgentServerStats stats = server.stats();
+    EXPECT_EQ(stats.sessions, 6u);
+    EXPECT_EQ(stats.active, 0u);
+    EXPECT_GT(stats.totals.moves, 6u * 20);
+    EXPECT_EQ(stats.totals.response_us.total, stats.totals.moves);
+    EXPECT_GT(stats.totals.think_us.total, 0u);
+
+    // The metrics agree, and every search had a time budget from the client's clock
+    const uint64_t moves = metrics.counter("othello_moves_total", "", "source=\"search\"").value() +
+                           metrics.counter("othello_moves_total", "", "source=\"pass\"").value();
+    EXPECT_EQ(moves, stats.totals.moves);
+    EXPECT_EQ(metrics.counter("othello_sessions_total", "").value(), 6u);
+    EXPECT_EQ(metrics.gauge("othello_sessions_active", "").value(), 0);
+    EXPECT_EQ(metrics.histogram("othello_session_moves", "").snapshot().total, 6u);
+    const uint64_t searched = metrics.histogram("othello_search_seconds", "", 1e-6).snapshot().total;
+    EXPECT_EQ(searched, stats.totals.think_us.total);
+    EXPECT_EQ(metrics.histogram("othello_move_budget_seconds", "", 1e-6).snapshot().total, searched);
+    EXPECT_EQ(metrics.histogram("othello_search_tree_nodes", "").snapshot().total, searched);
+    EXPECT_GE(metrics.counter("othello_search_simulations_total", "").value(), searched);
+    EXPECT_GT(metrics.histogram("othello_evaluator_seconds", "", 1e-9).snapshot().total, searched);
+    EXPECT_NE(metrics.prometheus_text().find("othello_move_budget_used_percent{quantile=\"0.99\"}"),
+              std::string::npos);
+}
+
+TEST(AgentServerTest, ReassemblesSplitFramesAndDropsBadClients) {
+    othello::AgentServer server(small_config());
+    std::thread loop([&] { server.run(); });
+    {
+        // Hello and the first move in one write, cut at an arbitrary byte
+        Client client(server.port());
+        ASSERT_TRUE(client.connected());
+        protocol::FrameWriter hello(protocol::MessageType::Hello);
+        hello.u8(protocol::kVersion).u8(1);
+        protocol::FrameWriter move(protocol::MessageType::Move);
+        move.i8(4).i8(5).i32(1000);
+        std::vector<uint8_t> bytes(hello.data(), hello.data() + hello.size());
+        bytes.insert(bytes.end(), move.data(), move.data() + move.size());
+        client.send_raw(bytes.data(), 7);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        client.send_raw(bytes.data() + 7, bytes.size() - 7);
+
+        OthelloBoard board;
+        board.apply_move(Player::BLACK, Move(4, 5));
+        Move reply = othello::PASS;
+        ASSERT_TRUE(client.read_reply(reply));
+        EXPECT_TRUE(board.apply_move(Player::WHITE, reply));
+
+        // A move before Hello is a protocol error
+        Client bad(server.port());
+        bad.move(othello::PASS);
+        protocol::MessageType type;
+        std::vector<uint8_t> payload;
+        EXPECT_FALSE(bad.read(type, payload));
+
+        // So is a length beyond kMaxPayload
+        Client oversized(server.port());
+        const uint8_t header[3] = {0xff, 0xff, 2};
+        oversized.send_raw(header, sizeof(header));
+        EXPECT_FALSE(oversized.read(type, payload));
+
+        // And an Analyze frame cut off before its position count
+        Client truncated(server.port());
+        protocol::FrameWriter analyze(protocol::MessageType::Analyze);
+        analyze.u32(7);
+        truncated.send_raw(analyze.data(), analyze.size());
+        EXPECT_FALSE(truncated.read(type, payload));
+    }
+    server.stop();
+    loop.join();
+    EXPECT_EQ(server.stats().sessions, 4u);
+}
+
+TEST(AgentServerTest, AnswersPingsAndPipelinedAnalysis) {
+    othello::AgentServer server(small_config());
+    std::thread loop([&] { server.run(); });
+    {
+        Client client(server.port());
+        ASSERT_TRUE(client.connected());
+
+        // Three analysis batches in flight at once, a ping behind them
+        OthelloBoard start;
+        OthelloBoard after = start.apply_move_copy(Player::BLACK, Move(4, 5));
+        for (uint32_t id = 1; id <= 3; ++id) {
+            protocol::FrameWriter analyze(protocol::MessageType::Analyze);
+            analyze.u32(id).u16(2);
+            analyze.u64(start.bits(Player::BLACK)).u64(start.bits(Player::WHITE)).u8(0);
+            analyze.u64(after.bits(Player::BLACK)).u64(after.bits(Player::WHITE)).u8(1);
+            client.send_frame(analyze);
+        }
+        protocol::FrameWriter ping(protocol::MessageType::Ping);
+        ping.u64(0x1234567890abcdefULL);
+        auto sent = std::chrono::steady_clock::now();
+        client.send_frame(ping);
+
+        std::map<uint32_t, int> analyses;
+        bool ponged = false;
+        while (analyses.size() < 3 || !ponged) {
+            protocol::MessageType type;
+            std::vector<uint8_t> payload;
+            ASSERT_TRUE(client.read(type, payload));
+            protocol::Frame frame{type, payload.data(), payload.size()};
+            protocol::PayloadReader in(frame);
+            if (type == protocol::MessageType::Pong) {
+                EXPECT_EQ(in.u64(), 0x1234567890abcdefULL);
+                EXPECT_LT(std::chrono::steady_clock::now() - sent, std::chrono::seconds(1));
+                ponged = true;
+                continue;
+            }
+            ASSERT_EQ(type, protocol::MessageType::Analysis);
+            uint32_t id = in.u32();
+            ASSERT_EQ(in.u16(), 2);
+            int x = in.i8(), y = in.i8();
+            float value = in.f32();
+            EXPECT_TRUE(start.is_valid_move(Player::BLACK, x, y));
+            EXPECT_GE(value, -1.0f);
+            EXPECT_LE(value, 1.0f);
+            x = in.i8();
+            y = in.i8();
+            in.f32();
+            EXPECT_TRUE(after.is_valid_move(Player::WHITE, x, y));
+            EXPECT_TRUE(in.ok());
+            ++analyses[id];
+        }
+        EXPECT_EQ(analyses, (std::map<uint32_t, int>{{1, 1}, {2, 1}, {3, 1}}));
+    }
+    server.stop();
+    loop.join();
+}
+
+TEST(AgentServerTest, QueuesMovesDuringASearchWithoutBlockingPings) {
+    othello::AgentServerConfig config = small_config();
+    config.simulations = 1 << 30;   // the ~0.2 s clock share bounds the search instead
+    othello::AgentServer server(config);
+    std::thread loop([&] { server.run(); });
+    {
+        Client client(server.port());
+        ASSERT_TRUE(client.connected());
+        client.hello(Player::BLACK);
+
+        // A second move and a ping behind the first search: the ping is answered at once,
+        // the moves in order afterwards (the queued pass is illegal, so it is ignored and
+        // the server moves again)
+        client.move(othello::PASS, 6400);
+        client.move(othello::PASS, 6400);
+        protocol::FrameWriter ping(protocol::MessageType::Ping);
+        ping.u64(7);
+        client.send_frame(ping);
+
+        protocol::MessageType type;
+        std::vector<uint8_t> payload;
+        ASSERT_TRUE(client.read(type, payload));
+        EXPECT_EQ(type, protocol::MessageType::Pong);
+        Move first = othello::PASS, second = othello::PASS;
+        ASSERT_TRUE(client.read_reply(first));
+        ASSERT_TRUE(client.read_reply(second));
+        OthelloBoard board;
+        EXPECT_TRUE(board.apply_move(Player::BLACK, first));
+        EXPECT_TRUE(board.apply_move(Player::BLACK, second));
+    }
+    server.stop();
+    loop.join();
+}
+
+TEST(AgentServerTest, ServesUnixSocketAndSharedMemoryClients) {
+    othello::AgentServerConfig config = small_config();
+    config.unix_path = ::testing::TempDir() + "agent_server_test.sock";
+    othello::AgentServer server(config);
+    std::thread loop([&] { server.run(); });
+    {
+        int unix_fd = othello::transport::connect_unix(config.unix_path);
+        ASSERT_GE(unix_fd, 0);
+        othello::transport::SocketTransport unix_link(unix_fd, "unix");
+        auto shm_link = othello::transport::ShmTransport::attach(othello::transport::connect_unix(config.unix_path));
+        ASSERT_TRUE(shm_link);
+
+        for (othello::transport::ClientTransport* link : {static_cast<othello::transport::ClientTransport*>(&unix_link),
+                                                          static_cast<othello::transport::ClientTransport*>(shm_link.get())}) {
+            SCOPED_TRACE(link->name());
+            protocol::FrameReader reader;
+            protocol::Frame frame;
+
+            // Enough pings to wrap the shared-memory rings several times
+            for (uint64_t token = 0; token < 20000; ++token) {
+                protocol::FrameWriter ping(protocol::MessageType::Ping);
+                ping.u64(token);
+                ASSERT_TRUE(othello::transport::send_frame(*link, ping));
+                ASSERT_TRUE(othello::transport::read_frame(*link, reader, protocol::MessageType::Pong, frame));
+                protocol::PayloadReader in(frame);
+                ASSERT_EQ(in.u64(), token);
+                reader.pop();
+            }
+
+            // And a move
+            protocol::FrameWriter hello(protocol::MessageType::Hello);
+            hello.u8(protocol::kVersion).u8(0);
+            protocol::FrameWriter move(protocol::MessageType::Move);
+            move.i8(-1).i8(-1).i32(1000);
+            ASSERT_TRUE(othello::transport::send_frame(*link, hello));
+            ASSERT_TRUE(othello::transport::send_frame(*link, move));
+            ASSERT_TRUE(othello::transport::read_frame(*link, reader, protocol::MessageType::Reply, frame));
+            protocol::PayloadReader in(frame);
+            int x = in.i8(), y = in.i8();
+            EXPECT_TRUE(OthelloBoard().is_valid_move(Player::BLACK, x, y));
+            reader.pop();
+        }
+    }
+    server.stop();
+    loop.join();
+    EXPECT_EQ(server.stats().sessions, 2u);
+    EXPECT_EQ(server.stats().totals.moves, 2u);
+}
+
+TEST(AgentServerTest, RejectsSharedMemoryWithoutSizeSeals) {
+    int fd = -1;
+    othello::shm::Channel* channel = othello::shm::create_channel(fd);
+    ASSERT_NE(channel, nullptr);
+    EXPECT_NE(fcntl(fd, F_GET_SEALS) & F_SEAL_SHRINK, 0);
+    EXPECT_NE(ftruncate(fd, 0), 0);
+    othello::shm::Channel* mapped = othello::shm::map_channel(fd);
+    ASSERT_NE(mapped, nullptr);
+    munmap(mapped, sizeof(othello::shm::Channel));
+    munmap(channel, sizeof(othello::shm::Channel));
+    close(fd);
+
+    // A right-sized memfd the client could still truncate under the engine
+    int unsealed = static_cast<int>(syscall(SYS_memfd_create, "unsealed", 0));
+    ASSERT_GE(unsealed, 0);
+    ASSERT_EQ(ftruncate(unsealed, sizeof(othello::shm::Channel)), 0);
+    EXPECT_EQ(othello::shm::map_channel(unsealed), nullptr);
+    close(unsealed);
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <new>
+#include "othello/greedy_evaluator.hpp"
+#include "othello/mcts.hpp"
+
+// Replaces the global allocator to count heap allocations made by the current thread. This
+// binary is kept apart from othello_tests so the replacement cannot affect any other test.
+static thread_local long allocations = 0;
+
+namespace {
+    void* counted(std::size_t size, std::size_t align = 0) {
+        ++allocations;
+        if (size == 0) size = 1;
+        if (!align) return std::malloc(size);
+        return std::aligned_alloc(align, (size + align - 1) / align * align);
+    }
+    // Out of line so GCC does not pair the free() with an inlined operator new at call sites
+    [[gnu::noinline]] void release(void* p) noexcept { std::free(p); }
+    void* or_throw(void* p) {
+        if (!p) throw std::bad_alloc();
+        return p;
+    }
+}
+
+void* operator new(std::size_t size) { return or_throw(counted(size)); }
+void* operator new[](std::size_t size) { return or_throw(counted(size)); }
+void* operator new(std::size_t size, std::align_val_t align) { return or_throw(counted(size, std::size_t(align))); }
+void* operator new[](std::size_t size, std::align_val_t align) { return or_throw(counted(size, std::size_t(align))); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return counted(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return counted(size); }
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return counted(size, std::size_t(align));
+}
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return counted(size, std::size_t(align));
+}
+
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, std::size_t) noexcept { release(p); }
+void operator delete[](void* p, std::size_t) noexcept { release(p); }
+void operator delete(void* p, std::align_val_t) noexcept { release(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { release(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { release(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { release(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { release(p); }
+
+TEST(MCTSTest, ExpansionDoesNotAllocate) {
+    othello::GreedyEvaluator evaluator;
+    OthelloBoard board;
+    othello::MCTSNode node(board, Player::BLACK), warmup(board, Player::BLACK);
+    float policy[othello::kPolicySize];
+    auto evaluate = [&](const OthelloBoard& b, Player p, float* out) { return evaluator.evaluate_into(b, p, out); };
+    warmup.expand(evaluate);   // first use of the logger may allocate
+
+    long before = allocations;
+    float value = evaluator.evaluate_into(board, Player::BLACK, policy);
+    float expanded = node.expand(evaluate);
+    EXPECT_EQ(allocations - before, 0);
+
+    EXPECT_EQ(value, expanded);
+    EXPECT_FLOAT_EQ(policy[othello::to_index(3, 2)], 0.25f);
+    EXPECT_EQ(node.legal_move_mask, board.legal_move_mask(Player::BLACK));
+    EXPECT_FLOAT_EQ(node.prior[othello::to_index(3, 2)], 0.25f);
+}
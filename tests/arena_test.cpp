@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include "othello/arena.hpp"
+#include "othello/greedy_evaluator.hpp"
+
+namespace {
+    othello::EngineSpec greedy_engine(const std::string& name, int simulations) {
+        othello::EngineSpec spec;
+        spec.name = name;
+        spec.simulations = simulations;
+        spec.factory = [] { return std::make_unique<othello::GreedyEvaluator>(); };
+        return spec;
+    }
+}
+
+TEST(ArenaTest, EloAndSprtStatistics) {
+    EXPECT_NEAR(othello::score_to_elo(0.5), 0.0, 1e-9);
+    EXPECT_NEAR(othello::score_to_elo(0.75), 190.85, 0.01);
+    EXPECT_NEAR(othello::elo_to_score(othello::score_to_elo(0.3)), 0.3, 1e-9);
+
+    othello::MatchScore even{400, 200, 400};
+    EXPECT_NEAR(even.elo(), 0.0, 1e-9);
+    EXPECT_GT(even.elo_error(), 10.0);
+    EXPECT_LT(even.elo_error(), 30.0);
+
+    // An even match speaks for H0 against a +20 Elo hypothesis, a lopsided one for H1
+    othello::SprtConfig sprt;
+    EXPECT_LT(even.llr(0.0, 20.0), 0.0);
+    othello::MatchScore strong{600, 100, 300};
+    EXPECT_GT(strong.llr(0.0, 20.0), sprt.upper_bound());
+    EXPECT_LT(sprt.lower_bound(), 0.0);
+    EXPECT_GT(sprt.upper_bound(), 0.0);
+}
+
+TEST(ArenaTest, OpeningsAreDistinctUpToSymmetry) {
+    // All four first moves are equivalent; after two plies there are three distinct positions
+    EXPECT_EQ(othello::generate_openings(1, 1).size(), 1u);
+    EXPECT_EQ(othello::generate_openings(2, 1).size(), 3u);
+
+    auto openings = othello::generate_openings(6, 7);
+    EXPECT_GT(openings.size(), 100u);
+    for (const auto& o : openings) {
+        EXPECT_EQ(o.moves.size(), 6u);
+        EXPECT_EQ(o.board.count_disks(Player::BLACK) + o.board.count_disks(Player::WHITE), 10);
+        EXPECT_TRUE(o.board.has_valid_move(o.to_move));
+    }
+
+    std::string path = ::testing::TempDir() + "openings.txt";
+    std::ofstream(path) << "# two lines\nf5d6\n\nf5 f6 e6\n";
+    auto loaded = othello::load_openings(path);
+    ASSERT_EQ(loaded.size(), 2u);
+    EXPECT_EQ(loaded[0].to_move, Player::BLACK);
+    EXPECT_EQ(loaded[1].to_move, Player::WHITE);
+    std::ofstream(path) << "f5f5\n";
+    EXPECT_THROW(othello::load_openings(path), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(ArenaTest, ParallelMatchPlaysColourSwappedPairs) {
+    othello::ArenaConfig config;
+    config.threads = 3;
+    config.max_games = 23;   // rounded up to 12 pairs
+    config.sprt.enabled = false;
+    othello::Arena arena(greedy_engine("a", 8), greedy_engine("b", 8), config);
+    othello::ArenaResult result = arena.run();
+
+    EXPECT_EQ(result.score.games(), 24u);
+    EXPECT_EQ(result.a_black_games, 12u);
+    EXPECT_EQ(result.sprt, othello::SprtResult::CONTINUE);
+    EXPECT_GT(result.games_per_second(), 0.0);
+}
+
+TEST(ArenaTest, StopsWhenTheOpeningsRunOut) {
+    othello::ArenaConfig config;
+    config.threads = 2;
+    config.max_games = 20;
+    config.sprt.enabled = false;
+    othello::Arena arena(greedy_engine("a", 4), greedy_engine("b", 4), config, othello::generate_openings(2, 1));
+    othello::ArenaResult result = arena.run();
+
+    EXPECT_EQ(result.score.games(), 6u);   // one pair for each of the 3 openings
+    EXPECT_EQ(result.a_black_games, 3u);
+}
+
+TEST(ArenaTest, SprtStopsEarlyOnAClearResult) {
+    // Greedy MCTS gains roughly +140 Elo going from 1 to 200 simulations per move
+    othello::ArenaConfig config;
+    config.threads = 3;
+    config.max_games = 1000;
+    config.sprt.elo0 = 0.0;
+    config.sprt.elo1 = 50.0;
+    othello::Arena arena(greedy_engine("strong", 200), greedy_engine("weak", 1), config);
+    othello::ArenaResult result = arena.run();
+
+    EXPECT_EQ(result.sprt, othello::SprtResult::ACCEPT_H1) << result.summary(config.sprt);
+    EXPECT_LT(result.score.games(), 1000u);
+    EXPECT_GE(result.llr, config.sprt.upper_bound());
+    EXPECT_GT(result.score.elo(), 50.0);
+    // Pairs still running when the test stopped are dropped whole, never half counted
+    EXPECT_EQ(result.score.games(), 2 * result.a_black_games);
+}
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
+#include <random>
+#include "othello/bitboard.hpp"
 #include "othello/board.hpp"
+#include "othello/symmetry.hpp"
 
 TEST(OthelloBoardTest, InitialStateHasFourPieces) {
     OthelloBoard board;
@@ -64,4 +67,25 @@ TEST(OthelloBoardTest, BitboardsDoNotOverlap) {
     board.apply_move(Player::BLACK, Move(2, 3));
     board.apply_move(Player::WHITE, Move(2, 2));
     EXPECT_EQ(board.debug_black() & board.debug_white(), 0ULL);  // Ensure no overlapping bits
-}
\ No newline at end of file
+}
+TEST(OthelloBoardTest, SymmetriesPermuteSquaresAndCommuteWithMoveGeneration) {
+    namespace sym = othello::symmetry;
+    std::mt19937_64 rng(7);
+    for (int t = 0; t < sym::kCount; ++t) {
+        // The bit tricks agree with the square map, which is a permutation
+        uint64_t image = 0;
+        for (int sq = 0; sq < 64; ++sq) {
+            EXPECT_EQ(sym::transform(1ULL << sq, t), 1ULL << sym::square(sq, t)) << "t=" << t << " sq=" << sq;
+            EXPECT_EQ(sym::square(sym::square(sq, t), sym::inverse(t)), sq);
+            image |= 1ULL << sym::square(sq, t);
+        }
+        EXPECT_EQ(image, ~0ULL);
+
+        for (int i = 0; i < 200; ++i) {
+            uint64_t occupied = rng() & rng();
+            uint64_t own = occupied & rng(), opp = occupied & ~own;
+            EXPECT_EQ(othello::bitboard::legal_moves(sym::transform(own, t), sym::transform(opp, t)),
+                      sym::transform(othello::bitboard::legal_moves(own, opp), t));
+        }
+    }
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include "othello/book.hpp"
+#include "othello/greedy_evaluator.hpp"
+#include "othello/selfplay.hpp"
+#include "othello/symmetry.hpp"
+
+namespace {
+    othello::GameRecord game(std::vector<Move> moves, Player winner) {
+        othello::GameRecord record;
+        record.moves = std::move(moves);
+        record.winner = winner;
+        return record;
+    }
+
+    // Image of a move under the main-diagonal transpose
+    Move mirrored(const Move& m) {
+        int sq = othello::symmetry::square(othello::to_index(m.x, m.y), 6);
+        return Move(sq % 8, sq / 8);
+    }
+}
+
+TEST(BookTest, BuildWriteProbeRoundTrip) {
+    othello::BookBuilder builder(4);
+    const std::vector<Move> line = {Move(5, 4), Move(3, 5), Move(2, 2)};
+    builder.add_game(game(line, Player::BLACK));
+    builder.add_game(game(line, Player::NONE));
+    builder.add_game(game({Move(5, 4), Move(5, 5)}, Player::WHITE));   // seen once: below min_games
+
+    std::string path = ::testing::TempDir() + "book.bin";
+    EXPECT_EQ(builder.write(path, 2), 3u);
+    EXPECT_EQ(builder.games(), 3u);
+
+    othello::OpeningBook book(path);
+    ASSERT_EQ(book.size(), 3u);
+    EXPECT_EQ(book.max_plies(), 4u);
+
+    // The four first moves are equivalent and share one entry
+    OthelloBoard board;
+    auto first = book.probe(board, Player::BLACK);
+    ASSERT_TRUE(first.has_value());
+    EXPECT_TRUE(board.is_valid_move(Player::BLACK, first->x, first->y));
+    auto entries = book.moves(board, Player::BLACK);
+    ASSERT_EQ(entries.size(), 1u);
+    EXPECT_EQ(entries[0].weight, 3u);   // a win and a draw out of three games
+
+    board.apply_move(Player::BLACK, Move(5, 4));
+    EXPECT_EQ(book.probe(board, Player::WHITE), Move(3, 5));
+    board.apply_move(Player::WHITE, Move(3, 5));
+    std::mt19937 rng(3);
+    EXPECT_EQ(book.probe(board, Player::BLACK, &rng), Move(2, 2));
+    board.apply_move(Player::BLACK, Move(2, 2));
+    EXPECT_FALSE(book.probe(board, Player::WHITE).has_value());
+    std::remove(path.c_str());
+}
+
+TEST(BookTest, SymmetricPositionsShareEntries) {
+    othello::BookBuilder builder;
+    builder.add_game(game({Move(5, 4), Move(3, 5), Move(2, 2)}, Player::BLACK));
+    builder.add_game(game({mirrored(Move(5, 4)), mirrored(Move(3, 5)), mirrored(Move(2, 2))}, Player::NONE));
+    std::string path = ::testing::TempDir() + "book_sym.bin";
+    EXPECT_EQ(builder.write(path, 2), 3u);
+    othello::OpeningBook book(path);
+
+    // The mirrored line probes back to mirrored moves
+    OthelloBoard board;
+    board.apply_move(Player::BLACK, mirrored(Move(5, 4)));
+    EXPECT_EQ(book.probe(board, Player::WHITE), mirrored(Move(3, 5)));
+    board.apply_move(Player::WHITE, mirrored(Move(3, 5)));
+    EXPECT_EQ(book.probe(board, Player::BLACK), mirrored(Move(2, 2)));
+    std::remove(path.c_str());
+}
+
+TEST(BookTest, CollectsSelfPlayGamesAndRejectsCorruptFiles) {
+    othello::SelfPlayConfig config;
+    config.threads = 2;
+    config.simulations = 8;
+    othello::BookBuilder builder(6);
+    ReplayBuffer sink(1024);
+    othello::SelfPlay selfplay([] { return std::make_unique<othello::GreedyEvaluator>(); }, sink, config);
+    selfplay.set_game_observer([&builder](const othello::GameRecord& g) { builder.add_game(g); });
+    selfplay.run(6);
+    EXPECT_EQ(builder.games(), 6u);
+
+    std::string path = ::testing::TempDir() + "book_selfplay.bin";
+    EXPECT_GT(builder.write(path, 1), 6u);
+    { othello::OpeningBook book(path); EXPECT_TRUE(book.probe(OthelloBoard(), Player::BLACK).has_value()); }
+
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << "OTHBOOK1 but not really a book";
+    EXPECT_THROW(othello::OpeningBook book(path), std::runtime_error);
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << "short";
+    EXPECT_THROW(othello::OpeningBook book(path), std::runtime_error);
+    EXPECT_THROW(othello::OpeningBook book(path + ".missing"), std::runtime_error);
+    EXPECT_THROW(builder.add_game(game({Move(0, 0)}, Player::BLACK)), std::invalid_argument);
+    std::remove(path.c_str());
+}
@@ -1,12 +1,21 @@
 #include <gtest/gtest.h>
+#include <cmath>
+#include <chrono>
+#include <filesystem>
 #include "opencl/context.hpp"
-#include "generated/weights.hpp"
+#include "opencl/network_evaluator.hpp"
+#include "othello/network_evaluator.hpp"
 #include "generated/kernels.hpp"
 
+// Selects any device, so these run on CPU-only machines with e.g. pocl installed
+#define REQUIRE_OPENCL_DEVICE() \
+    if (OpenCLContext::enumerate_devices().empty()) GTEST_SKIP() << "No OpenCL device available"
+
 // Test kernel: add_numbers.cl
 // Adds two float inputs on the GPU using OpenCL
 TEST(OpenCLTest, CLAddFloats) {
     using namespace std;
+    REQUIRE_OPENCL_DEVICE();
 
     // Load kernel source code
     std::string source = kernel_sources.at("add_numbers.cl");
@@ -65,3 +74,133 @@ TEST(OpenCLTest, CLAddFloats) {
     clReleaseKernel(kernel);
     clReleaseProgram(program);
 }
+
+TEST(OpenCLTest, DeviceSelectorParsing) {
+    EXPECT_EQ(DeviceSelector::parse("cpu").type, static_cast<cl_device_type>(CL_DEVICE_TYPE_CPU));
+    EXPECT_EQ(DeviceSelector::parse("GPU").type, static_cast<cl_device_type>(CL_DEVICE_TYPE_GPU));
+    EXPECT_EQ(DeviceSelector::parse("1").index, 1);
+    EXPECT_EQ(DeviceSelector::parse("pocl").vendor, "pocl");
+}
+
+TEST(OpenCLTest, RejectsOutOfRangeDeviceIndex) {
+    REQUIRE_OPENCL_DEVICE();
+    DeviceSelector selector;
+    selector.index = static_cast<int>(OpenCLContext::enumerate_devices().size());
+    EXPECT_THROW(OpenCLContext context(selector), std::runtime_error);
+}
+
+TEST(OpenCLTest, BatchedNetworkMatchesCpu) {
+    REQUIRE_OPENCL_DEVICE();
+
+    nn::Network net;
+    net.init_random(5);
+
+    // A few positions along one game
+    std::vector<float> inputs;
+    OthelloBoard board;
+    Player player = Player::BLACK;
+    const int n = 6;
+    for (int i = 0; i < n; ++i) {
+        auto t = board.to_tensor(player);
+        inputs.insert(inputs.end(), t.begin(), t.end());
+        board.apply_move(player, board.get_valid_moves(player)[0]);
+        player = othello::opponent(player);
+    }
+
+    DeviceSelector any;
+    any.type = CL_DEVICE_TYPE_ALL;
+    OpenCLContext context(any);
+    OpenCLEvaluator gpu(context, net, 8);
+    othello::NetworkEvaluator cpu(net);
+
+    std::vector<float> gpu_policy(n * nn::kPolicySize), cpu_policy(n * nn::kPolicySize);
+    std::vector<float> gpu_value(n), cpu_value(n);
+    gpu.evaluate_batch(inputs.data(), n, gpu_policy.data(), gpu_value.data());
+    cpu.evaluate_batch(inputs.data(), n, cpu_policy.data(), cpu_value.data());
+
+    for (int i = 0; i < n; ++i) EXPECT_NEAR(gpu_value[i], cpu_value[i], 1e-4f);
+    for (size_t i = 0; i < gpu_policy.size(); ++i) EXPECT_NEAR(gpu_policy[i], cpu_policy[i], 1e-4f);
+}
+
+TEST(OpenCLTest, ProgramCacheKeyCoversOptionsAndSource) {
+    DeviceInfo device{};
+    device.name = "device";
+    device.driver_version = "1.0";
+    uint64_t base = ProgramCache::key(device, "", "kernel");
+    EXPECT_EQ(base, ProgramCache::key(device, "", "kernel"));
+    EXPECT_NE(base, ProgramCache::key(device, "-cl-fast-relaxed-math", "kernel"));
+    EXPECT_NE(base, ProgramCache::key(device, "", "kernel2"));
+    device.driver_version = "1.1";
+    EXPECT_NE(base, ProgramCache::key(device, "", "kernel"));
+}
+
+TEST(OpenCLTest, ProgramCacheWarmStart) {
+    REQUIRE_OPENCL_DEVICE();
+    namespace fs = std::filesystem;
+    fs::path dir = fs::path(::testing::TempDir()) / "othello_cl_cache_test";
+    fs::remove_all(dir);
+
+    DeviceSelector any;
+    any.type = CL_DEVICE_TYPE_ALL;
+    OpenCLContext context(any);
+    ProgramCache cache(dir.string());
+    const std::string& source = kernel_sources.at("network.cl");
+
+    // Cold: compiled from source and stored; warm: loaded from the stored binary
+    bool hit = true;
+    auto start = std::chrono::steady_clock::now();
+    cl_program cold = cache.build(context.context(), context.device_info(), source, "", &hit);
+    auto cold_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_FALSE(hit);
+
+    start = std::chrono::steady_clock::now();
+    cl_program warm = cache.build(context.context(), context.device_info(), source, "", &hit);
+    auto warm_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_TRUE(hit);
+    RecordProperty("cold_build_us", static_cast<int>(cold_ms * 1000));
+    RecordProperty("warm_build_us", static_cast<int>(warm_ms * 1000));
+
+    cl_int err;
+    cl_kernel kernel = clCreateKernel(warm, "softmax", &err);
+    EXPECT_EQ(err, CL_SUCCESS);
+
+    clReleaseKernel(kernel);
+    clReleaseProgram(cold);
+    clReleaseProgram(warm);
+    fs::remove_all(dir);
+}
+
+TEST(OpenCLTest, PipelineOverlapsBatches) {
+    REQUIRE_OPENCL_DEVICE();
+
+    nn::Network net;
+    net.init_random(9);
+    OthelloBoard board;
+    auto tensor = board.to_tensor(Player::BLACK);
+    std::vector<float> inputs;
+    for (int i = 0; i < 4; ++i) inputs.insert(inputs.end(), tensor.begin(), tensor.end());
+
+    DeviceSelector any;
+    any.type = CL_DEVICE_TYPE_ALL;
+    OpenCLContext context(any);
+    InferencePipeline pipeline(context, net, 4, 2);
+
+    // Two batches in flight; a third submit must wait for a collected slot
+    uint64_t t0 = pipeline.submit(inputs.data(), 4);
+    uint64_t t1 = pipeline.submit(inputs.data(), 2);
+    EXPECT_EQ(pipeline.in_flight(), 2);
+    EXPECT_THROW(pipeline.submit(inputs.data(), 1), std::logic_error);
+
+    std::vector<float> expected_policy(nn::kPolicySize);
+    float expected_value = net.forward(tensor.data(), expected_policy.data());
+
+    std::vector<float> policies(4 * nn::kPolicySize), values(4);
+    pipeline.wait(t0, policies.data(), values.data());
+    for (int i = 0; i < 4; ++i) EXPECT_NEAR(values[i], expected_value, 1e-4f);
+    pipeline.wait(t1, policies.data(), values.data());
+    EXPECT_NEAR(policies[nn::kPolicySize + 19], expected_policy[19], 1e-4f);
+
+    EXPECT_EQ(pipeline.in_flight(), 0);
+    EXPECT_EQ(pipeline.stats().batches, 2u);
+    EXPECT_EQ(pipeline.stats().positions, 6u);
+}
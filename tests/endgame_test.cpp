@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include "othello/bitboard.hpp"
+#include "othello/endgame.hpp"
+
+namespace {
+    // Plain negamax over every move, no pruning
+    int brute_force(uint64_t own, uint64_t opp, bool passed = false) {
+        using namespace othello::bitboard;
+        uint64_t moves = legal_moves(own, opp);
+        if (!moves) {
+            if (passed) {
+                int diff = popcount(own) - popcount(opp), empties = 64 - popcount(own | opp);
+                return diff > 0 ? diff + empties : diff < 0 ? diff - empties : 0;
+            }
+            return -brute_force(opp, own, true);
+        }
+        int best = -65;
+        for (; moves; moves &= moves - 1) {
+            int sq = __builtin_ctzll(moves);
+            uint64_t f = flips(own, opp, sq);
+            best = std::max(best, -brute_force(opp & ~f, own | f | 1ULL << sq));
+        }
+        return best;
+    }
+
+    // A random game played until `empties` squares are left (with the side to move able to move)
+    std::pair<OthelloBoard, Player> random_position(uint32_t seed, int empties) {
+        std::mt19937 rng(seed);
+        OthelloBoard board;
+        Player player = Player::BLACK;
+        while (64 - board.count_disks(Player::BLACK) - board.count_disks(Player::WHITE) > empties &&
+               !board.is_game_over()) {
+            if (board.has_valid_move(player)) {
+                auto moves = board.get_valid_moves(player);
+                board.apply_move(player, moves[rng() % moves.size()]);
+            }
+            player = othello::opponent(player);
+        }
+        return {board, player};
+    }
+}
+
+TEST(EndgameTest, MatchesBruteForceOnSmallEndgames) {
+    othello::EndgameConfig config;
+    config.threads = 1;
+    config.table_bits = 16;
+    othello::EndgameSolver solver(config);
+    for (uint32_t seed = 0; seed < 30; ++seed) {
+        auto [board, player] = random_position(seed, 9);
+        const uint64_t own = board.bits(player), opp = board.bits(othello::opponent(player));
+        const othello::EndgameResult result = solver.solve(board, player);
+        ASSERT_EQ(result.score, brute_force(own, opp)) << "seed " << seed;
+        if (result.best == othello::PASS) {
+            EXPECT_EQ(board.legal_move_mask(player), 0u);
+            continue;
+        }
+
+        // The best move keeps the score
+        ASSERT_TRUE(board.is_valid_move(player, result.best.x, result.best.y));
+        OthelloBoard next = board.apply_move_copy(player, result.best);
+        uint64_t next_own = next.bits(othello::opponent(player)), next_opp = next.bits(player);
+        EXPECT_EQ(-brute_force(next_own, next_opp), result.score) << "seed " << seed;
+    }
+}
+
+TEST(EndgameTest, ParallelSearchAgreesWithOneThread) {
+    othello::EndgameConfig serial;
+    serial.threads = 1;
+    serial.table_bits = 18;
+    othello::EndgameConfig parallel = serial;
+    parallel.threads = 4;
+    parallel.split_empties = 8;   // small, so the test trees split often
+    for (uint32_t seed = 100; seed < 106; ++seed) {
+        auto [board, player] = random_position(seed, 14);
+        othello::EndgameSolver one(serial), four(parallel);
+        const othello::EndgameResult a = one.solve(board, player);
+        const othello::EndgameResult b = four.solve(board, player);
+        EXPECT_EQ(a.score, b.score) << "seed " << seed;
+        EXPECT_GT(b.nodes, 0u);
+
+        // Solving again reuses the table
+        EXPECT_EQ(four.solve(board, player).score, a.score);
+    }
+}
+
+TEST(EndgameTest, HandlesPassesAndFinishedGames) {
+    othello::EndgameSolver solver(othello::EndgameConfig{1, 12, 12});
+
+    // Black has no move; white must play
+    auto [pass, player] = othello::parse_position(
+        "OOOOOOOO OOOOOOOO OOOOOOOO OOOOOOOO OOOOOOOO OOOOOOOO OOOOOOX- OOOOOO-- X");
+    ASSERT_EQ(pass.legal_move_mask(player), 0u);
+    othello::EndgameResult result = solver.solve(pass, player);
+    EXPECT_EQ(result.best, othello::PASS);
+    EXPECT_EQ(result.score, brute_force(pass.bits(Player::BLACK), pass.bits(Player::WHITE)));
+
+    // A full board scores as counted
+    auto [full, side] = othello::parse_position(std::string(40, 'X') + std::string(24, 'O') + " O");
+    result = solver.solve(full, side);
+    EXPECT_EQ(result.score, -16);
+    EXPECT_EQ(result.best, othello::PASS);
+}
+
+TEST(EndgameTest, ParsesPositionsInTheFfoLayout) {
+    auto [board, player] = othello::parse_position(
+        "--XXXXX- --XXXXXO OOOOXOXO -XOXXOXX --OOOOXX --OXOXXX -OOOXX-- --O-O--- O");
+    EXPECT_EQ(player, Player::WHITE);
+    EXPECT_EQ(board.at(2, 0), Player::BLACK);
+    EXPECT_EQ(board.at(7, 1), Player::WHITE);
+    EXPECT_EQ(board.at(0, 0), Player::NONE);
+
+    EXPECT_THROW(othello::parse_position("XO-"), std::invalid_argument);
+    EXPECT_THROW(othello::parse_position(std::string(64, '-')), std::invalid_argument);
+    EXPECT_THROW(othello::parse_position(std::string(63, '-') + "Z X"), std::invalid_argument);
+    EXPECT_THROW(othello::parse_position(std::string(64, '-') + " Q"), std::invalid_argument);
+}
+
+TEST(EndgameTest, SolvesTheFastFfoPositionsToTheirPublishedScores) {
+    const std::vector<othello::ScoredPosition> positions = othello::load_positions(OTHELLO_FFO_FILE);
+    ASSERT_GE(positions.size(), 4u);
+    othello::EndgameSolver solver;
+    int solved = 0;
+    for (const othello::ScoredPosition& position : positions) {
+        ASSERT_FALSE(position.best.empty()) << position.label;
+        const OthelloBoard& board = position.board;
+        if (64 - board.count_disks(Player::BLACK) - board.count_disks(Player::WHITE) > 20) continue;   // bench only
+        solver.clear();
+        const othello::EndgameResult result = solver.solve(board, position.player);
+        EXPECT_EQ(result.score, position.score) << position.label;
+        EXPECT_NE(std::find(position.best.begin(), position.best.end(), result.best), position.best.end())
+            << position.label;
+        ++solved;
+    }
+    EXPECT_GE(solved, 1);
+
+    // Fields after the position: a label and the best moves, which must share one score
+    std::string path = ::testing::TempDir() + "positions.obf";
+    std::ofstream(path) << "# comment\n\n" << std::string(63, '-') << "X O; d4:-2; a8:-2; mine\n"
+                        << std::string(63, '-') << "X O\n";
+    std::vector<othello::ScoredPosition> parsed = othello::load_positions(path);
+    ASSERT_EQ(parsed.size(), 2u);
+    EXPECT_EQ(parsed[0].label, "mine");
+    EXPECT_EQ(parsed[0].score, -2);
+    EXPECT_EQ(parsed[0].best, (std::vector<Move>{Move(3, 3), Move(0, 7)}));
+    EXPECT_TRUE(parsed[1].best.empty());
+    EXPECT_EQ(parsed[1].label, path + ":4");
+    std::ofstream(path) << std::string(63, '-') << "X O; d4:-2; a8:+2\n";
+    EXPECT_THROW(othello::load_positions(path), std::invalid_argument);
+    std::ofstream(path) << std::string(63, '-') << "X O; z9:+2\n";
+    EXPECT_THROW(othello::load_positions(path), std::invalid_argument);
+    std::remove(path.c_str());
+}
+
+TEST(EndgameTest, ExpandsNodesWithMoreThan32Moves) {
+    // 34 legal moves for black; the root's children used to overflow a 32-entry buffer
+    auto [board, player] = othello::parse_position(
+        "XO--OXO----------OOOXOO--XX-XX---OX-OXO--XX--XX--OOX-OOX-------- X");
+    ASSERT_EQ(othello::bitboard::popcount(board.legal_move_mask(player)), 34);
+
+    othello::EndgameConfig config;
+    config.threads = 2;
+    config.table_bits = 16;
+    config.max_nodes = 20000;   // far too few to solve 34 empties; the point is the expansion
+    othello::EndgameSolver solver(config);
+    const othello::EndgameResult result = solver.solve(board, player);
+    EXPECT_FALSE(result.complete);
+    EXPECT_GE(result.nodes, config.max_nodes / 2);
+    EXPECT_EQ(result.best, othello::PASS);
+}
@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "othello/inference_broker.hpp"
+
+namespace {
+    // Deterministic backend: value = input[0], policy[k] = input[0] + k; records batch sizes
+    class EchoBackend : public othello::BatchEvaluator {
+    public:
+        explicit EchoBackend(int max_batch) : max_batch_(max_batch) {}
+
+        void evaluate_batch(const float* inputs, int n, float* policies, float* values) override {
+            if (fail) throw std::runtime_error("backend failure");
+            largest_batch = std::max(largest_batch.load(), n);
+            calls.fetch_add(1);
+            std::this_thread::sleep_for(std::chrono::microseconds(200));   // stands in for a device call
+            for (int i = 0; i < n; ++i) {
+                values[i] = inputs[i * 192];
+                for (int k = 0; k < 65; ++k) policies[i * 65 + k] = inputs[i * 192] + k;
+            }
+        }
+
+        int max_batch_size() const override { return max_batch_; }
+
+        std::atomic<int> calls{0};
+        std::atomic<int> largest_batch{0};
+        bool fail = false;
+
+    private:
+        int max_batch_;
+    };
+
+    // Two-slot echo device: submit only queues, collect "waits" for the device. Records how
+    // many batches were out at once.
+    class AsyncEchoBackend : public othello::AsyncBatchEvaluator {
+    public:
+        static constexpr int kDepth = 2;
+
+        uint64_t submit_batch(const float* inputs, int n) override {
+            Slot& slot = slots_[next_ % kDepth];
+            slot.n = n;
+            slot.values.assign(inputs, inputs + size_t(n) * 192);   // echo input[0] from these
+            max_in_flight = std::max(max_in_flight.load(), ++in_flight);
+            return next_++;
+        }
+
+        void collect(uint64_t ticket, float* policies, float* values) override {
+            std::this_thread::sleep_for(std::chrono::microseconds(300));   // the device finishing
+            const Slot& slot = slots_[ticket % kDepth];
+            for (int i = 0; i < slot.n; ++i) {
+                values[i] = slot.values[size_t(i) * 192];
+                for (int k = 0; k < 65; ++k) policies[i * 65 + k] = values[i] + k;
+            }
+            --in_flight;
+        }
+
+        int depth() const override { return kDepth; }
+        int max_batch_size() const override { return 8; }
+
+        std::atomic<int> in_flight{0};
+        std::atomic<int> max_in_flight{0};
+
+    private:
+        struct Slot {
+            int n = 0;
+            std::vector<float> values;
+        };
+        Slot slots_[kDepth];
+        uint64_t next_ = 0;
+    };
+}
+
+TEST(InferenceBrokerTest, ConcurrentRequestsAreBatchedAndRoutedBack) {
+    EchoBackend backend(32);
+    othello::BrokerConfig config;
+    config.max_batch = 64;                                   // clamped to the backend's 32
+    config.max_wait = std::chrono::microseconds(2000);
+    othello::InferenceBroker broker(backend, config);
+    EXPECT_EQ(broker.max_batch(), 32);
+
+    constexpr int kThreads = 16, kPerThread = 50;
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            std::vector<float> input(192, 0.0f), policy(65);
+            for (int i = 0; i < kPerThread; ++i) {
+                input[0] = float(t * 1000 + i);
+                float value = broker.evaluate(input.data(), policy.data());
+                if (value != input[0] || policy[64] != input[0] + 64) mismatches.fetch_add(1);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    EXPECT_EQ(mismatches.load(), 0);
+    othello::BrokerStats stats = broker.stats();
+    EXPECT_EQ(stats.requests, uint64_t(kThreads * kPerThread));
+    EXPECT_EQ(stats.latency_us.total, stats.requests);
+    EXPECT_GT(stats.mean_batch(), 2.0) << stats.report();
+    EXPECT_LE(backend.largest_batch.load(), 32);
+}
+
+TEST(InferenceBrokerTest, LoneRequestRunsAfterDeadline) {
+    EchoBackend backend(64);
+    othello::BrokerConfig config;
+    config.max_wait = std::chrono::microseconds(1000);
+    othello::InferenceBroker broker(backend, config);
+
+    std::vector<float> input(192, 3.0f), policy(65);
+    othello::InferenceRequest request;
+    auto start = std::chrono::steady_clock::now();
+    broker.submit(request, input.data(), policy.data());
+    EXPECT_EQ(broker.wait(request), 3.0f);
+    EXPECT_TRUE(request.ready());
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+    EXPECT_EQ(broker.stats().batch_fill[1], 1u);
+}
+
+TEST(InferenceBrokerTest, BackendErrorsReachTheCaller) {
+    EchoBackend backend(8);
+    backend.fail = true;
+    othello::InferenceBroker broker(backend);
+    std::vector<float> input(192, 0.0f), policy(65);
+    EXPECT_THROW(broker.evaluate(input.data(), policy.data()), std::runtime_error);
+}
+
+TEST(InferenceBrokerTest, AsyncBackendOverlapsBatches) {
+    AsyncEchoBackend backend;
+    othello::BrokerConfig config;
+    config.max_wait = std::chrono::microseconds(200);
+    othello::InferenceBroker broker(backend, config);
+
+    constexpr int kThreads = 24, kPerThread = 40;
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            std::vector<float> input(192, 0.0f), policy(65);
+            for (int i = 0; i < kPerThread; ++i) {
+                input[0] = float(t * 1000 + i);
+                float value = broker.evaluate(input.data(), policy.data());
+                if (value != input[0] || policy[64] != input[0] + 64) mismatches.fetch_add(1);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+
+    EXPECT_EQ(mismatches.load(), 0);
+    EXPECT_EQ(backend.max_in_flight.load(), AsyncEchoBackend::kDepth);
+    othello::BrokerStats stats = broker.stats();
+    EXPECT_EQ(stats.requests, uint64_t(kThreads * kPerThread));
+    EXPECT_GT(stats.stall_seconds, 0.0) << stats.report();
+}
+
+TEST(InferenceBrokerTest, ExportsBrokerMetrics) {
+    EchoBackend backend(8);
+    othello::metrics::Registry registry;
+    othello::InferenceBroker broker(backend, {}, &registry);
+    std::vector<float> input(192, 1.0f), policy(65);
+    for (int i = 0; i < 3; ++i) broker.evaluate(input.data(), policy.data());
+
+    othello::BrokerStats stats = broker.stats();
+    EXPECT_EQ(stats.requests, 3u);
+    EXPECT_EQ(stats.latency_us.total, 3u);
+    const std::string text = registry.prometheus_text();
+    EXPECT_NE(text.find("othello_broker_requests_total 3\n"), std::string::npos) << text;
+    EXPECT_NE(text.find("othello_broker_batch_size_count " + std::to_string(stats.batches) + "\n"),
+              std::string::npos) << text;
+    EXPECT_NE(text.find("othello_broker_latency_seconds_count 3\n"), std::string::npos) << text;
+}
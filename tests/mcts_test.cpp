@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <random>
+#include "othello/bitboard.hpp"
+#include "othello/greedy_evaluator.hpp"
+#include "othello/mcts.hpp"
+
+namespace {
+    // Exact final disk differential for the side owning `own`, both sides playing perfectly
+    int solve(uint64_t own, uint64_t opp, bool passed = false) {
+        uint64_t moves = othello::bitboard::legal_moves(own, opp);
+        if (!moves) {
+            if (passed) return othello::bitboard::popcount(own) - othello::bitboard::popcount(opp);
+            return -solve(opp, own, true);
+        }
+        int best = -65;
+        for (; moves; moves &= moves - 1) {
+            int sq = __builtin_ctzll(moves);
+            uint64_t flipped = othello::bitboard::flips(own, opp, sq);
+            best = std::max(best, -solve(opp & ~flipped, own | flipped | (1ULL << sq)));
+        }
+        return best;
+    }
+}
+
+TEST(MCTSTest, FindsExactMoveInEndgames) {
+    // With only a few empties the tree reaches every terminal, so the search must agree
+    // with perfect play; a sign error in backpropagation would pick the worst move instead
+    std::mt19937 rng(11);
+    othello::GreedyEvaluator evaluator;
+    othello::MCTS mcts(evaluator, 3000);
+
+    int checked = 0;
+    while (checked < 10) {
+        OthelloBoard board;
+        Player player = Player::BLACK;
+        while (!board.is_game_over() && board.count_disks(Player::BLACK) + board.count_disks(Player::WHITE) < 59) {
+            auto moves = board.get_valid_moves(player);
+            board.apply_move(player, moves[rng() % moves.size()]);
+            player = othello::opponent(player);
+        }
+        uint64_t own = board.bits(player), opp = board.bits(othello::opponent(player));
+        if (board.is_game_over() || __builtin_popcountll(board.legal_move_mask(player)) < 2) continue;
+
+        mcts.set_root(board, player);
+        mcts.run();
+        Move best = mcts.best_move();
+        int sq = othello::to_index(best.x, best.y);
+        ASSERT_TRUE((board.legal_move_mask(player) >> sq) & 1);
+
+        uint64_t flipped = othello::bitboard::flips(own, opp, sq);
+        int chosen = -solve(opp & ~flipped, own | flipped | (1ULL << sq));
+        EXPECT_EQ(chosen, solve(own, opp)) << "position " << checked;
+        ++checked;
+    }
+}
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "othello/greedy_evaluator.hpp"
+#include "othello/metrics.hpp"
+
+namespace metrics = othello::metrics;
+
+namespace {
+    // Whole response to one HTTP GET on the loopback port
+    std::string http_get(int port, const std::string& path) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            close(fd);
+            return "";
+        }
+        std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+        std::string response;
+        char buf[4096];
+        ssize_t n;
+        while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) response.append(buf, static_cast<size_t>(n));
+        close(fd);
+        return response;
+    }
+}
+
+TEST(MetricsTest, HistogramBucketsStayWithinAnEighth) {
+    for (uint64_t v : {0ULL, 1ULL, 7ULL, 8ULL, 9ULL, 100ULL, 12345ULL, 1ULL << 40, ~0ULL}) {
+        int b = metrics::Histogram::bucket_of(v);
+        ASSERT_LT(b, metrics::Histogram::kBuckets);
+        uint64_t upper = metrics::Histogram::bucket_upper(b);
+        EXPECT_GE(upper, v);
+        EXPECT_LE(upper - v, v / 8) << v;
+        if (b > 0) {
+            EXPECT_LT(metrics::Histogram::bucket_upper(b - 1), v) << v;
+        }
+    }
+
+    metrics::Histogram h;
+    for (uint64_t v = 1; v <= 1000; ++v) h.record(v);
+    metrics::HistogramSnapshot snap = h.snapshot();
+    EXPECT_EQ(snap.total, 1000u);
+    EXPECT_EQ(snap.sum, 500500u);
+    EXPECT_EQ(snap.max, 1000u);
+    EXPECT_NEAR(snap.percentile(0.5), 500.0, 500 / 8.0);
+    EXPECT_NEAR(snap.percentile(0.99), 990.0, 990 / 8.0);
+    EXPECT_EQ(snap.percentile(1.0), 1000u);   // clamped to the largest value seen
+}
+
+TEST(MetricsTest, ConcurrentRecordingLosesNothing) {
+    metrics::Registry registry;
+    metrics::Counter& counter = registry.counter("test_events_total", "Events");
+    metrics::Histogram& histogram = registry.histogram("test_latency_seconds", "Latency", 1e-6);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&, t] {
+            for (uint64_t i = 0; i < 10000; ++i) {
+                counter.add();
+                histogram.record(i + t);
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    EXPECT_EQ(counter.value(), 80000u);
+    EXPECT_EQ(histogram.snapshot().total, 80000u);
+    EXPECT_EQ(histogram.snapshot().max, 10006u);
+}
+
+TEST(MetricsTest, RendersPrometheusText) {
+    metrics::Registry registry;
+    registry.counter("test_moves_total", "Moves", "source=\"book\"").add(3);
+    registry.counter("test_moves_total", "Moves", "source=\"search\"").add(5);
+    EXPECT_EQ(registry.counter("test_moves_total", "Moves", "source=\"book\"").value(), 3u);   // same series
+    registry.gauge("test_active", "Active").set(-2);
+    registry.histogram("test_think_seconds", "Think", 1e-6).record(250000);
+    EXPECT_THROW(registry.gauge("test_moves_total", "Moves"), std::invalid_argument);
+
+    const std::string text = registry.prometheus_text();
+    EXPECT_NE(text.find("# TYPE test_moves_total counter\n"), std::string::npos);
+    EXPECT_NE(text.find("test_moves_total{source=\"book\"} 3\n"), std::string::npos);
+    EXPECT_NE(text.find("test_moves_total{source=\"search\"} 5\n"), std::string::npos);
+    EXPECT_NE(text.find("test_active -2\n"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE test_think_seconds summary\n"), std::string::npos);
+    EXPECT_NE(text.find("test_think_seconds{quantile=\"0.5\"} 0.25\n"), std::string::npos);
+    EXPECT_NE(text.find("test_think_seconds_count 1\n"), std::string::npos);
+    EXPECT_NE(text.find("test_think_seconds_max 0.25\n"), std::string::npos);
+    EXPECT_EQ(text.find("test_moves_total\n"), std::string::npos);   // no stray unlabelled series
+}
+
+TEST(MetricsTest, TimedEvaluatorRecordsEachCall) {
+    metrics::Histogram latency;
+    metrics::TimedEvaluator evaluator(std::make_unique<othello::GreedyEvaluator>(), latency);
+    OthelloBoard board;
+    float policy[othello::kPolicySize];
+    evaluator.evaluate_into(board, Player::BLACK, policy);
+    evaluator.evaluate(board, Player::BLACK);
+    EXPECT_EQ(latency.snapshot().total, 2u);
+}
+
+TEST(MetricsTest, ExporterServesHttpAndFlushesFile) {
+    metrics::Registry registry;
+    metrics::Counter& counter = registry.counter("test_requests_total", "Requests");
+    counter.add(7);
+
+    metrics::ExporterConfig config;
+    config.http_port = 0;
+    config.file_path = ::testing::TempDir() + "metrics_test.prom";
+    config.interval = std::chrono::milliseconds(20);
+    std::remove(config.file_path.c_str());
+    {
+        metrics::Exporter exporter(registry, config);
+        ASSERT_GT(exporter.port(), 0);
+
+        std::string response = http_get(exporter.port(), "/metrics");
+        EXPECT_EQ(response.rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+        EXPECT_NE(response.find("\r\n\r\n# HELP test_requests_total Requests\n"), std::string::npos);
+        EXPECT_NE(response.find("test_requests_total 7\n"), std::string::npos);
+        EXPECT_EQ(http_get(exporter.port(), "/other").rfind("HTTP/1.1 404", 0), 0u);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        std::ifstream file(config.file_path);
+        ASSERT_TRUE(file.good());
+        counter.add();
+    }
+
+    // The destructor flushes once more
+    std::ifstream file(config.file_path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    EXPECT_NE(contents.str().find("test_requests_total 8\n"), std::string::npos);
+    std::remove(config.file_path.c_str());
+}
@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include "othello/board.hpp"
+#include "nn/model_file.hpp"
+#include "nn/model_registry.hpp"
+#include "nn/network.hpp"
+#include "nn/quantized.hpp"
+#include "nn/simd.hpp"
+
+namespace {
+    std::vector<std::vector<float>> playout_positions(int count, uint32_t seed) {
+        std::mt19937 rng(seed);
+        std::vector<std::vector<float>> positions;
+        OthelloBoard board;
+        Player player = Player::BLACK;
+        while (static_cast<int>(positions.size()) < count) {
+            if (board.is_game_over()) { board = OthelloBoard(); player = Player::BLACK; }
+            positions.push_back(board.to_tensor(player));
+            auto moves = board.get_valid_moves(player);
+            board.apply_move(player, moves[rng() % moves.size()]);
+            player = othello::opponent(player);
+        }
+        return positions;
+    }
+}
+
+TEST(NetworkTest, Int8DotMatchesScalar) {
+    std::mt19937 rng(7);
+    std::vector<uint8_t> a(96);
+    std::vector<int8_t> b(96);
+    int32_t expected = 0;
+    for (int i = 0; i < 96; ++i) {
+        a[i] = rng() % 128;
+        b[i] = static_cast<int8_t>(static_cast<int>(rng() % 255) - 127);
+        expected += a[i] * b[i];
+    }
+    EXPECT_EQ(nn::simd::dot_u8s8(a.data(), b.data(), 96), expected);
+}
+
+TEST(NetworkTest, RejectsMismatchedWeights) {
+    std::vector<float> weights(512);
+    EXPECT_THROW(nn::Network::from_buffer(weights.data(), weights.size() * sizeof(float)), std::runtime_error);
+}
+
+TEST(NetworkTest, ForwardProducesDistributionAndBoundedValue) {
+    nn::Network net;
+    net.init_random(1);
+    std::vector<float> policy(nn::kPolicySize);
+    OthelloBoard board;
+    float value = net.forward(board.to_tensor(Player::BLACK).data(), policy.data());
+
+    EXPECT_NEAR(std::accumulate(policy.begin(), policy.end(), 0.0f), 1.0f, 1e-4f);
+    EXPECT_GE(value, -1.0f);
+    EXPECT_LE(value, 1.0f);
+}
+
+TEST(NetworkTest, QuantizedTracksFloat) {
+    nn::Network net;
+    net.init_random(3);
+    auto calib = nn::Calibration::collect(net, playout_positions(256, 11));
+    nn::QuantizedNetwork qnet(net, calib);
+
+    std::vector<float> p32(nn::kPolicySize), p8(nn::kPolicySize);
+    for (const auto& pos : playout_positions(64, 12)) {
+        float v32 = net.forward(pos.data(), p32.data());
+        float v8 = qnet.forward(pos.data(), p8.data());
+        float tv = 0.0f;
+        for (int i = 0; i < nn::kPolicySize; ++i) tv += std::fabs(p32[i] - p8[i]);
+        EXPECT_LT(0.5f * tv, 0.1f);
+        EXPECT_NEAR(v32, v8, 0.1f);
+    }
+}
+
+TEST(NetworkTest, ModelFileRoundTripIsZeroCopy) {
+    nn::Network net;
+    net.init_random(5);
+    std::string path = ::testing::TempDir() + "model_roundtrip.bin";
+    nn::save_model(path, net);
+
+    nn::Network loaded = nn::load_model(path);
+    EXPECT_TRUE(loaded.is_view());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(loaded.params()) % nn::kModelAlignment, 0u);
+    EXPECT_THROW(loaded.mutable_params(), std::logic_error) << "views must be read-only";
+    ASSERT_EQ(loaded.num_params(), net.num_params());
+
+    OthelloBoard board;
+    auto input = board.to_tensor(Player::BLACK);
+    std::vector<float> p1(nn::kPolicySize), p2(nn::kPolicySize);
+    EXPECT_EQ(net.forward(input.data(), p1.data()), loaded.forward(input.data(), p2.data()));
+    EXPECT_EQ(p1, p2);
+    std::remove(path.c_str());
+}
+
+TEST(NetworkTest, ModelFileRejectsCorruptionAndOtherArchitectures) {
+    nn::Network net;
+    net.init_random(6);
+    std::string path = ::testing::TempDir() + "model_corrupt.bin";
+    nn::save_model(path, net);
+
+    std::ifstream in(path, std::ios::binary);
+    std::vector<char> image(std::istreambuf_iterator<char>(in), {});
+    in.close();
+
+    // A flipped parameter bit fails the checksum
+    std::vector<char> corrupt = image;
+    corrupt.back() ^= 0x1;
+    alignas(64) static char buffer[1 << 20];
+    ASSERT_LE(corrupt.size(), sizeof(buffer));
+    std::memcpy(buffer, corrupt.data(), corrupt.size());
+    EXPECT_THROW(nn::load_model(buffer, corrupt.size()), std::runtime_error);
+
+    // Truncation is caught before reading past the end
+    std::memcpy(buffer, image.data(), image.size());
+    EXPECT_THROW(nn::load_model(buffer, image.size() - 4), std::runtime_error);
+    EXPECT_NO_THROW(nn::load_model(buffer, image.size()));
+
+    // A header whose architecture disagrees with the tensor table is rejected rather than misread
+    uint32_t channels = 48;
+    std::memcpy(buffer + offsetof(nn::ModelHeader, channels), &channels, sizeof(channels));
+    EXPECT_THROW(nn::load_model(buffer, image.size()), std::runtime_error);
+
+    // Absurd dimensions are rejected from the header alone, before any layout is built
+    for (size_t field : {offsetof(nn::ModelHeader, channels), offsetof(nn::ModelHeader, trunk_layers),
+                         offsetof(nn::ModelHeader, value_hidden)}) {
+        std::memcpy(buffer, image.data(), image.size());
+        uint32_t huge = 0xFFFFFFF0u;
+        std::memcpy(buffer + field, &huge, sizeof(huge));
+        EXPECT_THROW(nn::load_model(buffer, image.size()), std::runtime_error);
+    }
+    std::remove(path.c_str());
+}
+
+TEST(NetworkTest, RegistryReloadsReplacedModel) {
+    std::string path = ::testing::TempDir() + "model_registry.bin";
+    nn::Network first;
+    first.init_random(7);
+    nn::save_model(path, first);
+
+    nn::ModelRegistry registry(path);
+    auto pinned = registry.current();
+    EXPECT_FALSE(registry.poll());
+
+    nn::Network second;
+    second.init_random(8);
+    nn::save_model(path, second);
+    EXPECT_TRUE(registry.poll());
+    EXPECT_EQ(registry.generation(), 1u);
+    EXPECT_NE(registry.current(), pinned);
+    EXPECT_EQ(registry.current()->params()[0], second.params()[0]);
+    EXPECT_EQ(pinned->params()[0], first.params()[0]) << "old model must stay mapped while in use";
+
+    // A broken replacement keeps the current model
+    { std::ofstream(path + ".new", std::ios::binary) << "garbage"; }
+    std::rename((path + ".new").c_str(), path.c_str());
+    EXPECT_FALSE(registry.poll(true));
+    EXPECT_EQ(registry.current()->params()[0], second.params()[0]);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include "othello/bitboard.hpp"
+#include "othello/pattern_evaluator.hpp"
+#include "othello/pattern_trainer.hpp"
+
+namespace {
+    // Random playout, calling visit(board, player) before each move
+    template <typename Visit>
+    void random_game(std::mt19937& rng, Visit visit) {
+        OthelloBoard board;
+        Player player = Player::BLACK;
+        while (!board.is_game_over()) {
+            visit(board, player);
+            auto moves = board.get_valid_moves(player);
+            board.apply_move(player, moves[rng() % moves.size()]);
+            player = othello::opponent(player);
+        }
+    }
+}
+
+TEST(PatternEvaluatorTest, BitboardMovesMatchBoard) {
+    std::mt19937 rng(1);
+    for (int game = 0; game < 20; ++game) {
+        random_game(rng, [](const OthelloBoard& board, Player player) {
+            uint64_t expected = 0;
+            for (const auto& m : board.get_valid_moves(player))
+                if (m != othello::PASS) expected |= 1ULL << othello::to_index(m.x, m.y);
+            ASSERT_EQ(board.legal_move_mask(player), expected);
+
+            for (const auto& m : board.get_valid_moves(player)) {
+                if (m == othello::PASS) continue;
+                int sq = othello::to_index(m.x, m.y);
+                OthelloBoard next = board.apply_move_copy(player, m);
+                uint64_t flipped = othello::bitboard::flips(board.bits(player), board.bits(othello::opponent(player)), sq);
+                EXPECT_EQ(next.bits(player), board.bits(player) | flipped | (1ULL << sq));
+            }
+        });
+    }
+}
+
+TEST(PatternEvaluatorTest, IncrementalIndicesMatchRecompute) {
+    std::mt19937 rng(2);
+    OthelloBoard board;
+    Player player = Player::BLACK;
+    othello::PatternState state = othello::PatternState::from_board(board);
+
+    while (!board.is_game_over()) {
+        uint64_t moves = board.legal_move_mask(player);
+        if (moves) {
+            std::vector<int> squares;
+            for (uint64_t m = moves; m; m &= m - 1) squares.push_back(__builtin_ctzll(m));
+            int sq = squares[rng() % squares.size()];
+            uint64_t flipped = othello::bitboard::flips(board.bits(player), board.bits(othello::opponent(player)), sq);
+            state.apply(player, sq, flipped);
+            board.apply_move(player, Move(sq % 8, sq / 8));
+        }
+        player = othello::opponent(player);
+
+        othello::PatternState fresh = othello::PatternState::from_board(board);
+        for (int p = 0; p < 2; ++p)
+            for (int i = 0; i < othello::patterns::kNumInstances; ++i)
+                ASSERT_EQ(state.index[p][i], fresh.index[p][i]);
+    }
+}
+
+TEST(PatternEvaluatorTest, TrainerFitsDiskDifferential) {
+    othello::PatternEvaluator evaluator;
+    othello::PatternTrainer trainer(evaluator);
+
+    std::mt19937 rng(3);
+    for (int game = 0; game < 100; ++game) {
+        random_game(rng, [&](const OthelloBoard& board, Player player) {
+            uint64_t own = board.bits(player), opp = board.bits(othello::opponent(player));
+            float target = (__builtin_popcountll(own) - __builtin_popcountll(opp)) / 64.0f;
+            trainer.add_sample(own, opp, target);
+        });
+    }
+
+    float before = trainer.rmse();
+    float after = trainer.fit(50);
+    EXPECT_LT(after, 0.25f * before);
+    EXPECT_LT(after, 0.015f);
+}
+
+TEST(PatternEvaluatorTest, PolicyCoversLegalMovesAndRoundTrips) {
+    othello::PatternEvaluator evaluator;
+    std::mt19937 rng(4);
+    for (float& w : evaluator.weights()) w = std::uniform_real_distribution<float>(-0.05f, 0.05f)(rng);
+
+    OthelloBoard board;
+    auto [policy, value] = evaluator.evaluate(board, Player::BLACK);
+    EXPECT_NEAR(std::accumulate(policy.begin(), policy.end(), 0.0f), 1.0f, 1e-5f);
+    for (int i = 0; i < 64; ++i) {
+        if (!((board.legal_move_mask(Player::BLACK) >> i) & 1)) {
+            EXPECT_EQ(policy[i], 0.0f);
+        }
+    }
+
+    std::string path = ::testing::TempDir() + "patterns.bin";
+    evaluator.save(path);
+    othello::PatternEvaluator loaded;
+    loaded.load(path);
+    EXPECT_FLOAT_EQ(loaded.value(board, Player::BLACK), evaluator.value(board, Player::BLACK));
+    std::remove(path.c_str());
+}
+
+TEST(PatternEvaluatorTest, SearchPathMatchesFreshEvaluation) {
+    othello::PatternEvaluator evaluator;
+    std::mt19937 rng(5);
+    for (float& w : evaluator.weights()) w = std::uniform_real_distribution<float>(-0.05f, 0.05f)(rng);
+    othello::PatternEvaluator fresh = evaluator;   // shares the weights, never sees a path
+
+    // Descend from a fixed root along random lines, passes included, as MCTS::select_leaf does
+    OthelloBoard root;
+    for (int line = 0; line < 20; ++line) {
+        evaluator.begin_path(root, Player::BLACK);
+        OthelloBoard board = root;
+        Player player = Player::BLACK;
+        while (!board.is_game_over()) {
+            uint64_t moves = board.legal_move_mask(player);
+            int index = 64;
+            if (moves) {
+                for (int skip = rng() % __builtin_popcountll(moves); skip > 0; --skip) moves &= moves - 1;
+                index = __builtin_ctzll(moves);
+                board.apply_move(player, Move(index % 8, index / 8));
+            }
+            evaluator.descend(player, index, board);
+            player = othello::opponent(player);
+
+            float path_policy[othello::kPolicySize], fresh_policy[othello::kPolicySize];
+            float path_value = evaluator.evaluate_into(board, player, path_policy);
+            ASSERT_EQ(path_value, fresh.evaluate_into(board, player, fresh_policy));
+            for (int i = 0; i < othello::kPolicySize; ++i) ASSERT_EQ(path_policy[i], fresh_policy[i]);
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+#include "othello/protocol.hpp"
+
+namespace protocol = othello::protocol;
+
+namespace {
+    // Feeds `bytes` to the reader in chunks of `chunk` and collects every frame's type and size
+    std::vector<std::pair<protocol::MessageType, size_t>> parse(const std::vector<uint8_t>& bytes, size_t chunk) {
+        protocol::FrameReader reader;
+        std::vector<std::pair<protocol::MessageType, size_t>> frames;
+        for (size_t at = 0; at < bytes.size();) {
+            uint8_t* dst = reader.write_ptr();
+            size_t n = std::min({chunk, bytes.size() - at, reader.write_space()});
+            std::copy_n(bytes.begin() + at, n, dst);
+            reader.commit(n);
+            at += n;
+            protocol::Frame frame;
+            while (reader.peek(frame) == protocol::FrameReader::Ready) {
+                frames.push_back({frame.type, frame.size});
+                reader.pop();
+            }
+        }
+        EXPECT_EQ(reader.buffered(), 0u);
+        return frames;
+    }
+}
+
+TEST(ProtocolTest, FieldsRoundTripLittleEndian) {
+    protocol::FrameWriter w(protocol::MessageType::Move);
+    w.i8(-1).u16(0xbeef).i32(-123456).u64(0x0102030405060708ULL).f32(-0.25f);
+    ASSERT_FALSE(w.overflow());
+    const uint8_t* data = w.data();
+    EXPECT_EQ(data[0], 19);   // payload length
+    EXPECT_EQ(data[1], 0);
+    EXPECT_EQ(data[2], static_cast<uint8_t>(protocol::MessageType::Move));
+    EXPECT_EQ(data[4], 0xef);
+
+    protocol::Frame frame{protocol::MessageType::Move, data + protocol::kHeaderBytes, w.size() - protocol::kHeaderBytes};
+    protocol::PayloadReader in(frame);
+    EXPECT_EQ(in.i8(), -1);
+    EXPECT_EQ(in.u16(), 0xbeef);
+    EXPECT_EQ(in.i32(), -123456);
+    EXPECT_EQ(in.u64(), 0x0102030405060708ULL);
+    EXPECT_EQ(in.f32(), -0.25f);
+    EXPECT_TRUE(in.ok());
+    EXPECT_EQ(in.u8(), 0);   // past the end
+    EXPECT_FALSE(in.ok());
+}
+
+TEST(ProtocolTest, ReaderReassemblesAnySegmentation) {
+    std::vector<uint8_t> stream;
+    std::vector<std::pair<protocol::MessageType, size_t>> expected;
+    for (int i = 0; i < 40; ++i) {
+        protocol::FrameWriter w(i % 3 ? protocol::MessageType::Ping : protocol::MessageType::Analyze);
+        for (int k = 0; k < (i * 97) % 600; ++k) w.u8(static_cast<uint8_t>(k));
+        stream.insert(stream.end(), w.data(), w.data() + w.size());
+        expected.push_back({i % 3 ? protocol::MessageType::Ping : protocol::MessageType::Analyze, w.size() - 3});
+    }
+    for (size_t chunk : {size_t(1), size_t(2), size_t(7), size_t(1000), stream.size()})
+        EXPECT_EQ(parse(stream, chunk), expected) << "chunk " << chunk;
+}
+
+TEST(ProtocolTest, RejectsOversizedFramesAndWrites) {
+    protocol::FrameReader reader;
+    const uint8_t header[3] = {0x01, 0x20, 1};   // 8193-byte payload
+    std::copy_n(header, 3, reader.write_ptr());
+    reader.commit(3);
+    protocol::Frame frame;
+    EXPECT_EQ(reader.peek(frame), protocol::FrameReader::Invalid);
+
+    protocol::FrameWriter w(protocol::MessageType::Analysis);
+    for (size_t i = 0; i < protocol::kMaxPayload / 8; ++i) w.u64(i);
+    EXPECT_FALSE(w.overflow());
+    w.u8(1);
+    EXPECT_TRUE(w.overflow());
+    EXPECT_EQ(w.size(), protocol::kMaxFrame);
+}
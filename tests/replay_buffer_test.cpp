@@ -1,13 +1,21 @@
 #include <gtest/gtest.h>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <set>
+#include "othello/bitboard.hpp"
+#include "othello/board.hpp"
+#include "othello/symmetry.hpp"
 #include "replay/buffer.hpp"
+#include "replay/prioritized.hpp"
 
 TEST(ReplayBufferTest, InsertAndSample) {
     ReplayBuffer buffer(5);
 
     for (int i = 0; i < 10; ++i) {
         TrainSample s;
-        s.state = std::vector<float>(192, float(i)); // fill with i
-        s.policy = std::vector<float>(64, 1.0f / 64);
+        s.state = OthelloBoard().to_tensor(Player::BLACK);
+        s.policy = std::vector<float>(65, 1.0f / 65);
         s.value = (i % 3) - 1;
         buffer.insert(s);
     }
@@ -17,9 +25,188 @@ TEST(ReplayBufferTest, InsertAndSample) {
     auto batch = buffer.sample(3);
     EXPECT_EQ(batch.size(), 3);
     for (const auto& s : batch) {
-        EXPECT_EQ(s.state.size(), 192);
-        EXPECT_EQ(s.policy.size(), 64);
+        EXPECT_EQ(s.state, OthelloBoard().to_tensor(Player::BLACK));
+        EXPECT_EQ(s.policy.size(), 65);
+        EXPECT_NEAR(s.policy[0], 1.0f / 65, 1e-4f);
         EXPECT_GE(s.value, -1.0f);
         EXPECT_LE(s.value, 1.0f);
     }
 }
+
+TEST(ReplayBufferTest, ConcurrentWritersAndReadersSeeWholeSamples) {
+    // Every field of sample k is derived from k, so a torn read shows up as a mismatch
+    ReplayBuffer buffer(1024);
+    constexpr int kWriters = 4, kPerWriter = 20000;
+    std::atomic<bool> writing{true};
+    std::atomic<int> torn{0};
+
+    auto check = [&](const float* state, const float* policy, float value) {
+        uint64_t own = 0;
+        for (int i = 0; i < 64; ++i)
+            if (state[i] > 0.5f) own |= 1ULL << i;
+        int k = static_cast<int>(own);
+        if (value != float(k) || policy[k % 65] < 0.99f || state[64 + 63] != 1.0f) torn.fetch_add(1);
+    };
+
+    std::vector<std::thread> threads;
+    for (int w = 0; w < kWriters; ++w) {
+        threads.emplace_back([&, w] {
+            std::vector<float> policy(65);
+            for (int i = 0; i < kPerWriter; ++i) {
+                int k = w * kPerWriter + i + 1;
+                std::fill(policy.begin(), policy.end(), 0.0f);
+                policy[k % 65] = 1.0f;
+                buffer.insert(uint64_t(k), 1ULL << 63, policy.data(), float(k));
+            }
+        });
+    }
+    std::thread reader([&] {
+        std::mt19937 rng(1);
+        std::vector<float> states(32 * 192), policies(32 * 65), values(32);
+        while (writing.load() || buffer.size() == 0) {
+            if (buffer.size() == 0) continue;
+            buffer.sample_into(32, states.data(), policies.data(), values.data(), rng);
+            for (int b = 0; b < 32; ++b) check(&states[b * 192], &policies[b * 65], values[b]);
+        }
+    });
+    for (auto& t : threads) t.join();
+    writing.store(false);
+    reader.join();
+
+    EXPECT_EQ(torn.load(), 0);
+    EXPECT_EQ(buffer.size(), 1024u);
+    EXPECT_EQ(buffer.total_inserted(), uint64_t(kWriters * kPerWriter));
+    EXPECT_EQ(buffer.memory_bytes(), 1024u * 156);
+}
+
+TEST(ReplayBufferTest, SumTreeSamplesProportionally) {
+    replay::SumTree tree(5);   // not a power of two
+    const double priorities[5] = {1, 0, 3, 0.5, 5.5};
+    for (int i = 0; i < 5; ++i) tree.set(i, priorities[i]);
+    EXPECT_DOUBLE_EQ(tree.total(), 10.0);
+
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> u(0.0, tree.total());
+    std::vector<int> counts(5);
+    for (int i = 0; i < 100000; ++i) ++counts[tree.find(u(rng))];
+    EXPECT_EQ(counts[1], 0);
+    for (int i = 0; i < 5; ++i) EXPECT_NEAR(counts[i] / 100000.0, priorities[i] / 10.0, 0.01);
+}
+
+TEST(ReplayBufferTest, PrioritizedReplayFollowsPrioritiesAcrossEviction) {
+    replay::PriorityConfig config;
+    config.alpha = 1.0;
+    config.beta = 1.0;
+    replay::PrioritizedReplay replay(8, config);
+
+    std::vector<float> policy(65, 0.0f);
+    policy[64] = 1.0f;
+    std::vector<uint64_t> ids;
+    for (int i = 0; i < 8; ++i) ids.push_back(replay.insert(uint64_t(i + 1), 0, policy.data(), float(i)));
+
+    // Everything starts at the same priority; make sample 3 dominate
+    std::vector<float> errors(8, 0.1f);
+    errors[3] = 10.0f;
+    replay.update_priorities(ids.data(), errors.data(), ids.size());
+
+    std::mt19937 rng(5);
+    constexpr size_t kBatch = 64;
+    std::vector<float> states(kBatch * 192), policies(kBatch * 65), values(kBatch), weights(kBatch);
+    std::vector<uint64_t> sampled(kBatch);
+    replay.sample_into(kBatch, states.data(), policies.data(), values.data(), weights.data(), sampled.data(), rng);
+    int hits = 0;
+    for (size_t b = 0; b < kBatch; ++b) {
+        EXPECT_EQ(values[b], float(sampled[b])) << "data and id must describe the same sample";
+        if (sampled[b] == ids[3]) {
+            ++hits;
+            EXPECT_LT(weights[b], 0.05f) << "frequent samples are down-weighted";
+        }
+        EXPECT_LE(weights[b], 1.0f);
+    }
+    EXPECT_GT(hits, int(kBatch) * 3 / 4);
+    EXPECT_LT(hits, int(kBatch)) << "stratified sampling still visits the low-priority mass";
+
+    // Evict sample 3 by wrapping the ring: a late update for it must not touch its successor
+    for (int i = 8; i < 12; ++i) replay.insert(uint64_t(i + 1), 0, policy.data(), float(i));
+    double before = replay.total_priority();
+    float late_error = 100.0f;
+    replay.update_priorities(&ids[3], &late_error, 1);
+    EXPECT_DOUBLE_EQ(replay.total_priority(), before);
+
+    // The successor entered at the max priority, not at the evicted sample's
+    replay.sample_into(kBatch, states.data(), policies.data(), values.data(), weights.data(), sampled.data(), rng);
+    for (size_t b = 0; b < kBatch; ++b) EXPECT_NE(sampled[b], ids[3]);
+}
+
+TEST(ReplayBufferTest, PrioritizedSamplesMatchTheirIdsUnderConcurrentInserts) {
+    // A tiny ring overwritten constantly: every sampled value must still be its id's
+    replay::PrioritizedReplay replay(16, replay::PriorityConfig{});
+    std::vector<float> policy(65, 0.0f);
+    policy[64] = 1.0f;
+    for (int i = 0; i < 16; ++i) replay.insert(1, 0, policy.data(), float(i));
+
+    std::atomic<bool> writing{true};
+    std::thread writer([&] {
+        for (int i = 16; i < 200000; ++i) replay.insert(1, 0, policy.data(), float(i));
+        writing.store(false);
+    });
+    std::mt19937 rng(9);
+    constexpr size_t kBatch = 32;
+    std::vector<float> states(kBatch * 192), policies(kBatch * 65), values(kBatch), weights(kBatch);
+    std::vector<uint64_t> ids(kBatch);
+    int mismatched = 0;
+    while (writing.load()) {
+        replay.sample_into(kBatch, states.data(), policies.data(), values.data(), weights.data(), ids.data(), rng);
+        for (size_t b = 0; b < kBatch; ++b) mismatched += values[b] != float(ids[b]);
+    }
+    writer.join();
+    EXPECT_EQ(mismatched, 0);
+
+    ReplayBuffer buffer(2);
+    float state[192], out[65], value;
+    for (int i = 0; i < 3; ++i) buffer.insert(1, 0, policy.data(), float(i));
+    EXPECT_FALSE(buffer.read_id_into(0, state, out, &value)) << "overwritten by id 2";
+    EXPECT_TRUE(buffer.read_id_into(1, state, out, &value));
+    EXPECT_EQ(value, 1.0f);
+    EXPECT_TRUE(buffer.read_id_into(2, state, out, &value));
+    EXPECT_EQ(value, 2.0f);
+    EXPECT_FALSE(buffer.read_id_into(3, state, out, &value)) << "not written yet";
+}
+
+TEST(ReplayBufferTest, AugmentationKeepsPolicyOnTheTransformedMoves) {
+    // An asymmetric position after two moves, with all policy mass on one legal move
+    OthelloBoard board;
+    board.apply_move(Player::BLACK, board.get_valid_moves(Player::BLACK)[0]);
+    board.apply_move(Player::WHITE, board.get_valid_moves(Player::WHITE)[0]);
+    const uint64_t own = board.bits(Player::BLACK), opp = board.bits(Player::WHITE);
+    const uint64_t moves = othello::bitboard::legal_moves(own, opp);
+    std::vector<float> policy(65, 0.0f);
+    policy[__builtin_ctzll(moves)] = 1.0f;
+
+    ReplayBuffer buffer(4);
+    buffer.set_augment(true);
+    buffer.insert(own, opp, policy.data(), 0.5f);
+
+    std::mt19937 rng(11);
+    std::vector<float> states(64 * 192), policies(64 * 65), values(64);
+    buffer.sample_into(64, states.data(), policies.data(), values.data(), rng);
+    std::set<uint64_t> seen;
+    for (int b = 0; b < 64; ++b) {
+        const float* state = &states[b * 192];
+        const float* p = &policies[b * 65];
+        uint64_t own_t = 0, opp_t = 0, moves_t = 0;
+        for (int i = 0; i < 64; ++i) {
+            if (state[i] > 0.5f) own_t |= 1ULL << i;
+            if (state[64 + i] > 0.5f) opp_t |= 1ULL << i;
+            if (state[128 + i] > 0.5f) moves_t |= 1ULL << i;
+        }
+        EXPECT_EQ(moves_t, othello::bitboard::legal_moves(own_t, opp_t));
+        int target = int(std::max_element(p, p + 65) - p);
+        EXPECT_NEAR(p[target], 1.0f, 1e-4f);
+        EXPECT_TRUE((moves_t >> target) & 1) << "policy mass must follow the board";
+        EXPECT_EQ(p[64], 0.0f);
+        EXPECT_EQ(values[b], 0.5f);
+        seen.insert(own_t);
+    }
+    EXPECT_EQ(seen.size(), size_t(othello::symmetry::kCount));
+}
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include "othello/greedy_evaluator.hpp"
+#include "othello/selfplay.hpp"
+#include "othello/symmetry.hpp"
+#include "replay/store.hpp"
+
+namespace {
+    std::string fresh_dir(const std::string& name) {
+        std::string dir = ::testing::TempDir() + name;
+        std::filesystem::remove_all(dir);
+        return dir;
+    }
+
+    std::vector<TrainSample> selfplay_samples(int games) {
+        othello::GreedyEvaluator evaluator;
+        othello::SelfPlayConfig config;
+        config.simulations = 16;
+        std::vector<TrainSample> all;
+        for (int g = 0; g < games; ++g) {
+            auto samples = othello::SelfPlay::play_game(evaluator, config, g);
+            all.insert(all.end(), samples.begin(), samples.end());
+        }
+        return all;
+    }
+}
+
+TEST(ReplayStoreTest, RecordRoundTripIsCompact) {
+    auto samples = selfplay_samples(2);
+    size_t total_bytes = 0;
+    for (const auto& s : samples) {
+        uint64_t own = 0, opp = 0;
+        for (int i = 0; i < 64; ++i) {
+            if (s.state[i] > 0.5f) own |= 1ULL << i;
+            if (s.state[64 + i] > 0.5f) opp |= 1ULL << i;
+        }
+        bool black = s.to_move == Player::BLACK;
+        uint8_t record[replay::kRecordHeaderBytes + 64];
+        size_t bytes = replay::encode_record(black ? own : opp, black ? opp : own, s.to_move, s.policy.data(), s.value, record);
+        total_bytes += bytes;
+
+        std::vector<float> state(192), policy(65);
+        float value;
+        replay::decode_record(record, state.data(), policy.data(), &value);
+        EXPECT_EQ(state, s.state);
+        EXPECT_NEAR(value, s.value, 1.0f / 127);
+        for (int i = 0; i < 65; ++i) EXPECT_NEAR(policy[i], s.policy[i], 0.01f);
+
+        // Decoding under a symmetry permutes the policy like the squares
+        int t = int(total_bytes % othello::symmetry::kCount);
+        std::vector<float> augmented_state(192), augmented(65), expected(65);
+        replay::decode_record(record, augmented_state.data(), augmented.data(), &value, t);
+        othello::symmetry::transform_policy(policy.data(), expected.data(), t);
+        for (int i = 0; i < 65; ++i) EXPECT_FLOAT_EQ(augmented[i], expected[i]);
+        for (int sq = 0; sq < 64; ++sq) EXPECT_EQ(augmented_state[othello::symmetry::square(sq, t)], state[sq]);
+    }
+    EXPECT_LT(double(total_bytes) / samples.size(), 40.0);
+}
+
+TEST(ReplayStoreTest, SegmentsAreReadBackAcrossRotation) {
+    std::string dir = fresh_dir("replay_segments");
+    auto samples = selfplay_samples(3);
+    {
+        replay::ReplayStoreWriter writer(dir, 50);
+        for (const auto& s : samples) writer.append(s);
+    }
+    // An unsealed segment from a crashed writer is ignored
+    std::ofstream(dir + "/segment-0-000000.tmp") << "partial";
+
+    replay::ReplayStore store(dir);
+    ASSERT_EQ(store.size(), samples.size());
+
+    // Segments are listed in name order, which is append order for a single writer
+    std::vector<float> state(192), policy(65);
+    float value;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        store.read(i, state.data(), policy.data(), &value);
+        ASSERT_EQ(state, samples[i].state) << "record " << i;
+    }
+    EXPECT_EQ(store.refresh(), 0u);
+}
+
+TEST(ReplayStoreTest, RejectsRecordsOverrunningTheirPolicyBytes) {
+    // Hand-built segments holding the opening position, which has 4 legal moves and so needs
+    // 4 policy bytes; the second file's record claims fewer than its position implies
+    std::string dir = fresh_dir("replay_overrun");
+    std::filesystem::create_directories(dir);
+    auto write_segment = [&](const std::string& name, size_t policy_bytes) {
+        std::vector<uint8_t> image(sizeof(replay::SegmentHeader));
+        replay::SegmentHeader header{replay::kSegmentMagic, replay::kSegmentVersion};
+        std::memcpy(image.data(), &header, sizeof(header));
+        uint8_t record[replay::kRecordHeaderBytes + 64];
+        std::vector<float> policy(65, 0.25f);
+        replay::encode_record(0x0000000810000000ULL, 0x0000001008000000ULL, Player::BLACK, policy.data(), 0.0f,
+                              record);
+        const uint32_t offset = static_cast<uint32_t>(image.size());
+        image.insert(image.end(), record, record + replay::kRecordHeaderBytes + policy_bytes);
+        image.resize(image.size() + sizeof(offset));
+        std::memcpy(image.data() + image.size() - sizeof(offset), &offset, sizeof(offset));
+        replay::SegmentFooter footer{1, replay::kSegmentMagic, replay::kSegmentVersion};
+        image.resize(image.size() + sizeof(footer));
+        std::memcpy(image.data() + image.size() - sizeof(footer), &footer, sizeof(footer));
+        std::ofstream out(dir + "/" + name, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(image.data()), image.size());
+    };
+    write_segment("a.rps", 4);
+    write_segment("b.rps", 2);
+
+    replay::ReplayStore store(dir);
+    EXPECT_EQ(store.size(), 1u) << "the short record's segment is skipped at open";
+}
+
+TEST(ReplayStoreTest, LoaderAndBufferAdapterServeMinibatches) {
+    std::string dir = fresh_dir("replay_adapter");
+    replay::ReplayStoreBuffer buffer(dir, 64);
+    othello::SelfPlayConfig config;
+    config.threads = 2;
+    config.simulations = 8;
+    othello::SelfPlay selfplay([] { return std::make_unique<othello::GreedyEvaluator>(); }, buffer, config);
+    othello::SelfPlayStats stats = selfplay.run(4);
+    buffer.flush();
+    ASSERT_EQ(buffer.size(), stats.positions);
+
+    std::mt19937 rng(1);
+    std::vector<float> states(16 * 192), policies(16 * 65), values(16);
+    buffer.sample_into(16, states.data(), policies.data(), values.data(), rng);
+
+    replay::ReplayLoader loader(buffer.store(), 32, 2, 2);
+    replay::ReplayBatch batch;
+    for (int i = 0; i < 5; ++i) {
+        loader.next(batch);
+        ASSERT_EQ(batch.size, 32u);
+        for (size_t b = 0; b < batch.size; ++b) {
+            float sum = std::accumulate(&batch.policies[b * 65], &batch.policies[b * 65] + 65, 0.0f);
+            EXPECT_NEAR(sum, 1.0f, 1e-4f);
+            EXPECT_TRUE(batch.values[b] == 1.0f || batch.values[b] == -1.0f || batch.values[b] == 0.0f);
+        }
+    }
+}
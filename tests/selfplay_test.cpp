@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <numeric>
+#include "othello/greedy_evaluator.hpp"
+#include "othello/selfplay.hpp"
+
+TEST(SelfPlayTest, GameSamplesCarryVisitPolicyAndResult) {
+    othello::GreedyEvaluator evaluator;
+    othello::SelfPlayConfig config;
+    config.simulations = 32;
+
+    Player winner;
+    auto samples = othello::SelfPlay::play_game(evaluator, config, 7, &winner);
+    ASSERT_GE(samples.size(), 20u);
+
+    for (const auto& s : samples) {
+        ASSERT_EQ(s.state.size(), 192u);
+        ASSERT_EQ(s.policy.size(), 65u);
+        EXPECT_NEAR(std::accumulate(s.policy.begin(), s.policy.end(), 0.0f), 1.0f, 1e-4f);
+        // Visits only go to legal moves (plane 2)
+        for (int i = 0; i < 64; ++i) {
+            if (s.state[128 + i] == 0.0f) {
+                EXPECT_EQ(s.policy[i], 0.0f);
+            }
+        }
+    }
+
+    // Black moves first; the first sample's value is the result from black's side
+    float expected = winner == Player::BLACK ? 1.0f : (winner == Player::WHITE ? -1.0f : 0.0f);
+    EXPECT_EQ(samples.front().value, expected);
+}
+
+TEST(SelfPlayTest, WorkersFillTheReplayBuffer) {
+    ReplayBuffer buffer(100000);
+    othello::SelfPlayConfig config;
+    config.threads = 3;
+    config.simulations = 16;
+    othello::SelfPlay selfplay([] { return std::make_unique<othello::GreedyEvaluator>(); }, buffer, config);
+
+    othello::SelfPlayStats stats = selfplay.run(6);
+    EXPECT_EQ(stats.games, 6u);
+    EXPECT_EQ(stats.black_wins + stats.white_wins + stats.draws, 6u);
+    EXPECT_EQ(buffer.size(), stats.positions);
+    EXPECT_GT(stats.positions_per_second(), 0.0);
+
+    // Same seed, same game
+    othello::GreedyEvaluator evaluator;
+    auto a = othello::SelfPlay::play_game(evaluator, config, 3);
+    auto b = othello::SelfPlay::play_game(evaluator, config, 3);
+    ASSERT_EQ(a.size(), b.size());
+    for (size_t i = 0; i < a.size(); ++i) EXPECT_EQ(a[i].state, b[i].state);
+}
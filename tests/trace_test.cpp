@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "othello/greedy_evaluator.hpp"
+#include "othello/mcts.hpp"
+#include "othello/selfplay.hpp"
+#include "othello/trace.hpp"
+
+namespace trace = othello::trace;
+
+namespace {
+    void search(int simulations) {
+        othello::GreedyEvaluator evaluator;
+        othello::MCTS mcts(evaluator, simulations);
+        mcts.set_log_stats(false);
+        mcts.set_root(OthelloBoard(), Player::BLACK);
+        mcts.run();
+    }
+}
+
+TEST(TraceTest, RecordsNothingOutsideACapture) {
+    trace::start();
+    trace::stop();
+    search(16);
+    EXPECT_TRUE(trace::collect().empty());
+    EXPECT_FALSE(trace::enabled());
+}
+
+TEST(TraceTest, SearchSpansNestPerThread) {
+    trace::start();
+    search(50);
+    std::thread other([] {
+        trace::set_thread_name("second searcher");
+        search(20);
+    });
+    other.join();
+    trace::stop();
+
+    uint64_t dropped = 0;
+    std::vector<trace::Event> events = trace::collect(&dropped);
+    EXPECT_EQ(dropped, 0u);
+
+    // Two tracks, each one search of its simulations with a select and a backpropagate per simulation
+    std::map<uint32_t, std::map<std::string, int>> counts;
+    const trace::Event* outer = nullptr;
+    for (const trace::Event& e : events) {
+        ++counts[e.tid][e.name];
+        if (std::string(e.name) == "search" && !outer) outer = &e;
+    }
+    ASSERT_EQ(counts.size(), 2u);
+    std::multiset<int> simulations;
+    for (auto& [tid, names] : counts) {
+        EXPECT_EQ(names["search"], 1);
+        EXPECT_EQ(names["select"], names["simulation"]);
+        EXPECT_EQ(names["backpropagate"], names["simulation"]);
+        EXPECT_EQ(names["evaluate"], names["expand"]);
+        EXPECT_GT(names["expand"], 0);
+        simulations.insert(names["simulation"]);
+    }
+    EXPECT_EQ(simulations, (std::multiset<int>{20, 50}));
+
+    // Every span of the first track lies inside its search span, which carries the count
+    ASSERT_NE(outer, nullptr);
+    EXPECT_STREQ(outer->arg_name, "simulations");
+    for (const trace::Event& e : events) {
+        if (e.tid != outer->tid) continue;
+        EXPECT_GE(e.start_ns, outer->start_ns);
+        EXPECT_LE(e.start_ns + e.duration_ns, outer->start_ns + outer->duration_ns);
+    }
+
+    const std::string json = trace::chrome_json();
+    EXPECT_EQ(json.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0), 0u);
+    EXPECT_NE(json.find("\"args\":{\"name\":\"second searcher\"}"), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"select\",\"cat\":\"search\",\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(json.find("\"args\":{\"simulations\":50}"), std::string::npos);
+
+    // A new capture starts empty
+    trace::start();
+    trace::stop();
+    EXPECT_TRUE(trace::collect().empty());
+}
+
+TEST(TraceTest, SelfPlayTracesTheChosenGame) {
+    ReplayBuffer buffer(10000);
+    othello::SelfPlayConfig config;
+    config.threads = 1;
+    config.simulations = 8;
+    config.trace_game = 1;
+    config.trace_path = ::testing::TempDir() + "trace_test.json";
+    othello::SelfPlay selfplay([] { return std::make_unique<othello::GreedyEvaluator>(); }, buffer, config);
+    selfplay.run(3);
+    EXPECT_FALSE(trace::enabled());
+
+    // One game's searches, on the worker's track
+    std::ifstream file(config.trace_path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    const std::string json = contents.str();
+    EXPECT_NE(json.find("\"args\":{\"name\":\"selfplay 0\"}"), std::string::npos);
+    size_t searches = 0;
+    for (size_t at = json.find("\"name\":\"search\""); at != std::string::npos; at = json.find("\"name\":\"search\"", at + 1))
+        ++searches;
+    EXPECT_GE(searches, 20u);
+    EXPECT_LE(searches, 64u);
+    std::remove(config.trace_path.c_str());
+}
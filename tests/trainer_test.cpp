@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include "othello/board.hpp"
+#include "nn/model_file.hpp"
+#include "nn/network.hpp"
+#include "nn/trainer.hpp"
+
+namespace {
+    struct Batch {
+        std::vector<float> states, policies, values;
+        size_t size = 0;
+    };
+
+    // Random playout positions with a random policy over the legal moves and a random outcome
+    Batch random_batch(size_t n, uint32_t seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> u(0.0f, 1.0f);
+        Batch batch;
+        batch.size = n;
+        OthelloBoard board;
+        Player player = Player::BLACK;
+        while (batch.values.size() < n) {
+            if (board.is_game_over()) { board = OthelloBoard(); player = Player::BLACK; }
+            auto moves = board.get_valid_moves(player);
+            auto state = board.to_tensor(player);
+            batch.states.insert(batch.states.end(), state.begin(), state.end());
+
+            std::vector<float> policy(nn::kPolicySize, 0.0f);
+            float sum = 0.0f;
+            for (const auto& m : moves) {
+                int idx = (m == othello::PASS) ? 64 : othello::to_index(m.x, m.y);
+                policy[idx] = u(rng);
+                sum += policy[idx];
+            }
+            for (float& p : policy) p /= sum;
+            batch.policies.insert(batch.policies.end(), policy.begin(), policy.end());
+            batch.values.push_back(2.0f * u(rng) - 1.0f);
+
+            board.apply_move(player, moves[rng() % moves.size()]);
+            player = othello::opponent(player);
+        }
+        return batch;
+    }
+
+    nn::NetworkConfig small_config() {
+        nn::NetworkConfig config;
+        config.channels = 6;
+        config.trunk_layers = 2;
+        config.value_hidden = 8;
+        return config;
+    }
+}
+
+TEST(TrainerTest, LossMatchesForwardPass) {
+    nn::Network net(small_config());
+    net.init_random(3);
+    Batch batch = random_batch(5, 1);
+
+    double policy_loss = 0.0, value_loss = 0.0;
+    std::vector<float> policy(nn::kPolicySize);
+    for (size_t b = 0; b < batch.size; ++b) {
+        float v = net.forward(&batch.states[b * nn::kInputSize], policy.data());
+        for (int i = 0; i < nn::kPolicySize; ++i)
+            if (batch.policies[b * nn::kPolicySize + i] > 0.0f)
+                policy_loss -= batch.policies[b * nn::kPolicySize + i] * std::log(policy[i]);
+        value_loss += (v - batch.values[b]) * (v - batch.values[b]);
+    }
+
+    nn::Trainer trainer(net);
+    nn::TrainLoss loss = trainer.loss(batch.states.data(), batch.policies.data(), batch.values.data(), batch.size);
+    EXPECT_NEAR(loss.policy, policy_loss / batch.size, 1e-4);
+    EXPECT_NEAR(loss.value, value_loss / batch.size, 1e-4);
+}
+
+TEST(TrainerTest, GradientMatchesFiniteDifferences) {
+    nn::Network net(small_config());
+    net.init_random(5);
+    Batch batch = random_batch(4, 2);
+    nn::Trainer trainer(net);
+
+    // Zero biases put units on an empty patch exactly on the ReLU kink, where the
+    // central difference averages both sides
+    float* params = net.mutable_params();
+    std::mt19937 rng(9);
+    std::normal_distribution<float> noise(0.0f, 0.1f);
+    for (const auto& l : net.linears())
+        for (int o = 0; o < l.out; ++o) params[l.bias_offset + o] = noise(rng);
+
+    std::vector<float> grad(net.num_params());
+    trainer.gradient(batch.states.data(), batch.policies.data(), batch.values.data(), batch.size, grad.data());
+
+    // A few parameters of every layer, weights and biases
+    int checked = 0, mismatched = 0;
+    for (const auto& l : net.linears()) {
+        for (int k = 0; k < 8; ++k) {
+            size_t i = (k < 6) ? l.weight_offset + rng() % (size_t(l.out) * l.in) : l.bias_offset + rng() % l.out;
+            const float h = 1e-3f, saved = params[i];
+            params[i] = saved + h;
+            float up = trainer.loss(batch.states.data(), batch.policies.data(), batch.values.data(), batch.size).total();
+            params[i] = saved - h;
+            float down = trainer.loss(batch.states.data(), batch.policies.data(), batch.values.data(), batch.size).total();
+            params[i] = saved;
+
+            float numeric = (up - down) / (2 * h);
+            ++checked;
+            if (std::fabs(numeric - grad[i]) > 2e-3f + 0.05f * std::fabs(grad[i])) {
+                ++mismatched;
+                ADD_FAILURE() << l.name << " param " << i << ": analytic " << grad[i] << ", numeric " << numeric;
+            }
+        }
+    }
+    EXPECT_EQ(mismatched, 0) << "of " << checked;
+}
+
+TEST(TrainerTest, DataParallelGradientMatchesSingleThread) {
+    nn::Network net(small_config());
+    net.init_random(11);
+    Batch batch = random_batch(13, 3);
+
+    nn::TrainerConfig config;
+    config.threads = 1;
+    nn::Trainer single(net, config);
+    config.threads = 3;
+    nn::Trainer parallel(net, config);
+
+    std::vector<float> g1(net.num_params()), g3(net.num_params());
+    nn::TrainLoss l1 = single.gradient(batch.states.data(), batch.policies.data(), batch.values.data(), batch.size, g1.data());
+    nn::TrainLoss l3 = parallel.gradient(batch.states.data(), batch.policies.data(), batch.values.data(), batch.size, g3.data());
+    EXPECT_NEAR(l1.total(), l3.total(), 1e-5);
+    for (size_t i = 0; i < g1.size(); ++i) ASSERT_NEAR(g1[i], g3[i], 1e-5f + 1e-4f * std::fabs(g1[i])) << i;
+}
+
+TEST(TrainerTest, AdamFitsABatchAndWritesAPlayableModel) {
+    nn::Network net(small_config());
+    net.init_random(13);
+    Batch batch = random_batch(32, 4);
+
+    nn::TrainerConfig config;
+    config.learning_rate = 5e-3f;
+    config.threads = 2;
+    nn::Trainer trainer(net, config);
+    nn::TrainLoss first = trainer.step(batch.states.data(), batch.policies.data(), batch.values.data(), batch.size);
+    for (int i = 0; i < 150; ++i) trainer.step(batch.states.data(), batch.policies.data(), batch.values.data(), batch.size);
+    nn::TrainLoss last = trainer.loss(batch.states.data(), batch.policies.data(), batch.values.data(), batch.size);
+    EXPECT_EQ(trainer.steps(), 151u);
+    EXPECT_LT(last.value, 0.5f * first.value);
+    EXPECT_LT(last.policy, first.policy);
+
+    std::string path = ::testing::TempDir() + "trained_model.bin";
+    nn::save_model(path, net);
+    nn::Network loaded = nn::load_model(path);
+    std::vector<float> a(nn::kPolicySize), b(nn::kPolicySize);
+    EXPECT_FLOAT_EQ(net.forward(batch.states.data(), a.data()), loaded.forward(batch.states.data(), b.data()));
+    EXPECT_EQ(a, b);
+}
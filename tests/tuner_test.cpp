@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include "othello/greedy_evaluator.hpp"
+#include "othello/runtime_config.hpp"
+#include "othello/tuner.hpp"
+
+namespace {
+    // Batched greedy evaluations, so the tuner's broker path runs without a model
+    class GreedyBatch : public othello::BatchEvaluator {
+    public:
+        void evaluate_batch(const float* inputs, int n, float* policies, float* values) override {
+            for (int i = 0; i < n; ++i) {
+                std::fill(policies + i * othello::kPolicySize, policies + (i + 1) * othello::kPolicySize,
+                          1.0f / othello::kPolicySize);
+                values[i] = 0.0f;
+            }
+            (void)inputs;
+        }
+        int max_batch_size() const override { return 8; }
+    };
+}
+
+TEST(RuntimeConfigTest, RoundTripsTheTunedSettings) {
+    othello::AgentServerConfig config;
+    config.workers = 6;
+    config.simulations = 1234;
+    config.c_puct = 2.25f;
+    config.batch_size = 4;
+    config.batch_wait_us = 250;
+    const std::string yaml = othello::runtime_config_yaml(config, "tuned\nby a test");
+    EXPECT_EQ(yaml.rfind("# tuned\n# by a test\n", 0), 0u);
+
+    othello::AgentServerConfig loaded;
+    loaded.port = 4321;
+    othello::parse_runtime_config(yaml, "test", loaded);
+    EXPECT_EQ(loaded.workers, 6);
+    EXPECT_EQ(loaded.simulations, 1234);
+    EXPECT_FLOAT_EQ(loaded.c_puct, 2.25f);
+    EXPECT_EQ(loaded.batch_size, 4);
+    EXPECT_EQ(loaded.batch_wait_us, 250);
+    EXPECT_EQ(loaded.port, 4321);   // not in the profile, so untouched
+}
+
+TEST(RuntimeConfigTest, ReadsServerSectionAndFile) {
+    const std::string path = ::testing::TempDir() + "runtime_config_test.yaml";
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    ASSERT_NE(f, nullptr);
+    std::fputs("# hand written\nsearch:\n  threads: 3\nserver:\n  port: 5000\n  unix_path: /tmp/o.sock\n", f);
+    std::fclose(f);
+
+    othello::AgentServerConfig config;
+    othello::load_runtime_config(path, config);
+    EXPECT_EQ(config.workers, 3);
+    EXPECT_EQ(config.port, 5000);
+    EXPECT_EQ(config.unix_path, "/tmp/o.sock");
+    EXPECT_EQ(config.simulations, othello::AgentServerConfig{}.simulations);
+    std::remove(path.c_str());
+
+    EXPECT_THROW(othello::load_runtime_config(path, config), std::runtime_error);
+}
+
+TEST(RuntimeConfigTest, RejectsUnknownKeysAndBadValues) {
+    othello::AgentServerConfig config;
+    EXPECT_THROW(othello::parse_runtime_config("search:\n  thread: 4\n", "t", config), std::runtime_error);
+    EXPECT_THROW(othello::parse_runtime_config("engine:\n  threads: 4\n", "t", config), std::runtime_error);
+    EXPECT_THROW(othello::parse_runtime_config("search:\n  threads: four\n", "t", config), std::runtime_error);
+    EXPECT_THROW(othello::parse_runtime_config("search:\n  simulations: 0\n", "t", config), std::runtime_error);
+    EXPECT_THROW(othello::parse_runtime_config("search:\n  c_puct: -1\n", "t", config), std::runtime_error);
+    EXPECT_THROW(othello::parse_runtime_config("search: 4\n", "t", config), std::runtime_error);
+
+    // A failed load changes nothing, even where earlier keys were fine
+    EXPECT_THROW(othello::parse_runtime_config("search:\n  threads: 7\n  bogus: 1\n", "t", config),
+                 std::runtime_error);
+    EXPECT_EQ(config.workers, othello::AgentServerConfig{}.workers);
+
+    // An empty file is an empty profile
+    othello::parse_runtime_config("", "t", config);
+    EXPECT_EQ(config.workers, othello::AgentServerConfig{}.workers);
+}
+
+TEST(TunerTest, PicksTheFastestPointWithinTheTarget) {
+    GreedyBatch backend;
+    othello::TuneConfig config;
+    config.threads = {1, 2};
+    config.simulations = 32;
+    config.latency_ms = 10000.0;
+    config.seconds_per_point = 0.05;
+    othello::Tuner tuner([] { return std::make_unique<othello::GreedyEvaluator>(); }, &backend, config);
+    othello::TuneResult result = tuner.run();
+
+    // 1 thread: batch 1; 2 threads: batches 1 and 2
+    ASSERT_EQ(result.points.size(), 3u);
+    EXPECT_EQ(result.points[2].threads, 2);
+    EXPECT_EQ(result.points[2].batch_size, 2);
+    EXPECT_TRUE(result.met_target);
+    for (const othello::TunePoint& p : result.points) {
+        EXPECT_GE(p.searches, static_cast<uint64_t>(p.threads));
+        EXPECT_GT(p.nodes_per_second, 0.0);
+        EXPECT_LE(p.nodes_per_second, result.best_point.nodes_per_second);
+    }
+    EXPECT_EQ(result.best.workers, result.best_point.threads);
+    EXPECT_EQ(result.best.batch_size, result.best_point.batch_size);
+    EXPECT_EQ(result.best.simulations, 32);
+}
+
+TEST(TunerTest, ScalesSimulationsDownWhenNothingMeetsTheTarget) {
+    othello::TuneConfig config;
+    config.threads = {1};
+    config.simulations = 400;
+    config.latency_ms = 1e-6;
+    config.seconds_per_point = 0.02;
+    othello::Tuner tuner([] { return std::make_unique<othello::GreedyEvaluator>(); }, nullptr, config);
+    othello::TuneResult result = tuner.run();
+
+    ASSERT_EQ(result.points.size(), 1u);
+    EXPECT_FALSE(result.met_target);
+    EXPECT_EQ(result.best.workers, 1);
+    EXPECT_EQ(result.best.batch_size, 1);
+    EXPECT_EQ(result.best.simulations, 1);
+}
@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include "replay/wthor.hpp"
+
+namespace {
+    struct TestGame {
+        std::array<uint8_t, replay::kWthorGameBytes> record{};
+        std::vector<std::pair<OthelloBoard, Player>> positions;   // before each move
+        int black_differential = 0;
+        bool passed = false;
+    };
+
+    // A random game to the end, written the WTHOR way: moves only, passes left out
+    TestGame random_game(uint32_t seed) {
+        TestGame game;
+        std::mt19937 rng(seed);
+        OthelloBoard board;
+        Player player = Player::BLACK;
+        int n = 0;
+        while (!board.is_game_over()) {
+            if (!board.has_valid_move(player)) {
+                game.passed = true;
+                player = othello::opponent(player);
+                continue;
+            }
+            auto moves = board.get_valid_moves(player);
+            Move move = moves[rng() % moves.size()];
+            game.positions.push_back({board, player});
+            game.record[8 + n++] = static_cast<uint8_t>(10 * (move.y + 1) + move.x + 1);
+            board.apply_move(player, move);
+            player = othello::opponent(player);
+        }
+        int black = board.count_disks(Player::BLACK), white = board.count_disks(Player::WHITE);
+        int empties = 64 - black - white;
+        if (black > white) black += empties;
+        else if (white > black) white += empties;
+        game.record[6] = static_cast<uint8_t>(black);
+        game.black_differential = black - white;
+        return game;
+    }
+
+    void write_wtb(const std::string& path, const std::vector<TestGame>& games, uint32_t claimed = 0,
+                   uint8_t board_size = 8) {
+        std::array<uint8_t, replay::kWthorHeaderBytes> header{};
+        header[0] = 20, header[1] = 24, header[2] = 1, header[3] = 1;
+        uint32_t count = claimed ? claimed : static_cast<uint32_t>(games.size());
+        for (int i = 0; i < 4; ++i) header[4 + i] = static_cast<uint8_t>(count >> (8 * i));
+        header[10] = 2024 & 0xff, header[11] = 2024 >> 8;
+        header[12] = board_size;
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(header.data()), header.size());
+        for (const TestGame& g : games) out.write(reinterpret_cast<const char*>(g.record.data()), g.record.size());
+    }
+
+    std::vector<TestGame> random_games(int n) {
+        std::vector<TestGame> games;
+        for (int i = 0; i < n; ++i) games.push_back(random_game(i));
+        return games;
+    }
+}
+
+TEST(WthorTest, ReplaysGamesWithTheOmittedPasses) {
+    int with_passes = 0;
+    for (const TestGame& game : random_games(200)) {
+        std::vector<replay::WthorPosition> out;
+        ASSERT_EQ(replay::replay_wthor_game(game.record.data(), out), replay::WthorGameStatus::Complete);
+        ASSERT_EQ(out.size(), game.positions.size());
+        for (size_t i = 0; i < out.size(); ++i) {
+            const auto& [board, player] = game.positions[i];
+            EXPECT_EQ(out[i].black, board.bits(Player::BLACK));
+            EXPECT_EQ(out[i].white, board.bits(Player::WHITE));
+            EXPECT_EQ(out[i].to_move, player);
+            const int expected = player == Player::BLACK ? game.black_differential : -game.black_differential;
+            EXPECT_FLOAT_EQ(out[i].value, expected / 64.0f);
+        }
+        with_passes += game.passed;
+    }
+    EXPECT_GT(with_passes, 0);   // the pass handling was exercised
+}
+
+TEST(WthorTest, RejectsIllegalMovesAndLabelsShortGamesFromTheScore) {
+    TestGame game = random_game(7);
+    std::vector<replay::WthorPosition> out(3);
+
+    // a1 is never legal on the first move; nothing is appended
+    TestGame bad = game;
+    bad.record[8] = 11;
+    EXPECT_EQ(replay::replay_wthor_game(bad.record.data(), out), replay::WthorGameStatus::Invalid);
+    bad.record[8] = 19;   // column 9
+    EXPECT_EQ(replay::replay_wthor_game(bad.record.data(), out), replay::WthorGameStatus::Invalid);
+    EXPECT_EQ(out.size(), 3u);
+
+    // Resigned after ten moves with black on 40 discs
+    TestGame cut = game;
+    std::fill(cut.record.begin() + 18, cut.record.end(), 0);
+    cut.record[6] = 40;
+    out.clear();
+    EXPECT_EQ(replay::replay_wthor_game(cut.record.data(), out), replay::WthorGameStatus::Truncated);
+    ASSERT_EQ(out.size(), 10u);
+    EXPECT_FLOAT_EQ(out[0].value, 16 / 64.0f);
+    EXPECT_FLOAT_EQ(out[1].value, -16 / 64.0f);
+}
+
+TEST(WthorTest, ImportsIntoTheStoreAndTheBuffer) {
+    const std::string dir = ::testing::TempDir() + "wthor_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    std::vector<TestGame> games = random_games(50);
+    games[10].record[8] = 11;   // skipped
+    write_wtb(dir + "/a.wtb", std::vector<TestGame>(games.begin(), games.begin() + 30));
+    write_wtb(dir + "/b.wtb", std::vector<TestGame>(games.begin() + 30, games.end()));
+    size_t expected = 0;
+    for (size_t i = 0; i < games.size(); ++i)
+        if (i != 10) expected += games[i].positions.size();
+
+    replay::WthorImportConfig config;
+    config.threads = 3;
+    config.games_per_chunk = 4;
+    replay::WthorImporter importer(config);
+    const std::vector<std::string> paths{dir + "/a.wtb", dir + "/b.wtb"};
+
+    replay::WthorImportStats stats;
+    {
+        replay::ReplayStoreWriter writer(dir + "/store", 500);
+        stats = importer.import_into(paths, writer);
+    }
+    EXPECT_EQ(stats.files, 2u);
+    EXPECT_EQ(stats.games, 49u);
+    EXPECT_EQ(stats.invalid_games, 1u);
+    EXPECT_EQ(stats.truncated_games, 0u);
+    EXPECT_EQ(stats.positions, expected);
+
+    // Every record decodes to a one-hot policy on a legal move
+    replay::ReplayStore store(dir + "/store");
+    store.refresh();
+    ASSERT_EQ(store.size(), expected);
+    std::vector<float> state(192), policy(65);
+    float value = 0.0f;
+    for (size_t i = 0; i < store.size(); i += 97) {
+        store.read(i, state.data(), policy.data(), &value);
+        int ones = 0;
+        for (float p : policy) ones += p == 1.0f;
+        EXPECT_EQ(ones, 1);
+        EXPECT_LE(std::abs(value), 1.0f);
+    }
+
+    ReplayBuffer buffer(1 << 12);
+    stats = importer.import_into(paths, buffer);
+    EXPECT_EQ(buffer.total_inserted(), expected);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(WthorTest, RejectsMalformedFiles) {
+    const std::string dir = ::testing::TempDir() + "wthor_bad";
+    std::filesystem::create_directories(dir);
+    std::vector<TestGame> games = random_games(2);
+    write_wtb(dir + "/short.wtb", games, 3);
+    write_wtb(dir + "/big.wtb", games, 0, 10);
+    EXPECT_THROW(replay::WthorFile(dir + "/short.wtb"), std::runtime_error);
+    EXPECT_THROW(replay::WthorFile(dir + "/big.wtb"), std::runtime_error);
+    EXPECT_THROW(replay::WthorFile(dir + "/missing.wtb"), std::runtime_error);
+
+    // The rejected files are not left mapped
+    std::ifstream maps("/proc/self/maps");
+    std::string maps_text((std::istreambuf_iterator<char>(maps)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(maps_text.find("big.wtb"), std::string::npos);
+
+    write_wtb(dir + "/ok.wtb", games);
+    replay::WthorFile file(dir + "/ok.wtb");
+    EXPECT_EQ(file.games(), 2u);
+    EXPECT_EQ(file.year(), 2024);
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,111 @@
+// tools/calibrate_model.cpp
+// Collects int8 activation ranges for a model and reports int8 vs fp32 accuracy and throughput.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include "othello/board.hpp"
+#include "nn/model_file.hpp"
+#include "nn/network.hpp"
+#include "nn/quantized.hpp"
+#include "nn/simd.hpp"
+
+namespace {
+
+// Positions from random playouts, so every game phase is represented
+std::vector<std::vector<float>> sample_positions(size_t count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<std::vector<float>> positions;
+    positions.reserve(count);
+
+    while (positions.size() < count) {
+        OthelloBoard board;
+        Player player = Player::BLACK;
+        while (!board.is_game_over() && positions.size() < count) {
+            positions.push_back(board.to_tensor(player));
+            auto moves = board.get_valid_moves(player);
+            std::uniform_int_distribution<size_t> pick(0, moves.size() - 1);
+            board.apply_move(player, moves[pick(rng)]);
+            player = othello::opponent(player);
+        }
+    }
+    return positions;
+}
+
+// `mean_value` receives the mean of the values, which are logged so the loop cannot be
+// optimized away
+template <typename Net>
+double evals_per_second(const Net& net, const std::vector<std::vector<float>>& positions, double& mean_value) {
+    std::vector<float> policy(nn::kPolicySize);
+    double value_sum = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& p : positions) value_sum += net.forward(p.data(), policy.data());
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    mean_value = positions.empty() ? 0.0 : value_sum / positions.size();
+    return positions.size() / elapsed.count();
+}
+
+} // Anonymous namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3 || argc > 4) {
+        std::cerr << "Usage: calibrate_model <model.bin> <output.calib> [num_positions]\n";
+        return 1;
+    }
+    size_t num_positions = (argc == 4) ? std::stoul(argv[3]) : 4096;
+
+    nn::Network net = nn::load_model(argv[1]);
+
+    // Calibrate on one set of positions and report on a disjoint one
+    auto calib_set = sample_positions(num_positions, 1);
+    auto eval_set = sample_positions(num_positions, 2);
+
+    nn::Calibration calib = nn::Calibration::collect(net, calib_set);
+    calib.save(argv[2], net);
+    spdlog::info("Calibration over {} positions written to {}", calib_set.size(), argv[2]);
+
+    nn::QuantizedNetwork qnet(net, calib);
+
+    // Agreement report
+    std::vector<float> p32(nn::kPolicySize), p8(nn::kPolicySize);
+    size_t top1_agree = 0;
+    double policy_tv = 0.0, value_abs = 0.0, value_max = 0.0;
+    for (const auto& pos : eval_set) {
+        float v32 = net.forward(pos.data(), p32.data());
+        float v8 = qnet.forward(pos.data(), p8.data());
+
+        // Compare over legal moves only (plane 2), as the search does
+        int best32 = -1, best8 = -1;
+        for (int i = 0; i < nn::kBoardSquares; ++i) {
+            if (pos[2 * nn::kBoardSquares + i] == 0.0f) continue;
+            if (best32 < 0 || p32[i] > p32[best32]) best32 = i;
+            if (best8 < 0 || p8[i] > p8[best8]) best8 = i;
+        }
+        top1_agree += (best32 == best8);
+
+        double tv = 0.0;
+        for (int i = 0; i < nn::kPolicySize; ++i) tv += std::fabs(p32[i] - p8[i]);
+        policy_tv += 0.5 * tv;
+        value_abs += std::fabs(v32 - v8);
+        value_max = std::max(value_max, double(std::fabs(v32 - v8)));
+    }
+
+    double n = static_cast<double>(eval_set.size());
+    spdlog::info("Int8 backend: {}", nn::simd::int8_backend());
+    spdlog::info("Policy top-1 agreement: {:.2f}%", 100.0 * top1_agree / n);
+    spdlog::info("Policy total variation: {:.4f} (mean)", policy_tv / n);
+    spdlog::info("Value abs error: {:.4f} mean, {:.4f} max", value_abs / n, value_max);
+
+    double fp32_mean = 0.0, int8_mean = 0.0;
+    double fp32_rate = evals_per_second(net, eval_set, fp32_mean);
+    double int8_rate = evals_per_second(qnet, eval_set, int8_mean);
+    spdlog::info("Throughput fp32: {:.0f} evals/s, int8: {:.0f} evals/s ({:.2f}x); mean value {:.4f} / {:.4f}",
+                 fp32_rate, int8_rate, int8_rate / fp32_rate, fp32_mean, int8_mean);
+    return 0;
+}
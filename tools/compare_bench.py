@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+"""Compares two othello_bench JSON reports and flags regressions.
+
+    othello_bench --benchmark_out=baseline.json --benchmark_out_format=json
+    ... change things, rebuild ...
+    othello_bench --benchmark_out=current.json --benchmark_out_format=json
+    tools/compare_bench.py baseline.json current.json [--threshold 0.10]
+
+Times are real time per iteration. With --benchmark_repetitions the median aggregate is
+used, otherwise the mean of the runs. Exits with status 1 if any benchmark got slower by
+more than the threshold, so it can gate CI.
+"""
+
+import argparse
+import json
+import sys
+from collections import defaultdict
+
+NS_PER_UNIT = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def load(path):
+    """Benchmark name -> nanoseconds per iteration."""
+    with open(path) as f:
+        report = json.load(f)
+    runs = defaultdict(list)
+    medians = {}
+    for b in report.get("benchmarks", []):
+        if b.get("error_occurred"):
+            continue
+        ns = b["real_time"] * NS_PER_UNIT[b.get("time_unit", "ns")]
+        name = b.get("run_name", b["name"])
+        if b.get("run_type") == "aggregate":
+            if b.get("aggregate_name") == "median":
+                medians[name] = ns
+        else:
+            runs[name].append(ns)
+    times = {name: sum(v) / len(v) for name, v in runs.items()}
+    times.update(medians)
+    return times
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="relative slowdown that counts as a regression (default 0.10)")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+    regressions = []
+    width = max((len(n) for n in baseline.keys() | current.keys()), default=9)
+    print(f"{'Benchmark':<{width}}  {'baseline':>12}  {'current':>12}  {'change':>8}")
+    for name in sorted(baseline.keys() | current.keys()):
+        if name not in current:
+            print(f"{name:<{width}}  {baseline[name]:>10.0f}ns  {'-':>12}  {'gone':>8}")
+            continue
+        if name not in baseline:
+            print(f"{name:<{width}}  {'-':>12}  {current[name]:>10.0f}ns  {'new':>8}")
+            continue
+        change = current[name] / baseline[name] - 1.0
+        flag = ""
+        if change > args.threshold:
+            flag = "  REGRESSION"
+            regressions.append(name)
+        print(f"{name:<{width}}  {baseline[name]:>10.0f}ns  {current[name]:>10.0f}ns  {change:>+7.1%}{flag}")
+
+    if regressions:
+        print(f"\n{len(regressions)} regression(s) beyond {args.threshold:.0%}: {', '.join(regressions)}")
+        return 1
+    print(f"\nNo regressions beyond {args.threshold:.0%}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -6,17 +6,22 @@
 
 int main(int argc, char** argv) {
     if (argc != 3) {
-        std::cerr << "Usage: embed_model <input.bin> <output.hpp>\n";
+        std::cerr << "Usage: embed_model <model.bin> <output.hpp>\n";
         return 1;
     }
 
     std::ifstream in(argv[1], std::ios::binary);
+    if (!in) {
+        std::cerr << "Failed to open " << argv[1] << "\n";
+        return 1;
+    }
     std::ofstream out(argv[2]);
 
     std::vector<unsigned char> buffer(std::istreambuf_iterator<char>(in), {});
 
     out << "#pragma once\n";
-    out << "inline unsigned char model_data[] = {";
+    // Aligned so nn::load_model can use the parameters in place
+    out << "alignas(64) inline const unsigned char model_data[] = {";
 
     for (size_t i = 0; i < buffer.size(); ++i) {
         if (i % 12 == 0) out << "\n    ";
@@ -25,7 +30,7 @@ int main(int argc, char** argv) {
     }
 
     out << "\n};\n";
-    out << "inline size_t model_size = sizeof(model_data);\n";
+    out << "inline constexpr size_t model_size = sizeof(model_data);\n";
 
     return 0;
 }